@@ -209,18 +209,103 @@ void arm_core_mpu_configure_user_context(struct k_thread *thread)
 	arm_core_mpu_configure(THREAD_STACK_REGION, base, size);
 }
 
+#if defined(CONFIG_MPU_LAZY_DOMAIN_SWITCH)
+/*
+ * Partitions last programmed in the memory domain partition regions,
+ * indexed from the first of these regions; a disabled region holds a
+ * zero-sized partition. Entries start out invalid, as the state of the
+ * regions is unknown until they are first written.
+ */
+static struct {
+	struct k_mem_partition part;
+	bool valid;
+} domain_regions[CONFIG_MAX_DOMAIN_PARTITIONS];
+
+/**
+ * This internal function records the partition a memory domain partition
+ * region is about to hold, and returns true if it holds it already.
+ */
+static inline bool _domain_region_unchanged(u32_t part_index,
+				const struct k_mem_partition *part)
+{
+	static const struct k_mem_partition disabled;
+
+	if (part_index >= ARRAY_SIZE(domain_regions)) {
+		return false;
+	}
+
+	if (!part) {
+		part = &disabled;
+	}
+
+	if (domain_regions[part_index].valid &&
+	    domain_regions[part_index].part.start == part->start &&
+	    domain_regions[part_index].part.size == part->size &&
+	    domain_regions[part_index].part.attr == part->attr) {
+		return true;
+	}
+
+	domain_regions[part_index].part = *part;
+	domain_regions[part_index].valid = true;
+
+	return false;
+}
+#else
+static inline bool _domain_region_unchanged(u32_t part_index,
+				const struct k_mem_partition *part)
+{
+	ARG_UNUSED(part_index);
+	ARG_UNUSED(part);
+
+	return false;
+}
+#endif /* CONFIG_MPU_LAZY_DOMAIN_SWITCH */
+
+/**
+ * This internal function programs the MPU region of a memory domain
+ * partition, or disables it if part is NULL, unless the region holds
+ * that configuration already.
+ */
+static void _domain_region_set(u32_t part_index,
+			       struct k_mem_partition *part)
+{
+	u32_t region_index =
+		_get_region_index_by_type(THREAD_DOMAIN_PARTITION_REGION) +
+		part_index;
+	struct arm_mpu_region region_conf;
+
+	if (_domain_region_unchanged(part_index, part)) {
+		return;
+	}
+
+	if (part) {
+		LOG_DBG("set region 0x%x 0x%x 0x%x",
+			    region_index, part->start, part->size);
+		region_conf.base = part->start;
+		_get_ram_region_attr_by_conf(&region_conf.attr,
+			part->attr, part->start, part->size);
+		_region_init(region_index, &region_conf);
+	} else {
+		_disable_region(region_index);
+	}
+}
+
 /**
  * @brief configure MPU regions for the memory partitions of the memory domain
  *
+ * With CONFIG_MPU_LAZY_DOMAIN_SWITCH, only the regions whose partition
+ * differs from the one last programmed there are rewritten, so switching
+ * between threads of the same domain, or of domains sharing partitions,
+ * costs few or no MPU register writes.
+ *
  * @param   mem_domain    memory domain that thread belongs to
  */
 void arm_core_mpu_configure_mem_domain(struct k_mem_domain *mem_domain)
 {
-	u32_t region_index =
-		_get_region_index_by_type(THREAD_DOMAIN_PARTITION_REGION);
+	u32_t num_regions = arm_core_mpu_get_max_domain_partition_regions();
 	u32_t num_partitions;
 	struct k_mem_partition *pparts;
-	struct arm_mpu_region region_conf;
+	u32_t part_index;
 
 	if (mem_domain) {
 		LOG_DBG("configure domain: %p", mem_domain);
@@ -232,17 +317,12 @@ void arm_core_mpu_configure_mem_domain(struct k_mem_domain *mem_domain)
 		pparts = NULL;
 	}
 
-	for (; region_index < _get_num_regions(); region_index++) {
+	for (part_index = 0; part_index < num_regions; part_index++) {
 		if (num_partitions && pparts->size) {
-			LOG_DBG("set region 0x%x 0x%x 0x%x",
-				    region_index, pparts->start, pparts->size);
-			region_conf.base = pparts->start;
-			_get_ram_region_attr_by_conf(&region_conf.attr,
-				pparts->attr,	pparts->start, pparts->size);
-			_region_init(region_index, &region_conf);
+			_domain_region_set(part_index, pparts);
 			num_partitions--;
 		} else {
-			_disable_region(region_index);
+			_domain_region_set(part_index, NULL);
 		}
 		pparts++;
 	}
@@ -259,20 +339,14 @@ void arm_core_mpu_configure_mem_partition(u32_t part_index,
 {
 	u32_t region_index =
 		_get_region_index_by_type(THREAD_DOMAIN_PARTITION_REGION);
-	struct arm_mpu_region region_conf;
 
 	LOG_DBG("configure partition index: %u", part_index);
 
 	if (part &&
 		(region_index + part_index < _get_num_regions())) {
-		LOG_DBG("set region 0x%x 0x%x 0x%x",
-			    region_index + part_index, part->start, part->size);
-		_get_ram_region_attr_by_conf(&region_conf.attr,
-			part->attr, part->start, part->size);
-		region_conf.base = part->start;
-		_region_init(region_index + part_index, &region_conf);
+		_domain_region_set(part_index, part);
 	} else {
-		_disable_region(region_index + part_index);
+		_domain_region_set(part_index, NULL);
 	}
 }
 
@@ -283,10 +357,7 @@ void arm_core_mpu_configure_mem_partition(u32_t part_index,
  */
 void arm_core_mpu_mem_partition_remove(u32_t part_index)
 {
-	u32_t region_index =
-		_get_region_index_by_type(THREAD_DOMAIN_PARTITION_REGION);
-
-	_disable_region(region_index + part_index);
+	_domain_region_set(part_index, NULL);
 }
 
 /**
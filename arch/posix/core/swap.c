@@ -51,6 +51,9 @@ int __swap(unsigned int key)
 	/* retval may be modified with a call to _set_thread_return_value() */
 
 	z_sys_trace_thread_switched_in();
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	z_sched_usage_swap();
+#endif
 
 	posix_thread_status_t *ready_thread_ptr =
 		(posix_thread_status_t *)
@@ -49,80 +49,162 @@ static enum ethernet_hw_caps e1000_caps(struct device *dev)
 		ETHERNET_LINK_1000BASE_T;
 }
 
-static size_t e1000_linearize(struct net_pkt *pkt, void *buf, size_t bufsize)
+#if CONFIG_ETH_E1000_BUF_RX_COUNT <= E1000_RX_DESC_COUNT
+#error CONFIG_ETH_E1000_BUF_RX_COUNT must exceed the RX descriptor count
+#endif
+
+/* The device receives straight into these buffers, which are then passed
+ * to the stack as the data of the received packets.
+ */
+NET_BUF_POOL_DEFINE(e1000_rx_bufs, CONFIG_ETH_E1000_BUF_RX_COUNT,
+		    E1000_RX_BUF_SIZE, CONFIG_NET_BUF_USER_DATA_SIZE, NULL);
+
+#define E1000_RING_INC(_i, _count) ((_i) = ((_i) + 1) % (_count))
+
+/* Release the packets the device is done sending */
+static void e1000_tx_reclaim(struct e1000_dev *dev)
 {
-	size_t len = net_pkt_ll_reserve(pkt) + pkt->frags->len;
-	struct net_buf *nb;
+	unsigned int key = irq_lock();
 
-	/* First fragment contains link layer (Ethernet) header */
-	memcpy(buf, net_pkt_ll(pkt), len);
+	while (dev->tx_tail != dev->tx_head &&
+	       (dev->tx[dev->tx_tail].sta & TDESC_STA_DD)) {
+		if (dev->tx_pkt[dev->tx_tail]) {
+			net_pkt_unref(dev->tx_pkt[dev->tx_tail]);
+			dev->tx_pkt[dev->tx_tail] = NULL;
+		}
 
-	for (nb = pkt->frags->frags; nb; nb = nb->frags) {
-		memcpy((u8_t *) buf + len, nb->data, nb->len);
-		len += nb->len;
+		E1000_RING_INC(dev->tx_tail, E1000_TX_DESC_COUNT);
 	}
 
-	return len;
+	irq_unlock(key);
+}
+
+static int e1000_tx_free(struct e1000_dev *dev)
+{
+	/* One descriptor stays unused, telling a full ring from an
+	 * empty one.
+	 */
+	return E1000_TX_DESC_COUNT - 1 -
+		(dev->tx_head - dev->tx_tail + E1000_TX_DESC_COUNT) %
+		E1000_TX_DESC_COUNT;
 }
 
-static int e1000_tx(struct e1000_dev *dev, void *data, size_t data_len)
+/* Point a TX descriptor at each fragment, the first one along with the
+ * link layer (Ethernet) header in front of it.  The packet is released
+ * once the device is done with its last descriptor.
+ */
+static int e1000_send(struct net_if *iface, struct net_pkt *pkt)
 {
-	dev->tx.addr = POINTER_TO_INT(data);
-	dev->tx.len = data_len;
-	dev->tx.cmd = TDESC_EOP | TDESC_RS;
+	struct e1000_dev *dev = net_if_get_device(iface)->driver_data;
+	volatile struct e1000_tx *desc;
+	struct net_buf *frag;
+	unsigned int key;
+	int count = 0;
+
+	for (frag = pkt->frags; frag; frag = frag->frags) {
+		count++;
+	}
+
+	if (count >= E1000_TX_DESC_COUNT) {
+		LOG_ERR("Too many fragments: %d", count);
+		return -EMSGSIZE;
+	}
 
-	iow32(dev, TDT, 1);
+	e1000_tx_reclaim(dev);
 
-	while (!(dev->tx.sta)) {
+	while (e1000_tx_free(dev) < count) {
 		k_yield();
+		e1000_tx_reclaim(dev);
+	}
+
+	/* e1000_tx_reclaim() walks the ring up to tx_head from the ISR:
+	 * fill the descriptors and move tx_head with interrupts locked.
+	 */
+	key = irq_lock();
+
+	for (frag = pkt->frags; frag; frag = frag->frags) {
+		desc = &dev->tx[dev->tx_head];
+
+		if (frag == pkt->frags) {
+			desc->addr = POINTER_TO_INT(net_pkt_ll(pkt));
+			desc->len = net_pkt_ll_reserve(pkt) + frag->len;
+		} else {
+			desc->addr = POINTER_TO_INT(frag->data);
+			desc->len = frag->len;
+		}
+
+		desc->sta = 0;
+		desc->cmd = TDESC_RS | (frag->frags ? 0 : TDESC_EOP);
+
+		dev->tx_pkt[dev->tx_head] = frag->frags ? NULL : pkt;
+
+		E1000_RING_INC(dev->tx_head, E1000_TX_DESC_COUNT);
 	}
 
-	LOG_DBG("tx.sta: 0x%02hx", dev->tx.sta);
+	iow32(dev, TDT, dev->tx_head);
+
+	irq_unlock(key);
 
-	return (dev->tx.sta & TDESC_STA_DD) ? 0 : -EIO;
+	return 0;
 }
 
-static int e1000_send(struct net_if *iface, struct net_pkt *pkt)
+/* Hand the buffer a frame was received into to the stack, putting a new
+ * one in its place.  When no buffer or packet is available, the frame is
+ * dropped and its buffer used again.
+ */
+static struct net_pkt *e1000_rx_frame(struct e1000_dev *dev,
+				      volatile struct e1000_rx *desc)
 {
-	struct e1000_dev *dev = net_if_get_device(iface)->driver_data;
+	struct net_buf *buf = net_buf_alloc(&e1000_rx_bufs, K_NO_WAIT);
+	struct net_pkt *pkt = net_pkt_get_reserve_rx(0, K_NO_WAIT);
 
-	size_t len = e1000_linearize(pkt, dev->txb, sizeof(dev->txb));
+	if (!buf || !pkt) {
+		LOG_ERR("Out of RX buffers");
+
+		if (buf) {
+			net_buf_unref(buf);
+		}
 
-	int err = e1000_tx(dev, dev->txb, len);
+		if (pkt) {
+			net_pkt_unref(pkt);
+		}
 
-	if (!err) {
-		net_pkt_unref(pkt);
+		return NULL;
 	}
 
-	return err;
+	net_buf_add(dev->rx_buf[dev->rx_tail], desc->len - E1000_CRC_LEN);
+	net_pkt_frag_add(pkt, dev->rx_buf[dev->rx_tail]);
+	dev->rx_buf[dev->rx_tail] = buf;
+
+	return pkt;
 }
 
-static struct net_pkt *e1000_rx(struct e1000_dev *dev)
+static void e1000_rx(struct e1000_dev *dev)
 {
-	struct net_pkt *pkt = NULL;
+	volatile struct e1000_rx *desc;
+	struct net_pkt *pkt;
 
-	LOG_DBG("rx.sta: 0x%02hx", dev->rx.sta);
+	while ((desc = &dev->rx[dev->rx_tail])->sta & RDESC_STA_DD) {
+		LOG_DBG("rx.sta: 0x%02hx", desc->sta);
 
-	if (!(dev->rx.sta & RDESC_STA_DD)) {
-		LOG_ERR("RX descriptor not ready");
-		goto out;
-	}
+		if (desc->err || !(desc->sta & RDESC_STA_EOP)) {
+			LOG_ERR("Bad frame, rx.err: 0x%02hx", desc->err);
+			pkt = NULL;
+		} else {
+			pkt = e1000_rx_frame(dev, desc);
+		}
 
-	pkt = net_pkt_get_reserve_rx(0, K_NO_WAIT);
-	if (!pkt) {
-		LOG_ERR("Out of RX buffers");
-		goto out;
-	}
+		desc->addr = POINTER_TO_INT(dev->rx_buf[dev->rx_tail]->data);
+		desc->sta = 0;
+
+		/* Give the descriptor back to the device */
+		iow32(dev, RDT, dev->rx_tail);
+		E1000_RING_INC(dev->rx_tail, E1000_RX_DESC_COUNT);
 
-	if (!net_pkt_append_all(pkt, dev->rx.len - 4,
-				INT_TO_POINTER((u32_t) dev->rx.addr),
-				K_NO_WAIT)) {
-		LOG_ERR("Out of memory for received frame");
-		net_pkt_unref(pkt);
-		pkt = NULL;
+		if (pkt && net_recv_data(dev->iface, pkt) < 0) {
+			net_pkt_unref(pkt);
+		}
 	}
-out:
-	return pkt;
 }
 
 static void e1000_isr(struct device *device)
@@ -130,18 +212,16 @@ static void e1000_isr(struct device *device)
 	struct e1000_dev *dev = device->driver_data;
 	u32_t icr = ior32(dev, ICR); /* Cleared upon read */
 
-	icr &= ~(ICR_TXDW | ICR_TXQE);
-
-	if (icr & ICR_RXO) {
-		struct net_pkt *pkt = e1000_rx(dev);
-
-		icr &= ~ICR_RXO;
+	if (icr & ICR_TXDW) {
+		e1000_tx_reclaim(dev);
+	}
 
-		if (pkt) {
-			net_recv_data(dev->iface, pkt);
-		}
+	if (icr & (ICR_RXT0 | ICR_RXO)) {
+		e1000_rx(dev);
 	}
 
+	icr &= ~(ICR_TXDW | ICR_TXQE | ICR_RXT0 | ICR_RXO);
+
 	if (icr) {
 		LOG_ERR("Unhandled interrupt, ICR: 0x%x", icr);
 	}
@@ -173,33 +253,39 @@ static void e1000_init(struct net_if *iface)
 {
 	struct e1000_dev *dev = net_if_get_device(iface)->driver_data;
 	u32_t ral, rah;
+	int i;
 
 	dev->iface = iface;
 
-	/* Setup TX descriptor */
+	/* Setup TX descriptors */
 
-	iow32(dev, TDBAL, (u32_t) &dev->tx);
+	iow32(dev, TDBAL, (u32_t) dev->tx);
 	iow32(dev, TDBAH, 0);
-	iow32(dev, TDLEN, 1*16);
+	iow32(dev, TDLEN, sizeof(dev->tx));
 
 	iow32(dev, TDH, 0);
 	iow32(dev, TDT, 0);
 
 	iow32(dev, TCTL, TCTL_EN);
 
-	/* Setup RX descriptor */
+	/* Setup RX descriptors */
 
-	dev->rx.addr = POINTER_TO_INT(dev->rxb);
-	dev->rx.len = sizeof(dev->rxb);
+	for (i = 0; i < E1000_RX_DESC_COUNT; i++) {
+		dev->rx_buf[i] = net_buf_alloc(&e1000_rx_bufs, K_NO_WAIT);
+		dev->rx[i].addr = POINTER_TO_INT(dev->rx_buf[i]->data);
+	}
 
-	iow32(dev, RDBAL, (u32_t) &dev->rx);
+	iow32(dev, RDBAL, (u32_t) dev->rx);
 	iow32(dev, RDBAH, 0);
-	iow32(dev, RDLEN, 1*16);
+	iow32(dev, RDLEN, sizeof(dev->rx));
 
+	/* The descriptor before the head is kept by the driver, telling a
+	 * full ring from an empty one.
+	 */
 	iow32(dev, RDH, 0);
-	iow32(dev, RDT, 1);
+	iow32(dev, RDT, E1000_RX_DESC_COUNT - 1);
 
-	iow32(dev, IMS, IMS_RXO);
+	iow32(dev, IMS, IMS_TXDW | IMS_RXO | IMS_RXT0);
 
 	ral = ior32(dev, RAL);
 	rah = ior32(dev, RAH);
@@ -19,8 +19,11 @@ extern "C" {
 #define ICR_TXDW	     (1) /* Transmit Descriptor Written Back */
 #define ICR_TXQE	(1 << 1) /* Transmit Queue Empty */
 #define ICR_RXO		(1 << 6) /* Receiver Overrun */
+#define ICR_RXT0	(1 << 7) /* Receiver Timer Interrupt */
 
+#define IMS_TXDW	     (1) /* Transmit Descriptor Written Back */
 #define IMS_RXO		(1 << 6) /* Receiver FIFO Overrun */
+#define IMS_RXT0	(1 << 7) /* Receiver Timer Interrupt */
 
 #define RCTL_MPE	(1 << 4) /* Multicast Promiscuous Enabled */
 
@@ -28,10 +31,20 @@ extern "C" {
 #define TDESC_RS	(1 << 3) /* Report Status */
 
 #define RDESC_STA_DD	     (1) /* Descriptor Done */
+#define RDESC_STA_EOP	(1 << 1) /* End Of Packet */
 #define TDESC_STA_DD	     (1) /* Descriptor Done */
 
 #define E1000_MTU 1500
 
+/* Descriptor rings, their lengths must be multiples of 8 */
+#define E1000_TX_DESC_COUNT 16
+#define E1000_RX_DESC_COUNT 8
+
+/* Receive buffer size the device defaults to */
+#define E1000_RX_BUF_SIZE 2048
+
+#define E1000_CRC_LEN 4
+
 #define ETH_ALEN 6	/* TODO: Add a global reusable definition in OS */
 
 enum e1000_reg_t {
@@ -77,13 +90,18 @@ struct e1000_rx {
 };
 
 struct e1000_dev {
-	volatile struct e1000_tx tx __aligned(16);
-	volatile struct e1000_rx rx __aligned(16);
+	volatile struct e1000_tx tx[E1000_TX_DESC_COUNT] __aligned(16);
+	volatile struct e1000_rx rx[E1000_RX_DESC_COUNT] __aligned(16);
+	/* Packet sent through each TX descriptor, set on the last one */
+	struct net_pkt *tx_pkt[E1000_TX_DESC_COUNT];
+	/* Buffer the device receives into through each RX descriptor */
+	struct net_buf *rx_buf[E1000_RX_DESC_COUNT];
+	u16_t tx_head;	/* Next TX descriptor to fill */
+	u16_t tx_tail;	/* Oldest TX descriptor not reclaimed yet */
+	u16_t rx_tail;	/* Next RX descriptor to be filled by the device */
 	struct pci_dev_info pci;
 	struct net_if *iface;
 	u8_t mac[ETH_ALEN];
-	u8_t txb[E1000_MTU];
-	u8_t rxb[E1000_MTU];
 };
 
 static const char *e1000_reg_to_string(enum e1000_reg_t r)
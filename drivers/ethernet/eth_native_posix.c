@@ -50,6 +50,14 @@ LOG_MODULE_REGISTER(LOG_MODULE_NAME);
 #define ETH_HDR_LEN sizeof(struct net_eth_hdr)
 #endif
 
+/* Number of fragments a received frame is read into */
+#define ETH_RX_FRAGS \
+	((_ETH_MTU + ETH_HDR_LEN + CONFIG_NET_BUF_DATA_SIZE - 1) / \
+	 CONFIG_NET_BUF_DATA_SIZE)
+
+/* Maximum number of fragments in a frame that is sent */
+#define ETH_TX_FRAGS 64
+
 #if defined(CONFIG_NET_LLDP)
 static const struct net_lldpdu lldpdu = {
 	.chassis_id = {
@@ -80,8 +88,9 @@ static const struct net_lldpdu lldpdu = {
 #endif /* CONFIG_NET_LLDP */
 
 struct eth_context {
-	u8_t recv[_ETH_MTU + ETH_HDR_LEN];
-	u8_t send[_ETH_MTU + ETH_HDR_LEN];
+	struct net_buf *recv[ETH_RX_FRAGS];
+	struct eth_iovec recv_iov[ETH_RX_FRAGS];
+	struct eth_iovec send_iov[ETH_TX_FRAGS];
 	u8_t mac_addr[6];
 	struct net_linkaddr ll_addr;
 	struct net_if *iface;
@@ -210,19 +219,29 @@ static int eth_send(struct net_if *iface, struct net_pkt *pkt)
 	struct eth_context *ctx = get_context(iface);
 	struct net_buf *frag;
 	int count = 0;
+	int iovcnt = 0;
 	int ret;
 
-	/* First fragment contains link layer (Ethernet) headers.
+	/* The fragments are written as they are, the first one along with
+	 * the link layer (Ethernet) headers in front of it.
 	 */
-	count = net_pkt_ll_reserve(pkt) + pkt->frags->len;
-	memcpy(ctx->send, net_pkt_ll(pkt), count);
-
-	/* Then the remaining data */
-	frag = pkt->frags->frags;
-	while (frag) {
-		memcpy(ctx->send + count, frag->data, frag->len);
-		count += frag->len;
-		frag = frag->frags;
+	for (frag = pkt->frags; frag; frag = frag->frags) {
+		if (iovcnt == ETH_TX_FRAGS) {
+			LOG_DBG("Too many fragments in pkt %p", pkt);
+			return -EMSGSIZE;
+		}
+
+		if (frag == pkt->frags) {
+			ctx->send_iov[iovcnt].base = net_pkt_ll(pkt);
+			ctx->send_iov[iovcnt].len = net_pkt_ll_reserve(pkt) +
+						    frag->len;
+		} else {
+			ctx->send_iov[iovcnt].base = frag->data;
+			ctx->send_iov[iovcnt].len = frag->len;
+		}
+
+		count += ctx->send_iov[iovcnt].len;
+		iovcnt++;
 	}
 
 	eth_stats_update_bytes_tx(iface, count);
@@ -243,7 +262,7 @@ static int eth_send(struct net_if *iface, struct net_pkt *pkt)
 
 	LOG_DBG("Send pkt %p len %d", pkt, count);
 
-	ret = eth_write_data(ctx->dev_fd, ctx->send, count);
+	ret = eth_write_datav(ctx->dev_fd, ctx->send_iov, iovcnt);
 	if (ret < 0) {
 		LOG_DBG("Cannot send pkt %p (%d)", pkt, ret);
 	} else {
@@ -286,17 +305,45 @@ static inline struct net_if *get_iface(struct eth_context *ctx,
 #endif
 }
 
+/* Keep enough fragments ready for a full size frame, the ones a frame
+ * was read into being handed over to the stack.
+ */
+static int refill_recv(struct eth_context *ctx)
+{
+	int i;
+
+	for (i = 0; i < ETH_RX_FRAGS; i++) {
+		if (!ctx->recv[i]) {
+			ctx->recv[i] = net_pkt_get_reserve_rx_data(
+				0, NET_BUF_TIMEOUT);
+			if (!ctx->recv[i]) {
+				return -ENOMEM;
+			}
+		}
+
+		ctx->recv_iov[i].base = net_buf_tail(ctx->recv[i]);
+		ctx->recv_iov[i].len = net_buf_tailroom(ctx->recv[i]);
+	}
+
+	return 0;
+}
+
 static int read_data(struct eth_context *ctx, int fd)
 {
 	u16_t vlan_tag = NET_VLAN_TAG_UNSPEC;
-	int count = 0;
 	struct net_if *iface;
 	struct net_pkt *pkt;
 	struct net_buf *frag;
 	u32_t pkt_len;
 	int ret;
+	int i;
+
+	if (refill_recv(ctx) < 0) {
+		return -ENOMEM;
+	}
 
-	ret = eth_read_data(fd, ctx->recv, sizeof(ctx->recv));
+	/* The frame is read straight into the network buffers */
+	ret = eth_read_datav(fd, ctx->recv_iov, ETH_RX_FRAGS);
 	if (ret <= 0) {
 		return 0;
 	}
@@ -306,20 +353,15 @@ static int read_data(struct eth_context *ctx, int fd)
 		return -ENOMEM;
 	}
 
-	do {
-		frag = net_pkt_get_frag(pkt, NET_BUF_TIMEOUT);
-		if (!frag) {
-			net_pkt_unref(pkt);
-			return -ENOMEM;
-		}
-
-		net_pkt_frag_add(pkt, frag);
+	for (i = 0; ret > 0; i++) {
+		frag = ctx->recv[i];
+		ctx->recv[i] = NULL;
 
-		net_buf_add_mem(frag, ctx->recv + count,
-				min(net_buf_tailroom(frag), ret));
+		net_buf_add(frag, min(net_buf_tailroom(frag), ret));
 		ret -= frag->len;
-		count += frag->len;
-	} while (ret > 0);
+
+		net_pkt_frag_add(pkt, frag);
+	}
 
 #if defined(CONFIG_NET_VLAN)
 	{
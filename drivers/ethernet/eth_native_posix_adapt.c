@@ -15,6 +15,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <errno.h>
 #include <string.h>
 #include <stdbool.h>
@@ -23,6 +24,7 @@
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/select.h>
+#include <sys/uio.h>
 #include <net/if.h>
 #include <time.h>
 #include "posix_trace.h"
@@ -175,6 +177,22 @@ ssize_t eth_write_data(int fd, void *buf, size_t buf_len)
 	return write(fd, buf, buf_len);
 }
 
+BUILD_ASSERT(sizeof(struct eth_iovec) == sizeof(struct iovec));
+BUILD_ASSERT(offsetof(struct eth_iovec, base) ==
+	     offsetof(struct iovec, iov_base));
+BUILD_ASSERT(offsetof(struct eth_iovec, len) ==
+	     offsetof(struct iovec, iov_len));
+
+ssize_t eth_read_datav(int fd, const struct eth_iovec *iov, int iovcnt)
+{
+	return readv(fd, (const struct iovec *)iov, iovcnt);
+}
+
+ssize_t eth_write_datav(int fd, const struct eth_iovec *iov, int iovcnt)
+{
+	return writev(fd, (const struct iovec *)iov, iovcnt);
+}
+
 #if defined(CONFIG_NET_GPTP)
 int eth_clock_gettime(struct net_ptp_time *time)
 {
@@ -25,6 +25,14 @@
 #define ETH_NATIVE_POSIX_STARTUP_SCRIPT_USER ""
 #endif
 
+/* Laid out like the host struct iovec, so that fragments of network
+ * buffers can be read and written in place.
+ */
+struct eth_iovec {
+	void *base;
+	size_t len;
+};
+
 int eth_iface_create(const char *if_name, bool tun_only);
 int eth_iface_remove(int fd);
 int eth_setup_host(const char *if_name);
@@ -32,6 +40,8 @@ int eth_start_script(const char *if_name);
 int eth_wait_data(int fd);
 ssize_t eth_read_data(int fd, void *buf, size_t buf_len);
 ssize_t eth_write_data(int fd, void *buf, size_t buf_len);
+ssize_t eth_read_datav(int fd, const struct eth_iovec *iov, int iovcnt);
+ssize_t eth_write_datav(int fd, const struct eth_iovec *iov, int iovcnt);
 int eth_if_up(const char *if_name);
 int eth_if_down(const char *if_name);
 
@@ -85,6 +85,15 @@ extern bool _priq_rb_lessthan(struct rbnode *a, struct rbnode *b);
 
 #define _WAIT_Q_INIT(wait_q) { { { .lessthan_fn = _priq_rb_lessthan } } }
 
+#elif defined(CONFIG_WAITQ_MULTIQ)
+
+typedef struct {
+	struct _priq_mq waitq;
+} _wait_q_t;
+
+/* all-zero is an empty multiq, see sched_priq.h */
+#define _WAIT_Q_INIT(wait_q) { { .summary = 0 } }
+
 #else
 
 typedef struct {
@@ -167,6 +176,19 @@ struct _k_object_assignment {
 	void * const *objects;
 };
 
+#if CONFIG_KOBJECT_CACHE_SIZE > 0
+struct _k_object_cache_entry {
+	void *obj;
+	struct _k_object *ko;
+};
+
+/* Objects recently looked up by a thread's system calls */
+struct _k_object_cache {
+	u32_t gen;
+	struct _k_object_cache_entry entries[CONFIG_KOBJECT_CACHE_SIZE];
+};
+#endif
+
 /**
  * @brief Grant a static thread access to a list of kernel objects
  *
@@ -384,6 +406,24 @@ struct __thread_entry {
 };
 #endif
 
+/**
+ * @brief Thread runtime statistics
+ *
+ * See k_thread_runtime_stats_get().
+ */
+struct k_thread_runtime_stats {
+	/** Time spent running, in k_cycle_get_32() units */
+	u64_t execution_cycles;
+	/** Number of times the thread was switched in */
+	u32_t switches;
+	/** Number of times it was switched out while still runnable, other
+	 * than by yielding
+	 */
+	u32_t preemptions;
+	/** Number of times it was switched out by k_yield() */
+	u32_t yields;
+};
+
 /* can be used for creating 'dummy' threads, e.g. for pending on objects */
 struct _thread_base {
 
@@ -398,6 +438,9 @@ struct _thread_base {
 	 */
 	_wait_q_t *pended_on;
 
+	/* mutex the thread is waiting on, for priority inheritance chains */
+	struct k_mutex *pended_mutex;
+
 	/* user facing 'thread options'; values defined in include/kernel.h */
 	u8_t user_options;
 
@@ -435,6 +478,21 @@ struct _thread_base {
 	int prio_deadline;
 #endif
 
+#ifdef CONFIG_SCHED_DEADLINE_CBS
+	/* constant bandwidth server, in k_cycle_get_32() units */
+	struct {
+		/* budget per period, 0 if the thread has no server */
+		u32_t budget;
+		u32_t period;
+		/* relative deadline of each job, at most period */
+		u32_t deadline;
+		/* budget left before the deadline is postponed */
+		s32_t left;
+		/* reserved bandwidth (budget / deadline), 16.16 fixed point */
+		u32_t bw;
+	} cbs;
+#endif
+
 	u32_t order_key;
 
 #ifdef CONFIG_SMP
@@ -448,6 +506,11 @@ struct _thread_base {
 	u8_t global_lock_count;
 #endif
 
+#ifdef CONFIG_SCHED_PER_CPU_RUNQ
+	/* "May run on" bits for each CPU */
+	u8_t cpu_mask;
+#endif
+
 	/* data returned by APIs */
 	void *swap_data;
 
@@ -455,6 +518,13 @@ struct _thread_base {
 	/* this thread's entry in a timeout queue */
 	struct _timeout timeout;
 #endif
+
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	struct k_thread_runtime_stats usage;
+
+	/* set while the thread switches out in k_yield() */
+	u8_t yielding;
+#endif
 };
 
 typedef struct _thread_base _thread_base_t;
@@ -554,6 +624,10 @@ struct k_thread {
 	struct _mem_domain_info mem_domain_info;
 	/** Base address of thread stack */
 	k_thread_stack_t *stack_obj;
+#if CONFIG_KOBJECT_CACHE_SIZE > 0
+	/** kernel objects recently looked up by the thread's system calls */
+	struct _k_object_cache kobj_cache;
+#endif
 #endif /* CONFIG_USERSPACE */
 
 #if defined(CONFIG_USE_SWITCH)
@@ -1018,19 +1092,142 @@ __syscall void k_thread_priority_set(k_tid_t thread, int prio);
  * modify its priority with k_thread_priority_set().
  *
  * @note Despite the API naming, the scheduler makes no guarantees the
- * the thread WILL be scheduled within that deadline, nor does it take
- * extra metadata (like e.g. the "runtime" and "period" parameters in
- * Linux sched_setattr()) that allows the kernel to validate the
- * scheduling for achievability.  Such features could be implemented
- * above this call, which is simply input to the priority selection
- * logic.
+ * the thread WILL be scheduled within that deadline, unless the thread
+ * has a bandwidth reservation made with k_thread_cbs_set().  For such
+ * threads, @a deadline becomes the relative deadline of each of the
+ * thread's jobs (capped at its period), the thread starts a new job
+ * with a full budget, and the change is subject to admission control.
  *
  * @param thread A thread on which to set the deadline
  * @param deadline A time delta, in cycle units
  *
+ * @retval 0 Deadline set.
+ * @retval -EINVAL @a deadline is not positive, or the thread has a
+ *         bandwidth reservation and @a deadline is shorter than its budget.
+ * @retval -EBUSY The thread has a bandwidth reservation and the new
+ *         deadline would exceed the bandwidth available for reservations.
  * @req K-THREAD-007
  */
-__syscall void k_thread_deadline_set(k_tid_t thread, int deadline);
+__syscall int k_thread_deadline_set(k_tid_t thread, int deadline);
+#endif
+
+#ifdef CONFIG_SCHED_DEADLINE_CBS
+/**
+ * @brief Reserve a share of the CPU for a deadline thread
+ *
+ * This attaches a constant bandwidth server to @a thread: the thread
+ * may run for @a budget cycles in every @a period cycles at the
+ * deadline priority the server assigns it.  Its deadline is set to
+ * one period from now and, whenever it exhausts its budget, the
+ * budget is replenished and the deadline postponed by one period.
+ * When it wakes up, it starts a new job with a fresh deadline unless
+ * its current budget still fits in the time left to its deadline.
+ * The scheduler compares these deadlines between threads of the same
+ * static priority, so threads with reservations should share one
+ * priority.
+ *
+ * The sum of the budget / deadline ratios of all reservations may not
+ * exceed CONFIG_SCHED_DEADLINE_CBS_MAX_UTILIZATION percent of each CPU.
+ * A budget of 0 releases the reservation.  Budgets are enforced with
+ * the kernel timeout queue, so with the system tick granularity.
+ *
+ * @param thread Thread to reserve bandwidth for
+ * @param budget Execution time per period, in cycle units
+ * @param period Period, in cycle units
+ *
+ * @retval 0 Reservation made.
+ * @retval -EINVAL @a period is 0 or less than @a budget.
+ * @retval -EBUSY Not enough bandwidth left for the reservation.
+ */
+__syscall int k_thread_cbs_set(k_tid_t thread, u32_t budget, u32_t period);
+#endif
+
+#ifdef CONFIG_SCHED_PER_CPU_RUNQ
+/**
+ * @brief Sets all CPU enable masks to zero
+ *
+ * After this returns, the thread will no longer be schedulable on any
+ * CPUs.  The thread must not be currently runnable.  k_thread_start()
+ * does not start a thread with an empty mask, and a thread with an empty
+ * mask that becomes ready is suspended instead, until it is given a CPU
+ * and resumed with k_thread_resume().
+ *
+ * @param thread Thread to operate upon
+ * @return Zero on success, otherwise error code
+ */
+int k_thread_cpu_mask_clear(k_tid_t thread);
+
+/**
+ * @brief Sets all CPU enable masks to one
+ *
+ * After this returns, the thread will be schedulable on any CPU.  The
+ * thread must not be currently runnable.
+ *
+ * @param thread Thread to operate upon
+ * @return Zero on success, otherwise error code
+ */
+int k_thread_cpu_mask_enable_all(k_tid_t thread);
+
+/**
+ * @brief Enable thread to run on specified CPU
+ *
+ * The thread must not be currently runnable.
+ *
+ * @param thread Thread to operate upon
+ * @param cpu CPU index
+ * @retval 0 Mask updated.
+ * @retval -EINVAL The thread is runnable, or @a cpu is not a valid CPU
+ *         index.
+ */
+int k_thread_cpu_mask_enable(k_tid_t thread, int cpu);
+
+/**
+ * @brief Prevent thread to run on specified CPU
+ *
+ * The thread must not be currently runnable.
+ *
+ * @param thread Thread to operate upon
+ * @param cpu CPU index
+ * @retval 0 Mask updated.
+ * @retval -EINVAL The thread is runnable, or @a cpu is not a valid CPU
+ *         index.
+ */
+int k_thread_cpu_mask_disable(k_tid_t thread, int cpu);
+#endif
+
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+/**
+ * @brief Get a thread's runtime statistics
+ *
+ * Execution time is accumulated at each context switch and system
+ * clock tick, and includes the time spent in interrupts taken while
+ * the thread was running.  The figures for the calling thread are
+ * up to date; those of a thread running on another CPU may lag by
+ * up to a tick.
+ *
+ * @param thread Thread to get the statistics of
+ * @param stats Filled with the statistics
+ *
+ * @retval 0 Success.
+ */
+__syscall int k_thread_runtime_stats_get(k_tid_t thread,
+					 struct k_thread_runtime_stats *stats);
+
+/**
+ * @brief Get a CPU's idle time statistics
+ *
+ * These are the runtime statistics of the CPU's idle thread, so
+ * execution_cycles is the time the CPU spent idle, and switches the
+ * number of times it went idle.
+ *
+ * @param cpu CPU index
+ * @param stats Filled with the statistics
+ *
+ * @retval 0 Success.
+ * @retval -EINVAL No such CPU.
+ */
+__syscall int k_cpu_idle_stats_get(int cpu,
+				   struct k_thread_runtime_stats *stats);
 #endif
 
 /**
@@ -1315,6 +1512,8 @@ struct k_timer {
 	/* wait queue for the (single) thread waiting on this timer */
 	_wait_q_t wait_q;
 
+	struct k_spinlock lock;
+
 	/* runs in ISR context */
 	void (*expiry_fn)(struct k_timer *);
 
@@ -1664,6 +1863,10 @@ static inline u32_t k_uptime_delta_32(s64_t *reftime)
 
 struct k_queue {
 	sys_sflist_t data_q;
+	struct k_spinlock lock;
+#ifdef CONFIG_QUEUE_LOCKLESS_APPEND
+	atomic_t inbox;
+#endif
 	union {
 		_wait_q_t wait_q;
 
@@ -1685,6 +1888,17 @@ struct k_queue {
 
 extern void *z_queue_node_peek(sys_sfnode_t *node, bool needs_free);
 
+#ifdef CONFIG_QUEUE_LOCKLESS_APPEND
+/* lowest bit of the inbox word, set while threads may be waiting */
+#define _K_QUEUE_INBOX_CLOSED 0x1
+
+extern void z_queue_inbox_flush(struct k_queue *queue);
+extern bool z_queue_inbox_close(struct k_queue *queue);
+#ifdef CONFIG_POLL
+extern void z_poll_queue_inbox_reopen(struct k_queue *queue);
+#endif
+#endif
+
 /**
  * INTERNAL_HIDDEN @endcond
  */
@@ -1824,6 +2038,27 @@ extern void k_queue_insert(struct k_queue *queue, void *prev, void *data);
  */
 extern void k_queue_append_list(struct k_queue *queue, void *head, void *tail);
 
+/**
+ * @brief Atomically prepend a list of elements to a queue.
+ *
+ * This routine adds a list of data items to the front of @a queue in one
+ * operation, as if each was prepended in turn: the last data item of the
+ * list ends up first in the queue. Threads waiting on the queue get the
+ * first data items of the list. The data items must be in a
+ * singly-linked list, with the first 32 bits in each data item pointing
+ * to the next data item.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param queue Address of the queue.
+ * @param head Pointer to first node in singly-linked list.
+ * @param tail Pointer to last node in singly-linked list.
+ *
+ * @return N/A
+ */
+extern void k_queue_prepend_list(struct k_queue *queue, void *head,
+				 void *tail);
+
 /**
  * @brief Atomically add a list of elements to a queue.
  *
@@ -1871,10 +2106,7 @@ __syscall void *k_queue_get(struct k_queue *queue, s32_t timeout);
  *
  * @return true if data item was removed
  */
-static inline bool k_queue_remove(struct k_queue *queue, void *data)
-{
-	return sys_sflist_find_and_remove(&queue->data_q, (sys_sfnode_t *)data);
-}
+extern bool k_queue_remove(struct k_queue *queue, void *data);
 
 /**
  * @brief Append an element to a queue only if it's not present already.
@@ -1890,19 +2122,7 @@ static inline bool k_queue_remove(struct k_queue *queue, void *data)
  *
  * @return true if data item was added, false if not
  */
-static inline bool k_queue_unique_append(struct k_queue *queue, void *data)
-{
-	sys_sfnode_t *test;
-
-	SYS_SFLIST_FOR_EACH_NODE(&queue->data_q, test) {
-		if (test == (sys_sfnode_t *) data) {
-			return false;
-		}
-	}
-
-	k_queue_append(queue, data);
-	return true;
-}
+extern bool k_queue_unique_append(struct k_queue *queue, void *data);
 
 /**
  * @brief Query a queue to see if it has data available.
@@ -1921,6 +2141,11 @@ __syscall int k_queue_is_empty(struct k_queue *queue);
 
 static inline int _impl_k_queue_is_empty(struct k_queue *queue)
 {
+#ifdef CONFIG_QUEUE_LOCKLESS_APPEND
+	if ((atomic_get(&queue->inbox) & ~_K_QUEUE_INBOX_CLOSED) != 0) {
+		return 0;
+	}
+#endif
 	return (int)sys_sflist_is_empty(&queue->data_q);
 }
 
@@ -1937,6 +2162,9 @@ __syscall void *k_queue_peek_head(struct k_queue *queue);
 
 static inline void *_impl_k_queue_peek_head(struct k_queue *queue)
 {
+#ifdef CONFIG_QUEUE_LOCKLESS_APPEND
+	z_queue_inbox_flush(queue);
+#endif
 	return z_queue_node_peek(sys_sflist_peek_head(&queue->data_q), false);
 }
 
@@ -1953,6 +2181,9 @@ __syscall void *k_queue_peek_tail(struct k_queue *queue);
 
 static inline void *_impl_k_queue_peek_tail(struct k_queue *queue)
 {
+#ifdef CONFIG_QUEUE_LOCKLESS_APPEND
+	z_queue_inbox_flush(queue);
+#endif
 	return z_queue_node_peek(sys_sflist_peek_tail(&queue->data_q), false);
 }
 
@@ -2262,6 +2493,26 @@ struct k_lifo {
 #define k_lifo_alloc_put(lifo, data) \
 	k_queue_alloc_prepend((struct k_queue *) lifo, data)
 
+/**
+ * @brief Atomically add a list of elements to a LIFO queue.
+ *
+ * This routine adds a list of data items to @a lifo in one operation, as
+ * if each was put in turn with k_lifo_put(): the last data item of the
+ * list is the first one k_lifo_get() returns. The data items must be in a
+ * singly-linked list, with the first 32 bits each data item pointing to
+ * the next data item.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param lifo Address of the LIFO queue.
+ * @param head Pointer to first node in singly-linked list.
+ * @param tail Pointer to last node in singly-linked list.
+ *
+ * @return N/A
+ */
+#define k_lifo_put_list(lifo, head, tail) \
+	k_queue_prepend_list((struct k_queue *) lifo, head, tail)
+
 /**
  * @brief Get an element from a LIFO queue.
  *
@@ -2305,6 +2556,7 @@ struct k_lifo {
 
 struct k_stack {
 	_wait_q_t wait_q;
+	struct k_spinlock lock;
 	u32_t *base, *next, *top;
 
 	_OBJECT_TRACING_NEXT_PTR(k_stack);
@@ -2413,6 +2665,51 @@ __syscall void k_stack_push(struct k_stack *stack, u32_t data);
  */
 __syscall int k_stack_pop(struct k_stack *stack, u32_t *data, s32_t timeout);
 
+/**
+ * @brief Push several elements onto a stack.
+ *
+ * This routine adds the @a num_entries 32-bit values of @a data to
+ * @a stack, in order, so that the last one ends up on top. It has the
+ * same effect as successive calls to k_stack_push(), but takes the
+ * stack's lock and calls the scheduler once for the whole batch. The
+ * first values go to threads waiting on the stack, if any. Nothing is
+ * pushed unless the stack has room for all of the values those threads
+ * do not take.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param stack Address of the stack.
+ * @param data Values to push onto the stack.
+ * @param num_entries Number of values to push.
+ *
+ * @retval 0 Values pushed.
+ * @retval -ENOMEM Not enough room on the stack for the values.
+ */
+__syscall int k_stack_push_n(struct k_stack *stack, const u32_t *data,
+			     u32_t num_entries);
+
+/**
+ * @brief Pop several elements from a stack.
+ *
+ * This routine removes up to @a num_entries 32-bit values from @a stack,
+ * top first, and stores them in @a data. If the stack is empty, it
+ * waits for a value to be pushed and only returns that one.
+ *
+ * @note Can be called by ISRs, but @a timeout must be set to K_NO_WAIT.
+ *
+ * @param stack Address of the stack.
+ * @param data Address of array to hold the values popped from the stack.
+ * @param num_entries Size of the array, which must not be zero.
+ * @param timeout Waiting period to obtain a value (in milliseconds),
+ *                or one of the special values K_NO_WAIT and K_FOREVER.
+ *
+ * @return Number of values popped, if any
+ * @retval -EBUSY Returned without waiting.
+ * @retval -EAGAIN Waiting period timed out.
+ */
+__syscall int k_stack_pop_n(struct k_stack *stack, u32_t *data,
+			    u32_t num_entries, s32_t timeout);
+
 /**
  * @brief Statically define and initialize a stack
  *
@@ -2624,8 +2921,11 @@ extern void k_delayed_work_init(struct k_delayed_work *work,
  * the workqueue and becomes pending.
  *
  * Submitting a previously submitted delayed work item that is still
- * counting down cancels the existing submission and restarts the
- * countdown using the new delay.  Note that this behavior is
+ * counting down restarts the countdown using the new delay.  The
+ * pending timeout is moved rather than canceled and added again, so
+ * frequent resubmissions stay cheap with many delayed work items
+ * outstanding.  A work item that is already pending in the workqueue's
+ * queue is removed from it first.  Note that this behavior is
  * inherently subject to race conditions with the pre-existing
  * timeouts and work queue, so care must be taken to synchronize such
  * resubmissions externally.
@@ -2641,8 +2941,7 @@ extern void k_delayed_work_init(struct k_delayed_work *work,
  * @param delay Delay before submitting the work item (in milliseconds).
  *
  * @retval 0 Work item countdown started.
- * @retval -EINPROGRESS Work item is already pending.
- * @retval -EINVAL Work item is being processed or has completed its work.
+ * @retval -EINVAL Work item is being processed.
  * @retval -EADDRINUSE Work item is pending on a different workqueue.
  * @req K-DWORK-001
  */
@@ -2654,16 +2953,17 @@ extern int k_delayed_work_submit_to_queue(struct k_work_q *work_q,
  * @brief Cancel a delayed work item.
  *
  * This routine cancels the submission of delayed work item @a work.
- * A delayed work item can only be canceled while its countdown is still
- * underway.
+ * A delayed work item can be canceled while its countdown is underway
+ * and once it is pending in the workqueue's queue, until the workqueue's
+ * thread starts processing it.
  *
  * @note Can be called by ISRs.
  *
  * @param work Address of delayed work item.
  *
- * @retval 0 Work item countdown canceled.
- * @retval -EINPROGRESS Work item is already pending.
- * @retval -EINVAL Work item is being processed or has completed its work.
+ * @retval 0 Work item countdown canceled, or work item removed from the
+ *         workqueue's queue.
+ * @retval -EINVAL Work item is being processed or was never submitted.
  * @req K-DWORK-001
  */
 extern int k_delayed_work_cancel(struct k_delayed_work *work);
@@ -2705,12 +3005,13 @@ static inline void k_work_submit(struct k_work *work)
  * the workqueue and becomes pending.
  *
  * Submitting a previously submitted delayed work item that is still
- * counting down cancels the existing submission and restarts the countdown
- * using the new delay. If the work item is currently pending on the
- * workqueue's queue because the countdown has completed it is too late to
- * resubmit the item, and resubmission fails without impacting the work item.
- * If the work item has already been processed, or is currently being processed,
- * its work is considered complete and the work item can be resubmitted.
+ * counting down restarts the countdown using the new delay, moving the
+ * pending timeout in place. If the work item is currently pending on the
+ * workqueue's queue because the countdown has completed, it is removed
+ * from the queue and the countdown is started again. If the work item is
+ * currently being processed, resubmission fails without impacting the
+ * work item. If the work item has already been processed, its work is
+ * considered complete and the work item can be resubmitted.
  *
  * @warning
  * Work items submitted to the system workqueue should avoid using handlers
@@ -2723,8 +3024,7 @@ static inline void k_work_submit(struct k_work *work)
  * @param delay Delay before submitting the work item (in milliseconds).
  *
  * @retval 0 Work item countdown started.
- * @retval -EINPROGRESS Work item is already pending.
- * @retval -EINVAL Work item is being processed or has completed its work.
+ * @retval -EINVAL Work item is being processed.
  * @retval -EADDRINUSE Work item is pending on a different workqueue.
  * @req K-DWORK-001
  */
@@ -2739,7 +3039,8 @@ static inline int k_delayed_work_submit(struct k_delayed_work *work,
  *
  * This routine computes the (approximate) time remaining before a
  * delayed work gets executed. If the delayed work is not waiting to be
- * scheduled, it returns zero.
+ * scheduled, it returns zero. It takes constant time, whatever the
+ * number of pending timeouts.
  *
  * @param work     Delayed work item.
  *
@@ -2751,6 +3052,239 @@ static inline s32_t k_delayed_work_remaining_get(struct k_delayed_work *work)
 	return __ticks_to_ms(z_timeout_remaining(&work->timeout));
 }
 
+/** @} */
+
+struct k_pool_work;
+
+/**
+ * @defgroup workpool_apis Work Pool APIs
+ * @ingroup kernel_apis
+ * @{
+ */
+
+/**
+ * @typedef k_pool_work_handler_t
+ * @brief Work pool item handler function type.
+ *
+ * @param work Address of the work pool item.
+ *
+ * @return N/A
+ */
+typedef void (*k_pool_work_handler_t)(struct k_pool_work *work);
+
+/**
+ * @cond INTERNAL_HIDDEN
+ */
+
+struct k_work_domain {
+	sys_slist_t backlog;
+	bool busy;
+};
+
+struct k_pool_work {
+	sys_snode_t node;
+	k_pool_work_handler_t handler;
+	struct k_work_domain *domain;
+	u8_t prio;
+	bool pending;
+#ifdef CONFIG_WORK_POOL_STATS
+	u32_t submit_cycles;
+#endif
+};
+
+/**
+ * INTERNAL_HIDDEN @endcond
+ */
+
+/** @brief Work pool statistics, as reported by k_work_pool_stats_get() */
+struct k_work_pool_stats {
+	/** Items submitted and not yet picked up by a worker thread */
+	u32_t queued;
+	/** Highest value queued reached */
+	u32_t max_queued;
+	/** Items whose handler returned */
+	u32_t completed;
+#ifdef CONFIG_WORK_POOL_STATS
+	/** Longest time an item waited for a worker thread, in cycles */
+	u32_t max_wait_cycles;
+	/** Total time items waited for a worker thread, in cycles */
+	u64_t total_wait_cycles;
+	/** Longest time a handler ran, in cycles */
+	u32_t max_run_cycles;
+	/** Total time handlers ran, in cycles */
+	u64_t total_run_cycles;
+#endif
+};
+
+/**
+ * @cond INTERNAL_HIDDEN
+ */
+
+struct k_work_pool {
+	struct k_spinlock lock;
+	_wait_q_t wait_q;
+	/* pending items, one list per priority */
+	sys_slist_t queues[CONFIG_WORK_POOL_PRIORITIES];
+	/* bit n set when queues[n] is not empty */
+	u32_t ready;
+	struct k_thread *threads;
+	k_thread_stack_t *stacks;
+	size_t stack_size;
+	u8_t num_threads;
+	struct k_work_pool_stats stats;
+};
+
+/**
+ * INTERNAL_HIDDEN @endcond
+ */
+
+/** Run one worker thread per CPU, each pinned to its CPU */
+#define K_WORK_POOL_PER_CPU BIT(0)
+
+/**
+ * @brief Statically define a work pool.
+ *
+ * A work pool is a set of worker threads draining a shared queue of
+ * work items.  Unlike a workqueue, a handler that blocks only holds up
+ * its own worker thread.  The work pool must be started with
+ * k_work_pool_start() before its threads run.
+ *
+ * The work pool can be accessed outside the module where it is defined
+ * using:
+ *
+ * @code extern struct k_work_pool <name>; @endcode
+ *
+ * @param name Name of the work pool.
+ * @param nthreads Number of worker threads.
+ * @param stack_sz Stack size of each worker thread (in bytes).
+ */
+#define K_WORK_POOL_DEFINE(name, nthreads, stack_sz)			\
+	static K_THREAD_STACK_ARRAY_DEFINE(_k_work_pool_stacks_##name,	\
+					   nthreads, stack_sz);		\
+	static struct k_thread _k_work_pool_threads_##name[nthreads];	\
+	struct k_work_pool name = {					\
+		.wait_q = _WAIT_Q_INIT(&name.wait_q),			\
+		.threads = _k_work_pool_threads_##name,		\
+		.stacks = _k_work_pool_stacks_##name[0],		\
+		.stack_size = stack_sz,					\
+		.num_threads = nthreads,				\
+	}
+
+/**
+ * @brief Start a work pool.
+ *
+ * This routine initializes the work pool's queues and spawns its worker
+ * threads, which run forever.
+ *
+ * With the @a options K_WORK_POOL_PER_CPU and
+ * CONFIG_SCHED_PER_CPU_RUNQ, worker thread i only runs on CPU i modulo
+ * the number of CPUs, so a pool defined with CONFIG_MP_NUM_CPUS threads
+ * has one worker per CPU.
+ *
+ * @param pool Address of the work pool.
+ * @param prio Priority of the worker threads.
+ * @param options K_WORK_POOL_PER_CPU, or 0.
+ *
+ * @return N/A
+ */
+extern void k_work_pool_start(struct k_work_pool *pool, int prio,
+			      u32_t options);
+
+/**
+ * @brief Initialize an ordering domain.
+ *
+ * Work items of the same domain never run concurrently, and run in the
+ * order they were submitted, whatever their priority: an item only
+ * enters its pool's queue once the previous item of its domain has
+ * completed.
+ *
+ * @param domain Address of the domain.
+ *
+ * @return N/A
+ */
+static inline void k_work_domain_init(struct k_work_domain *domain)
+{
+	sys_slist_init(&domain->backlog);
+	domain->busy = false;
+}
+
+/**
+ * @brief Initialize a work pool item.
+ *
+ * @param work Address of the work pool item.
+ * @param handler Function to invoke each time the item is processed.
+ * @param prio Priority of the item, from 0 (highest) to
+ *        CONFIG_WORK_POOL_PRIORITIES - 1.  Worker threads pick up the
+ *        oldest item of the highest priority first.
+ * @param domain Ordering domain of the item, or NULL to let it run
+ *        concurrently with any other item.
+ *
+ * @return N/A
+ */
+static inline void k_pool_work_init(struct k_pool_work *work,
+				    k_pool_work_handler_t handler, int prio,
+				    struct k_work_domain *domain)
+{
+	__ASSERT(prio >= 0 && prio < CONFIG_WORK_POOL_PRIORITIES,
+		 "invalid work pool item priority");
+
+	*work = (struct k_pool_work) {
+		.handler = handler,
+		.domain = domain,
+		.prio = prio,
+	};
+}
+
+/**
+ * @brief Submit a work pool item.
+ *
+ * This routine submits work pool item @a work to be processed by one of
+ * the worker threads of @a pool.  If the item is already pending, this
+ * routine has no effect on it.  An item stops being pending when a
+ * worker thread picks it up, so it can be resubmitted by its handler.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param pool Address of the work pool.
+ * @param work Address of the work pool item.
+ *
+ * @return N/A
+ */
+extern void k_work_pool_submit(struct k_work_pool *pool,
+			       struct k_pool_work *work);
+
+/**
+ * @brief Check if a work pool item is pending.
+ *
+ * @param work Address of the work pool item.
+ *
+ * @return true if the item is waiting to be processed.
+ */
+static inline bool k_pool_work_pending(struct k_pool_work *work)
+{
+	return work->pending;
+}
+
+/**
+ * @brief Get the statistics of a work pool.
+ *
+ * @param pool Address of the work pool.
+ * @param stats Filled with the statistics.
+ *
+ * @return N/A
+ */
+extern void k_work_pool_stats_get(struct k_work_pool *pool,
+				  struct k_work_pool_stats *stats);
+
+/**
+ * @brief Reset the maximum and total statistics of a work pool.
+ *
+ * @param pool Address of the work pool.
+ *
+ * @return N/A
+ */
+extern void k_work_pool_stats_reset(struct k_work_pool *pool);
+
 /** @} */
 /**
  * @defgroup mutex_apis Mutex APIs
@@ -2867,6 +3401,7 @@ __syscall void k_mutex_unlock(struct k_mutex *mutex);
 
 struct k_sem {
 	_wait_q_t wait_q;
+	struct k_spinlock lock;
 	u32_t count;
 	u32_t limit;
 	_POLL_EVENT;
@@ -3165,6 +3700,7 @@ __syscall void k_alert_send(struct k_alert *alert);
  */
 struct k_msgq {
 	_wait_q_t wait_q;
+	struct k_spinlock lock;
 	size_t msg_size;
 	u32_t max_msgs;
 	char *buffer_start;
@@ -3327,6 +3863,95 @@ __syscall int k_msgq_put(struct k_msgq *q, void *data, s32_t timeout);
  */
 __syscall int k_msgq_get(struct k_msgq *q, void *data, s32_t timeout);
 
+/**
+ * @brief Send several messages to a message queue.
+ *
+ * This routine sends up to @a num_msgs consecutive messages from @a data to
+ * message queue @a q, taking the message queue's lock only once. Messages
+ * are first handed to threads waiting to receive, then queued as long as
+ * there is space. If no message at all can be sent, the caller waits up to
+ * @a timeout for the first one to be accepted.
+ *
+ * @note Can be called by ISRs, but @a timeout must be set to K_NO_WAIT.
+ *
+ * @param q Address of the message queue.
+ * @param data Pointer to the array of messages.
+ * @param num_msgs Number of messages in @a data.
+ * @param timeout Waiting period to add the first message (in milliseconds),
+ *                or one of the special values K_NO_WAIT and K_FOREVER.
+ *
+ * @return Number of messages sent, which is less than @a num_msgs if the
+ *         queue filled up.
+ * @retval -ENOMSG Returned without waiting or queue purged.
+ * @retval -EAGAIN Waiting period timed out.
+ */
+__syscall int k_msgq_put_n(struct k_msgq *q, const void *data, u32_t num_msgs,
+			   s32_t timeout);
+
+/**
+ * @brief Receive several messages from a message queue.
+ *
+ * This routine receives up to @a num_msgs messages from message queue @a q
+ * into @a data in a "first in, first out" manner, taking the message
+ * queue's lock only once. Threads waiting to send are given as many of the
+ * freed slots as they need. If the queue is empty, the caller waits up to
+ * @a timeout for one message.
+ *
+ * @note Can be called by ISRs, but @a timeout must be set to K_NO_WAIT.
+ *
+ * @param q Address of the message queue.
+ * @param data Address of area to hold @a num_msgs messages.
+ * @param num_msgs Maximum number of messages to receive.
+ * @param timeout Waiting period to receive a message (in milliseconds),
+ *                or one of the special values K_NO_WAIT and K_FOREVER.
+ *
+ * @return Number of messages received.
+ * @retval -ENOMSG Returned without waiting.
+ * @retval -EAGAIN Waiting period timed out.
+ */
+__syscall int k_msgq_get_n(struct k_msgq *q, void *data, u32_t num_msgs,
+			   s32_t timeout);
+
+/**
+ * @brief Get direct access to messages in a message queue.
+ *
+ * This routine gives access to up to @a num_msgs messages at the head of
+ * message queue @a q without copying them. The messages stay in the queue,
+ * still counted as used, until they are released with k_msgq_get_finish().
+ * Fewer messages than available may be returned when they wrap around the
+ * end of the ring buffer; claim again after finishing to get the rest.
+ *
+ * @warning
+ * While messages are claimed, no other thread or ISR may receive from or
+ * purge the message queue.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param q Address of the message queue.
+ * @param data Set to the address of the first message in the ring buffer.
+ * @param num_msgs Maximum number of messages to claim.
+ *
+ * @return Number of consecutive messages available at @a data.
+ */
+u32_t k_msgq_get_claim(struct k_msgq *q, void **data, u32_t num_msgs);
+
+/**
+ * @brief Release messages obtained with k_msgq_get_claim().
+ *
+ * This routine removes the first @a num_msgs messages from message queue
+ * @a q, which the caller must have claimed and is done with, and lets
+ * threads waiting to send use the freed space.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param q Address of the message queue.
+ * @param num_msgs Number of messages to release.
+ *
+ * @retval 0 Messages released.
+ * @retval -EINVAL @a num_msgs exceeds the number of messages in the queue.
+ */
+int k_msgq_get_finish(struct k_msgq *q, u32_t num_msgs);
+
 /**
  * @brief Purge a message queue.
  *
@@ -3403,11 +4028,19 @@ static inline u32_t _impl_k_msgq_num_used_get(struct k_msgq *q)
  * to 16M of memory managed by a single pool.  Long term it would be
  * good to move to a variable bit size based on configuration.
  */
+#ifdef CONFIG_MEM_POOL_HEAP_BACKEND
+struct k_mem_block_id {
+	u32_t pool : 8;
+	/* offset of the block in the pool's buffer, in 8 byte units */
+	u32_t offset : 24;
+};
+#else
 struct k_mem_block_id {
 	u32_t pool : 8;
 	u32_t level : 4;
 	u32_t block : 20;
 };
+#endif
 
 struct k_mem_block {
 	void *data;
@@ -3450,6 +4083,7 @@ struct k_mbox_msg {
 struct k_mbox {
 	_wait_q_t tx_msg_queue;
 	_wait_q_t rx_msg_queue;
+	struct k_spinlock lock;
 
 	_OBJECT_TRACING_NEXT_PTR(k_mbox);
 };
@@ -3629,6 +4263,10 @@ struct k_pipe {
 	size_t         bytes_used;      /**< # bytes used in buffer */
 	size_t         read_index;      /**< Where in buffer to read from */
 	size_t         write_index;     /**< Where in buffer to write */
+	size_t         put_claimed;     /**< # bytes claimed for writing */
+	size_t         get_claimed;     /**< # bytes claimed for reading */
+
+	struct k_spinlock lock;         /**< Pipe lock */
 
 	struct {
 		_wait_q_t      readers; /**< Reader wait queue */
@@ -3651,6 +4289,8 @@ struct k_pipe {
 	.bytes_used = 0,                                              \
 	.read_index = 0,                                              \
 	.write_index = 0,                                             \
+	.put_claimed = 0,                                             \
+	.get_claimed = 0,                                             \
 	.wait_q.writers = _WAIT_Q_INIT(&obj.wait_q.writers), \
 	.wait_q.readers = _WAIT_Q_INIT(&obj.wait_q.readers), \
 	_OBJECT_TRACING_INIT                            \
@@ -3745,6 +4385,7 @@ __syscall int k_pipe_alloc_init(struct k_pipe *pipe, size_t size);
  *
  * @retval 0 At least @a min_xfer bytes of data were written.
  * @retval -EIO Returned without waiting; zero data bytes were written.
+ * @retval -EBUSY A write claim is outstanding; zero data bytes were written.
  * @retval -EAGAIN Waiting period timed out; between zero and @a min_xfer
  *                 minus one data bytes were written.
  * @req K-PIPE-002
@@ -3769,6 +4410,7 @@ __syscall int k_pipe_put(struct k_pipe *pipe, void *data,
  *
  * @retval 0 At least @a min_xfer bytes of data were read.
  * @retval -EIO Returned without waiting; zero data bytes were read.
+ * @retval -EBUSY A read claim is outstanding; zero data bytes were read.
  * @retval -EAGAIN Waiting period timed out; between zero and @a min_xfer
  *                 minus one data bytes were read.
  * @req K-PIPE-002
@@ -3795,19 +4437,183 @@ __syscall int k_pipe_get(struct k_pipe *pipe, void *data,
 extern void k_pipe_block_put(struct k_pipe *pipe, struct k_mem_block *block,
 			     size_t size, struct k_sem *sem);
 
+/**
+ * @brief Claim space in a pipe's ring buffer for writing.
+ *
+ * This routine gives direct access to the free space of @a pipe's ring
+ * buffer, so that a producer can build its data in place rather than
+ * copying it in with k_pipe_put(). The claimed area is contiguous, so it
+ * may be smaller than requested when the free space wraps around the end
+ * of the ring buffer.
+ *
+ * Nothing is written to the pipe until k_pipe_put_commit() is called.
+ * Only one write claim can be outstanding at a time, and k_pipe_put() fails
+ * with -EBUSY until it is committed.
+ *
+ * @param pipe Address of the pipe.
+ * @param data Address of area to hold the address of the claimed space.
+ * @param bytes Maximum number of bytes to claim.
+ * @param bytes_claimed Address of area to hold the number of bytes claimed.
+ * @param timeout Waiting period to wait for free space (in milliseconds),
+ *                or one of the special values K_NO_WAIT and K_FOREVER.
+ *
+ * @retval 0 At least one byte was claimed.
+ * @retval -EBUSY A write claim is already outstanding.
+ * @retval -EINVAL The pipe has no ring buffer, or @a bytes is zero.
+ * @retval -EIO Returned without waiting; the ring buffer is full.
+ * @retval -EAGAIN Waiting period timed out.
+ */
+extern int k_pipe_put_claim(struct k_pipe *pipe, void **data, size_t bytes,
+			    size_t *bytes_claimed, s32_t timeout);
+
+/**
+ * @brief Write claimed space to a pipe.
+ *
+ * This routine adds the first @a bytes bytes of the space claimed by
+ * k_pipe_put_claim() to @a pipe, and releases the rest of the claim.
+ * Readers waiting for data are given it at once.
+ *
+ * @param pipe Address of the pipe.
+ * @param bytes Number of bytes to write, at most the number claimed.
+ *
+ * @return N/A
+ */
+extern void k_pipe_put_commit(struct k_pipe *pipe, size_t bytes);
+
+/**
+ * @brief Claim data in a pipe's ring buffer for reading.
+ *
+ * This routine gives direct access to the data held in @a pipe's ring
+ * buffer, so that a consumer can process it in place rather than copying
+ * it out with k_pipe_get(). The claimed area is contiguous, so it may be
+ * smaller than the data available when the data wraps around the end of
+ * the ring buffer.
+ *
+ * The data stays in the pipe until k_pipe_get_commit() is called. Only
+ * one read claim can be outstanding at a time, and k_pipe_get() fails with
+ * -EBUSY until it is committed.
+ *
+ * @param pipe Address of the pipe.
+ * @param data Address of area to hold the address of the claimed data.
+ * @param bytes Maximum number of bytes to claim.
+ * @param bytes_claimed Address of area to hold the number of bytes claimed.
+ * @param timeout Waiting period to wait for data (in milliseconds), or one
+ *                of the special values K_NO_WAIT and K_FOREVER.
+ *
+ * @retval 0 At least one byte was claimed.
+ * @retval -EBUSY A read claim is already outstanding.
+ * @retval -EINVAL The pipe has no ring buffer, or @a bytes is zero.
+ * @retval -EIO Returned without waiting; the ring buffer is empty.
+ * @retval -EAGAIN Waiting period timed out.
+ */
+extern int k_pipe_get_claim(struct k_pipe *pipe, void **data, size_t bytes,
+			    size_t *bytes_claimed, s32_t timeout);
+
+/**
+ * @brief Read claimed data from a pipe.
+ *
+ * This routine removes the first @a bytes bytes of the data claimed by
+ * k_pipe_get_claim() from @a pipe, and releases the rest of the claim.
+ * Writers waiting for space are given it at once.
+ *
+ * @param pipe Address of the pipe.
+ * @param bytes Number of bytes to read, at most the number claimed.
+ *
+ * @return N/A
+ */
+extern void k_pipe_get_commit(struct k_pipe *pipe, size_t bytes);
+
+/** Pipe scatter-gather element */
+struct k_pipe_vec {
+	void   *data;   /**< Address of the data */
+	size_t  len;    /**< Size of the data (in bytes) */
+};
+
+/**
+ * @brief Write scattered data to a pipe.
+ *
+ * This routine writes the buffers described by @a vec, in order, to
+ * @a pipe, as k_pipe_put() would write them once gathered in a single
+ * buffer. The data is copied straight into the pipe's ring buffer through
+ * k_pipe_put_claim(), so the pipe must have a ring buffer, and no other
+ * data may be written to the pipe meanwhile.
+ *
+ * @param pipe Address of the pipe.
+ * @param vec Array of buffers to write.
+ * @param count Number of elements in @a vec.
+ * @param bytes_written Address of area to hold the number of bytes written.
+ * @param min_xfer Minimum number of bytes to write.
+ * @param timeout Waiting period to wait for the data to be written (in
+ *                milliseconds), or one of the special values K_NO_WAIT
+ *                and K_FOREVER.
+ *
+ * @retval 0 At least @a min_xfer bytes of data were written.
+ * @retval -EIO Returned without waiting; zero data bytes were written.
+ * @retval -EAGAIN Waiting period timed out; between zero and @a min_xfer
+ *                 minus one data bytes were written.
+ */
+extern int k_pipe_put_sg(struct k_pipe *pipe, const struct k_pipe_vec *vec,
+			 int count, size_t *bytes_written, size_t min_xfer,
+			 s32_t timeout);
+
+/**
+ * @brief Read data from a pipe into scattered buffers.
+ *
+ * This routine reads data from @a pipe into the buffers described by
+ * @a vec, filling each in turn, as k_pipe_get() would read it into a
+ * single buffer. The data is copied straight out of the pipe's ring
+ * buffer through k_pipe_get_claim(), so the pipe must have a ring buffer,
+ * and no other data may be read from the pipe meanwhile.
+ *
+ * @param pipe Address of the pipe.
+ * @param vec Array of buffers to fill.
+ * @param count Number of elements in @a vec.
+ * @param bytes_read Address of area to hold the number of bytes read.
+ * @param min_xfer Minimum number of bytes to read.
+ * @param timeout Waiting period to wait for the data to be read (in
+ *                milliseconds), or one of the special values K_NO_WAIT
+ *                and K_FOREVER.
+ *
+ * @retval 0 At least @a min_xfer bytes of data were read.
+ * @retval -EIO Returned without waiting; zero data bytes were read.
+ * @retval -EAGAIN Waiting period timed out; between zero and @a min_xfer
+ *                 minus one data bytes were read.
+ */
+extern int k_pipe_get_sg(struct k_pipe *pipe, const struct k_pipe_vec *vec,
+			 int count, size_t *bytes_read, size_t min_xfer,
+			 s32_t timeout);
+
 /** @} */
 
 /**
  * @cond INTERNAL_HIDDEN
  */
 
+#ifdef CONFIG_MEM_SLAB_MAGAZINES
+struct k_mem_slab_magazine {
+	struct k_spinlock lock;
+	char *list;
+	u32_t count;
+};
+#endif
+
 struct k_mem_slab {
 	_wait_q_t wait_q;
+	struct k_spinlock lock;
 	u32_t num_blocks;
 	size_t block_size;
 	char *buffer;
 	char *free_list;
+	/* blocks not on free_list, including those cached in magazines */
 	u32_t num_used;
+#ifdef CONFIG_MEM_SLAB_TRACE_MAX_UTILIZATION
+	u32_t max_used;
+#endif
+#ifdef CONFIG_MEM_SLAB_MAGAZINES
+	struct k_mem_slab_magazine mags[CONFIG_MP_NUM_CPUS];
+	/* threads waiting, or about to, for a block */
+	atomic_t waiters;
+#endif
 
 	_OBJECT_TRACING_NEXT_PTR(k_mem_slab);
 };
@@ -3921,11 +4727,47 @@ extern int k_mem_slab_alloc(struct k_mem_slab *slab, void **mem,
  */
 extern void k_mem_slab_free(struct k_mem_slab *slab, void **mem);
 
+/**
+ * @brief Allocate several blocks from a memory slab.
+ *
+ * This routine allocates @a count memory blocks at once, taking the
+ * slab's lock only once.  Either all of them are allocated or none is.
+ * It does not wait for blocks to become available.
+ *
+ * @param slab Address of the memory slab.
+ * @param mem Array of @a count block addresses, set to the starting
+ *        addresses of the memory blocks.
+ * @param count Number of blocks to allocate.
+ *
+ * @retval 0 Memory allocated.
+ * @retval -ENOMEM Fewer than @a count blocks are free.
+ */
+extern int k_mem_slab_alloc_n(struct k_mem_slab *slab, void **mem,
+			      u32_t count);
+
+/**
+ * @brief Free several blocks into a memory slab.
+ *
+ * This routine releases @a count memory blocks at once, taking the
+ * slab's lock only once.  Threads waiting for a block get the first
+ * ones.
+ *
+ * @param slab Address of the memory slab.
+ * @param mem Array of @a count block addresses, as set by
+ *        k_mem_slab_alloc_n() or k_mem_slab_alloc().
+ * @param count Number of blocks to free.
+ *
+ * @return N/A
+ */
+extern void k_mem_slab_free_n(struct k_mem_slab *slab, void **mem,
+			      u32_t count);
+
 /**
  * @brief Get the number of used blocks in a memory slab.
  *
  * This routine gets the number of memory blocks that are currently
- * allocated in @a slab.
+ * allocated in @a slab.  With CONFIG_MEM_SLAB_MAGAZINES, the result is
+ * only approximate while other CPUs use the slab.
  *
  * @param slab Address of the memory slab.
  *
@@ -3934,9 +4776,38 @@ extern void k_mem_slab_free(struct k_mem_slab *slab, void **mem);
  */
 static inline u32_t k_mem_slab_num_used_get(struct k_mem_slab *slab)
 {
+#ifdef CONFIG_MEM_SLAB_MAGAZINES
+	u32_t num_used = slab->num_used;
+	u32_t cached = 0;
+
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		cached += slab->mags[i].count;
+	}
+
+	return num_used > cached ? num_used - cached : 0;
+#else
 	return slab->num_used;
+#endif
 }
 
+#ifdef CONFIG_MEM_SLAB_TRACE_MAX_UTILIZATION
+/**
+ * @brief Get the maximum number of used blocks in a memory slab.
+ *
+ * This routine gets the highest number of memory blocks that were
+ * allocated at once in @a slab since it was initialized.  Blocks cached
+ * in per-CPU magazines count as allocated.
+ *
+ * @param slab Address of the memory slab.
+ *
+ * @return Maximum number of allocated memory blocks.
+ */
+static inline u32_t k_mem_slab_max_used_get(struct k_mem_slab *slab)
+{
+	return slab->max_used;
+}
+#endif
+
 /**
  * @brief Get the number of unused blocks in a memory slab.
  *
@@ -3950,7 +4821,7 @@ static inline u32_t k_mem_slab_num_used_get(struct k_mem_slab *slab)
  */
 static inline u32_t k_mem_slab_num_free_get(struct k_mem_slab *slab)
 {
-	return slab->num_blocks - slab->num_used;
+	return slab->num_blocks - k_mem_slab_num_used_get(slab);
 }
 
 /** @} */
@@ -3959,10 +4830,18 @@ static inline u32_t k_mem_slab_num_free_get(struct k_mem_slab *slab)
  * @cond INTERNAL_HIDDEN
  */
 
+#ifdef CONFIG_MEM_POOL_HEAP_BACKEND
+struct k_mem_pool {
+	struct sys_heap heap;
+	struct k_spinlock lock;
+	_wait_q_t wait_q;
+};
+#else
 struct k_mem_pool {
 	struct sys_mem_pool_base base;
 	_wait_q_t wait_q;
 };
+#endif
 
 /**
  * INTERNAL_HIDDEN @endcond
@@ -3993,6 +4872,17 @@ struct k_mem_pool {
  * @param align Alignment of the pool's buffer (power of 2).
  * @req K-MPOOL-001
  */
+#ifdef CONFIG_MEM_POOL_HEAP_BACKEND
+#define K_MEM_POOL_DEFINE(name, minsz, maxsz, nmax, align)		\
+	char __aligned(max(align, 8))					\
+		_mpool_buf_##name[SYS_HEAP_BUF_SIZE(nmax, maxsz)];	\
+	struct k_mem_pool name __in_section(_k_mem_pool, static, name) = { \
+		.heap = {						\
+			.init_mem = _mpool_buf_##name,			\
+			.init_bytes = sizeof(_mpool_buf_##name),	\
+		} \
+	}
+#else
 #define K_MEM_POOL_DEFINE(name, minsz, maxsz, nmax, align)		\
 	char __aligned(align) _mpool_buf_##name[_ALIGN4(maxsz * nmax)	\
 				  + _MPOOL_BITS_SIZE(maxsz, minsz, nmax)]; \
@@ -4007,6 +4897,7 @@ struct k_mem_pool {
 			.flags = SYS_MEM_POOL_KERNEL			\
 		} \
 	}
+#endif
 
 /**
  * @brief Allocate memory from a memory pool.
@@ -4273,6 +5164,15 @@ struct k_poll_event {
 	};
 };
 
+/* public - persistent poll set */
+struct k_poll_set {
+	/* PRIVATE - DO NOT TOUCH */
+	struct _poller poller;
+	_wait_q_t wait_q;
+	sys_dlist_t ready;
+	sys_dlist_t returned;
+};
+
 #define K_POLL_EVENT_INITIALIZER(event_type, event_mode, event_obj) \
 	{ \
 	.poller = NULL, \
@@ -4425,6 +5325,82 @@ __syscall void k_poll_signal_check(struct k_poll_signal *signal,
 
 __syscall int k_poll_signal_raise(struct k_poll_signal *signal, int result);
 
+/**
+ * @brief Initialize a poll set.
+ *
+ * A poll set watches any number of poll events across calls to
+ * k_poll_set_wait(). Unlike with k_poll(), the events are registered
+ * with their objects once, when added to the set, and signaled events
+ * are queued on the set, so the cost of a wait depends on the number of
+ * events that are ready, not on the number of events watched.
+ *
+ * @param set Address of the poll set.
+ *
+ * @return N/A
+ */
+extern void k_poll_set_init(struct k_poll_set *set);
+
+/**
+ * @brief Add an event to a poll set.
+ *
+ * The event, initialized with k_poll_event_init(), must stay valid and
+ * untouched until it is removed from the set. It can only be in one set
+ * at a time, and must not be passed to k_poll() meanwhile.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param set Address of the poll set.
+ * @param event Address of the event.
+ *
+ * @retval 0 Event added.
+ * @retval -EINVAL Event is of type K_POLL_TYPE_IGNORE.
+ * @retval -EBUSY Event is already in a poll set or being polled.
+ */
+extern int k_poll_set_add(struct k_poll_set *set, struct k_poll_event *event);
+
+/**
+ * @brief Remove an event from a poll set.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param set Address of the poll set.
+ * @param event Address of the event.
+ *
+ * @retval 0 Event removed.
+ * @retval -EINVAL Event is not in @a set.
+ */
+extern int k_poll_set_remove(struct k_poll_set *set,
+			     struct k_poll_event *event);
+
+/**
+ * @brief Wait for events of a poll set to be ready.
+ *
+ * Stores the addresses of up to @a max_events ready events of the set
+ * in @a events, oldest first, and returns how many there are. Their
+ * state field tells which conditions were met, as with k_poll().
+ *
+ * Readiness is level triggered: the events returned are checked again
+ * at the start of the next call, and are returned again if their
+ * condition is still met, e.g. if the semaphore was not taken or the
+ * FIFO not emptied meanwhile.
+ *
+ * Several threads can wait on the same set. Each ready event is only
+ * returned to one of them.
+ *
+ * @param set Address of the poll set.
+ * @param events Array filled with the addresses of the ready events.
+ * @param max_events Size of @a events.
+ * @param timeout Waiting period for an event to be ready (in
+ *                milliseconds), or one of the special values K_NO_WAIT
+ *                and K_FOREVER.
+ *
+ * @return Number of ready events stored in @a events.
+ * @retval -EAGAIN No event was ready before the timeout.
+ */
+extern int k_poll_set_wait(struct k_poll_set *set,
+			   struct k_poll_event **events, int max_events,
+			   s32_t timeout);
+
 /**
  * @internal
  */
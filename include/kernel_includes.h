@@ -26,12 +26,14 @@
 #include <misc/sflist.h>
 #include <misc/util.h>
 #include <misc/mempool_base.h>
+#include <misc/heap.h>
 #include <kernel_version.h>
 #include <random/rand32.h>
 #include <kernel_arch_thread.h>
 #include <syscall.h>
 #include <misc/printk.h>
 #include <arch/cpu.h>
+#include <spinlock.h>
 #include <misc/rb.h>
 #include <sys_clock.h>
 
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_MISC_HEAP_H_
+#define ZEPHYR_INCLUDE_MISC_HEAP_H_
+
+#include <zephyr/types.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <misc/util.h>
+
+/**
+ * @file
+ * @brief Two-level segregated fit heap
+ *
+ * A sys_heap hands out blocks of any size from a single buffer, like
+ * malloc().  Free blocks are kept in lists by size class: the first
+ * level is the power of two below the size, the second one splits that
+ * range in four.  Allocating takes the first block from the smallest
+ * non-empty class whose blocks are all large enough, found with two
+ * bitmap lookups, and splits off what isn't needed.  Freeing a block
+ * merges it with its free neighbors.  Both take constant time, except
+ * that when no such class has a block, the class of the requested size
+ * itself is searched before failing, which is linear in its length.
+ *
+ * Each block costs 8 bytes of header and blocks are 8 byte aligned.
+ *
+ * The heap does no locking of its own: callers using it from several
+ * contexts must serialize the calls.
+ */
+
+struct z_heap;
+
+struct sys_heap {
+	struct z_heap *heap;
+	void *init_mem;
+	size_t init_bytes;
+};
+
+/** @brief Heap usage, as reported by sys_heap_stats_get() */
+struct sys_heap_stats {
+	/** Bytes in free blocks, headers included */
+	size_t free_bytes;
+	/** Bytes in allocated blocks, headers included */
+	size_t allocated_bytes;
+	/** Highest value allocated_bytes reached */
+	size_t max_allocated_bytes;
+	/** Largest block that can currently be allocated */
+	size_t largest_free_bytes;
+};
+
+/**
+ * @cond INTERNAL_HIDDEN
+ */
+
+#define Z_HEAP_CHUNK_SIZE 8
+#define Z_HEAP_SL_LOG2 2
+
+/* Must match struct z_heap and struct z_heap_bucket in lib/heap/heap.c */
+#define Z_HEAP_HDR_BYTES 16
+#define Z_HEAP_BUCKET_BYTES (4 * (1 + BIT(Z_HEAP_SL_LOG2)))
+
+#define Z_HEAP_LOG2_4(n) ((n) >= 8 ? 3 : (n) >= 4 ? 2 : (n) >= 2 ? 1 : 0)
+#define Z_HEAP_LOG2_8(n) \
+	((n) >= 16 ? 4 + Z_HEAP_LOG2_4((n) >> 4) : Z_HEAP_LOG2_4(n))
+#define Z_HEAP_LOG2_16(n) \
+	((n) >= 256 ? 8 + Z_HEAP_LOG2_8((n) >> 8) : Z_HEAP_LOG2_8(n))
+#define Z_HEAP_LOG2(n) \
+	((n) >= 65536 ? 16 + Z_HEAP_LOG2_16((n) >> 16) : Z_HEAP_LOG2_16(n))
+
+/* Upper bound of the size of the heap's bookkeeping, for a buffer of
+ * at most the given size: header, one bucket per power of two of
+ * chunks, and the end marker.  The bookkeeping of any heap is less than
+ * 256 bytes plus the size of its blocks, so twice that is a safe guess
+ * of the total size when sizing a buffer.
+ */
+#define Z_HEAP_OVERHEAD(bytes)						\
+	(ROUND_UP(Z_HEAP_HDR_BYTES + Z_HEAP_BUCKET_BYTES *		\
+		  Z_HEAP_LOG2((bytes) / Z_HEAP_CHUNK_SIZE), Z_HEAP_CHUNK_SIZE) \
+	 + Z_HEAP_CHUNK_SIZE)
+
+#define Z_HEAP_BLOCKS_BYTES(n, size) \
+	((n) * (Z_HEAP_CHUNK_SIZE + ROUND_UP(size, Z_HEAP_CHUNK_SIZE)))
+
+/**
+ * INTERNAL_HIDDEN @endcond
+ */
+
+/**
+ * @brief Size of a buffer guaranteed to hold some blocks
+ *
+ * This is the size a buffer needs for a heap to be able to hold @a n
+ * blocks of @a size bytes at the same time.
+ *
+ * @param n Number of blocks.
+ * @param size Size of each block (in bytes).
+ */
+#define SYS_HEAP_BUF_SIZE(n, size)					\
+	(Z_HEAP_BLOCKS_BYTES(n, size) +					\
+	 Z_HEAP_OVERHEAD(2 * Z_HEAP_BLOCKS_BYTES(n, size) + 256))
+
+/**
+ * @brief Initialize a heap
+ *
+ * The buffer holds the heap's bookkeeping as well as the blocks.
+ *
+ * @param h Heap to initialize.
+ * @param mem Buffer, 8 byte aligned for no bytes to be lost.
+ * @param bytes Size of the buffer.
+ */
+void sys_heap_init(struct sys_heap *h, void *mem, size_t bytes);
+
+/**
+ * @brief Allocate memory from a heap
+ *
+ * @param h Heap to allocate from.
+ * @param bytes Number of bytes requested.
+ *
+ * @return Pointer to the memory, or NULL if @a bytes is zero or no free
+ *         block is large enough.
+ */
+void *sys_heap_alloc(struct sys_heap *h, size_t bytes);
+
+/**
+ * @brief Free memory into a heap
+ *
+ * @param h Heap the memory was allocated from.
+ * @param mem Memory to free, or NULL, in which case it is a no-op.
+ */
+void sys_heap_free(struct sys_heap *h, void *mem);
+
+/**
+ * @brief Resize an allocated block
+ *
+ * The block is shrunk in place, or grown in place if it is followed by
+ * a large enough free block, and only moved otherwise.  On failure,
+ * the block is left untouched.
+ *
+ * @param h Heap the memory was allocated from.
+ * @param mem Memory to resize, or NULL to allocate a new block.
+ * @param bytes New size, or zero to free the block.
+ *
+ * @return Pointer to the resized memory, or NULL if @a bytes is zero or
+ *         no free block is large enough.
+ */
+void *sys_heap_realloc(struct sys_heap *h, void *mem, size_t bytes);
+
+/**
+ * @brief Get the usable size of an allocated block
+ *
+ * @param h Heap the memory was allocated from.
+ * @param mem Memory returned by sys_heap_alloc() or sys_heap_realloc().
+ *
+ * @return Number of bytes that can be used, at least as many as were
+ *         requested.
+ */
+size_t sys_heap_usable_size(struct sys_heap *h, void *mem);
+
+/**
+ * @brief Get heap usage statistics
+ *
+ * Finding the largest free block walks the free list of the largest
+ * size class, so this is not a constant time operation.
+ *
+ * @param h Heap to examine.
+ * @param stats Filled with the statistics.
+ */
+void sys_heap_stats_get(struct sys_heap *h, struct sys_heap_stats *stats);
+
+/**
+ * @brief Check the consistency of a heap
+ *
+ * Walks all the blocks and free lists of the heap, checking that they
+ * agree with each other, which takes time linear in the size of the
+ * heap.  Intended for tests.
+ *
+ * @param h Heap to check.
+ *
+ * @return true if the heap is consistent
+ */
+bool sys_heap_validate(struct sys_heap *h);
+
+#endif /* ZEPHYR_INCLUDE_MISC_HEAP_H_ */
@@ -34,6 +34,12 @@ struct sys_mem_pool_base {
 	s8_t max_inline_level;
 	struct sys_mem_pool_lvl *levels;
 	u8_t flags;
+#ifdef CONFIG_MEM_POOL_IRQ_LOCK_STATS
+	/* k_cycle_get_32() when interrupts were last locked */
+	u32_t lock_start;
+	/* longest time interrupts were locked, in cycles */
+	u32_t max_lock_cycles;
+#endif
 };
 
 #define _ALIGN4(n) ((((n)+3)/4)*4)
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_MISC_MUTEX_H_
+#define ZEPHYR_INCLUDE_MISC_MUTEX_H_
+
+/**
+ * @file
+ * @brief Mutexes with an uncontended path that doesn't enter the kernel
+ *
+ * A struct k_mutex lives in kernel memory, so every operation on it
+ * from a user mode thread is a system call.  A struct sys_mutex lives
+ * in memory the threads using it can write: locking or unlocking it
+ * while no other thread wants it is a single atomic operation, and only
+ * the contended cases go to the kernel, through a semaphore the waiters
+ * sleep on.
+ *
+ * Unlike struct k_mutex, a sys_mutex does not support recursive locking
+ * or priority inheritance.
+ */
+
+#include <kernel.h>
+#include <atomic.h>
+
+struct sys_mutex {
+	/* 0: unlocked, 1: locked, 2: locked and maybe waited for */
+	atomic_t val;
+	struct k_sem *sem;
+};
+
+/**
+ * @brief Statically define a system mutex
+ *
+ * If the mutex is to be accessed outside the module where it is defined,
+ * it can be declared via
+ *
+ * @code extern struct sys_mutex <name>; @endcode
+ *
+ * Threads using it need access to both the mutex's memory and @a ksem.
+ *
+ * @param name Name of the mutex.
+ * @param ksem Pointer to a k_sem object with a limit of 1, declared with
+ *	       K_SEM_DEFINE(), which waiters sleep on.
+ * @param section Destination binary section for the mutex
+ */
+#define SYS_MUTEX_DEFINE(name, ksem, section)			\
+	_GENERIC_SECTION(section) struct sys_mutex name = {	\
+		.val = ATOMIC_INIT(0),				\
+		.sem = ksem,					\
+	}
+
+/**
+ * @brief Initialize a system mutex
+ *
+ * @param mutex Address of the mutex.
+ * @param ksem Semaphore with a limit of 1 which waiters sleep on.
+ */
+static inline void sys_mutex_init(struct sys_mutex *mutex, struct k_sem *ksem)
+{
+	atomic_clear(&mutex->val);
+	mutex->sem = ksem;
+}
+
+int z_sys_mutex_lock_contended(struct sys_mutex *mutex, s32_t timeout);
+void z_sys_mutex_unlock_contended(struct sys_mutex *mutex);
+
+/**
+ * @brief Lock a system mutex
+ *
+ * Locking a mutex that no other thread holds or waits for does not enter
+ * the kernel.  A sys_mutex cannot be locked again by the thread holding
+ * it.  This cannot be called from interrupt context.
+ *
+ * @param mutex Address of the mutex.
+ * @param timeout Waiting period to lock the mutex (in milliseconds),
+ *                or one of the special values K_NO_WAIT and K_FOREVER.
+ *
+ * @retval 0 Mutex locked.
+ * @retval -EBUSY Returned without waiting.
+ * @retval -EAGAIN Waiting period timed out.
+ */
+static inline int sys_mutex_lock(struct sys_mutex *mutex, s32_t timeout)
+{
+	if (likely(atomic_cas(&mutex->val, 0, 1))) {
+		return 0;
+	}
+
+	return z_sys_mutex_lock_contended(mutex, timeout);
+}
+
+/**
+ * @brief Unlock a system mutex
+ *
+ * Unlocking a mutex nobody waits for does not enter the kernel.  Only
+ * the thread holding the mutex may unlock it.
+ *
+ * @param mutex Address of the mutex.
+ */
+static inline void sys_mutex_unlock(struct sys_mutex *mutex)
+{
+	if (unlikely(atomic_dec(&mutex->val) != 1)) {
+		z_sys_mutex_unlock_contended(mutex);
+	}
+}
+
+#endif /* ZEPHYR_INCLUDE_MISC_MUTEX_H_ */
@@ -24,6 +24,7 @@
 #include <sys/types.h>
 #include <zephyr/types.h>
 #include <net/net_ip.h>
+#include <net/buf.h>
 #include <net/dns_resolve.h>
 #include <stdlib.h>
 
@@ -44,8 +45,30 @@ struct zsock_pollfd {
 #define ZSOCK_POLLHUP 0x10
 #define ZSOCK_POLLNVAL 0x20
 
+struct zsock_iovec {
+	void *iov_base;
+	size_t iov_len;
+};
+
+struct zsock_msghdr {
+	void *msg_name;
+	socklen_t msg_namelen;
+	struct zsock_iovec *msg_iov;
+	size_t msg_iovlen;
+	void *msg_control;
+	size_t msg_controllen;
+	int msg_flags;
+};
+
+struct zsock_mmsghdr {
+	struct zsock_msghdr msg_hdr;
+	unsigned int msg_len;
+};
+
 #define ZSOCK_MSG_PEEK 0x02
+#define ZSOCK_MSG_TRUNC 0x20
 #define ZSOCK_MSG_DONTWAIT 0x40
+#define ZSOCK_MSG_WAITFORONE 0x10000
 
 /* Protocol level for TLS.
  * Here, the same socket protocol level for TLS as in Linux was used.
@@ -143,6 +166,39 @@ static inline ssize_t zsock_recv(int sock, void *buf, size_t max_len,
 	return zsock_recvfrom(sock, buf, max_len, flags, NULL, NULL);
 }
 
+__syscall ssize_t zsock_sendmsg(int sock, const struct zsock_msghdr *msg,
+				int flags);
+
+__syscall ssize_t zsock_recvmsg(int sock, struct zsock_msghdr *msg, int flags);
+
+__syscall int zsock_sendmmsg(int sock, struct zsock_mmsghdr *msgvec,
+			     unsigned int vlen, int flags);
+
+/* Unlike in POSIX, there is no timeout argument. MSG_WAITFORONE may be
+ * used instead to return as soon as one message was received.
+ */
+__syscall int zsock_recvmmsg(int sock, struct zsock_mmsghdr *msgvec,
+			     unsigned int vlen, int flags);
+
+/* Zero-copy send. The payload is the fragment chain @a frags, typically
+ * allocated with net_pkt_get_reserve_tx_data(), which the stack sends as
+ * is instead of copying it. The caller's reference to @a frags always
+ * passes to the stack, which releases the chain if sending fails, so the
+ * caller must not use it after the call either way. Fails with
+ * EOPNOTSUPP on a TLS or DTLS socket. Not available from user mode.
+ */
+ssize_t zsock_send_zc(int sock, struct net_buf *frags, int flags,
+		      const struct sockaddr *dest_addr, socklen_t addrlen);
+
+/* Zero-copy receive. Sets @a frags to the fragment chain holding the next
+ * datagram, or the data of the next received segment for a stream socket,
+ * and returns its length. The caller owns the chain and releases it with
+ * net_buf_unref() once done. MSG_PEEK is not supported, and TLS or DTLS
+ * sockets fail with EOPNOTSUPP. Not available from user mode.
+ */
+ssize_t zsock_recv_zc(int sock, struct net_buf **frags, int flags,
+		      struct sockaddr *src_addr, socklen_t *addrlen);
+
 __syscall int zsock_fcntl(int sock, int cmd, int flags);
 
 __syscall int zsock_poll(struct zsock_pollfd *fds, int nfds, int timeout);
@@ -178,6 +234,15 @@ ssize_t ztls_sendto(int sock, const void *buf, size_t len, int flags,
 		    const struct sockaddr *dest_addr, socklen_t addrlen);
 ssize_t ztls_recvfrom(int sock, void *buf, size_t max_len, int flags,
 		      struct sockaddr *src_addr, socklen_t *addrlen);
+/* On a DTLS socket a message goes out, or comes in, as a single record,
+ * so it has to be in a single buffer, or these fail with ENOTSUP.
+ */
+ssize_t ztls_sendmsg(int sock, const struct zsock_msghdr *msg, int flags);
+ssize_t ztls_recvmsg(int sock, struct zsock_msghdr *msg, int flags);
+int ztls_sendmmsg(int sock, struct zsock_mmsghdr *msgvec, unsigned int vlen,
+		  int flags);
+int ztls_recvmmsg(int sock, struct zsock_mmsghdr *msgvec, unsigned int vlen,
+		  int flags);
 int ztls_fcntl(int sock, int cmd, int flags);
 int ztls_poll(struct zsock_pollfd *fds, int nfds, int timeout);
 int ztls_getsockopt(int sock, int level, int optname,
@@ -189,6 +254,9 @@ int ztls_setsockopt(int sock, int level, int optname,
 
 #if defined(CONFIG_NET_SOCKETS_POSIX_NAMES)
 #define pollfd zsock_pollfd
+#define iovec zsock_iovec
+#define msghdr zsock_msghdr
+#define mmsghdr zsock_mmsghdr
 #if !defined(CONFIG_NET_SOCKETS_OFFLOAD)
 static inline int socket(int family, int type, int proto)
 {
@@ -291,6 +359,45 @@ static inline ssize_t recvfrom(int sock, void *buf, size_t max_len, int flags,
 #endif /* defined(CONFIG_NET_SOCKETS_SOCKOPT_TLS) */
 }
 
+static inline ssize_t sendmsg(int sock, const struct zsock_msghdr *msg,
+			      int flags)
+{
+#if defined(CONFIG_NET_SOCKETS_SOCKOPT_TLS)
+	return ztls_sendmsg(sock, msg, flags);
+#else
+	return zsock_sendmsg(sock, msg, flags);
+#endif /* defined(CONFIG_NET_SOCKETS_SOCKOPT_TLS) */
+}
+
+static inline ssize_t recvmsg(int sock, struct zsock_msghdr *msg, int flags)
+{
+#if defined(CONFIG_NET_SOCKETS_SOCKOPT_TLS)
+	return ztls_recvmsg(sock, msg, flags);
+#else
+	return zsock_recvmsg(sock, msg, flags);
+#endif /* defined(CONFIG_NET_SOCKETS_SOCKOPT_TLS) */
+}
+
+static inline int sendmmsg(int sock, struct zsock_mmsghdr *msgvec,
+			   unsigned int vlen, int flags)
+{
+#if defined(CONFIG_NET_SOCKETS_SOCKOPT_TLS)
+	return ztls_sendmmsg(sock, msgvec, vlen, flags);
+#else
+	return zsock_sendmmsg(sock, msgvec, vlen, flags);
+#endif /* defined(CONFIG_NET_SOCKETS_SOCKOPT_TLS) */
+}
+
+static inline int recvmmsg(int sock, struct zsock_mmsghdr *msgvec,
+			   unsigned int vlen, int flags)
+{
+#if defined(CONFIG_NET_SOCKETS_SOCKOPT_TLS)
+	return ztls_recvmmsg(sock, msgvec, vlen, flags);
+#else
+	return zsock_recvmmsg(sock, msgvec, vlen, flags);
+#endif /* defined(CONFIG_NET_SOCKETS_SOCKOPT_TLS) */
+}
+
 static inline int poll(struct zsock_pollfd *fds, int nfds, int timeout)
 {
 #if defined(CONFIG_NET_SOCKETS_SOCKOPT_TLS)
@@ -358,6 +465,8 @@ struct addrinfo {
 
 #define MSG_PEEK ZSOCK_MSG_PEEK
 #define MSG_DONTWAIT ZSOCK_MSG_DONTWAIT
+#define MSG_WAITFORONE ZSOCK_MSG_WAITFORONE
+#define MSG_TRUNC ZSOCK_MSG_TRUNC
 
 static inline char *inet_ntop(sa_family_t family, const void *src, char *dst,
 			      size_t size)
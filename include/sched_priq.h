@@ -10,7 +10,7 @@
 #include <misc/dlist.h>
 #include <misc/rb.h>
 
-/* Two abstractions are defined here for "thread priority queues".
+/* Three abstractions are defined here for "thread priority queues".
  *
  * One is a "dumb" list implementation appropriate for systems with
  * small numbers of threads and sensitive to code size.  It is stored
@@ -19,12 +19,15 @@
  * abstraction worked and is very fast as long as the number of
  * threads is small.
  *
- * The other is a balanced tree "fast" implementation with rather
+ * Another is a balanced tree "fast" implementation with rather
  * larger code size (due to the data structure itself, the code here
  * is just stubs) and higher constant-factor performance overhead, but
  * much better O(logN) scaling in the presence of large number of
  * threads.
  *
+ * The last is an array of per-priority lists indexed by a bitmap,
+ * O(1) in all operations at the cost of one list head per priority.
+ *
  * Each can be used for either the wait_q or system ready queue,
  * configurable at build time.
  */
@@ -44,20 +47,35 @@ void _priq_rb_add(struct _priq_rb *pq, struct k_thread *thread);
 void _priq_rb_remove(struct _priq_rb *pq, struct k_thread *thread);
 struct k_thread *_priq_rb_best(struct _priq_rb *pq);
 
-/* Traditional/textbook "multi-queue" structure.  Separate lists for a
- * small number (max 32 here) of fixed priorities.  This corresponds
- * to the original Zephyr scheduler.  RAM requirements are
- * comparatively high, but performance is very fast.  Won't work with
- * features like deadline scheduling which need large priority spaces
- * to represet their requirements.
+/* Traditional/textbook "multi-queue" structure.  Separate lists for
+ * each of the K_NUM_PRIORITIES fixed priorities, with a two-level
+ * bitmap of the non-empty ones: bit i of bitmask[w] is set if
+ * queues[w * 32 + i] is non-empty, and bit w of the summary word is
+ * set if bitmask[w] is non-zero.  Finding the best thread is then two
+ * find-first-set operations for up to 1024 priorities.  This
+ * corresponds to the original Zephyr scheduler.  RAM requirements
+ * are comparatively high, but performance is very fast.  Won't work
+ * with features like deadline scheduling which need large priority
+ * spaces to represet their requirements.
+ *
+ * A list whose bit is clear is not looked at and is (re)initialized
+ * when a thread is added to it, so an all-zero structure is a valid
+ * empty queue.
  */
+#define K_NUM_PRIORITIES \
+	(CONFIG_NUM_COOP_PRIORITIES + CONFIG_NUM_PREEMPT_PRIORITIES + 1)
+
+#define K_NUM_PRIO_BITMAPS ((K_NUM_PRIORITIES + 31) >> 5)
+
 struct _priq_mq {
-	sys_dlist_t queues[32];
-	unsigned int bitmask; /* bit 1<<i set if queues[i] is non-empty */
+	sys_dlist_t queues[K_NUM_PRIORITIES];
+	u32_t bitmask[K_NUM_PRIO_BITMAPS];
+	u32_t summary;
 };
 
 void _priq_mq_add(struct _priq_mq *pq, struct k_thread *thread);
 void _priq_mq_remove(struct _priq_mq *pq, struct k_thread *thread);
 struct k_thread *_priq_mq_best(struct _priq_mq *pq);
+struct k_thread *_priq_mq_next(struct _priq_mq *pq, struct k_thread *thread);
 
 #endif /* ZEPHYR_INCLUDE_SCHED_PRIQ_H_ */
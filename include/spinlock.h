@@ -21,6 +21,15 @@ struct k_spinlock {
 	int saved_key;
 #endif
 #endif
+
+#if defined(CONFIG_CPLUSPLUS) && !defined(CONFIG_SMP)
+	/* Without SMP the lock has no members, which makes it zero
+	 * bytes in C but one byte in C++.  Kernel objects embed a
+	 * k_spinlock, so pad it to keep their layout identical in
+	 * both languages.
+	 */
+	char dummy;
+#endif
 };
 
 static inline k_spinlock_key_t k_spin_lock(struct k_spinlock *l)
@@ -66,4 +75,15 @@ static inline void k_spin_unlock(struct k_spinlock *l, k_spinlock_key_t key)
 	_arch_irq_unlock(key.key);
 }
 
+/* Internal function: releases the lock, but leaves local interrupts
+ * disabled.  Used by the scheduler to drop an object lock before a
+ * context switch, which then restores the interrupt state itself.
+ */
+static inline void k_spin_release(struct k_spinlock *l)
+{
+#ifdef CONFIG_SMP
+	atomic_clear(&l->locked);
+#endif
+}
+
 #endif /* ZEPHYR_INCLUDE_SPINLOCK_H_ */
@@ -213,6 +213,13 @@ struct _timeout {
 	sys_dnode_t node;
 	s32_t dticks;
 	_timeout_func_t fn;
+#ifdef CONFIG_TIMEOUT_QUEUE_WHEEL
+	/* absolute tick of expiry */
+	u64_t expiry;
+#else
+	/* low 32 bits of the absolute tick of expiry */
+	u32_t expiry;
+#endif
 };
 
 /*
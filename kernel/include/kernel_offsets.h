@@ -35,7 +35,9 @@ GEN_OFFSET_SYM(_kernel_t, threads);
 GEN_OFFSET_SYM(_kernel_t, idle);
 #endif
 
+#ifndef CONFIG_SCHED_PER_CPU_RUNQ
 GEN_OFFSET_SYM(_kernel_t, ready_q);
+#endif
 GEN_OFFSET_SYM(_kernel_t, arch);
 
 #ifndef CONFIG_SMP
@@ -17,11 +17,6 @@
 #include <string.h>
 #endif
 
-#define K_NUM_PRIORITIES \
-	(CONFIG_NUM_COOP_PRIORITIES + CONFIG_NUM_PREEMPT_PRIORITIES + 1)
-
-#define K_NUM_PRIO_BITMAPS ((K_NUM_PRIORITIES + 31) >> 5)
-
 /*
  * Bitmask definitions for the struct k_thread.thread_state field.
  *
@@ -79,6 +74,11 @@ struct _ready_q {
 #elif defined(CONFIG_SCHED_MULTIQ)
 	struct _priq_mq runq;
 #endif
+
+#ifdef CONFIG_SCHED_PER_CPU_RUNQ
+	/* number of threads in runq, used to pick a CPU to steal from */
+	u32_t count;
+#endif
 };
 
 typedef struct _ready_q _ready_q_t;
@@ -107,6 +107,16 @@ struct _cpu {
 	/* True when _current is allowed to context switch */
 	u8_t swap_ok;
 #endif
+
+#ifdef CONFIG_SCHED_PER_CPU_RUNQ
+	/* threads runnable on this CPU, excluding current */
+	struct _ready_q ready_q;
+#endif
+
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	/* k_cycle_get_32() when current's runtime was last accounted */
+	u32_t usage_start;
+#endif
 };
 
 typedef struct _cpu _cpu_t;
@@ -141,11 +151,13 @@ struct z_kernel {
 	s32_t idle; /* Number of ticks for kernel idling */
 #endif
 
+#ifndef CONFIG_SCHED_PER_CPU_RUNQ
 	/*
 	 * ready queue: can be big, keep after small fields, since some
 	 * assembly (e.g. ARC) are limited in the encoding of the offset
 	 */
 	struct _ready_q ready_q;
+#endif
 
 #ifdef CONFIG_FP_SHARING
 	/*
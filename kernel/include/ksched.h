@@ -8,6 +8,7 @@
 #define ZEPHYR_KERNEL_INCLUDE_KSCHED_H_
 
 #include <kernel_structs.h>
+#include <spinlock.h>
 #include <tracing.h>
 #include <stdbool.h>
 
@@ -37,18 +38,31 @@ void _move_thread_to_end_of_prio_q(struct k_thread *thread);
 void _remove_thread_from_ready_q(struct k_thread *thread);
 int _is_thread_time_slicing(struct k_thread *thread);
 void _unpend_thread_no_timeout(struct k_thread *thread);
-int _pend_current_thread(u32_t key, _wait_q_t *wait_q, s32_t timeout);
+int _pend_curr_irqlock(u32_t key, _wait_q_t *wait_q, s32_t timeout);
+int _pend_curr(struct k_spinlock *lock, k_spinlock_key_t key,
+	       _wait_q_t *wait_q, s32_t timeout);
 void _pend_thread(struct k_thread *thread, _wait_q_t *wait_q, s32_t timeout);
-void _reschedule(u32_t key);
+void _reschedule(struct k_spinlock *lock, k_spinlock_key_t key);
+void _reschedule_irqlock(u32_t key);
 struct k_thread *_unpend_first_thread(_wait_q_t *wait_q);
+struct k_thread *_unpend1_no_timeout(_wait_q_t *wait_q);
 void _unpend_thread(struct k_thread *thread);
 int _unpend_all(_wait_q_t *wait_q);
 void _thread_priority_set(struct k_thread *thread, int prio);
+bool _set_prio(struct k_thread *thread, int prio);
 void *_get_next_switch_handle(void *interrupted);
 struct k_thread *_find_first_thread_to_unpend(_wait_q_t *wait_q,
 					      struct k_thread *from);
 void idle(void *a, void *b, void *c);
 void z_time_slice(int ticks);
+#ifdef CONFIG_SCHED_DEADLINE_CBS
+void z_sched_cbs_release(struct k_thread *thread);
+#endif
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+void z_sched_usage_switch(struct k_thread *from, struct k_thread *to);
+void z_sched_usage_swap(void);
+void z_sched_usage_update(void);
+#endif
 
 /* find which one is the next thread to run */
 /* must be called with interrupts locked */
@@ -272,15 +286,14 @@ static ALWAYS_INLINE bool _is_thread_timeout_expired(struct k_thread *thread)
 #endif
 }
 
-static inline struct k_thread *_unpend1_no_timeout(_wait_q_t *wait_q)
+/* Reschedule from a context that holds no lock at all: used after
+ * readying a thread outside of any object critical section.
+ */
+static inline void _reschedule_unlocked(void)
 {
-	struct k_thread *thread = _find_first_thread_to_unpend(wait_q, NULL);
-
-	if (thread != NULL) {
-		_unpend_thread_no_timeout(thread);
-	}
+	struct k_spinlock lock = {};
 
-	return thread;
+	_reschedule(&lock, k_spin_lock(&lock));
 }
 
 #endif /* ZEPHYR_KERNEL_INCLUDE_KSCHED_H_ */
@@ -7,6 +7,7 @@
 #define ZEPHYR_KERNEL_INCLUDE_KSWAP_H_
 
 #include <ksched.h>
+#include <spinlock.h>
 #include <kernel_arch_func.h>
 
 #ifdef CONFIG_STACK_SENTINEL
@@ -33,9 +34,15 @@ void _smp_release_global_lock(struct k_thread *thread);
  * primitive that doesn't know about the scheduler or return value.
  * Needed for SMP, where the scheduler requires spinlocking that we
  * don't want to have to do in per-architecture assembly.
+ *
+ * Note that is_spinlock is a compile-time construct which will be
+ * optimized out when this function is expanded.
  */
-static inline int _Swap(unsigned int key)
+static ALWAYS_INLINE int do_swap(unsigned int key,
+				 struct k_spinlock *lock,
+				 int is_spinlock)
 {
+	ARG_UNUSED(lock);
 	struct k_thread *new_thread, *old_thread;
 	int ret = 0;
 
@@ -52,6 +59,10 @@ static inline int _Swap(unsigned int key)
 	sys_trace_thread_switched_out();
 #endif
 
+	if (is_spinlock) {
+		k_spin_release(lock);
+	}
+
 	new_thread = _get_next_ready_thread();
 
 	if (new_thread != old_thread) {
@@ -62,9 +73,22 @@ static inline int _Swap(unsigned int key)
 
 		new_thread->base.cpu = _arch_curr_cpu()->id;
 
-		_smp_release_global_lock(new_thread);
+		/* A thread blocking under an object spinlock doesn't
+		 * hold the global irq_lock() (unless it is also nested
+		 * inside one), so it has nothing to hand over and must
+		 * take the global lock on behalf of an incoming thread
+		 * that was switched out while holding it.
+		 */
+		if (is_spinlock && !old_thread->base.global_lock_count) {
+			_smp_reacquire_global_lock(new_thread);
+		} else {
+			_smp_release_global_lock(new_thread);
+		}
 #endif
 
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+		z_sched_usage_switch(old_thread, new_thread);
+#endif
 		_current = new_thread;
 		_arch_switch(new_thread->switch_handle,
 			     &old_thread->switch_handle);
@@ -76,16 +100,38 @@ static inline int _Swap(unsigned int key)
 	sys_trace_thread_switched_in();
 #endif
 
-	irq_unlock(key);
+	if (is_spinlock) {
+		_arch_irq_unlock(key);
+	} else {
+		irq_unlock(key);
+	}
 
 	return ret;
 }
 
+static inline int _Swap_irqlock(unsigned int key)
+{
+	return do_swap(key, NULL, 0);
+}
+
+static inline int _Swap(struct k_spinlock *lock, k_spinlock_key_t key)
+{
+	return do_swap(key.key, lock, 1);
+}
+
+static inline void _Swap_unlocked(void)
+{
+	struct k_spinlock lock = {};
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	(void) _Swap(&lock, key);
+}
+
 #else /* !CONFIG_USE_SWITCH */
 
 extern int __swap(unsigned int key);
 
-static inline int _Swap(unsigned int key)
+static inline int _Swap_irqlock(unsigned int key)
 {
 	int ret;
 	_check_stack_sentinel();
@@ -104,6 +150,22 @@ static inline int _Swap(unsigned int key)
 
 	return ret;
 }
+
+/* If !USE_SWITCH, then spinlocks are guaranteed degenerate as we
+ * can't be in SMP.  The k_spin_release() call is just for validation
+ * handling.
+ */
+static ALWAYS_INLINE int _Swap(struct k_spinlock *lock, k_spinlock_key_t key)
+{
+	k_spin_release(lock);
+	return _Swap_irqlock(key.key);
+}
+
+static inline void _Swap_unlocked(void)
+{
+	(void) _Swap_irqlock(_arch_irq_lock());
+}
+
 #endif
 
 #endif /* ZEPHYR_KERNEL_INCLUDE_KSWAP_H_ */
@@ -71,6 +71,40 @@ extern void _dump_object_error(int retval, void *obj, struct _k_object *ko,
  */
 extern struct _k_object *_k_object_find(void *obj);
 
+/**
+ * Kernel object lookup on behalf of the current thread
+ *
+ * Same as _k_object_find(), going through the current thread's object
+ * cache first, see CONFIG_KOBJECT_CACHE_SIZE. Only for use in system call
+ * handlers, as nothing else must touch a thread's cache while it runs.
+ *
+ * @param obj Address of kernel object to get metadata
+ * @return Kernel object's metadata, or NULL if the parameter wasn't the
+ * memory address of a kernel object
+ */
+#if CONFIG_KOBJECT_CACHE_SIZE > 0
+extern struct _k_object *z_object_find_cached(void *obj);
+#else
+static inline struct _k_object *z_object_find_cached(void *obj)
+{
+	return _k_object_find(obj);
+}
+#endif
+
+/**
+ * Empty a thread's kernel object cache
+ *
+ * @param thread Thread being created
+ */
+#if CONFIG_KOBJECT_CACHE_SIZE > 0
+extern void z_object_cache_reset(struct k_thread *thread);
+#else
+static inline void z_object_cache_reset(struct k_thread *thread)
+{
+	ARG_UNUSED(thread);
+}
+#endif
+
 typedef void (*_wordlist_cb_func_t)(struct _k_object *ko, void *context);
 
 /**
@@ -411,8 +445,8 @@ static inline int _obj_validation_check(struct _k_object *ko,
 
 #define Z_SYSCALL_IS_OBJ(ptr, type, init) \
 	Z_SYSCALL_VERIFY_MSG( \
-	    !_obj_validation_check(_k_object_find((void *)ptr), (void *)ptr, \
-				   type, init), "access denied")
+	    !_obj_validation_check(z_object_find_cached((void *)ptr), \
+				   (void *)ptr, type, init), "access denied")
 
 /**
  * @brief Runtime check driver object pointer for presence of operation
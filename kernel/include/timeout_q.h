@@ -29,6 +29,9 @@ void _add_timeout(struct _timeout *to, _timeout_func_t fn, s32_t ticks);
 
 int _abort_timeout(struct _timeout *to);
 
+void z_timeout_reschedule(struct _timeout *to, _timeout_func_t fn,
+			  s32_t ticks);
+
 static inline void _init_thread_timeout(struct _thread_base *thread_base)
 {
 	_init_timeout(&thread_base->timeout, NULL);
@@ -39,7 +39,26 @@ static inline struct k_thread *_waitq_head(_wait_q_t *w)
 	return (void *)rb_get_min(&w->waitq.tree);
 }
 
-#else /* !CONFIG_WAITQ_SCALABLE: */
+#elif defined(CONFIG_WAITQ_MULTIQ)
+
+#define _WAIT_Q_FOR_EACH(wq, thread_ptr) \
+	for (thread_ptr = _priq_mq_best(&(wq)->waitq); thread_ptr != NULL; \
+	     thread_ptr = _priq_mq_next(&(wq)->waitq, thread_ptr))
+
+static inline void _waitq_init(_wait_q_t *w)
+{
+	for (int i = 0; i < K_NUM_PRIO_BITMAPS; i++) {
+		w->waitq.bitmask[i] = 0;
+	}
+	w->waitq.summary = 0;
+}
+
+static inline struct k_thread *_waitq_head(_wait_q_t *w)
+{
+	return _priq_mq_best(&w->waitq);
+}
+
+#else /* !CONFIG_WAITQ_SCALABLE && !CONFIG_WAITQ_MULTIQ: */
 
 #define _WAIT_Q_FOR_EACH(wq, thread_ptr) \
 	SYS_DLIST_FOR_EACH_CONTAINER(&((wq)->waitq), thread_ptr, \
@@ -55,7 +74,7 @@ static inline struct k_thread *_waitq_head(_wait_q_t *w)
 	return (void *)sys_dlist_peek_head(&w->waitq);
 }
 
-#endif /* !CONFIG_WAITQ_SCALABLE */
+#endif /* !CONFIG_WAITQ_SCALABLE && !CONFIG_WAITQ_MULTIQ */
 
 #ifdef __cplusplus
 }
@@ -13,6 +13,7 @@
 #include <misc/dlist.h>
 #include <ksched.h>
 #include <init.h>
+#include <string.h>
 
 extern struct k_mem_slab _k_mem_slab_list_start[];
 extern struct k_mem_slab _k_mem_slab_list_end[];
@@ -77,6 +78,14 @@ void k_mem_slab_init(struct k_mem_slab *slab, void *buffer,
 	slab->block_size = block_size;
 	slab->buffer = buffer;
 	slab->num_used = 0;
+#ifdef CONFIG_MEM_SLAB_TRACE_MAX_UTILIZATION
+	slab->max_used = 0;
+#endif
+#ifdef CONFIG_MEM_SLAB_MAGAZINES
+	(void)memset(slab->mags, 0, sizeof(slab->mags));
+	atomic_clear(&slab->waiters);
+#endif
+	slab->lock = (struct k_spinlock) {};
 	create_free_list(slab);
 	_waitq_init(&slab->wait_q);
 	SYS_TRACING_OBJ_INIT(k_mem_slab, slab);
@@ -84,9 +93,180 @@ void k_mem_slab_init(struct k_mem_slab *slab, void *buffer,
 	_k_object_init(slab);
 }
 
-int k_mem_slab_alloc(struct k_mem_slab *slab, void **mem, s32_t timeout)
+static inline void track_max_used(struct k_mem_slab *slab)
+{
+#ifdef CONFIG_MEM_SLAB_TRACE_MAX_UTILIZATION
+	if (slab->num_used > slab->max_used) {
+		slab->max_used = slab->num_used;
+	}
+#endif
+}
+
+/* Hands a freed block to the first waiting thread, or puts it back on
+ * the free list.  Returns true if a thread was readied.  Called with
+ * the slab lock held.
+ */
+static bool give_block(struct k_mem_slab *slab, char *block)
+{
+	struct k_thread *pending_thread = _unpend_first_thread(&slab->wait_q);
+
+	if (pending_thread != NULL) {
+		_set_thread_return_value_with_data(pending_thread, 0, block);
+		_ready_thread(pending_thread);
+		return true;
+	}
+
+	*(char **)block = slab->free_list;
+	slab->free_list = block;
+	slab->num_used--;
+
+	return false;
+}
+
+#ifdef CONFIG_MEM_SLAB_MAGAZINES
+
+#define MAG_SIZE CONFIG_MEM_SLAB_MAGAZINE_SIZE
+#define MAG_BATCH (MAG_SIZE / 2)
+
+/* Moves up to n blocks from the head of one block list to another */
+static u32_t move_blocks(char **from, char **to, u32_t n)
+{
+	u32_t moved;
+	char *block;
+
+	for (moved = 0; moved < n && *from != NULL; moved++) {
+		block = *from;
+		*from = *(char **)block;
+		*(char **)block = *to;
+		*to = block;
+	}
+
+	return moved;
+}
+
+/* Gives up to n blocks of a magazine back to the slab, handing them to
+ * waiting threads first.  Readied threads run at the next rescheduling
+ * point.  Called with the magazine lock held.
+ */
+static void mag_flush(struct k_mem_slab *slab, struct k_mem_slab_magazine *mag,
+		      u32_t n)
+{
+	k_spinlock_key_t key = k_spin_lock(&slab->lock);
+	char *block;
+
+	while (n-- > 0 && mag->list != NULL) {
+		block = mag->list;
+		mag->list = *(char **)block;
+		mag->count--;
+		give_block(slab, block);
+	}
+
+	k_spin_unlock(&slab->lock, key);
+}
+
+static bool mag_pop(struct k_mem_slab_magazine *mag, void **mem)
+{
+	if (mag->list == NULL) {
+		return false;
+	}
+
+	*mem = mag->list;
+	mag->list = *(char **)mag->list;
+	mag->count--;
+
+	return true;
+}
+
+/* Allocates from the current CPU's magazine, refilling it from the free
+ * list if it is empty, or else from another CPU's magazine.
+ */
+static bool mag_alloc(struct k_mem_slab *slab, void **mem)
+{
+	/* stay on this CPU while using its magazine */
+	unsigned int irq_key = _arch_irq_lock();
+	u8_t id = _current_cpu->id;
+	struct k_mem_slab_magazine *mag = &slab->mags[id];
+	k_spinlock_key_t key = k_spin_lock(&mag->lock);
+	k_spinlock_key_t slab_key;
+	u32_t moved;
+	bool found;
+	int i;
+
+	if (mag->count == 0) {
+		slab_key = k_spin_lock(&slab->lock);
+		moved = move_blocks(&slab->free_list, &mag->list, MAG_BATCH);
+		mag->count += moved;
+		slab->num_used += moved;
+		track_max_used(slab);
+		k_spin_unlock(&slab->lock, slab_key);
+	}
+
+	found = mag_pop(mag, mem);
+	k_spin_unlock(&mag->lock, key);
+
+	for (i = 0; !found && i < CONFIG_MP_NUM_CPUS; i++) {
+		if (i != id) {
+			key = k_spin_lock(&slab->mags[i].lock);
+			found = mag_pop(&slab->mags[i], mem);
+			k_spin_unlock(&slab->mags[i].lock, key);
+		}
+	}
+
+	_arch_irq_unlock(irq_key);
+
+	return found;
+}
+
+/* Frees into the current CPU's magazine, making room in it first if it
+ * is full.  While threads wait for a block, or are about to, it is left
+ * to the slow path, which hands it over.  Such a thread counts itself
+ * in slab->waiters before it looks through the magazines a last time,
+ * each under its lock, so it either finds the block or is seen here.
+ */
+static bool mag_free(struct k_mem_slab *slab, char *block)
+{
+	unsigned int irq_key = _arch_irq_lock();
+	struct k_mem_slab_magazine *mag = &slab->mags[_current_cpu->id];
+	k_spinlock_key_t key = k_spin_lock(&mag->lock);
+	bool cached = false;
+
+	if (atomic_get(&slab->waiters) == 0) {
+		if (mag->count == MAG_SIZE) {
+			mag_flush(slab, mag, MAG_BATCH);
+		}
+
+		*(char **)block = mag->list;
+		mag->list = block;
+		mag->count++;
+		cached = true;
+	}
+
+	k_spin_unlock(&mag->lock, key);
+	_arch_irq_unlock(irq_key);
+
+	return cached;
+}
+
+static void mag_flush_all(struct k_mem_slab *slab)
+{
+	k_spinlock_key_t key;
+	int i;
+
+	for (i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		key = k_spin_lock(&slab->mags[i].lock);
+		mag_flush(slab, &slab->mags[i], MAG_SIZE);
+		k_spin_unlock(&slab->mags[i].lock, key);
+	}
+}
+
+#endif /* CONFIG_MEM_SLAB_MAGAZINES */
+
+/* Takes a free block, or waits for one.  Called with the slab lock held,
+ * which it releases.
+ */
+static int mem_slab_alloc_locked(struct k_mem_slab *slab, void **mem,
+				 k_spinlock_key_t key, s32_t timeout)
 {
-	unsigned int key = irq_lock();
 	int result;
 
 	if (slab->free_list != NULL) {
@@ -94,6 +274,7 @@ int k_mem_slab_alloc(struct k_mem_slab *slab, void **mem, s32_t timeout)
 		*mem = slab->free_list;
 		slab->free_list = *(char **)(slab->free_list);
 		slab->num_used++;
+		track_max_used(slab);
 		result = 0;
 	} else if (timeout == K_NO_WAIT) {
 		/* don't wait for a free block to become available */
@@ -101,31 +282,118 @@ int k_mem_slab_alloc(struct k_mem_slab *slab, void **mem, s32_t timeout)
 		result = -ENOMEM;
 	} else {
 		/* wait for a free block or timeout */
-		result = _pend_current_thread(key, &slab->wait_q, timeout);
+		result = _pend_curr(&slab->lock, key, &slab->wait_q, timeout);
 		if (result == 0) {
 			*mem = _current->base.swap_data;
 		}
 		return result;
 	}
 
-	irq_unlock(key);
+	k_spin_unlock(&slab->lock, key);
 
 	return result;
 }
 
+int k_mem_slab_alloc(struct k_mem_slab *slab, void **mem, s32_t timeout)
+{
+	k_spinlock_key_t key;
+
+#ifdef CONFIG_MEM_SLAB_MAGAZINES
+	int result;
+
+	if (mag_alloc(slab, mem)) {
+		return 0;
+	}
+
+	key = k_spin_lock(&slab->lock);
+
+	if (slab->free_list == NULL && timeout != K_NO_WAIT) {
+		/* Have frees skip the magazines until we are done waiting,
+		 * then take back what they cached before.
+		 */
+		atomic_inc(&slab->waiters);
+		k_spin_unlock(&slab->lock, key);
+
+		mag_flush_all(slab);
+
+		key = k_spin_lock(&slab->lock);
+		result = mem_slab_alloc_locked(slab, mem, key, timeout);
+		atomic_dec(&slab->waiters);
+
+		return result;
+	}
+#else
+	key = k_spin_lock(&slab->lock);
+#endif
+
+	return mem_slab_alloc_locked(slab, mem, key, timeout);
+}
+
 void k_mem_slab_free(struct k_mem_slab *slab, void **mem)
 {
-	int key = irq_lock();
-	struct k_thread *pending_thread = _unpend_first_thread(&slab->wait_q);
+	k_spinlock_key_t key;
 
-	if (pending_thread != NULL) {
-		_set_thread_return_value_with_data(pending_thread, 0, *mem);
-		_ready_thread(pending_thread);
-		_reschedule(key);
+#ifdef CONFIG_MEM_SLAB_MAGAZINES
+	if (mag_free(slab, *mem)) {
+		return;
+	}
+#endif
+
+	key = k_spin_lock(&slab->lock);
+
+	if (give_block(slab, *mem)) {
+		_reschedule(&slab->lock, key);
+	} else {
+		k_spin_unlock(&slab->lock, key);
+	}
+}
+
+int k_mem_slab_alloc_n(struct k_mem_slab *slab, void **mem, u32_t count)
+{
+	k_spinlock_key_t key;
+	u32_t i;
+
+#ifdef CONFIG_MEM_SLAB_MAGAZINES
+	/* the missing blocks may be cached in magazines */
+	if (slab->num_blocks - slab->num_used < count) {
+		mag_flush_all(slab);
+	}
+#endif
+
+	key = k_spin_lock(&slab->lock);
+
+	if (slab->num_blocks - slab->num_used < count) {
+		k_spin_unlock(&slab->lock, key);
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < count; i++) {
+		mem[i] = slab->free_list;
+		slab->free_list = *(char **)(slab->free_list);
+	}
+	slab->num_used += count;
+	track_max_used(slab);
+
+	k_spin_unlock(&slab->lock, key);
+
+	return 0;
+}
+
+void k_mem_slab_free_n(struct k_mem_slab *slab, void **mem, u32_t count)
+{
+	k_spinlock_key_t key = k_spin_lock(&slab->lock);
+	bool readied = false;
+	u32_t i;
+
+	for (i = 0; i < count; i++) {
+		if (give_block(slab, mem[i])) {
+			readied = true;
+		}
+	}
+
+	if (readied) {
+		_reschedule(&slab->lock, key);
 	} else {
-		**(char ***)mem = slab->free_list;
-		slab->free_list = *(char **)mem;
-		slab->num_used--;
-		irq_unlock(key);
+		k_spin_unlock(&slab->lock, key);
 	}
 }
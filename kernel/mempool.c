@@ -29,7 +29,11 @@ static int pool_id(struct k_mem_pool *pool)
 static void k_mem_pool_init(struct k_mem_pool *p)
 {
 	_waitq_init(&p->wait_q);
+#ifdef CONFIG_MEM_POOL_HEAP_BACKEND
+	sys_heap_init(&p->heap, p->heap.init_mem, p->heap.init_bytes);
+#else
 	_sys_mem_pool_base_init(&p->base);
+#endif
 }
 
 int init_static_pools(struct device *unused)
@@ -46,6 +50,71 @@ int init_static_pools(struct device *unused)
 
 SYS_INIT(init_static_pools, PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_OBJECTS);
 
+#ifdef CONFIG_MEM_POOL_HEAP_BACKEND
+
+int k_mem_pool_alloc(struct k_mem_pool *p, struct k_mem_block *block,
+		     size_t size, s32_t timeout)
+{
+	k_spinlock_key_t key;
+	s64_t end = 0;
+
+	__ASSERT(!(_is_in_isr() && timeout != K_NO_WAIT), "");
+
+	if (timeout > 0) {
+		end = z_tick_get() + _ms_to_ticks(timeout);
+	}
+
+	while (true) {
+		key = k_spin_lock(&p->lock);
+
+		block->data = sys_heap_alloc(&p->heap, size);
+		if (block->data != NULL) {
+			k_spin_unlock(&p->lock, key);
+
+			block->id.pool = pool_id(p);
+			block->id.offset = ((char *)block->data -
+					    (char *)p->heap.init_mem) / 8;
+			return 0;
+		}
+
+		if (timeout == K_NO_WAIT) {
+			k_spin_unlock(&p->lock, key);
+			return -ENOMEM;
+		}
+
+		(void)_pend_curr(&p->lock, key, &p->wait_q, timeout);
+
+		if (timeout != K_FOREVER) {
+			timeout = end - z_tick_get();
+
+			if (timeout < 0) {
+				break;
+			}
+		}
+	}
+
+	return -EAGAIN;
+}
+
+void k_mem_pool_free_id(struct k_mem_block_id *id)
+{
+	struct k_mem_pool *p = get_pool(id->pool);
+	k_spinlock_key_t key = k_spin_lock(&p->lock);
+
+	sys_heap_free(&p->heap, (char *)p->heap.init_mem + id->offset * 8);
+
+	/* Wake up anyone blocked on this pool and let them repeat
+	 * their allocation attempts
+	 */
+	if (_unpend_all(&p->wait_q) != 0 && !_is_in_isr()) {
+		_reschedule(&p->lock, key);
+	} else {
+		k_spin_unlock(&p->lock, key);
+	}
+}
+
+#else
+
 int k_mem_pool_alloc(struct k_mem_pool *p, struct k_mem_block *block,
 		     size_t size, s32_t timeout)
 {
@@ -90,7 +159,7 @@ int k_mem_pool_alloc(struct k_mem_pool *p, struct k_mem_block *block,
 			return ret;
 		}
 
-		(void)_pend_current_thread(irq_lock(), &p->wait_q, timeout);
+		(void)_pend_curr_irqlock(irq_lock(), &p->wait_q, timeout);
 
 		if (timeout != K_FOREVER) {
 			timeout = end - z_tick_get();
@@ -119,12 +188,14 @@ void k_mem_pool_free_id(struct k_mem_block_id *id)
 	need_sched = _unpend_all(&p->wait_q);
 
 	if (need_sched && !_is_in_isr()) {
-		_reschedule(key);
+		_reschedule_irqlock(key);
 	} else {
 		irq_unlock(key);
 	}
 }
 
+#endif /* CONFIG_MEM_POOL_HEAP_BACKEND */
+
 void k_mem_pool_free(struct k_mem_block *block)
 {
 	k_mem_pool_free_id(&block->id);
@@ -17,6 +17,7 @@
 #include <linker/sections.h>
 #include <string.h>
 #include <wait_q.h>
+#include <ksched.h>
 #include <misc/dlist.h>
 #include <init.h>
 #include <syscall_handler.h>
@@ -58,6 +59,7 @@ void k_msgq_init(struct k_msgq *q, char *buffer, size_t msg_size,
 	q->write_ptr = buffer;
 	q->used_msgs = 0;
 	q->flags = 0;
+	q->lock = (struct k_spinlock) {};
 	_waitq_init(&q->wait_q);
 	SYS_TRACING_OBJ_INIT(k_msgq, q);
 
@@ -97,6 +99,79 @@ Z_SYSCALL_HANDLER(k_msgq_alloc_init, q, msg_size, max_msgs)
 }
 #endif
 
+/* copy num_msgs messages from data to the ring buffer */
+static void msgq_write(struct k_msgq *q, const char *data, u32_t num_msgs)
+{
+	size_t size = num_msgs * q->msg_size;
+	size_t first = min(size, (size_t)(q->buffer_end - q->write_ptr));
+
+	(void)memcpy(q->write_ptr, data, first);
+	if (first < size) {
+		(void)memcpy(q->buffer_start, data + first, size - first);
+		q->write_ptr = q->buffer_start + (size - first);
+	} else {
+		q->write_ptr += size;
+		if (q->write_ptr == q->buffer_end) {
+			q->write_ptr = q->buffer_start;
+		}
+	}
+	q->used_msgs += num_msgs;
+}
+
+/* copy num_msgs messages from the ring buffer to data (if not NULL) */
+static void msgq_read(struct k_msgq *q, char *data, u32_t num_msgs)
+{
+	size_t size = num_msgs * q->msg_size;
+	size_t first = min(size, (size_t)(q->buffer_end - q->read_ptr));
+
+	if (data != NULL) {
+		(void)memcpy(data, q->read_ptr, first);
+	}
+	if (first < size) {
+		if (data != NULL) {
+			(void)memcpy(data + first, q->buffer_start,
+				     size - first);
+		}
+		q->read_ptr = q->buffer_start + (size - first);
+	} else {
+		q->read_ptr += size;
+		if (q->read_ptr == q->buffer_end) {
+			q->read_ptr = q->buffer_start;
+		}
+	}
+	q->used_msgs -= num_msgs;
+}
+
+/*
+ * Fill the space freed by a read with the messages of threads waiting
+ * to write, waking them.  Only valid if the queue was non-empty before
+ * the read, so that nobody on the wait queue is waiting to read.
+ *
+ * Returns true if any thread was woken.
+ */
+static bool msgq_refill(struct k_msgq *q)
+{
+	struct k_thread *pending_thread;
+	bool woken = false;
+
+	while (q->used_msgs < q->max_msgs) {
+		pending_thread = _unpend_first_thread(&q->wait_q);
+		if (pending_thread == NULL) {
+			break;
+		}
+
+		/* add thread's message to queue */
+		msgq_write(q, pending_thread->base.swap_data, 1);
+
+		/* wake up waiting thread */
+		_set_thread_return_value(pending_thread, 0);
+		_ready_thread(pending_thread);
+		woken = true;
+	}
+
+	return woken;
+}
+
 void k_msgq_cleanup(struct k_msgq *q)
 {
 	__ASSERT_NO_MSG(!_waitq_head(&q->wait_q));
@@ -112,7 +187,7 @@ int _impl_k_msgq_put(struct k_msgq *q, void *data, s32_t timeout)
 {
 	__ASSERT(!_is_in_isr() || timeout == K_NO_WAIT, "");
 
-	unsigned int key = irq_lock();
+	k_spinlock_key_t key = k_spin_lock(&q->lock);
 	struct k_thread *pending_thread;
 	int result;
 
@@ -126,16 +201,11 @@ int _impl_k_msgq_put(struct k_msgq *q, void *data, s32_t timeout)
 			/* wake up waiting thread */
 			_set_thread_return_value(pending_thread, 0);
 			_ready_thread(pending_thread);
-			_reschedule(key);
+			_reschedule(&q->lock, key);
 			return 0;
 		} else {
 			/* put message in queue */
-			(void)memcpy(q->write_ptr, data, q->msg_size);
-			q->write_ptr += q->msg_size;
-			if (q->write_ptr == q->buffer_end) {
-				q->write_ptr = q->buffer_start;
-			}
-			q->used_msgs++;
+			msgq_write(q, data, 1);
 		}
 		result = 0;
 	} else if (timeout == K_NO_WAIT) {
@@ -144,10 +214,10 @@ int _impl_k_msgq_put(struct k_msgq *q, void *data, s32_t timeout)
 	} else {
 		/* wait for put message success, failure, or timeout */
 		_current->base.swap_data = data;
-		return _pend_current_thread(key, &q->wait_q, timeout);
+		return _pend_curr(&q->lock, key, &q->wait_q, timeout);
 	}
 
-	irq_unlock(key);
+	k_spin_unlock(&q->lock, key);
 
 	return result;
 }
@@ -187,35 +257,16 @@ int _impl_k_msgq_get(struct k_msgq *q, void *data, s32_t timeout)
 {
 	__ASSERT(!_is_in_isr() || timeout == K_NO_WAIT, "");
 
-	unsigned int key = irq_lock();
-	struct k_thread *pending_thread;
+	k_spinlock_key_t key = k_spin_lock(&q->lock);
 	int result;
 
 	if (q->used_msgs > 0) {
 		/* take first available message from queue */
-		(void)memcpy(data, q->read_ptr, q->msg_size);
-		q->read_ptr += q->msg_size;
-		if (q->read_ptr == q->buffer_end) {
-			q->read_ptr = q->buffer_start;
-		}
-		q->used_msgs--;
+		msgq_read(q, data, 1);
 
 		/* handle first thread waiting to write (if any) */
-		pending_thread = _unpend_first_thread(&q->wait_q);
-		if (pending_thread != NULL) {
-			/* add thread's message to queue */
-			(void)memcpy(q->write_ptr, pending_thread->base.swap_data,
-			       q->msg_size);
-			q->write_ptr += q->msg_size;
-			if (q->write_ptr == q->buffer_end) {
-				q->write_ptr = q->buffer_start;
-			}
-			q->used_msgs++;
-
-			/* wake up waiting thread */
-			_set_thread_return_value(pending_thread, 0);
-			_ready_thread(pending_thread);
-			_reschedule(key);
+		if (msgq_refill(q)) {
+			_reschedule(&q->lock, key);
 			return 0;
 		}
 		result = 0;
@@ -225,10 +276,10 @@ int _impl_k_msgq_get(struct k_msgq *q, void *data, s32_t timeout)
 	} else {
 		/* wait for get message success or timeout */
 		_current->base.swap_data = data;
-		return _pend_current_thread(key, &q->wait_q, timeout);
+		return _pend_curr(&q->lock, key, &q->wait_q, timeout);
 	}
 
-	irq_unlock(key);
+	k_spin_unlock(&q->lock, key);
 
 	return result;
 }
@@ -245,9 +296,171 @@ Z_SYSCALL_HANDLER(k_msgq_get, msgq_p, data, timeout)
 }
 #endif
 
+int _impl_k_msgq_put_n(struct k_msgq *q, const void *data, u32_t num_msgs,
+		       s32_t timeout)
+{
+	__ASSERT(!_is_in_isr() || timeout == K_NO_WAIT, "");
+
+	k_spinlock_key_t key = k_spin_lock(&q->lock);
+	struct k_thread *pending_thread;
+	const char *msg = data;
+	u32_t count = 0;
+	u32_t n;
+	bool woken = false;
+	int ret;
+
+	if (num_msgs == 0) {
+		k_spin_unlock(&q->lock, key);
+		return 0;
+	}
+
+	/* readers only ever wait on an empty queue: give them a message
+	 * each, in the order they started waiting
+	 */
+	if (q->used_msgs == 0) {
+		while (count < num_msgs) {
+			pending_thread = _unpend_first_thread(&q->wait_q);
+			if (pending_thread == NULL) {
+				break;
+			}
+			(void)memcpy(pending_thread->base.swap_data, msg,
+				     q->msg_size);
+			_set_thread_return_value(pending_thread, 0);
+			_ready_thread(pending_thread);
+			msg += q->msg_size;
+			count++;
+			woken = true;
+		}
+	}
+
+	/* queue as many of the others as fit */
+	n = min(num_msgs - count, q->max_msgs - q->used_msgs);
+	msgq_write(q, msg, n);
+	count += n;
+
+	if (count == 0) {
+		if (timeout == K_NO_WAIT) {
+			k_spin_unlock(&q->lock, key);
+			return -ENOMSG;
+		}
+
+		/* queue full: wait until the first message can be sent */
+		_current->base.swap_data = (void *)data;
+		ret = _pend_curr(&q->lock, key, &q->wait_q, timeout);
+		return (ret == 0) ? 1 : ret;
+	}
+
+	if (woken) {
+		_reschedule(&q->lock, key);
+	} else {
+		k_spin_unlock(&q->lock, key);
+	}
+
+	return count;
+}
+
+#ifdef CONFIG_USERSPACE
+Z_SYSCALL_HANDLER(k_msgq_put_n, msgq_p, data, num_msgs, timeout)
+{
+	struct k_msgq *q = (struct k_msgq *)msgq_p;
+
+	Z_OOPS(Z_SYSCALL_OBJ(q, K_OBJ_MSGQ));
+	Z_OOPS(Z_SYSCALL_MEMORY_ARRAY_READ(data, num_msgs, q->msg_size));
+
+	return _impl_k_msgq_put_n(q, (const void *)data, num_msgs, timeout);
+}
+#endif
+
+int _impl_k_msgq_get_n(struct k_msgq *q, void *data, u32_t num_msgs,
+		       s32_t timeout)
+{
+	__ASSERT(!_is_in_isr() || timeout == K_NO_WAIT, "");
+
+	k_spinlock_key_t key = k_spin_lock(&q->lock);
+	u32_t count;
+	int ret;
+
+	if (num_msgs == 0) {
+		k_spin_unlock(&q->lock, key);
+		return 0;
+	}
+
+	if (q->used_msgs > 0) {
+		count = min(num_msgs, q->used_msgs);
+		msgq_read(q, data, count);
+
+		/* let threads waiting to write use the space just freed */
+		if (msgq_refill(q)) {
+			_reschedule(&q->lock, key);
+		} else {
+			k_spin_unlock(&q->lock, key);
+		}
+		return count;
+	}
+
+	if (timeout == K_NO_WAIT) {
+		k_spin_unlock(&q->lock, key);
+		return -ENOMSG;
+	}
+
+	/* wait for the first message; writers hand over one at a time */
+	_current->base.swap_data = data;
+	ret = _pend_curr(&q->lock, key, &q->wait_q, timeout);
+	return (ret == 0) ? 1 : ret;
+}
+
+#ifdef CONFIG_USERSPACE
+Z_SYSCALL_HANDLER(k_msgq_get_n, msgq_p, data, num_msgs, timeout)
+{
+	struct k_msgq *q = (struct k_msgq *)msgq_p;
+
+	Z_OOPS(Z_SYSCALL_OBJ(q, K_OBJ_MSGQ));
+	Z_OOPS(Z_SYSCALL_MEMORY_ARRAY_WRITE(data, num_msgs, q->msg_size));
+
+	return _impl_k_msgq_get_n(q, (void *)data, num_msgs, timeout);
+}
+#endif
+
+u32_t k_msgq_get_claim(struct k_msgq *q, void **data, u32_t num_msgs)
+{
+	k_spinlock_key_t key = k_spin_lock(&q->lock);
+	u32_t contiguous = (q->buffer_end - q->read_ptr) / q->msg_size;
+	u32_t count = min(min(num_msgs, q->used_msgs), contiguous);
+
+	*data = q->read_ptr;
+	k_spin_unlock(&q->lock, key);
+
+	return count;
+}
+
+int k_msgq_get_finish(struct k_msgq *q, u32_t num_msgs)
+{
+	k_spinlock_key_t key = k_spin_lock(&q->lock);
+
+	if (num_msgs > q->used_msgs) {
+		k_spin_unlock(&q->lock, key);
+		return -EINVAL;
+	}
+
+	if (num_msgs == 0) {
+		k_spin_unlock(&q->lock, key);
+		return 0;
+	}
+
+	msgq_read(q, NULL, num_msgs);
+
+	if (msgq_refill(q)) {
+		_reschedule(&q->lock, key);
+	} else {
+		k_spin_unlock(&q->lock, key);
+	}
+
+	return 0;
+}
+
 void _impl_k_msgq_purge(struct k_msgq *q)
 {
-	unsigned int key = irq_lock();
+	k_spinlock_key_t key = k_spin_lock(&q->lock);
 	struct k_thread *pending_thread;
 
 	/* wake up any threads that are waiting to write */
@@ -259,7 +472,7 @@ void _impl_k_msgq_purge(struct k_msgq *q)
 	q->used_msgs = 0;
 	q->read_ptr = q->write_ptr;
 
-	_reschedule(key);
+	_reschedule(&q->lock, key);
 }
 
 #ifdef CONFIG_USERSPACE
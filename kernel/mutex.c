@@ -13,6 +13,9 @@
  * level of the owning thread to match the priority level of the highest
  * priority thread waiting on the mutex.
  *
+ * Inheritance is transitive: if the owner is itself waiting on another mutex,
+ * the owner of that one is boosted too, and so on down the chain.
+ *
  * Each mutex that contributes to priority inheritance must be released in the
  * reverse order in which it was acquired.  Furthermore each subsequent mutex
  * that contributes to raising the owning thread's priority level must be
@@ -31,6 +34,7 @@
 #include <toolchain.h>
 #include <linker/sections.h>
 #include <wait_q.h>
+#include <ksched.h>
 #include <misc/dlist.h>
 #include <debug/object_tracing_common.h>
 #include <errno.h>
@@ -41,6 +45,10 @@
 #define RECORD_STATE_CHANGE(mutex) do { } while (false)
 #define RECORD_CONFLICT(mutex) do { } while (false)
 
+/* We use a global spin lock here because priority inheritance follows
+ * chains of mutexes, so it isn't state that belongs to any single one.
+ */
+static struct k_spinlock lock;
 
 extern struct k_mutex _k_mutex_list_start[];
 extern struct k_mutex _k_mutex_list_end[];
@@ -101,7 +109,7 @@ static s32_t new_prio_for_inheritance(s32_t target, s32_t limit)
 	return new_prio;
 }
 
-static void adjust_owner_prio(struct k_mutex *mutex, s32_t new_prio)
+static bool adjust_owner_prio(struct k_mutex *mutex, s32_t new_prio)
 {
 	if (mutex->owner->base.prio != new_prio) {
 
@@ -110,17 +118,81 @@ static void adjust_owner_prio(struct k_mutex *mutex, s32_t new_prio)
 			'y' : 'n',
 			new_prio, mutex->owner->base.prio);
 
-		_thread_priority_set(mutex->owner, new_prio);
+		return _set_prio(mutex->owner, new_prio);
 	}
+	return false;
+}
+
+/* Returns the mutex the owner of @a mutex is waiting on, if any */
+static struct k_mutex *next_in_chain(struct k_mutex *mutex)
+{
+	struct k_thread *owner = mutex->owner;
+
+	return _is_thread_pending(owner) ? owner->base.pended_mutex : NULL;
+}
+
+/*
+ * Boost the owner of mutex up to prio, then the owner of the mutex that
+ * one is waiting on, and so on, until an owner already runs at least at
+ * that priority.  Boosting an owner that is waiting on a mutex moves it
+ * up that mutex's wait queue, so it is what wakes up there first.
+ */
+static bool boost_chain(struct k_mutex *mutex, s32_t prio)
+{
+	bool resched = false;
+	s32_t new_prio;
+
+	while (mutex != NULL) {
+		s32_t owner_prio = mutex->owner->base.prio;
+
+		new_prio = new_prio_for_inheritance(prio, owner_prio);
+		if (!_is_prio_higher(new_prio, owner_prio)) {
+			break;
+		}
+
+		resched = adjust_owner_prio(mutex, new_prio) || resched;
+		mutex = next_in_chain(mutex);
+	}
+
+	return resched;
+}
+
+/*
+ * Recompute the priority of the owner of mutex once a waiter gave up,
+ * from its original one and the best remaining waiter, then do the same
+ * down the chain for as long as it changes anything.
+ */
+static bool unboost_chain(struct k_mutex *mutex)
+{
+	bool resched = false;
+	struct k_thread *waiter;
+	s32_t new_prio;
+
+	while (mutex != NULL) {
+		waiter = _waitq_head(&mutex->wait_q);
+		new_prio = mutex->owner_orig_prio;
+		new_prio = (waiter != NULL) ?
+			new_prio_for_inheritance(waiter->base.prio, new_prio) :
+			new_prio;
+
+		if (new_prio == mutex->owner->base.prio) {
+			break;
+		}
+
+		resched = adjust_owner_prio(mutex, new_prio) || resched;
+		mutex = next_in_chain(mutex);
+	}
+
+	return resched;
 }
 
 int _impl_k_mutex_lock(struct k_mutex *mutex, s32_t timeout)
 {
-	int new_prio;
-	u32_t key;
+	k_spinlock_key_t key;
+	bool resched = false;
 
 	sys_trace_void(SYS_TRACE_ID_MUTEX_LOCK);
-	_sched_lock();
+	key = k_spin_lock(&lock);
 
 	if (likely((mutex->lock_count == 0U) || (mutex->owner == _current))) {
 
@@ -137,7 +209,7 @@ int _impl_k_mutex_lock(struct k_mutex *mutex, s32_t timeout)
 			_current, mutex, mutex->lock_count,
 			mutex->owner_orig_prio);
 
-		k_sched_unlock();
+		k_spin_unlock(&lock, key);
 		sys_trace_end_call(SYS_TRACE_ID_MUTEX_LOCK);
 
 		return 0;
@@ -146,23 +218,19 @@ int _impl_k_mutex_lock(struct k_mutex *mutex, s32_t timeout)
 	RECORD_CONFLICT();
 
 	if (unlikely(timeout == (s32_t)K_NO_WAIT)) {
-		k_sched_unlock();
+		k_spin_unlock(&lock, key);
 		sys_trace_end_call(SYS_TRACE_ID_MUTEX_LOCK);
 		return -EBUSY;
 	}
 
-	new_prio = new_prio_for_inheritance(_current->base.prio,
-					    mutex->owner->base.prio);
-
-	key = irq_lock();
-
 	K_DEBUG("adjusting prio up on mutex %p\n", mutex);
 
-	if (_is_prio_higher(new_prio, mutex->owner->base.prio)) {
-		adjust_owner_prio(mutex, new_prio);
-	}
+	resched = boost_chain(mutex, _current->base.prio);
 
-	s32_t got_mutex = _pend_current_thread(key, &mutex->wait_q, timeout);
+	/* cleared by whoever takes us off the wait queue, under the lock */
+	_current->base.pended_mutex = mutex;
+
+	int got_mutex = _pend_curr(&lock, key, &mutex->wait_q, timeout);
 
 	K_DEBUG("on mutex %p got_mutex value: %d\n", mutex, got_mutex);
 
@@ -170,7 +238,6 @@ int _impl_k_mutex_lock(struct k_mutex *mutex, s32_t timeout)
 		got_mutex ? 'y' : 'n');
 
 	if (got_mutex == 0) {
-		k_sched_unlock();
 		sys_trace_end_call(SYS_TRACE_ID_MUTEX_LOCK);
 		return 0;
 	}
@@ -179,20 +246,19 @@ int _impl_k_mutex_lock(struct k_mutex *mutex, s32_t timeout)
 
 	K_DEBUG("%p timeout on mutex %p\n", _current, mutex);
 
-	struct k_thread *waiter = _waitq_head(&mutex->wait_q);
+	key = k_spin_lock(&lock);
 
-	new_prio = mutex->owner_orig_prio;
-	new_prio = (waiter != NULL) ?
-		new_prio_for_inheritance(waiter->base.prio, new_prio) :
-		new_prio;
+	_current->base.pended_mutex = NULL;
 
 	K_DEBUG("adjusting prio down on mutex %p\n", mutex);
 
-	key = irq_lock();
-	adjust_owner_prio(mutex, new_prio);
-	irq_unlock(key);
+	resched = unboost_chain(mutex) || resched;
 
-	k_sched_unlock();
+	if (resched) {
+		_reschedule(&lock, key);
+	} else {
+		k_spin_unlock(&lock, key);
+	}
 
 	sys_trace_end_call(SYS_TRACE_ID_MUTEX_LOCK);
 	return -EAGAIN;
@@ -208,28 +274,43 @@ Z_SYSCALL_HANDLER(k_mutex_lock, mutex, timeout)
 
 void _impl_k_mutex_unlock(struct k_mutex *mutex)
 {
-	u32_t key;
+	k_spinlock_key_t key;
 	struct k_thread *new_owner;
+	bool resched;
 
 	__ASSERT(mutex->lock_count > 0U, "");
 	__ASSERT(mutex->owner == _current, "");
 
 	sys_trace_void(SYS_TRACE_ID_MUTEX_UNLOCK);
-	_sched_lock();
 
 	RECORD_STATE_CHANGE();
 
-	mutex->lock_count--;
-
-	K_DEBUG("mutex %p lock_count: %d\n", mutex, mutex->lock_count);
+	K_DEBUG("mutex %p lock_count: %d\n", mutex, mutex->lock_count - 1U);
 
-	if (mutex->lock_count != 0U) {
+	/* Only the owner changes the count of a recursively locked mutex */
+	if (mutex->lock_count != 1U) {
+		mutex->lock_count--;
 		goto k_mutex_unlock_return;
 	}
 
-	key = irq_lock();
+	/* The final release must be atomic with the hand-off to the
+	 * next owner, or another CPU could see the count drop to zero
+	 * and claim the mutex in between.
+	 */
+	key = k_spin_lock(&lock);
 
-	adjust_owner_prio(mutex, mutex->owner_orig_prio);
+	mutex->lock_count--;
+
+	new_owner = _waitq_head(&mutex->wait_q);
+	if (likely((new_owner == NULL) &&
+		   (_current->base.prio == mutex->owner_orig_prio))) {
+		/* uncontended: nothing to hand off or to reschedule */
+		mutex->owner = NULL;
+		k_spin_unlock(&lock, key);
+		goto k_mutex_unlock_return;
+	}
+
+	resched = adjust_owner_prio(mutex, mutex->owner_orig_prio);
 
 	new_owner = _unpend_first_thread(&mutex->wait_q);
 
@@ -239,10 +320,9 @@ void _impl_k_mutex_unlock(struct k_mutex *mutex)
 		mutex, new_owner, new_owner ? new_owner->base.prio : -1000);
 
 	if (new_owner != NULL) {
+		new_owner->base.pended_mutex = NULL;
 		_ready_thread(new_owner);
 
-		irq_unlock(key);
-
 		_set_thread_return_value(new_owner, 0);
 
 		/*
@@ -252,12 +332,17 @@ void _impl_k_mutex_unlock(struct k_mutex *mutex)
 		 */
 		mutex->lock_count++;
 		mutex->owner_orig_prio = new_owner->base.prio;
+		resched = true;
 	}
 
-	irq_unlock(key);
+	if (resched) {
+		_reschedule(&lock, key);
+	} else {
+		k_spin_unlock(&lock, key);
+	}
 
 k_mutex_unlock_return:
-	k_sched_unlock();
+	sys_trace_end_call(SYS_TRACE_ID_MUTEX_UNLOCK);
 }
 
 #ifdef CONFIG_USERSPACE
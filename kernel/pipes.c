@@ -20,6 +20,7 @@
 #include <init.h>
 #include <syscall_handler.h>
 #include <misc/__assert.h>
+#include <string.h>
 
 struct k_pipe_desc {
 	unsigned char *buffer;           /* Position in src/dest buffer */
@@ -138,9 +139,12 @@ void k_pipe_init(struct k_pipe *pipe, unsigned char *buffer, size_t size)
 	pipe->bytes_used = 0;
 	pipe->read_index = 0;
 	pipe->write_index = 0;
+	pipe->put_claimed = 0;
+	pipe->get_claimed = 0;
 	pipe->flags = 0;
 	_waitq_init(&pipe->wait_q.writers);
 	_waitq_init(&pipe->wait_q.readers);
+	pipe->lock = (struct k_spinlock) {};
 	SYS_TRACING_OBJ_INIT(k_pipe, pipe);
 	_k_object_init(pipe);
 }
@@ -197,13 +201,8 @@ static size_t pipe_xfer(unsigned char *dest, size_t dest_size,
 			 const unsigned char *src, size_t src_size)
 {
 	size_t num_bytes = min(dest_size, src_size);
-	const unsigned char *end = src + num_bytes;
 
-	while (src != end) {
-		*dest = *src;
-		dest++;
-		src++;
-	}
+	(void)memcpy(dest, src, num_bytes);
 
 	return num_bytes;
 }
@@ -412,8 +411,6 @@ static int pipe_return_code(size_t min_xfer, size_t bytes_remaining,
  */
 static void pipe_thread_ready(struct k_thread *thread)
 {
-	unsigned int  key;
-
 #if (CONFIG_NUM_PIPE_ASYNC_MSGS > 0)
 	if (thread->base.thread_state & _THREAD_DUMMY) {
 		pipe_async_finish((struct k_pipe_async *)thread);
@@ -421,9 +418,7 @@ static void pipe_thread_ready(struct k_thread *thread)
 	}
 #endif
 
-	key = irq_lock();
 	_ready_thread(thread);
-	irq_unlock(key);
 }
 
 /**
@@ -437,15 +432,26 @@ int _k_pipe_put_internal(struct k_pipe *pipe, struct k_pipe_async *async_desc,
 	struct k_thread    *reader;
 	struct k_pipe_desc *desc;
 	sys_dlist_t    xfer_list;
-	unsigned int   key;
+	k_spinlock_key_t key;
 	size_t         num_bytes_written = 0;
 	size_t         bytes_copied;
 
 #if (CONFIG_NUM_PIPE_ASYNC_MSGS == 0)
 	ARG_UNUSED(async_desc);
 #endif
+	key = k_spin_lock(&pipe->lock);
 
-	key = irq_lock();
+	if (pipe->put_claimed != 0) {
+		k_spin_unlock(&pipe->lock, key);
+		*bytes_written = 0;
+#if (CONFIG_NUM_PIPE_ASYNC_MSGS > 0)
+		/* Release the block so that k_pipe_block_put() leaks nothing */
+		if (async_desc != NULL) {
+			pipe_async_finish(async_desc);
+		}
+#endif
+		return -EBUSY;
+	}
 
 	/*
 	 * Create a list of "working readers" into which the data will be
@@ -455,20 +461,20 @@ int _k_pipe_put_internal(struct k_pipe *pipe, struct k_pipe_async *async_desc,
 	if (!pipe_xfer_prepare(&xfer_list, &reader, &pipe->wait_q.readers,
 				pipe->size - pipe->bytes_used, bytes_to_write,
 				min_xfer, timeout)) {
-		irq_unlock(key);
+		k_spin_unlock(&pipe->lock, key);
 		*bytes_written = 0;
 		return -EIO;
 	}
 
 	_sched_lock();
-	irq_unlock(key);
+	k_spin_unlock(&pipe->lock, key);
 
 	/*
 	 * 1. 'xfer_list' currently contains a list of reader threads that can
 	 * have their read requests fulfilled by the current call.
 	 * 2. 'reader' if not NULL points to a thread on the reader wait_q
 	 * that can get some of its requested data.
-	 * 3. Interrupts are unlocked but the scheduler is locked to allow
+	 * 3. The pipe lock is released but the scheduler is locked to allow
 	 * ticks to be delivered but no scheduling to occur
 	 * 4. If 'reader' times out while we are copying data, not only do we
 	 * still have a pointer to it, but it can not execute until this call
@@ -488,9 +494,7 @@ int _k_pipe_put_internal(struct k_pipe *pipe, struct k_pipe_async *async_desc,
 		desc->bytes_to_xfer -= bytes_copied;
 
 		/* The thread's read request has been satisfied. Ready it. */
-		key = irq_lock();
 		_ready_thread(thread);
-		irq_unlock(key);
 
 		thread = (struct k_thread *)sys_dlist_get(&xfer_list);
 	}
@@ -535,10 +539,10 @@ int _k_pipe_put_internal(struct k_pipe *pipe, struct k_pipe_async *async_desc,
 #if (CONFIG_NUM_PIPE_ASYNC_MSGS > 0)
 	if (async_desc != NULL) {
 		/*
-		 * Lock interrupts and unlock the scheduler before
+		 * Take the pipe lock and unlock the scheduler before
 		 * manipulating the writers wait_q.
 		 */
-		key = irq_lock();
+		key = k_spin_lock(&pipe->lock);
 		_sched_unlock_no_reschedule();
 
 		async_desc->desc.buffer = data + num_bytes_written;
@@ -547,7 +551,7 @@ int _k_pipe_put_internal(struct k_pipe *pipe, struct k_pipe_async *async_desc,
 
 		_pend_thread((struct k_thread *) &async_desc->thread,
 			     &pipe->wait_q.writers, K_FOREVER);
-		_reschedule(key);
+		_reschedule(&pipe->lock, key);
 		return 0;
 	}
 #endif
@@ -560,12 +564,13 @@ int _k_pipe_put_internal(struct k_pipe *pipe, struct k_pipe_async *async_desc,
 	if (timeout != K_NO_WAIT) {
 		_current->base.swap_data = &pipe_desc;
 		/*
-		 * Lock interrupts and unlock the scheduler before
+		 * Take the pipe lock and unlock the scheduler before
 		 * manipulating the writers wait_q.
 		 */
-		key = irq_lock();
+		key = k_spin_lock(&pipe->lock);
 		_sched_unlock_no_reschedule();
-		(void)_pend_current_thread(key, &pipe->wait_q.writers, timeout);
+		(void)_pend_curr(&pipe->lock, key, &pipe->wait_q.writers,
+				 timeout);
 	} else {
 		k_sched_unlock();
 	}
@@ -582,14 +587,19 @@ int _impl_k_pipe_get(struct k_pipe *pipe, void *data, size_t bytes_to_read,
 	struct k_thread    *writer;
 	struct k_pipe_desc *desc;
 	sys_dlist_t    xfer_list;
-	unsigned int   key;
+	k_spinlock_key_t key;
 	size_t         num_bytes_read = 0;
 	size_t         bytes_copied;
 
 	__ASSERT(min_xfer <= bytes_to_read, "");
 	__ASSERT(bytes_read != NULL, "");
+	key = k_spin_lock(&pipe->lock);
 
-	key = irq_lock();
+	if (pipe->get_claimed != 0) {
+		k_spin_unlock(&pipe->lock, key);
+		*bytes_read = 0;
+		return -EBUSY;
+	}
 
 	/*
 	 * Create a list of "working readers" into which the data will be
@@ -599,13 +609,13 @@ int _impl_k_pipe_get(struct k_pipe *pipe, void *data, size_t bytes_to_read,
 	if (!pipe_xfer_prepare(&xfer_list, &writer, &pipe->wait_q.writers,
 				pipe->bytes_used, bytes_to_read,
 				min_xfer, timeout)) {
-		irq_unlock(key);
+		k_spin_unlock(&pipe->lock, key);
 		*bytes_read = 0;
 		return -EIO;
 	}
 
 	_sched_lock();
-	irq_unlock(key);
+	k_spin_unlock(&pipe->lock, key);
 
 	num_bytes_read = pipe_buffer_get(pipe, data, bytes_to_read);
 
@@ -616,7 +626,7 @@ int _impl_k_pipe_get(struct k_pipe *pipe, void *data, size_t bytes_to_read,
 	 *    that can post some of its requested data.
 	 * 3. Data will be copied from each writer's buffer to either the
 	 *    reader's buffer and/or to the pipe's circular buffer.
-	 * 4. Interrupts are unlocked but the scheduler is locked to allow
+	 * 4. The pipe lock is released but the scheduler is locked to allow
 	 *    ticks to be delivered but no scheduling to occur
 	 * 5. If 'writer' times out while we are copying data, not only do we
 	 *    still have a pointer to it, but it can not execute until this
@@ -705,9 +715,10 @@ int _impl_k_pipe_get(struct k_pipe *pipe, void *data, size_t bytes_to_read,
 
 	if (timeout != K_NO_WAIT) {
 		_current->base.swap_data = &pipe_desc;
-		key = irq_lock();
+		key = k_spin_lock(&pipe->lock);
 		_sched_unlock_no_reschedule();
-		(void)_pend_current_thread(key, &pipe->wait_q.readers, timeout);
+		(void)_pend_curr(&pipe->lock, key, &pipe->wait_q.readers,
+				 timeout);
 	} else {
 		k_sched_unlock();
 	}
@@ -785,3 +796,418 @@ void k_pipe_block_put(struct k_pipe *pipe, struct k_mem_block *block,
 				    bytes_to_write, K_FOREVER);
 }
 #endif
+
+/**
+ * @brief Ready the threads of a transfer list
+ *
+ * Releases the pipe lock, and readies the threads in @a xfer_list with
+ * the scheduler locked, as the transfers above do.
+ *
+ * @return N/A
+ */
+static void pipe_xfer_finish(struct k_pipe *pipe, k_spinlock_key_t key,
+			     sys_dlist_t *xfer_list)
+{
+	struct k_thread *thread;
+
+	if (sys_dlist_is_empty(xfer_list)) {
+		k_spin_unlock(&pipe->lock, key);
+		return;
+	}
+
+	_sched_lock();
+	k_spin_unlock(&pipe->lock, key);
+
+	while ((thread = (struct k_thread *)sys_dlist_get(xfer_list)) != NULL) {
+		pipe_thread_ready(thread);
+	}
+
+	k_sched_unlock();
+}
+
+/* What is left of @a timeout, @a start being when the wait began */
+static s32_t pipe_timeout_left(s32_t timeout, u32_t start)
+{
+	u32_t elapsed;
+
+	if (timeout == K_NO_WAIT || timeout == K_FOREVER) {
+		return timeout;
+	}
+
+	elapsed = k_uptime_get_32() - start;
+
+	return (elapsed < (u32_t)timeout) ? (s32_t)(timeout - elapsed) :
+							 K_NO_WAIT;
+}
+
+/**
+ * @brief Pend on a pipe until a transfer wakes the thread up
+ *
+ * The thread waits with an empty request, which the next transfer from the
+ * other end of the pipe satisfies at once.
+ *
+ * @return N/A
+ */
+static void pipe_claim_wait(struct k_pipe *pipe, k_spinlock_key_t key,
+			    _wait_q_t *wait_q, s32_t timeout)
+{
+	struct k_pipe_desc pipe_desc;
+
+	pipe_desc.buffer        = pipe->buffer;
+	pipe_desc.bytes_to_xfer = 0;
+
+	_current->base.swap_data = &pipe_desc;
+	(void)_pend_curr(&pipe->lock, key, wait_q, timeout);
+}
+
+/* Contiguous free space at the write index */
+static size_t pipe_put_run(struct k_pipe *pipe)
+{
+	return min(pipe->size - pipe->bytes_used,
+		   pipe->size - pipe->write_index);
+}
+
+/* Contiguous data at the read index */
+static size_t pipe_get_run(struct k_pipe *pipe)
+{
+	return min(pipe->bytes_used, pipe->size - pipe->read_index);
+}
+
+int k_pipe_put_claim(struct k_pipe *pipe, void **data, size_t bytes,
+		     size_t *bytes_claimed, s32_t timeout)
+{
+	u32_t start = k_uptime_get_32();
+	k_spinlock_key_t key;
+	s32_t left;
+	size_t run;
+
+	if (pipe->size == 0 || bytes == 0) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&pipe->lock);
+
+	/*
+	 * Readers waiting on a full pipe do not exist. A commit of zero bytes
+	 * wakes the thread without making room, so wait again until there
+	 * is some or the timeout expires.
+	 */
+	run = pipe_put_run(pipe);
+	while (run == 0 && timeout != K_NO_WAIT && pipe->put_claimed == 0) {
+		left = pipe_timeout_left(timeout, start);
+		if (left == K_NO_WAIT) {
+			k_spin_unlock(&pipe->lock, key);
+			return -EAGAIN;
+		}
+
+		pipe_claim_wait(pipe, key, &pipe->wait_q.writers, left);
+
+		key = k_spin_lock(&pipe->lock);
+		run = pipe_put_run(pipe);
+	}
+
+	if (pipe->put_claimed != 0) {
+		k_spin_unlock(&pipe->lock, key);
+		return -EBUSY;
+	}
+
+	if (run == 0) {
+		k_spin_unlock(&pipe->lock, key);
+		return -EIO;
+	}
+
+	pipe->put_claimed = min(run, bytes);
+	*data = pipe->buffer + pipe->write_index;
+	*bytes_claimed = pipe->put_claimed;
+
+	k_spin_unlock(&pipe->lock, key);
+
+	return 0;
+}
+
+void k_pipe_put_commit(struct k_pipe *pipe, size_t bytes)
+{
+	struct k_thread    *thread;
+	struct k_pipe_desc *desc;
+	sys_dlist_t    xfer_list;
+	k_spinlock_key_t key;
+	size_t         bytes_copied;
+
+	key = k_spin_lock(&pipe->lock);
+
+	__ASSERT(bytes <= pipe->put_claimed, "commit exceeds claim");
+
+	pipe->put_claimed = 0;
+	pipe->bytes_used += bytes;
+	pipe->write_index += bytes;
+	if (pipe->write_index == pipe->size) {
+		pipe->write_index = 0;
+	}
+
+	/*
+	 * Readers only wait on an empty pipe: hand them the new data, and
+	 * ready those whose request is complete.
+	 */
+
+	sys_dlist_init(&xfer_list);
+
+	while ((thread = _waitq_head(&pipe->wait_q.readers)) != NULL) {
+		desc = (struct k_pipe_desc *)thread->base.swap_data;
+		bytes_copied = pipe_buffer_get(pipe, desc->buffer,
+						desc->bytes_to_xfer);
+
+		desc->buffer        += bytes_copied;
+		desc->bytes_to_xfer -= bytes_copied;
+
+		if (desc->bytes_to_xfer != 0) {
+			break;
+		}
+
+		_unpend_thread(thread);
+		sys_dlist_append(&xfer_list, &thread->base.qnode_dlist);
+	}
+
+	pipe_xfer_finish(pipe, key, &xfer_list);
+}
+
+int k_pipe_get_claim(struct k_pipe *pipe, void **data, size_t bytes,
+		     size_t *bytes_claimed, s32_t timeout)
+{
+	u32_t start = k_uptime_get_32();
+	k_spinlock_key_t key;
+	s32_t left;
+	size_t run;
+
+	if (pipe->size == 0 || bytes == 0) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&pipe->lock);
+
+	/*
+	 * Writers waiting on an empty pipe do not exist. A commit of zero bytes
+	 * wakes the thread without adding data, so wait again until there
+	 * is some or the timeout expires.
+	 */
+	run = pipe_get_run(pipe);
+	while (run == 0 && timeout != K_NO_WAIT && pipe->get_claimed == 0) {
+		left = pipe_timeout_left(timeout, start);
+		if (left == K_NO_WAIT) {
+			k_spin_unlock(&pipe->lock, key);
+			return -EAGAIN;
+		}
+
+		pipe_claim_wait(pipe, key, &pipe->wait_q.readers, left);
+
+		key = k_spin_lock(&pipe->lock);
+		run = pipe_get_run(pipe);
+	}
+
+	if (pipe->get_claimed != 0) {
+		k_spin_unlock(&pipe->lock, key);
+		return -EBUSY;
+	}
+
+	if (run == 0) {
+		k_spin_unlock(&pipe->lock, key);
+		return -EIO;
+	}
+
+	pipe->get_claimed = min(run, bytes);
+	*data = pipe->buffer + pipe->read_index;
+	*bytes_claimed = pipe->get_claimed;
+
+	k_spin_unlock(&pipe->lock, key);
+
+	return 0;
+}
+
+void k_pipe_get_commit(struct k_pipe *pipe, size_t bytes)
+{
+	struct k_thread    *thread;
+	struct k_pipe_desc *desc;
+	sys_dlist_t    xfer_list;
+	k_spinlock_key_t key;
+	size_t         bytes_copied;
+
+	key = k_spin_lock(&pipe->lock);
+
+	__ASSERT(bytes <= pipe->get_claimed, "commit exceeds claim");
+
+	pipe->get_claimed = 0;
+	pipe->bytes_used -= bytes;
+	pipe->read_index += bytes;
+	if (pipe->read_index == pipe->size) {
+		pipe->read_index = 0;
+	}
+
+	/*
+	 * Writers only wait on a full pipe: move their data into the space
+	 * just freed, and ready those whose request is complete.
+	 */
+
+	sys_dlist_init(&xfer_list);
+
+	while ((thread = _waitq_head(&pipe->wait_q.writers)) != NULL) {
+		desc = (struct k_pipe_desc *)thread->base.swap_data;
+		bytes_copied = pipe_buffer_put(pipe, desc->buffer,
+						desc->bytes_to_xfer);
+
+		desc->buffer        += bytes_copied;
+		desc->bytes_to_xfer -= bytes_copied;
+
+		if (desc->bytes_to_xfer != 0) {
+			break;
+		}
+
+		_unpend_thread(thread);
+		sys_dlist_append(&xfer_list, &thread->base.qnode_dlist);
+	}
+
+	pipe_xfer_finish(pipe, key, &xfer_list);
+}
+
+/**
+ * @brief Copy between a scatter-gather list and a contiguous area
+ *
+ * Moves the cursor (@a idx, @a offset) into @a vec past the bytes copied.
+ *
+ * @return N/A
+ */
+static void pipe_vec_xfer(const struct k_pipe_vec *vec, int *idx,
+			  size_t *offset, unsigned char *area, size_t bytes,
+			  bool to_vec)
+{
+	unsigned char *data;
+	size_t chunk;
+
+	while (bytes != 0) {
+		chunk = min(bytes, vec[*idx].len - *offset);
+		data = (unsigned char *)vec[*idx].data + *offset;
+
+		if (to_vec) {
+			(void)memcpy(data, area, chunk);
+		} else {
+			(void)memcpy(area, data, chunk);
+		}
+
+		area    += chunk;
+		bytes   -= chunk;
+		*offset += chunk;
+		if (*offset == vec[*idx].len) {
+			(*idx)++;
+			*offset = 0;
+		}
+	}
+}
+
+static size_t pipe_vec_len(const struct k_pipe_vec *vec, int count)
+{
+	size_t len = 0;
+
+	for (int i = 0; i < count; i++) {
+		len += vec[i].len;
+	}
+
+	return len;
+}
+
+int k_pipe_put_sg(struct k_pipe *pipe, const struct k_pipe_vec *vec,
+		  int count, size_t *bytes_written, size_t min_xfer,
+		  s32_t timeout)
+{
+	size_t bytes_to_write = pipe_vec_len(vec, count);
+	size_t num_bytes_written = 0;
+	size_t claimed;
+	size_t offset = 0;
+	u32_t start = k_uptime_get_32();
+	void *space;
+	int idx = 0;
+
+	__ASSERT(min_xfer <= bytes_to_write, "");
+	__ASSERT(bytes_written != NULL, "");
+
+	if (timeout == K_NO_WAIT) {
+		k_spinlock_key_t key = k_spin_lock(&pipe->lock);
+		size_t space_left = pipe->size - pipe->bytes_used;
+
+		k_spin_unlock(&pipe->lock, key);
+
+		if (space_left < min_xfer) {
+			*bytes_written = 0;
+			return -EIO;
+		}
+	}
+
+	while (num_bytes_written < bytes_to_write) {
+		if (k_pipe_put_claim(pipe, &space,
+				     bytes_to_write - num_bytes_written,
+				     &claimed,
+				     pipe_timeout_left(timeout, start)) != 0) {
+			break;
+		}
+
+		pipe_vec_xfer(vec, &idx, &offset, space, claimed, false);
+		k_pipe_put_commit(pipe, claimed);
+
+		num_bytes_written += claimed;
+	}
+
+	*bytes_written = num_bytes_written;
+
+	if (num_bytes_written >= min_xfer) {
+		return 0;
+	}
+
+	return (timeout == K_NO_WAIT) ? -EIO : -EAGAIN;
+}
+
+int k_pipe_get_sg(struct k_pipe *pipe, const struct k_pipe_vec *vec,
+		  int count, size_t *bytes_read, size_t min_xfer,
+		  s32_t timeout)
+{
+	size_t bytes_to_read = pipe_vec_len(vec, count);
+	size_t num_bytes_read = 0;
+	size_t claimed;
+	size_t offset = 0;
+	u32_t start = k_uptime_get_32();
+	void *data;
+	int idx = 0;
+
+	__ASSERT(min_xfer <= bytes_to_read, "");
+	__ASSERT(bytes_read != NULL, "");
+
+	if (timeout == K_NO_WAIT) {
+		k_spinlock_key_t key = k_spin_lock(&pipe->lock);
+		size_t data_left = pipe->bytes_used;
+
+		k_spin_unlock(&pipe->lock, key);
+
+		if (data_left < min_xfer) {
+			*bytes_read = 0;
+			return -EIO;
+		}
+	}
+
+	while (num_bytes_read < bytes_to_read) {
+		if (k_pipe_get_claim(pipe, &data,
+				     bytes_to_read - num_bytes_read,
+				     &claimed,
+				     pipe_timeout_left(timeout, start)) != 0) {
+			break;
+		}
+
+		pipe_vec_xfer(vec, &idx, &offset, data, claimed, true);
+		k_pipe_get_commit(pipe, claimed);
+
+		num_bytes_read += claimed;
+	}
+
+	*bytes_read = num_bytes_read;
+
+	if (num_bytes_read >= min_xfer) {
+		return 0;
+	}
+
+	return (timeout == K_NO_WAIT) ? -EIO : -EAGAIN;
+}
@@ -25,6 +25,16 @@
 #include <misc/util.h>
 #include <misc/__assert.h>
 
+/* Single subsystem lock.  Locking per-event would be better on highly
+ * contended SMP systems, but the original locking scheme here is
+ * subtle (it relies on releasing/reacquiring the lock in areas for
+ * latency control and it's sometimes hard to see exactly what data is
+ * "inside" a given critical section).  Do the synchronization port
+ * later as an optimization.  Kernel objects signal their poll events
+ * with their own lock held, so this one nests inside those.
+ */
+static struct k_spinlock lock;
+
 void k_poll_event_init(struct k_poll_event *event, u32_t type,
 		       int mode, void *obj)
 {
@@ -42,7 +52,7 @@ void k_poll_event_init(struct k_poll_event *event, u32_t type,
 	event->obj = obj;
 }
 
-/* must be called with interrupts locked */
+/* must be called with the poll lock held */
 static inline int is_condition_met(struct k_poll_event *event, u32_t *state)
 {
 	switch (event->type) {
@@ -57,6 +67,15 @@ static inline int is_condition_met(struct k_poll_event *event, u32_t *state)
 			*state = K_POLL_STATE_FIFO_DATA_AVAILABLE;
 			return 1;
 		}
+#ifdef CONFIG_QUEUE_LOCKLESS_APPEND
+		/* force the next append through the locked path, which is
+		 * the one that signals poll events
+		 */
+		if (!z_queue_inbox_close(event->queue)) {
+			*state = K_POLL_STATE_FIFO_DATA_AVAILABLE;
+			return 1;
+		}
+#endif
 		break;
 	case K_POLL_TYPE_SIGNAL:
 		if (event->signal->signaled) {
@@ -74,6 +93,40 @@ static inline int is_condition_met(struct k_poll_event *event, u32_t *state)
 	return 0;
 }
 
+#ifdef CONFIG_QUEUE_LOCKLESS_APPEND
+/* Reopens the lock-free inbox of @a queue unless an event is registered
+ * on it. Called with the queue lock held.
+ */
+void z_poll_queue_inbox_reopen(struct k_queue *queue)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	if (sys_dlist_is_empty(&queue->poll_events)) {
+		(void)atomic_cas(&queue->inbox, _K_QUEUE_INBOX_CLOSED, 0);
+	}
+
+	k_spin_unlock(&lock, key);
+}
+#endif
+
+/* Poll sets have no thread of their own: they are notified after the
+ * threads in k_poll() on the same object.
+ */
+static inline bool is_set_poller(struct _poller *poller)
+{
+	return poller->thread == NULL;
+}
+
+static inline bool is_p1_higher_prio_than_p2(struct _poller *p1,
+					     struct _poller *p2)
+{
+	if (is_set_poller(p1) || is_set_poller(p2)) {
+		return !is_set_poller(p1) && is_set_poller(p2);
+	}
+
+	return _is_t1_higher_prio_than_t2(p1->thread, p2->thread);
+}
+
 static inline void add_event(sys_dlist_t *events, struct k_poll_event *event,
 			     struct _poller *poller)
 {
@@ -81,15 +134,13 @@ static inline void add_event(sys_dlist_t *events, struct k_poll_event *event,
 
 	pending = (struct k_poll_event *)sys_dlist_peek_tail(events);
 	if ((pending == NULL) ||
-		_is_t1_higher_prio_than_t2(pending->poller->thread,
-		poller->thread)) {
+		!is_p1_higher_prio_than_p2(poller, pending->poller)) {
 		sys_dlist_append(events, &event->_node);
 		return;
 	}
 
 	SYS_DLIST_FOR_EACH_CONTAINER(events, pending, _node) {
-		if (_is_t1_higher_prio_than_t2(poller->thread,
-					       pending->poller->thread)) {
+		if (is_p1_higher_prio_than_p2(poller, pending->poller)) {
 			sys_dlist_insert_before(events, &pending->_node,
 						&event->_node);
 			return;
@@ -99,7 +150,7 @@ static inline void add_event(sys_dlist_t *events, struct k_poll_event *event,
 	sys_dlist_append(events, &event->_node);
 }
 
-/* must be called with interrupts locked */
+/* must be called with the poll lock held */
 static inline int register_event(struct k_poll_event *event,
 				 struct _poller *poller)
 {
@@ -129,7 +180,7 @@ static inline int register_event(struct k_poll_event *event,
 	return 0;
 }
 
-/* must be called with interrupts locked */
+/* must be called with the poll lock held */
 static inline void clear_event_registration(struct k_poll_event *event)
 {
 	event->poller = NULL;
@@ -156,15 +207,15 @@ static inline void clear_event_registration(struct k_poll_event *event)
 	}
 }
 
-/* must be called with interrupts locked */
+/* must be called with the poll lock held */
 static inline void clear_event_registrations(struct k_poll_event *events,
 					      int last_registered,
-					      unsigned int key)
+					      k_spinlock_key_t key)
 {
 	for (; last_registered >= 0; last_registered--) {
 		clear_event_registration(&events[last_registered]);
-		irq_unlock(key);
-		key = irq_lock();
+		k_spin_unlock(&lock, key);
+		key = k_spin_lock(&lock);
 	}
 }
 
@@ -181,7 +232,7 @@ int _impl_k_poll(struct k_poll_event *events, int num_events, s32_t timeout)
 	__ASSERT(num_events > 0, "zero events\n");
 
 	int last_registered = -1, rc;
-	unsigned int key;
+	k_spinlock_key_t key;
 
 	struct _poller poller = { .thread = _current, .is_polling = 1, };
 
@@ -189,7 +240,7 @@ int _impl_k_poll(struct k_poll_event *events, int num_events, s32_t timeout)
 	for (int ii = 0; ii < num_events; ii++) {
 		u32_t state;
 
-		key = irq_lock();
+		key = k_spin_lock(&lock);
 		if (is_condition_met(&events[ii], &state)) {
 			set_event_ready(&events[ii], state);
 			poller.is_polling = 0;
@@ -201,10 +252,10 @@ int _impl_k_poll(struct k_poll_event *events, int num_events, s32_t timeout)
 				__ASSERT(false, "unexpected return code\n");
 			}
 		}
-		irq_unlock(key);
+		k_spin_unlock(&lock, key);
 	}
 
-	key = irq_lock();
+	key = k_spin_lock(&lock);
 
 	/*
 	 * If we're not polling anymore, it means that at least one event
@@ -213,20 +264,20 @@ int _impl_k_poll(struct k_poll_event *events, int num_events, s32_t timeout)
 	 */
 	if (!poller.is_polling) {
 		clear_event_registrations(events, last_registered, key);
-		irq_unlock(key);
+		k_spin_unlock(&lock, key);
 		return 0;
 	}
 
 	poller.is_polling = 0;
 
 	if (timeout == K_NO_WAIT) {
-		irq_unlock(key);
+		k_spin_unlock(&lock, key);
 		return -EAGAIN;
 	}
 
 	_wait_q_t wait_q = _WAIT_Q_INIT(&wait_q);
 
-	int swap_rc = _pend_current_thread(key, &wait_q, timeout);
+	int swap_rc = _pend_curr(&lock, key, &wait_q, timeout);
 
 	/*
 	 * Clear all event registrations. If events happen while we're in this
@@ -237,17 +288,199 @@ int _impl_k_poll(struct k_poll_event *events, int num_events, s32_t timeout)
 	 * added to the list of events that occurred, the user has to check the
 	 * return code first, which invalidates the whole list of event states.
 	 */
-	key = irq_lock();
+	key = k_spin_lock(&lock);
 	clear_event_registrations(events, last_registered, key);
-	irq_unlock(key);
+	k_spin_unlock(&lock, key);
 
 	return swap_rc;
 }
 
+/*
+ * An event added to a poll set is always on exactly one list, through
+ * its _node: the poll events of its object while armed, the set's ready
+ * list once signaled, and the set's returned list once handed out by
+ * k_poll_set_wait(), until the next call re-arms it.  Its poller stays
+ * the set's, so it can be told apart from k_poll() events.
+ */
+
+/* must be called with the poll lock held */
+static bool wake_set_waiter(struct k_poll_set *set)
+{
+	struct k_thread *thread = _unpend_first_thread(&set->wait_q);
+
+	if (thread == NULL) {
+		return false;
+	}
+
+	_set_thread_return_value(thread, 0);
+	_ready_thread(thread);
+	return true;
+}
+
+/* must be called with the poll lock held */
+static void signal_set_event(struct k_poll_event *event, u32_t state)
+{
+	struct k_poll_set *set = CONTAINER_OF(event->poller,
+					      struct k_poll_set, poller);
+
+	event->state |= state;
+	sys_dlist_append(&set->ready, &event->_node);
+	(void)wake_set_waiter(set);
+}
+
+/* must be called with the poll lock held */
+static void arm_set_event(struct k_poll_set *set, struct k_poll_event *event)
+{
+	u32_t state;
+
+	event->state = K_POLL_STATE_NOT_READY;
+	if (is_condition_met(event, &state)) {
+		event->state = state;
+		sys_dlist_append(&set->ready, &event->_node);
+	} else {
+		(void)register_event(event, &set->poller);
+	}
+}
+
+void k_poll_set_init(struct k_poll_set *set)
+{
+	set->poller.thread = NULL;
+	set->poller.is_polling = 0;
+	_waitq_init(&set->wait_q);
+	sys_dlist_init(&set->ready);
+	sys_dlist_init(&set->returned);
+}
+
+int k_poll_set_add(struct k_poll_set *set, struct k_poll_event *event)
+{
+	k_spinlock_key_t key;
+
+	if (event->type == K_POLL_TYPE_IGNORE) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&lock);
+
+	if (event->poller != NULL) {
+		k_spin_unlock(&lock, key);
+		return -EBUSY;
+	}
+
+	event->poller = &set->poller;
+	arm_set_event(set, event);
+
+	if (!sys_dlist_is_empty(&set->ready) && wake_set_waiter(set)) {
+		_reschedule(&lock, key);
+		return 0;
+	}
+
+	k_spin_unlock(&lock, key);
+	return 0;
+}
+
+int k_poll_set_remove(struct k_poll_set *set, struct k_poll_event *event)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	if (event->poller != &set->poller) {
+		k_spin_unlock(&lock, key);
+		return -EINVAL;
+	}
+
+	sys_dlist_remove(&event->_node);
+	event->poller = NULL;
+
+	k_spin_unlock(&lock, key);
+	return 0;
+}
+
+/* must be called with the poll lock held */
+static int take_set_events(struct k_poll_set *set, struct k_poll_event **events,
+			   int max_events)
+{
+	struct k_poll_event *event;
+	sys_dnode_t *node;
+	u32_t state;
+	int num = 0;
+
+	while (num < max_events &&
+	       (node = sys_dlist_get(&set->ready)) != NULL) {
+		event = CONTAINER_OF(node, struct k_poll_event, _node);
+
+		/* All the sets on an object are signaled, so the condition
+		 * may be gone already: another thread got there first.
+		 */
+		if ((event->state & K_POLL_STATE_CANCELLED) == 0 &&
+		    !is_condition_met(event, &state)) {
+			event->state = K_POLL_STATE_NOT_READY;
+			(void)register_event(event, &set->poller);
+			continue;
+		}
+
+		events[num++] = event;
+		sys_dlist_append(&set->returned, node);
+	}
+
+	return num;
+}
+
+int k_poll_set_wait(struct k_poll_set *set, struct k_poll_event **events,
+		    int max_events, s32_t timeout)
+{
+	__ASSERT(!_is_in_isr(), "");
+	__ASSERT(max_events > 0, "zero events\n");
+
+	u32_t start = timeout != K_FOREVER ? k_uptime_get_32() : 0;
+	k_spinlock_key_t key = k_spin_lock(&lock);
+	s32_t left = timeout;
+	sys_dnode_t *node;
+	int num, rc;
+
+	/* level triggered: what was handed out last time is checked again */
+	while ((node = sys_dlist_get(&set->returned)) != NULL) {
+		arm_set_event(set, CONTAINER_OF(node, struct k_poll_event,
+						_node));
+	}
+
+	/* A thread woken along with another one can find nothing left, in
+	 * which case it waits again for whatever time remains.
+	 */
+	while ((num = take_set_events(set, events, max_events)) == 0) {
+		if (left == K_NO_WAIT) {
+			k_spin_unlock(&lock, key);
+			return -EAGAIN;
+		}
+
+		rc = _pend_curr(&lock, key, &set->wait_q, left);
+		if (rc != 0) {
+			return rc;
+		}
+
+		if (timeout != K_FOREVER) {
+			u32_t elapsed = k_uptime_get_32() - start;
+
+			left = elapsed < (u32_t)timeout ? timeout - elapsed :
+						       K_NO_WAIT;
+		}
+
+		key = k_spin_lock(&lock);
+	}
+
+	/* another thread waiting on the set takes what is left */
+	if (!sys_dlist_is_empty(&set->ready) && wake_set_waiter(set)) {
+		_reschedule(&lock, key);
+		return num;
+	}
+
+	k_spin_unlock(&lock, key);
+	return num;
+}
+
 #ifdef CONFIG_USERSPACE
 Z_SYSCALL_HANDLER(k_poll, events, num_events, timeout)
 {
-	int ret, key;
+	int ret;
+	k_spinlock_key_t key;
 	struct k_poll_event *events_copy = NULL;
 	unsigned int bounds;
 
@@ -272,13 +505,13 @@ Z_SYSCALL_HANDLER(k_poll, events, num_events, timeout)
 		goto out;
 	}
 
-	key = irq_lock();
+	key = k_spin_lock(&lock);
 	if (Z_SYSCALL_MEMORY_WRITE(events, bounds)) {
-		irq_unlock(key);
+		k_spin_unlock(&lock, key);
 		goto oops_free;
 	}
 	(void)memcpy(events_copy, (void *)events, bounds);
-	irq_unlock(key);
+	k_spin_unlock(&lock, key);
 
 	/* Validate what's inside events_copy */
 	for (int i = 0; i < num_events; i++) {
@@ -319,13 +552,18 @@ oops_free:
 }
 #endif
 
-/* must be called with interrupts locked */
+/* must be called with the poll lock held */
 static int signal_poll_event(struct k_poll_event *event, u32_t state)
 {
 	if (!event->poller) {
 		goto ready_event;
 	}
 
+	if (is_set_poller(event->poller)) {
+		signal_set_event(event, state);
+		return 0;
+	}
+
 	struct k_thread *thread = event->poller->thread;
 
 	__ASSERT(event->poller->thread != NULL,
@@ -356,14 +594,38 @@ ready_event:
 	return 0;
 }
 
-void _handle_obj_poll_events(sys_dlist_t *events, u32_t state)
+/* must be called with the poll lock held */
+static int signal_poll_events(sys_dlist_t *events, u32_t state)
 {
-	struct k_poll_event *poll_event;
+	struct k_poll_event *poll_event, *next;
+	int rc = 0;
 
 	poll_event = (struct k_poll_event *)sys_dlist_get(events);
 	if (poll_event != NULL) {
-		(void) signal_poll_event(poll_event, state);
+		rc = signal_poll_event(poll_event, state);
 	}
+
+	/* Only the first thread in k_poll() is woken, but every poll set
+	 * is signaled: one that nobody waits on at the moment would
+	 * otherwise keep the signal from one that somebody does.
+	 */
+	SYS_DLIST_FOR_EACH_CONTAINER_SAFE(events, poll_event, next, _node) {
+		if (is_set_poller(poll_event->poller)) {
+			sys_dlist_remove(&poll_event->_node);
+			signal_set_event(poll_event, state);
+		}
+	}
+
+	return rc;
+}
+
+void _handle_obj_poll_events(sys_dlist_t *events, u32_t state)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	(void)signal_poll_events(events, state);
+
+	k_spin_unlock(&lock, key);
 }
 
 void _impl_k_poll_signal_init(struct k_poll_signal *signal)
@@ -405,21 +667,20 @@ Z_SYSCALL_HANDLER(k_poll_signal_check, signal, signaled, result)
 
 int _impl_k_poll_signal_raise(struct k_poll_signal *signal, int result)
 {
-	unsigned int key = irq_lock();
-	struct k_poll_event *poll_event;
+	k_spinlock_key_t key = k_spin_lock(&lock);
 
 	signal->result = result;
 	signal->signaled = 1;
 
-	poll_event = (struct k_poll_event *)sys_dlist_get(&signal->poll_events);
-	if (poll_event == NULL) {
-		irq_unlock(key);
+	if (sys_dlist_is_empty(&signal->poll_events)) {
+		k_spin_unlock(&lock, key);
 		return 0;
 	}
 
-	int rc = signal_poll_event(poll_event, K_POLL_STATE_SIGNALED);
+	int rc = signal_poll_events(&signal->poll_events,
+				    K_POLL_STATE_SIGNALED);
 
-	_reschedule(key);
+	_reschedule(&lock, key);
 	return rc;
 }
 
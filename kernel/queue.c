@@ -58,6 +58,101 @@ void *z_queue_node_peek(sys_sfnode_t *node, bool needs_free)
 	return ret;
 }
 
+#ifdef CONFIG_QUEUE_LOCKLESS_APPEND
+
+/*
+ * Lock-free appends go to queue->inbox, a LIFO of nodes linked through
+ * their sfnode word, with _K_QUEUE_INBOX_CLOSED in the low bit of the
+ * head pointer.  Producers push with a CAS as long as the bit is clear.
+ * Anything holding the queue lock first moves the inbox, reversed, to
+ * the tail of data_q, so items keep the order they were appended in.
+ *
+ * The bit is set, only ever from an empty inbox, before a thread pends
+ * on the queue or k_poll() registers on it, so that the next append
+ * takes the locked path and wakes it.  It is cleared by the locked path
+ * once nobody is waiting any more.
+ */
+BUILD_ASSERT_MSG(sizeof(atomic_t) == sizeof(void *),
+		 "inbox pointers must fit in an atomic_t");
+
+/* must be called with the queue lock held */
+static void inbox_flush(struct k_queue *queue)
+{
+	atomic_val_t head = atomic_get(&queue->inbox);
+	sys_sfnode_t *node, *next, *prev = NULL;
+
+	if ((head & ~_K_QUEUE_INBOX_CLOSED) == 0) {
+		return;
+	}
+
+	/* producers can't close a non-empty inbox, and only lock holders
+	 * empty it, so nobody else can have changed the closed bit
+	 */
+	node = (sys_sfnode_t *)atomic_set(&queue->inbox, 0);
+
+	while (node != NULL) {
+		next = z_sfnode_next_peek(node);
+		z_sfnode_next_set(node, prev);
+		prev = node;
+		node = next;
+	}
+
+	for (node = prev; node != NULL; node = next) {
+		next = z_sfnode_next_peek(node);
+		sys_sfnode_init(node, sys_sfnode_flags_get(node));
+		sys_sflist_append(&queue->data_q, node);
+	}
+}
+
+static bool inbox_push(struct k_queue *queue, sys_sfnode_t *node, u8_t flags)
+{
+	atomic_val_t head;
+
+	do {
+		head = atomic_get(&queue->inbox);
+		if ((head & _K_QUEUE_INBOX_CLOSED) != 0) {
+			return false;
+		}
+		node->next_and_flags = (unative_t)head | flags;
+	} while (atomic_cas(&queue->inbox, head, (atomic_val_t)node) == 0);
+
+	return true;
+}
+
+/* must be called with the queue lock held */
+static void inbox_reopen(struct k_queue *queue)
+{
+#if defined(CONFIG_POLL)
+	/* poll events are registered under the poll lock, not this one */
+	z_poll_queue_inbox_reopen(queue);
+#else
+	if (_waitq_head(&queue->wait_q) == NULL) {
+		(void)atomic_cas(&queue->inbox, _K_QUEUE_INBOX_CLOSED, 0);
+	}
+#endif
+}
+
+void z_queue_inbox_flush(struct k_queue *queue)
+{
+	k_spinlock_key_t key = k_spin_lock(&queue->lock);
+
+	inbox_flush(queue);
+	k_spin_unlock(&queue->lock, key);
+}
+
+bool z_queue_inbox_close(struct k_queue *queue)
+{
+	return atomic_cas(&queue->inbox, 0, _K_QUEUE_INBOX_CLOSED) != 0 ||
+	       atomic_get(&queue->inbox) == _K_QUEUE_INBOX_CLOSED;
+}
+
+#else
+
+#define inbox_flush(queue) do { } while (false)
+#define inbox_reopen(queue) do { } while (false)
+
+#endif /* CONFIG_QUEUE_LOCKLESS_APPEND */
+
 #ifdef CONFIG_OBJECT_TRACING
 
 struct k_queue *_trace_list_k_queue;
@@ -84,6 +179,10 @@ SYS_INIT(init_queue_module, PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_OBJECTS);
 void _impl_k_queue_init(struct k_queue *queue)
 {
 	sys_sflist_init(&queue->data_q);
+	queue->lock = (struct k_spinlock) {};
+#ifdef CONFIG_QUEUE_LOCKLESS_APPEND
+	atomic_set(&queue->inbox, 0);
+#endif
 	_waitq_init(&queue->wait_q);
 #if defined(CONFIG_POLL)
 	sys_dlist_init(&queue->poll_events);
@@ -121,7 +220,7 @@ static inline void handle_poll_events(struct k_queue *queue, u32_t state)
 
 void _impl_k_queue_cancel_wait(struct k_queue *queue)
 {
-	u32_t key = irq_lock();
+	k_spinlock_key_t key = k_spin_lock(&queue->lock);
 #if !defined(CONFIG_POLL)
 	struct k_thread *first_pending_thread;
 
@@ -133,8 +232,9 @@ void _impl_k_queue_cancel_wait(struct k_queue *queue)
 #else
 	handle_poll_events(queue, K_POLL_STATE_CANCELLED);
 #endif /* !CONFIG_POLL */
+	inbox_reopen(queue);
 
-	_reschedule(key);
+	_reschedule(&queue->lock, key);
 }
 
 #ifdef CONFIG_USERSPACE
@@ -143,9 +243,15 @@ Z_SYSCALL_HANDLER1_SIMPLE_VOID(k_queue_cancel_wait, K_OBJ_QUEUE,
 #endif
 
 static s32_t queue_insert(struct k_queue *queue, void *prev, void *data,
-			  bool alloc)
+			  bool alloc, bool is_append)
 {
-	u32_t key = irq_lock();
+	k_spinlock_key_t key = k_spin_lock(&queue->lock);
+
+	inbox_flush(queue);
+
+	if (is_append) {
+		prev = sys_sflist_peek_tail(&queue->data_q);
+	}
 #if !defined(CONFIG_POLL)
 	struct k_thread *first_pending_thread;
 
@@ -153,7 +259,8 @@ static s32_t queue_insert(struct k_queue *queue, void *prev, void *data,
 
 	if (first_pending_thread != NULL) {
 		prepare_thread_to_run(first_pending_thread, data);
-		_reschedule(key);
+		inbox_reopen(queue);
+		_reschedule(&queue->lock, key);
 		return 0;
 	}
 #endif /* !CONFIG_POLL */
@@ -164,6 +271,7 @@ static s32_t queue_insert(struct k_queue *queue, void *prev, void *data,
 
 		anode = z_thread_malloc(sizeof(*anode));
 		if (anode == NULL) {
+			k_spin_unlock(&queue->lock, key);
 			return -ENOMEM;
 		}
 		anode->data = data;
@@ -177,31 +285,90 @@ static s32_t queue_insert(struct k_queue *queue, void *prev, void *data,
 #if defined(CONFIG_POLL)
 	handle_poll_events(queue, K_POLL_STATE_DATA_AVAILABLE);
 #endif /* CONFIG_POLL */
+	inbox_reopen(queue);
 
-	_reschedule(key);
+	_reschedule(&queue->lock, key);
 	return 0;
 }
 
+static s32_t queue_append(struct k_queue *queue, void *data, bool alloc)
+{
+#ifdef CONFIG_QUEUE_LOCKLESS_APPEND
+	if ((atomic_get(&queue->inbox) & _K_QUEUE_INBOX_CLOSED) == 0) {
+		struct alloc_node *anode = NULL;
+		sys_sfnode_t *node = data;
+
+		if (alloc) {
+			anode = z_thread_malloc(sizeof(*anode));
+			if (anode == NULL) {
+				return -ENOMEM;
+			}
+			anode->data = data;
+			node = &anode->node;
+		}
+
+		if (inbox_push(queue, node, alloc ? 0x1 : 0x0)) {
+			return 0;
+		}
+
+		/* a thread started waiting meanwhile, hand it over directly */
+		k_free(anode);
+	}
+#endif /* CONFIG_QUEUE_LOCKLESS_APPEND */
+
+	return queue_insert(queue, NULL, data, alloc, true);
+}
+
+bool k_queue_remove(struct k_queue *queue, void *data)
+{
+	k_spinlock_key_t key = k_spin_lock(&queue->lock);
+	bool removed;
+
+	/* the item may still be in the lock-free inbox */
+	inbox_flush(queue);
+	removed = sys_sflist_find_and_remove(&queue->data_q,
+					     (sys_sfnode_t *)data);
+	k_spin_unlock(&queue->lock, key);
+
+	return removed;
+}
+
+bool k_queue_unique_append(struct k_queue *queue, void *data)
+{
+	k_spinlock_key_t key = k_spin_lock(&queue->lock);
+	sys_sfnode_t *test;
+
+	inbox_flush(queue);
+	SYS_SFLIST_FOR_EACH_NODE(&queue->data_q, test) {
+		if (test == (sys_sfnode_t *)data) {
+			k_spin_unlock(&queue->lock, key);
+			return false;
+		}
+	}
+	k_spin_unlock(&queue->lock, key);
+
+	k_queue_append(queue, data);
+	return true;
+}
+
 void k_queue_insert(struct k_queue *queue, void *prev, void *data)
 {
-	(void)queue_insert(queue, prev, data, false);
+	(void)queue_insert(queue, prev, data, false, false);
 }
 
 void k_queue_append(struct k_queue *queue, void *data)
 {
-	(void)queue_insert(queue, sys_sflist_peek_tail(&queue->data_q),
-			   data, false);
+	(void)queue_append(queue, data, false);
 }
 
 void k_queue_prepend(struct k_queue *queue, void *data)
 {
-	(void)queue_insert(queue, NULL, data, false);
+	(void)queue_insert(queue, NULL, data, false, false);
 }
 
 s32_t _impl_k_queue_alloc_append(struct k_queue *queue, void *data)
 {
-	return queue_insert(queue, sys_sflist_peek_tail(&queue->data_q), data,
-			    true);
+	return queue_append(queue, data, true);
 }
 
 #ifdef CONFIG_USERSPACE
@@ -216,7 +383,7 @@ Z_SYSCALL_HANDLER(k_queue_alloc_append, queue, data)
 
 s32_t _impl_k_queue_alloc_prepend(struct k_queue *queue, void *data)
 {
-	return queue_insert(queue, NULL, data, true);
+	return queue_insert(queue, NULL, data, true, false);
 }
 
 #ifdef CONFIG_USERSPACE
@@ -233,7 +400,9 @@ void k_queue_append_list(struct k_queue *queue, void *head, void *tail)
 {
 	__ASSERT(head && tail, "invalid head or tail");
 
-	unsigned int key = irq_lock();
+	k_spinlock_key_t key = k_spin_lock(&queue->lock);
+
+	inbox_flush(queue);
 #if !defined(CONFIG_POLL)
 	struct k_thread *thread;
 
@@ -251,8 +420,43 @@ void k_queue_append_list(struct k_queue *queue, void *head, void *tail)
 	sys_sflist_append_list(&queue->data_q, head, tail);
 	handle_poll_events(queue, K_POLL_STATE_DATA_AVAILABLE);
 #endif /* !CONFIG_POLL */
+	inbox_reopen(queue);
 
-	_reschedule(key);
+	_reschedule(&queue->lock, key);
+}
+
+void k_queue_prepend_list(struct k_queue *queue, void *head, void *tail)
+{
+	__ASSERT(head && tail, "invalid head or tail");
+
+	k_spinlock_key_t key = k_spin_lock(&queue->lock);
+	void *node, *next;
+
+	inbox_flush(queue);
+#if !defined(CONFIG_POLL)
+	struct k_thread *thread;
+
+	/* waiting threads get the first items, as with successive prepends */
+	while ((head != NULL) &&
+		(thread = _unpend_first_thread(&queue->wait_q))) {
+		prepare_thread_to_run(thread, head);
+		head = (head == tail) ? NULL : *(void **)head;
+	}
+#endif /* !CONFIG_POLL */
+
+	/* prepending the others in turn leaves the last one at the head */
+	for (node = head; node != NULL; node = next) {
+		next = (node == tail) ? NULL : *(void **)node;
+		sys_sfnode_init(node, 0x0);
+		sys_sflist_prepend(&queue->data_q, node);
+	}
+
+#if defined(CONFIG_POLL)
+	handle_poll_events(queue, K_POLL_STATE_DATA_AVAILABLE);
+#endif /* CONFIG_POLL */
+	inbox_reopen(queue);
+
+	_reschedule(&queue->lock, key);
 }
 
 void k_queue_merge_slist(struct k_queue *queue, sys_slist_t *list)
@@ -277,7 +481,7 @@ static void *k_queue_poll(struct k_queue *queue, s32_t timeout)
 {
 	struct k_poll_event event;
 	int err, elapsed = 0, done = 0;
-	unsigned int key;
+	k_spinlock_key_t key;
 	void *val;
 	u32_t start;
 
@@ -298,11 +502,12 @@ static void *k_queue_poll(struct k_queue *queue, s32_t timeout)
 		}
 
 		/* sys_sflist_* aren't threadsafe, so must be always protected
-		 * by irq_lock.
+		 * by the queue lock.
 		 */
-		key = irq_lock();
+		key = k_spin_lock(&queue->lock);
+		inbox_flush(queue);
 		val = z_queue_node_peek(sys_sflist_get(&queue->data_q), true);
-		irq_unlock(key);
+		k_spin_unlock(&queue->lock, key);
 
 		if ((val == NULL) && (timeout != K_FOREVER)) {
 			elapsed = k_uptime_get_32() - start;
@@ -316,32 +521,43 @@ static void *k_queue_poll(struct k_queue *queue, s32_t timeout)
 
 void *_impl_k_queue_get(struct k_queue *queue, s32_t timeout)
 {
-	unsigned int key;
+	k_spinlock_key_t key;
 	void *data;
 
-	key = irq_lock();
+	key = k_spin_lock(&queue->lock);
+	inbox_flush(queue);
 
 	if (likely(!sys_sflist_is_empty(&queue->data_q))) {
 		sys_sfnode_t *node;
 
 		node = sys_sflist_get_not_empty(&queue->data_q);
 		data = z_queue_node_peek(node, true);
-		irq_unlock(key);
+		k_spin_unlock(&queue->lock, key);
 		return data;
 	}
 
 	if (timeout == K_NO_WAIT) {
-		irq_unlock(key);
+		k_spin_unlock(&queue->lock, key);
 		return NULL;
 	}
 
 #if defined(CONFIG_POLL)
-	irq_unlock(key);
+	k_spin_unlock(&queue->lock, key);
 
 	return k_queue_poll(queue, timeout);
 
 #else
-	int ret = _pend_current_thread(key, &queue->wait_q, timeout);
+#ifdef CONFIG_QUEUE_LOCKLESS_APPEND
+	if (!z_queue_inbox_close(queue)) {
+		/* an append slipped in after the flush */
+		inbox_flush(queue);
+		data = z_queue_node_peek(sys_sflist_get_not_empty(
+						 &queue->data_q), true);
+		k_spin_unlock(&queue->lock, key);
+		return data;
+	}
+#endif
+	int ret = _pend_curr(&queue->lock, key, &queue->wait_q, timeout);
 
 	return (ret != 0) ? NULL : _current->base.swap_data;
 #endif /* CONFIG_POLL */
@@ -35,6 +35,10 @@
 #define _priq_wait_add		_priq_dumb_add
 #define _priq_wait_remove	_priq_dumb_remove
 #define _priq_wait_best		_priq_dumb_best
+#elif defined(CONFIG_WAITQ_MULTIQ)
+#define _priq_wait_add		_priq_mq_add
+#define _priq_wait_remove	_priq_mq_remove
+#define _priq_wait_best		_priq_mq_best
 #endif
 
 /* the only struct z_kernel instance */
@@ -142,6 +146,123 @@ static int should_preempt(struct k_thread *th, int preempt_ok)
 	return 0;
 }
 
+#ifdef CONFIG_SCHED_PER_CPU_RUNQ
+# if CONFIG_MP_NUM_CPUS > 8
+# error Too many CPUs for the per-CPU ready queue affinity mask (max 8)
+# endif
+
+static inline int cpu_allowed(struct k_thread *thread, int cpu)
+{
+	return (thread->base.cpu_mask & BIT(cpu)) != 0;
+}
+
+static inline int cpu_is_idle(struct _cpu *cpu)
+{
+	return cpu->current == cpu->idle_thread;
+}
+
+/* Picks the CPU whose queue a newly runnable thread goes on: the one
+ * it last ran on if that CPU is idle, else any idle CPU it may run
+ * on, else the one it last ran on (or the first it may run on).  The
+ * idle checks are unlocked reads of remote CPU state and only a hint.
+ */
+static int select_cpu(struct k_thread *thread)
+{
+	int home = thread->base.cpu;
+	int i;
+
+	__ASSERT(thread->base.cpu_mask != 0, "thread may not run on any CPU");
+
+	if (cpu_allowed(thread, home) && cpu_is_idle(&_kernel.cpus[home])) {
+		return home;
+	}
+
+	for (i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		if (cpu_allowed(thread, i) && cpu_is_idle(&_kernel.cpus[i])) {
+			return i;
+		}
+	}
+
+	if (cpu_allowed(thread, home)) {
+		return home;
+	}
+
+	return find_lsb_set(thread->base.cpu_mask) - 1;
+}
+
+static void runq_add(struct k_thread *thread)
+{
+	struct _ready_q *rq;
+
+	thread->base.cpu = select_cpu(thread);
+	rq = &_kernel.cpus[thread->base.cpu].ready_q;
+
+	_priq_run_add(&rq->runq, thread);
+	rq->count++;
+}
+
+static void runq_remove(struct k_thread *thread)
+{
+	struct _ready_q *rq = &_kernel.cpus[thread->base.cpu].ready_q;
+
+	_priq_run_remove(&rq->runq, thread);
+	rq->count--;
+}
+
+/* Called with the local queue empty: returns the best thread of the
+ * CPU with the most queued threads if it may run here.  The thread
+ * stays queued on its old CPU until next_up() commits to it.
+ */
+static struct k_thread *steal_thread(void)
+{
+	struct _cpu *victim = NULL;
+	struct k_thread *th;
+	int i;
+
+	for (i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		struct _cpu *cpu = &_kernel.cpus[i];
+
+		if (cpu == _current_cpu || cpu->ready_q.count == 0) {
+			continue;
+		}
+
+		if (victim == NULL || cpu->ready_q.count > victim->ready_q.count) {
+			victim = cpu;
+		}
+	}
+
+	if (victim == NULL) {
+		return NULL;
+	}
+
+	th = _priq_run_best(&victim->ready_q.runq);
+
+	return cpu_allowed(th, _current_cpu->id) ? th : NULL;
+}
+
+static struct k_thread *runq_best(void)
+{
+	struct k_thread *th = _priq_run_best(&_current_cpu->ready_q.runq);
+
+	return th ? th : steal_thread();
+}
+#else
+static ALWAYS_INLINE void runq_add(struct k_thread *thread)
+{
+	_priq_run_add(&_kernel.ready_q.runq, thread);
+}
+
+static ALWAYS_INLINE void runq_remove(struct k_thread *thread)
+{
+	_priq_run_remove(&_kernel.ready_q.runq, thread);
+}
+
+static ALWAYS_INLINE struct k_thread *runq_best(void)
+{
+	return _priq_run_best(&_kernel.ready_q.runq);
+}
+#endif
+
 static struct k_thread *next_up(void)
 {
 #ifndef CONFIG_SMP
@@ -151,7 +272,7 @@ static struct k_thread *next_up(void)
 	 * responsible for putting it back in _Swap and ISR return!),
 	 * which makes this choice simple.
 	 */
-	struct k_thread *th = _priq_run_best(&_kernel.ready_q.runq);
+	struct k_thread *th = runq_best();
 
 	return th ? th : _current_cpu->idle_thread;
 #else
@@ -169,7 +290,7 @@ static struct k_thread *next_up(void)
 	int active = !_is_thread_prevented_from_running(_current);
 
 	/* Choose the best thread that is not current */
-	struct k_thread *th = _priq_run_best(&_kernel.ready_q.runq);
+	struct k_thread *th = runq_best();
 	if (th == NULL) {
 		th = _current_cpu->idle_thread;
 	}
@@ -187,13 +308,13 @@ static struct k_thread *next_up(void)
 
 	/* Put _current back into the queue */
 	if (th != _current && active && !_is_idle(_current) && !queued) {
-		_priq_run_add(&_kernel.ready_q.runq, _current);
+		runq_add(_current);
 		_mark_thread_as_queued(_current);
 	}
 
 	/* Take the new _current out of the queue */
 	if (_is_thread_queued(th)) {
-		_priq_run_remove(&_kernel.ready_q.runq, th);
+		runq_remove(th);
 	}
 	_mark_thread_as_not_queued(th);
 
@@ -255,6 +376,109 @@ void z_time_slice(int ticks)
 static void reset_time_slice(void) { /* !CONFIG_TIMESLICING */ }
 #endif
 
+#ifdef CONFIG_SCHED_DEADLINE_CBS
+
+/* Constant bandwidth servers.  Each CPU charges the server thread it
+ * runs for the cycles it ran, from the moment the scheduler picks it
+ * until it picks another thread, and arms a timeout for when its
+ * budget runs out.  Bandwidths are 16.16 fixed point fractions of a
+ * CPU.
+ */
+#define CBS_BW_SHIFT 16
+#define CBS_MAX_BW ((CONFIG_SCHED_DEADLINE_CBS_MAX_UTILIZATION << CBS_BW_SHIFT) \
+		    / 100 * CONFIG_MP_NUM_CPUS)
+
+static struct cbs_cpu {
+	struct k_thread *thread;
+	u32_t start;
+	struct _timeout timeout;
+} cbs_cpus[CONFIG_MP_NUM_CPUS];
+
+static u32_t cbs_total_bw;
+
+static void cbs_exhausted(struct _timeout *to);
+
+static inline bool has_cbs(struct k_thread *thread)
+{
+	return thread->base.cbs.budget != 0;
+}
+
+/* Starts a new job: full budget, deadline one relative deadline away */
+static void cbs_new_job(struct k_thread *thread, u32_t now)
+{
+	thread->base.cbs.left = thread->base.cbs.budget;
+	thread->base.prio_deadline = now + thread->base.cbs.deadline;
+}
+
+/* CBS wakeup rule: keep the current deadline and budget only if the
+ * budget left fits in the time left at the reserved bandwidth
+ */
+static void cbs_wakeup(struct k_thread *thread)
+{
+	u32_t now = k_cycle_get_32();
+	s32_t window = thread->base.prio_deadline - (int)now;
+
+	if (window <= 0 ||
+	    (u64_t)thread->base.cbs.left * thread->base.cbs.deadline >
+	    (u64_t)window * thread->base.cbs.budget) {
+		cbs_new_job(thread, now);
+	}
+}
+
+/* Charges the server thread running on a CPU and stops its budget
+ * timer.  An exhausted budget is replenished, with the deadline
+ * postponed by one period for each replenishment.
+ */
+static void cbs_charge(struct cbs_cpu *cpu)
+{
+	struct k_thread *th = cpu->thread;
+
+	(void)_abort_timeout(&cpu->timeout);
+	cpu->thread = NULL;
+
+	th->base.cbs.left -= k_cycle_get_32() - cpu->start;
+	if (th->base.cbs.left > 0) {
+		return;
+	}
+
+	do {
+		th->base.cbs.left += th->base.cbs.budget;
+		th->base.prio_deadline += th->base.cbs.period;
+	} while (th->base.cbs.left <= 0);
+
+	if (_is_thread_queued(th)) {
+		runq_remove(th);
+		runq_add(th);
+	}
+}
+
+/* Called when the scheduler picks th to run on this CPU */
+static void cbs_switch(struct k_thread *th)
+{
+	struct cbs_cpu *cpu = &cbs_cpus[_current_cpu->id];
+	s32_t cpt = sys_clock_hw_cycles_per_tick();
+
+	if (cpu->thread == th) {
+		return;
+	}
+
+	if (cpu->thread != NULL) {
+		cbs_charge(cpu);
+	}
+
+	if (has_cbs(th)) {
+		cpu->thread = th;
+		cpu->start = k_cycle_get_32();
+		_add_timeout(&cpu->timeout, cbs_exhausted,
+			     max(1, (th->base.cbs.left + cpt - 1) / cpt));
+	}
+}
+
+#else
+static inline void cbs_wakeup(struct k_thread *thread) { }
+static inline void cbs_switch(struct k_thread *th) { }
+#endif /* CONFIG_SCHED_DEADLINE_CBS */
+
 static void update_cache(int preempt_ok)
 {
 #ifndef CONFIG_SMP
@@ -268,6 +492,7 @@ static void update_cache(int preempt_ok)
 	} else {
 		_kernel.ready_q.cache = _current;
 	}
+	cbs_switch(_kernel.ready_q.cache);
 
 #else
 	/* The way this works is that the CPU record keeps its
@@ -283,7 +508,22 @@ static void update_cache(int preempt_ok)
 void _add_thread_to_ready_q(struct k_thread *thread)
 {
 	LOCKED(&sched_lock) {
-		_priq_run_add(&_kernel.ready_q.runq, thread);
+#ifdef CONFIG_SCHED_PER_CPU_RUNQ
+		/* A thread that may run on no CPU would have no queue to go
+		 * on: it is suspended instead, until its mask is fixed and
+		 * it is resumed.  continue leaves the LOCKED block.
+		 */
+		if (thread->base.cpu_mask == 0) {
+			_mark_thread_as_suspended(thread);
+			continue;
+		}
+#endif
+#ifdef CONFIG_SCHED_DEADLINE_CBS
+		if (has_cbs(thread)) {
+			cbs_wakeup(thread);
+		}
+#endif
+		runq_add(thread);
 		_mark_thread_as_queued(thread);
 		update_cache(0);
 	}
@@ -292,8 +532,10 @@ void _add_thread_to_ready_q(struct k_thread *thread)
 void _move_thread_to_end_of_prio_q(struct k_thread *thread)
 {
 	LOCKED(&sched_lock) {
-		_priq_run_remove(&_kernel.ready_q.runq, thread);
-		_priq_run_add(&_kernel.ready_q.runq, thread);
+		if (_is_thread_queued(thread)) {
+			runq_remove(thread);
+		}
+		runq_add(thread);
 		_mark_thread_as_queued(thread);
 		update_cache(thread == _current);
 	}
@@ -303,7 +545,7 @@ void _remove_thread_from_ready_q(struct k_thread *thread)
 {
 	LOCKED(&sched_lock) {
 		if (_is_thread_queued(thread)) {
-			_priq_run_remove(&_kernel.ready_q.runq, thread);
+			runq_remove(thread);
 			_mark_thread_as_not_queued(thread);
 			update_cache(thread == _current);
 		}
@@ -316,8 +558,15 @@ static void pend(struct k_thread *thread, _wait_q_t *wait_q, s32_t timeout)
 	_mark_thread_as_pending(thread);
 
 	if (wait_q != NULL) {
-		thread->base.pended_on = wait_q;
-		_priq_wait_add(&wait_q->waitq, thread);
+		/* Wait queues belong to objects with their own locks,
+		 * but threads also leave them from timeout context, so
+		 * the queue itself is only ever touched under the
+		 * scheduler lock.
+		 */
+		LOCKED(&sched_lock) {
+			thread->base.pended_on = wait_q;
+			_priq_wait_add(&wait_q->waitq, thread);
+		}
 	}
 
 	if (timeout != K_FOREVER) {
@@ -356,14 +605,34 @@ struct k_thread *_find_first_thread_to_unpend(_wait_q_t *wait_q,
 	return ret;
 }
 
+/* must be called with sched_lock held */
+static void unpend_thread_no_timeout(struct k_thread *thread)
+{
+	_priq_wait_remove(&pended_on(thread)->waitq, thread);
+	_mark_thread_as_not_pending(thread);
+	thread->base.pended_on = NULL;
+}
+
 void _unpend_thread_no_timeout(struct k_thread *thread)
 {
 	LOCKED(&sched_lock) {
-		_priq_wait_remove(&pended_on(thread)->waitq, thread);
-		_mark_thread_as_not_pending(thread);
+		unpend_thread_no_timeout(thread);
 	}
+}
 
-	thread->base.pended_on = NULL;
+struct k_thread *_unpend1_no_timeout(_wait_q_t *wait_q)
+{
+	struct k_thread *thread = NULL;
+
+	LOCKED(&sched_lock) {
+		thread = _priq_wait_best(&wait_q->waitq);
+
+		if (thread != NULL) {
+			unpend_thread_no_timeout(thread);
+		}
+	}
+
+	return thread;
 }
 
 #ifdef CONFIG_SYS_CLOCK_EXISTS
@@ -372,18 +641,27 @@ void z_thread_timeout(struct _timeout *to)
 {
 	struct k_thread *th = CONTAINER_OF(to, struct k_thread, base.timeout);
 
-	if (th->base.pended_on != NULL) {
-		_unpend_thread_no_timeout(th);
+	LOCKED(&sched_lock) {
+		if (th->base.pended_on != NULL) {
+			unpend_thread_no_timeout(th);
+		}
 	}
 	_mark_thread_as_started(th);
 	_ready_thread(th);
 }
 #endif
 
-int _pend_current_thread(u32_t key, _wait_q_t *wait_q, s32_t timeout)
+int _pend_curr_irqlock(u32_t key, _wait_q_t *wait_q, s32_t timeout)
 {
 	pend(_current, wait_q, timeout);
-	return _Swap(key);
+	return _Swap_irqlock(key);
+}
+
+int _pend_curr(struct k_spinlock *lock, k_spinlock_key_t key,
+	       _wait_q_t *wait_q, s32_t timeout)
+{
+	pend(_current, wait_q, timeout);
+	return _Swap(lock, key);
 }
 
 struct k_thread *_unpend_first_thread(_wait_q_t *wait_q)
@@ -410,55 +688,80 @@ void _unpend_thread(struct k_thread *thread)
  * priorities on either _current or a pended thread, though, so it's
  * fine for now.
  */
-void _thread_priority_set(struct k_thread *thread, int prio)
+bool _set_prio(struct k_thread *thread, int prio)
 {
 	bool need_sched = 0;
 
 	LOCKED(&sched_lock) {
 		need_sched = _is_thread_ready(thread);
 
-		if (need_sched) {
-			_priq_run_remove(&_kernel.ready_q.runq, thread);
+		if (need_sched && _is_thread_queued(thread)) {
+			runq_remove(thread);
 			thread->base.prio = prio;
-			_priq_run_add(&_kernel.ready_q.runq, thread);
+			runq_add(thread);
 			update_cache(1);
+		} else if (_is_thread_pending(thread) &&
+			   thread->base.pended_on != NULL) {
+			/* keep the wait queue sorted, and the multiq
+			 * backend finds threads by their priority
+			 */
+			_priq_wait_remove(&thread->base.pended_on->waitq,
+					  thread);
+			thread->base.prio = prio;
+			_priq_wait_add(&thread->base.pended_on->waitq, thread);
 		} else {
 			thread->base.prio = prio;
 		}
 	}
 	sys_trace_thread_priority_set(thread);
 
-	if (need_sched) {
-		_reschedule(irq_lock());
+	return need_sched;
+}
+
+void _thread_priority_set(struct k_thread *thread, int prio)
+{
+	if (_set_prio(thread, prio)) {
+		_reschedule_unlocked();
 	}
 }
 
-void _reschedule(u32_t key)
+static inline bool resched(void)
 {
 #ifdef CONFIG_SMP
 	if (!_current_cpu->swap_ok) {
-		goto noswap;
+		return false;
 	}
 
 	_current_cpu->swap_ok = 0;
 #endif
 
 	if (_is_in_isr()) {
-		goto noswap;
+		return false;
 	}
 
 #ifdef CONFIG_SMP
-	(void)_Swap(key);
-	return;
+	return true;
 #else
-	if (_get_next_ready_thread() != _current) {
-		(void)_Swap(key);
-		return;
-	}
+	return _get_next_ready_thread() != _current;
 #endif
+}
 
- noswap:
-	irq_unlock(key);
+void _reschedule(struct k_spinlock *lock, k_spinlock_key_t key)
+{
+	if (resched()) {
+		(void)_Swap(lock, key);
+	} else {
+		k_spin_unlock(lock, key);
+	}
+}
+
+void _reschedule_irqlock(u32_t key)
+{
+	if (resched()) {
+		(void)_Swap_irqlock(key);
+	} else {
+		irq_unlock(key);
+	}
 }
 
 void k_sched_lock(void)
@@ -482,7 +785,7 @@ void k_sched_unlock(void)
 	K_DEBUG("scheduler unlocked (%p:%d)\n",
 		_current, _current->base.sched_locked);
 
-	_reschedule(irq_lock());
+	_reschedule_unlocked();
 #endif
 }
 
@@ -499,6 +802,97 @@ struct k_thread *_get_next_ready_thread(void)
 }
 #endif
 
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+/* Charges the time since the last call on this CPU to from, which is
+ * being switched out for to.  Called with interrupts locked, from the
+ * context switch paths and, with from == to, on ticks.
+ */
+void z_sched_usage_switch(struct k_thread *from, struct k_thread *to)
+{
+	struct _cpu *cpu = _current_cpu;
+	u32_t now = k_cycle_get_32();
+
+	from->base.usage.execution_cycles += now - cpu->usage_start;
+	cpu->usage_start = now;
+
+	if (to != from) {
+		to->base.usage.switches++;
+		if (from->base.yielding) {
+			from->base.usage.yields++;
+		} else if (_is_thread_ready(from) && !_is_idle(from)) {
+			from->base.usage.preemptions++;
+		}
+	}
+}
+
+#ifndef CONFIG_USE_SWITCH
+/* Called by architecture code right before it switches from _current
+ * to _kernel.ready_q.cache
+ */
+void z_sched_usage_swap(void)
+{
+	z_sched_usage_switch(_current, _kernel.ready_q.cache);
+}
+#endif
+
+/* Accounts the running thread's time so far, so that it is up to date
+ * and the 32-bit cycle counter can't wrap in between.
+ */
+void z_sched_usage_update(void)
+{
+	unsigned int key = _arch_irq_lock();
+
+	z_sched_usage_switch(_current, _current);
+	_arch_irq_unlock(key);
+}
+
+int _impl_k_thread_runtime_stats_get(k_tid_t thread,
+				     struct k_thread_runtime_stats *stats)
+{
+	unsigned int key = _arch_irq_lock();
+
+	if (thread == _current) {
+		z_sched_usage_switch(_current, _current);
+	}
+	*stats = thread->base.usage;
+	_arch_irq_unlock(key);
+
+	return 0;
+}
+
+int _impl_k_cpu_idle_stats_get(int cpu, struct k_thread_runtime_stats *stats)
+{
+	if (cpu < 0 || cpu >= CONFIG_MP_NUM_CPUS) {
+		return -EINVAL;
+	}
+
+	return _impl_k_thread_runtime_stats_get(_kernel.cpus[cpu].idle_thread,
+						stats);
+}
+
+#ifdef CONFIG_USERSPACE
+Z_SYSCALL_HANDLER(k_thread_runtime_stats_get, thread_p, stats_p)
+{
+	struct k_thread *thread = (struct k_thread *)thread_p;
+	struct k_thread_runtime_stats *stats = (void *)stats_p;
+
+	Z_OOPS(Z_SYSCALL_OBJ(thread, K_OBJ_THREAD));
+	Z_OOPS(Z_SYSCALL_MEMORY_WRITE(stats, sizeof(*stats)));
+
+	return _impl_k_thread_runtime_stats_get((k_tid_t)thread, stats);
+}
+
+Z_SYSCALL_HANDLER(k_cpu_idle_stats_get, cpu, stats_p)
+{
+	struct k_thread_runtime_stats *stats = (void *)stats_p;
+
+	Z_OOPS(Z_SYSCALL_MEMORY_WRITE(stats, sizeof(*stats)));
+
+	return _impl_k_cpu_idle_stats_get(cpu, stats);
+}
+#endif
+#endif /* CONFIG_THREAD_RUNTIME_STATS */
+
 #ifdef CONFIG_USE_SWITCH
 void *_get_next_switch_handle(void *interrupted)
 {
@@ -508,11 +902,16 @@ void *_get_next_switch_handle(void *interrupted)
 	LOCKED(&sched_lock) {
 		struct k_thread *th = next_up();
 
+		cbs_switch(th);
 		if (_current != th) {
 			reset_time_slice();
 			_current_cpu->swap_ok = 0;
+			th->base.cpu = _current_cpu->id;
 #ifdef CONFIG_TRACING
 			sys_trace_thread_switched_out();
+#endif
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+			z_sched_usage_switch(_current, th);
 #endif
 			_current = th;
 #ifdef CONFIG_TRACING
@@ -524,6 +923,9 @@ void *_get_next_switch_handle(void *interrupted)
 #else
 #ifdef CONFIG_TRACING
 	sys_trace_thread_switched_out();
+#endif
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	z_sched_usage_switch(_current, _get_next_ready_thread());
 #endif
 	_current = _get_next_ready_thread();
 #ifdef CONFIG_TRACING
@@ -624,42 +1026,98 @@ struct k_thread *_priq_rb_best(struct _priq_rb *pq)
 	return CONTAINER_OF(n, struct k_thread, base.qnode_rb);
 }
 
-#ifdef CONFIG_SCHED_MULTIQ
-# if (K_LOWEST_THREAD_PRIO - K_HIGHEST_THREAD_PRIO) > 31
-# error Too many priorities for multiqueue scheduler (max 32)
-# endif
+#if K_NUM_PRIO_BITMAPS > 32
+#error Too many priorities for multiqueue scheduler (max 1024)
 #endif
 
+static inline int mq_index(struct k_thread *thread)
+{
+	return thread->base.prio - K_HIGHEST_THREAD_PRIO;
+}
+
+/* Index of the first non-empty queue at or after index i, or -1 */
+static int mq_find(struct _priq_mq *pq, int i)
+{
+	int w = i >> 5;
+	u32_t bits;
+
+	if (w >= K_NUM_PRIO_BITMAPS) {
+		return -1;
+	}
+
+	bits = pq->bitmask[w] & (~0U << (i & 31));
+	if (bits == 0) {
+		/* next word with any bit set, if any */
+		bits = pq->summary & ~((2U << w) - 1);
+		if (bits == 0) {
+			return -1;
+		}
+		w = __builtin_ctz(bits);
+		bits = pq->bitmask[w];
+	}
+
+	return (w << 5) + __builtin_ctz(bits);
+}
+
 void _priq_mq_add(struct _priq_mq *pq, struct k_thread *thread)
 {
-	int priority_bit = thread->base.prio - K_HIGHEST_THREAD_PRIO;
+	int i = mq_index(thread);
+	u32_t bit = BIT(i & 31);
 
-	sys_dlist_append(&pq->queues[priority_bit], &thread->base.qnode_dlist);
-	pq->bitmask |= (1 << priority_bit);
+	if ((pq->bitmask[i >> 5] & bit) == 0) {
+		sys_dlist_init(&pq->queues[i]);
+		pq->bitmask[i >> 5] |= bit;
+		pq->summary |= BIT(i >> 5);
+	}
+
+	sys_dlist_append(&pq->queues[i], &thread->base.qnode_dlist);
 }
 
 void _priq_mq_remove(struct _priq_mq *pq, struct k_thread *thread)
 {
-	int priority_bit = thread->base.prio - K_HIGHEST_THREAD_PRIO;
+	int i = mq_index(thread);
 
 	sys_dlist_remove(&thread->base.qnode_dlist);
-	if (sys_dlist_is_empty(&pq->queues[priority_bit])) {
-		pq->bitmask &= ~(1 << priority_bit);
+	if (sys_dlist_is_empty(&pq->queues[i])) {
+		pq->bitmask[i >> 5] &= ~BIT(i & 31);
+		if (pq->bitmask[i >> 5] == 0) {
+			pq->summary &= ~BIT(i >> 5);
+		}
 	}
 }
 
 struct k_thread *_priq_mq_best(struct _priq_mq *pq)
 {
-	if (!pq->bitmask) {
+	if (pq->summary == 0) {
 		return NULL;
 	}
 
-	sys_dlist_t *l = &pq->queues[__builtin_ctz(pq->bitmask)];
+	int w = __builtin_ctz(pq->summary);
+	sys_dlist_t *l = &pq->queues[(w << 5) + __builtin_ctz(pq->bitmask[w])];
 
 	return CONTAINER_OF(sys_dlist_peek_head(l),
 			    struct k_thread, base.qnode_dlist);
 }
 
+/* Thread after the given one in priority order, or NULL */
+struct k_thread *_priq_mq_next(struct _priq_mq *pq, struct k_thread *thread)
+{
+	int i = mq_index(thread);
+	sys_dnode_t *n;
+
+	n = sys_dlist_peek_next_no_check(&pq->queues[i],
+					 &thread->base.qnode_dlist);
+	if (n == NULL) {
+		i = mq_find(pq, i + 1);
+		if (i < 0) {
+			return NULL;
+		}
+		n = sys_dlist_peek_head(&pq->queues[i]);
+	}
+
+	return CONTAINER_OF(n, struct k_thread, base.qnode_dlist);
+}
+
 int _unpend_all(_wait_q_t *waitq)
 {
 	int need_sched = 0;
@@ -674,14 +1132,14 @@ int _unpend_all(_wait_q_t *waitq)
 	return need_sched;
 }
 
-void _sched_init(void)
+static void init_ready_q(struct _ready_q *rq)
 {
 #ifdef CONFIG_SCHED_DUMB
-	sys_dlist_init(&_kernel.ready_q.runq);
+	sys_dlist_init(&rq->runq);
 #endif
 
 #ifdef CONFIG_SCHED_SCALABLE
-	_kernel.ready_q.runq = (struct _priq_rb) {
+	rq->runq = (struct _priq_rb) {
 		.tree = {
 			.lessthan_fn = _priq_rb_lessthan,
 		}
@@ -689,15 +1147,30 @@ void _sched_init(void)
 #endif
 
 #ifdef CONFIG_SCHED_MULTIQ
-	for (int i = 0; i < ARRAY_SIZE(_kernel.ready_q.runq.queues); i++) {
-		sys_dlist_init(&_kernel.ready_q.runq.queues[i]);
+	rq->runq = (struct _priq_mq) {};
+#endif
+}
+
+void _sched_init(void)
+{
+#ifdef CONFIG_SCHED_PER_CPU_RUNQ
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		init_ready_q(&_kernel.cpus[i].ready_q);
 	}
+#else
+	init_ready_q(&_kernel.ready_q);
 #endif
 
 #ifdef CONFIG_TIMESLICING
 	k_sched_time_slice_set(CONFIG_TIMESLICE_SIZE,
 		CONFIG_TIMESLICE_PRIORITY);
 #endif
+
+#ifdef CONFIG_SCHED_DEADLINE_CBS
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		_init_timeout(&cbs_cpus[i].timeout, cbs_exhausted);
+	}
+#endif
 }
 
 int _impl_k_thread_priority_get(k_tid_t thread)
@@ -741,18 +1214,152 @@ Z_SYSCALL_HANDLER(k_thread_priority_set, thread_p, prio)
 }
 #endif
 
+#ifdef CONFIG_SCHED_DEADLINE_CBS
+/* Timeout handler: the server thread running on a CPU ran out of budget */
+static void cbs_exhausted(struct _timeout *to)
+{
+	struct cbs_cpu *cpu = CONTAINER_OF(to, struct cbs_cpu, timeout);
+
+	LOCKED(&sched_lock) {
+		if (cpu->thread != NULL) {
+			cbs_charge(cpu);
+			update_cache(0);
+		}
+	}
+}
+
+/* must be called with sched_lock held */
+static int cbs_admit(struct k_thread *thread, u32_t budget, u32_t deadline)
+{
+	u32_t bw;
+
+	__ASSERT(deadline >= budget && budget != 0, "invalid reservation");
+
+	bw = ((u64_t)budget << CBS_BW_SHIFT) / deadline;
+
+	if (cbs_total_bw - thread->base.cbs.bw + bw > CBS_MAX_BW) {
+		return -EBUSY;
+	}
+
+	cbs_total_bw += bw - thread->base.cbs.bw;
+	thread->base.cbs.bw = bw;
+
+	return 0;
+}
+
+/* Charges a thread for its current run before its server parameters
+ * change; accounting restarts when it is next picked to run.
+ * Must be called with sched_lock held.
+ */
+static void cbs_settle(struct k_thread *thread)
+{
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		if (cbs_cpus[i].thread == thread) {
+			cbs_charge(&cbs_cpus[i]);
+		}
+	}
+}
+
+/* must be called with sched_lock held */
+static void cbs_release(struct k_thread *thread)
+{
+	cbs_settle(thread);
+	cbs_total_bw -= thread->base.cbs.bw;
+	thread->base.cbs.bw = 0;
+	thread->base.cbs.budget = 0;
+}
+
+void z_sched_cbs_release(struct k_thread *thread)
+{
+	LOCKED(&sched_lock) {
+		cbs_release(thread);
+	}
+}
+
+int _impl_k_thread_cbs_set(k_tid_t tid, u32_t budget, u32_t period)
+{
+	struct k_thread *th = tid;
+	int ret = 0;
+
+	if (period == 0 || budget > period || period > INT_MAX) {
+		return -EINVAL;
+	}
+
+	LOCKED(&sched_lock) {
+		if (budget == 0) {
+			cbs_release(th);
+		} else {
+			ret = cbs_admit(th, budget, period);
+		}
+
+		if (ret == 0 && budget != 0) {
+			cbs_settle(th);
+			th->base.cbs.budget = budget;
+			th->base.cbs.period = period;
+			th->base.cbs.deadline = period;
+			cbs_new_job(th, k_cycle_get_32());
+			if (_is_thread_queued(th)) {
+				runq_remove(th);
+				runq_add(th);
+			}
+			update_cache(0);
+		}
+	}
+
+	return ret;
+}
+
+#ifdef CONFIG_USERSPACE
+Z_SYSCALL_HANDLER(k_thread_cbs_set, thread_p, budget, period)
+{
+	struct k_thread *thread = (struct k_thread *)thread_p;
+
+	Z_OOPS(Z_SYSCALL_OBJ(thread, K_OBJ_THREAD));
+
+	return _impl_k_thread_cbs_set((k_tid_t)thread, budget, period);
+}
+#endif
+#endif /* CONFIG_SCHED_DEADLINE_CBS */
+
 #ifdef CONFIG_SCHED_DEADLINE
-void _impl_k_thread_deadline_set(k_tid_t tid, int deadline)
+int _impl_k_thread_deadline_set(k_tid_t tid, int deadline)
 {
 	struct k_thread *th = tid;
+	int ret = 0;
+
+	if (deadline <= 0) {
+		return -EINVAL;
+	}
 
 	LOCKED(&sched_lock) {
-		th->base.prio_deadline = k_cycle_get_32() + deadline;
-		if (_is_thread_queued(th)) {
-			_priq_run_remove(&_kernel.ready_q.runq, th);
-			_priq_run_add(&_kernel.ready_q.runq, th);
+#ifdef CONFIG_SCHED_DEADLINE_CBS
+		if (has_cbs(th)) {
+			deadline = min((u32_t)deadline, th->base.cbs.period);
+
+			if ((u32_t)deadline < th->base.cbs.budget) {
+				ret = -EINVAL;
+			} else {
+				ret = cbs_admit(th, th->base.cbs.budget,
+						deadline);
+			}
+			if (ret == 0) {
+				cbs_settle(th);
+				th->base.cbs.deadline = deadline;
+				th->base.cbs.left = th->base.cbs.budget;
+			}
+		}
+#endif
+		if (ret == 0) {
+			th->base.prio_deadline = k_cycle_get_32() + deadline;
+			if (_is_thread_queued(th)) {
+				runq_remove(th);
+				runq_add(th);
+			}
+			update_cache(0);
 		}
 	}
+
+	return ret;
 }
 
 #ifdef CONFIG_USERSPACE
@@ -765,29 +1372,101 @@ Z_SYSCALL_HANDLER(k_thread_deadline_set, thread_p, deadline)
 				    "invalid thread deadline %d",
 				    (int)deadline));
 
-	_impl_k_thread_deadline_set((k_tid_t)thread, deadline);
-	return 0;
+	/* deadlines shorter than a CBS budget fail with -EINVAL, checked
+	 * by the implementation under the scheduler lock
+	 */
+	return _impl_k_thread_deadline_set((k_tid_t)thread, deadline);
 }
 #endif
 #endif
 
+#ifdef CONFIG_SCHED_PER_CPU_RUNQ
+static int cpu_mask_mod(k_tid_t thread, u32_t enable_mask, u32_t disable_mask)
+{
+	int ret = 0;
+
+	LOCKED(&sched_lock) {
+		if (_is_thread_prevented_from_running(thread)) {
+			thread->base.cpu_mask |= enable_mask;
+			thread->base.cpu_mask &= ~disable_mask;
+		} else {
+			ret = -EINVAL;
+		}
+	}
+
+	return ret;
+}
+
+int k_thread_cpu_mask_clear(k_tid_t thread)
+{
+	return cpu_mask_mod(thread, 0, 0xffffffff);
+}
+
+int k_thread_cpu_mask_enable_all(k_tid_t thread)
+{
+	return cpu_mask_mod(thread, 0xffffffff, 0);
+}
+
+int k_thread_cpu_mask_enable(k_tid_t thread, int cpu)
+{
+	if (cpu < 0 || cpu >= CONFIG_MP_NUM_CPUS) {
+		return -EINVAL;
+	}
+
+	return cpu_mask_mod(thread, BIT(cpu), 0);
+}
+
+int k_thread_cpu_mask_disable(k_tid_t thread, int cpu)
+{
+	if (cpu < 0 || cpu >= CONFIG_MP_NUM_CPUS) {
+		return -EINVAL;
+	}
+
+	return cpu_mask_mod(thread, 0, BIT(cpu));
+}
+#endif
+
+/* Switches away from the yielding thread, marked for the runtime
+ * statistics to count a yield rather than a preemption.
+ */
+static void yield_swap(void)
+{
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	struct k_spinlock lock = {};
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	_current->base.yielding = 1;
+	(void)_Swap(&lock, key);
+
+	/* The thread may be the only one ready and never switch out */
+	key = k_spin_lock(&lock);
+	_current->base.yielding = 0;
+	k_spin_unlock(&lock, key);
+#else
+	_Swap_unlocked();
+#endif
+}
+
 void _impl_k_yield(void)
 {
 	__ASSERT(!_is_in_isr(), "");
 
 	if (!_is_idle(_current)) {
 		LOCKED(&sched_lock) {
-			_priq_run_remove(&_kernel.ready_q.runq, _current);
-			_priq_run_add(&_kernel.ready_q.runq, _current);
+			if (_is_thread_queued(_current)) {
+				runq_remove(_current);
+			}
+			runq_add(_current);
+			_mark_thread_as_queued(_current);
 			update_cache(1);
 		}
 	}
 
 #ifdef CONFIG_SMP
-	(void)_Swap(irq_lock());
+	yield_swap();
 #else
 	if (_get_next_ready_thread() != _current) {
-		(void)_Swap(irq_lock());
+		yield_swap();
 	}
 #endif
 }
@@ -801,7 +1480,6 @@ s32_t _impl_k_sleep(s32_t duration)
 #ifdef CONFIG_MULTITHREADING
 	u32_t expected_wakeup_time;
 	s32_t ticks;
-	unsigned int key;
 
 	__ASSERT(!_is_in_isr(), "");
 	__ASSERT(duration != K_FOREVER, "");
@@ -816,12 +1494,18 @@ s32_t _impl_k_sleep(s32_t duration)
 
 	ticks = _TICK_ALIGN + _ms_to_ticks(duration);
 	expected_wakeup_time = ticks + z_tick_get_32();
-	key = irq_lock();
+
+	/* Spinlock purely for local interrupt locking to prevent us
+	 * from being interrupted while _current is in an intermediate
+	 * state.  Should unify this implementation with pend().
+	 */
+	struct k_spinlock local_lock = {};
+	k_spinlock_key_t key = k_spin_lock(&local_lock);
 
 	_remove_thread_from_ready_q(_current);
 	_add_thread_timeout(_current, ticks);
 
-	(void)_Swap(key);
+	(void)_Swap(&local_lock, key);
 
 	ticks = expected_wakeup_time - z_tick_get_32();
 	if (ticks > 0) {
@@ -847,25 +1531,19 @@ Z_SYSCALL_HANDLER(k_sleep, duration)
 
 void _impl_k_wakeup(k_tid_t thread)
 {
-	unsigned int key = irq_lock();
-
 	/* verify first if thread is not waiting on an object */
 	if (_is_thread_pending(thread)) {
-		irq_unlock(key);
 		return;
 	}
 
 	if (_abort_thread_timeout(thread) == _INACTIVE) {
-		irq_unlock(key);
 		return;
 	}
 
 	_ready_thread(thread);
 
-	if (_is_in_isr()) {
-		irq_unlock(key);
-	} else {
-		_reschedule(key);
+	if (!_is_in_isr()) {
+		_reschedule_unlocked();
 	}
 }
 
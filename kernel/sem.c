@@ -64,6 +64,7 @@ void _impl_k_sem_init(struct k_sem *sem, unsigned int initial_count,
 	sys_trace_void(SYS_TRACE_ID_SEMA_INIT);
 	sem->count = initial_count;
 	sem->limit = limit;
+	sem->lock = (struct k_spinlock) {};
 	_waitq_init(&sem->wait_q);
 #if defined(CONFIG_POLL)
 	sys_dlist_init(&sem->poll_events);
@@ -114,12 +115,12 @@ static void do_sem_give(struct k_sem *sem)
 
 void _impl_k_sem_give(struct k_sem *sem)
 {
-	u32_t key = irq_lock();
+	k_spinlock_key_t key = k_spin_lock(&sem->lock);
 
 	sys_trace_void(SYS_TRACE_ID_SEMA_GIVE);
 	do_sem_give(sem);
 	sys_trace_end_call(SYS_TRACE_ID_SEMA_GIVE);
-	_reschedule(key);
+	_reschedule(&sem->lock, key);
 }
 
 #ifdef CONFIG_USERSPACE
@@ -131,24 +132,24 @@ int _impl_k_sem_take(struct k_sem *sem, s32_t timeout)
 	__ASSERT(((_is_in_isr() == false) || (timeout == K_NO_WAIT)), "");
 
 	sys_trace_void(SYS_TRACE_ID_SEMA_TAKE);
-	u32_t key = irq_lock();
+	k_spinlock_key_t key = k_spin_lock(&sem->lock);
 
 	if (likely(sem->count > 0U)) {
 		sem->count--;
-		irq_unlock(key);
+		k_spin_unlock(&sem->lock, key);
 		sys_trace_end_call(SYS_TRACE_ID_SEMA_TAKE);
 		return 0;
 	}
 
 	if (timeout == K_NO_WAIT) {
-		irq_unlock(key);
+		k_spin_unlock(&sem->lock, key);
 		sys_trace_end_call(SYS_TRACE_ID_SEMA_TAKE);
 		return -EBUSY;
 	}
 
 	sys_trace_end_call(SYS_TRACE_ID_SEMA_TAKE);
 
-	return _pend_current_thread(key, &sem->wait_q, timeout);
+	return _pend_curr(&sem->lock, key, &sem->wait_q, timeout);
 }
 
 #ifdef CONFIG_USERSPACE
@@ -18,6 +18,7 @@
 #include <misc/__assert.h>
 #include <init.h>
 #include <syscall_handler.h>
+#include <string.h>
 
 extern struct k_stack _k_stack_list_start[];
 extern struct k_stack _k_stack_list_end[];
@@ -49,6 +50,7 @@ void k_stack_init(struct k_stack *stack, u32_t *buffer,
 		  u32_t num_entries)
 {
 	_waitq_init(&stack->wait_q);
+	stack->lock = (struct k_spinlock) {};
 	stack->base = buffer;
 	stack->next = buffer;
 	stack->top = stack->base + num_entries;
@@ -98,11 +100,11 @@ void k_stack_cleanup(struct k_stack *stack)
 void _impl_k_stack_push(struct k_stack *stack, u32_t data)
 {
 	struct k_thread *first_pending_thread;
-	u32_t key;
+	k_spinlock_key_t key;
 
 	__ASSERT(stack->next != stack->top, "stack is full");
 
-	key = irq_lock();
+	key = k_spin_lock(&stack->lock);
 
 	first_pending_thread = _unpend_first_thread(&stack->wait_q);
 
@@ -111,12 +113,12 @@ void _impl_k_stack_push(struct k_stack *stack, u32_t data)
 
 		_set_thread_return_value_with_data(first_pending_thread,
 						   0, (void *)data);
-		_reschedule(key);
+		_reschedule(&stack->lock, key);
 		return;
 	} else {
 		*(stack->next) = data;
 		stack->next++;
-		irq_unlock(key);
+		k_spin_unlock(&stack->lock, key);
 	}
 
 }
@@ -135,26 +137,98 @@ Z_SYSCALL_HANDLER(k_stack_push, stack_p, data)
 }
 #endif
 
+/*
+ * Pushes take the stack's lock like pops do.  A lock-free push would
+ * have to claim a slot by moving stack->next with a CAS and only then
+ * store its value, so a pop on another CPU, or an ISR popping on this
+ * one, could read the slot before the value lands in it; storing first
+ * instead lets two pushes fill the same slot.  A push must also hand its
+ * value to a thread waiting on the empty stack, which takes the
+ * scheduler lock anyway.  Without SMP, the lock amounts to the interrupt
+ * lock any ISR-safe push would need.
+ */
+int _impl_k_stack_push_n(struct k_stack *stack, const u32_t *data,
+			 u32_t num_entries)
+{
+	struct k_thread *pending_thread;
+	bool woken = false;
+	k_spinlock_key_t key;
+	u32_t waiting = 0;
+
+	key = k_spin_lock(&stack->lock);
+
+	/* All or nothing: what waiting threads do not take must fit */
+	_WAIT_Q_FOR_EACH(&stack->wait_q, pending_thread) {
+		if (waiting == num_entries) {
+			break;
+		}
+		waiting++;
+	}
+
+	if (num_entries - waiting > (u32_t)(stack->top - stack->next)) {
+		k_spin_unlock(&stack->lock, key);
+		return -ENOMEM;
+	}
+
+	/* Waiting threads get the first values, as with successive pushes */
+	while (num_entries > 0) {
+		pending_thread = _unpend_first_thread(&stack->wait_q);
+		if (pending_thread == NULL) {
+			break;
+		}
+
+		_ready_thread(pending_thread);
+		_set_thread_return_value_with_data(pending_thread,
+						   0, (void *)*data);
+		data++;
+		num_entries--;
+		woken = true;
+	}
+
+	(void)memcpy(stack->next, data, num_entries * sizeof(u32_t));
+	stack->next += num_entries;
+
+	if (woken) {
+		_reschedule(&stack->lock, key);
+	} else {
+		k_spin_unlock(&stack->lock, key);
+	}
+
+	return 0;
+}
+
+#ifdef CONFIG_USERSPACE
+Z_SYSCALL_HANDLER(k_stack_push_n, stack_p, data, num_entries)
+{
+	struct k_stack *stack = (struct k_stack *)stack_p;
+
+	Z_OOPS(Z_SYSCALL_OBJ(stack, K_OBJ_STACK));
+	Z_OOPS(Z_SYSCALL_MEMORY_ARRAY_READ(data, num_entries, sizeof(u32_t)));
+
+	return _impl_k_stack_push_n(stack, (const u32_t *)data, num_entries);
+}
+#endif
+
 int _impl_k_stack_pop(struct k_stack *stack, u32_t *data, s32_t timeout)
 {
-	u32_t key;
+	k_spinlock_key_t key;
 	int result;
 
-	key = irq_lock();
+	key = k_spin_lock(&stack->lock);
 
 	if (likely(stack->next > stack->base)) {
 		stack->next--;
 		*data = *(stack->next);
-		irq_unlock(key);
+		k_spin_unlock(&stack->lock, key);
 		return 0;
 	}
 
 	if (timeout == K_NO_WAIT) {
-		irq_unlock(key);
+		k_spin_unlock(&stack->lock, key);
 		return -EBUSY;
 	}
 
-	result = _pend_current_thread(key, &stack->wait_q, timeout);
+	result = _pend_curr(&stack->lock, key, &stack->wait_q, timeout);
 	if (result == -EAGAIN) {
 		return -EAGAIN;
 	}
@@ -173,3 +247,51 @@ Z_SYSCALL_HANDLER(k_stack_pop, stack, data, timeout)
 				 timeout);
 }
 #endif
+
+int _impl_k_stack_pop_n(struct k_stack *stack, u32_t *data,
+			u32_t num_entries, s32_t timeout)
+{
+	k_spinlock_key_t key;
+	u32_t count, i;
+	int result;
+
+	__ASSERT(num_entries > 0, "no room for popped values");
+
+	key = k_spin_lock(&stack->lock);
+
+	count = min(num_entries, (u32_t)(stack->next - stack->base));
+	if (likely(count > 0)) {
+		for (i = 0; i < count; i++) {
+			stack->next--;
+			data[i] = *(stack->next);
+		}
+		k_spin_unlock(&stack->lock, key);
+		return count;
+	}
+
+	if (timeout == K_NO_WAIT) {
+		k_spin_unlock(&stack->lock, key);
+		return -EBUSY;
+	}
+
+	/* Pushes hand a single value to each waiting thread */
+	result = _pend_curr(&stack->lock, key, &stack->wait_q, timeout);
+	if (result == -EAGAIN) {
+		return -EAGAIN;
+	}
+
+	data[0] = (u32_t)_current->base.swap_data;
+	return 1;
+}
+
+#ifdef CONFIG_USERSPACE
+Z_SYSCALL_HANDLER(k_stack_pop_n, stack, data, num_entries, timeout)
+{
+	Z_OOPS(Z_SYSCALL_OBJ(stack, K_OBJ_STACK));
+	Z_OOPS(Z_SYSCALL_VERIFY(num_entries > 0));
+	Z_OOPS(Z_SYSCALL_MEMORY_ARRAY_WRITE(data, num_entries, sizeof(u32_t)));
+
+	return _impl_k_stack_pop_n((struct k_stack *)stack, (u32_t *)data,
+				   num_entries, timeout);
+}
+#endif
@@ -18,6 +18,7 @@
 
 #include <kernel_structs.h>
 #include <misc/printk.h>
+#include <string.h>
 #include <sys_clock.h>
 #include <drivers/system_timer.h>
 #include <ksched.h>
@@ -267,9 +268,17 @@ void _impl_k_thread_start(struct k_thread *thread)
 		return;
 	}
 
+#ifdef CONFIG_SCHED_PER_CPU_RUNQ
+	/* left unstarted, so that its mask can still be set */
+	if (thread->base.cpu_mask == 0) {
+		irq_unlock(key);
+		return;
+	}
+#endif
+
 	_mark_thread_as_started(thread);
 	_ready_thread(thread);
-	_reschedule(key);
+	_reschedule_irqlock(key);
 }
 
 #ifdef CONFIG_USERSPACE
@@ -385,6 +394,7 @@ void _setup_new_thread(struct k_thread *new_thread,
 	_k_object_init(new_thread);
 	_k_object_init(stack);
 	new_thread->stack_obj = stack;
+	z_object_cache_reset(new_thread);
 
 	/* Any given thread has access to itself */
 	k_object_access_grant(new_thread, new_thread);
@@ -409,6 +419,10 @@ void _setup_new_thread(struct k_thread *new_thread,
 #endif
 #ifdef CONFIG_SCHED_DEADLINE
 	new_thread->base.prio_deadline = 0;
+#endif
+#ifdef CONFIG_SCHED_DEADLINE_CBS
+	new_thread->base.cbs.budget = 0;
+	new_thread->base.cbs.bw = 0;
 #endif
 	new_thread->resource_pool = _current->resource_pool;
 	sys_trace_thread_create(new_thread);
@@ -536,7 +550,7 @@ void _impl_k_thread_suspend(struct k_thread *thread)
 	sys_trace_thread_suspend(thread);
 
 	if (thread == _current) {
-		(void)_Swap(key);
+		(void)_Swap_irqlock(key);
 	} else {
 		irq_unlock(key);
 	}
@@ -559,7 +573,7 @@ void _impl_k_thread_resume(struct k_thread *thread)
 	_k_thread_single_resume(thread);
 
 	sys_trace_thread_resume(thread);
-	_reschedule(key);
+	_reschedule_irqlock(key);
 }
 
 #ifdef CONFIG_USERSPACE
@@ -572,6 +586,10 @@ void _k_thread_single_abort(struct k_thread *thread)
 		thread->fn_abort();
 	}
 
+#ifdef CONFIG_SCHED_DEADLINE_CBS
+	z_sched_cbs_release(thread);
+#endif
+
 	if (_is_thread_ready(thread)) {
 		_remove_thread_from_ready_q(thread);
 	} else {
@@ -677,6 +695,18 @@ void _init_thread_base(struct _thread_base *thread_base, int priority,
 
 	thread_base->sched_locked = 0;
 
+	thread_base->pended_mutex = NULL;
+
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	(void)memset(&thread_base->usage, 0, sizeof(thread_base->usage));
+	thread_base->yielding = 0;
+#endif
+
+#ifdef CONFIG_SCHED_PER_CPU_RUNQ
+	thread_base->cpu = 0;
+	thread_base->cpu_mask = -1;
+#endif
+
 	/* swap_data does not need to be initialized */
 
 	_init_thread_timeout(thread_base);
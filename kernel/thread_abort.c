@@ -41,12 +41,12 @@ void _impl_k_thread_abort(k_tid_t thread)
 		irq_unlock(key);
 	} else {
 		if (_current == thread) {
-			(void)_Swap(key);
+			(void)_Swap_irqlock(key);
 			CODE_UNREACHABLE;
 		}
 
 		/* The abort handler might have altered the ready queue. */
-		_reschedule(key);
+		_reschedule_irqlock(key);
 	}
 }
 #endif
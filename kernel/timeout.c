@@ -17,8 +17,6 @@
 
 static u64_t curr_tick;
 
-static sys_dlist_t timeout_list = SYS_DLIST_STATIC_INIT(&timeout_list);
-
 static struct k_spinlock timeout_lock;
 
 static bool can_wait_forever;
@@ -30,6 +28,9 @@ static int announce_remaining;
 int z_clock_hw_cycles_per_sec = CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC;
 #endif
 
+#ifdef CONFIG_TIMEOUT_QUEUE_DLIST
+static sys_dlist_t timeout_list = SYS_DLIST_STATIC_INIT(&timeout_list);
+
 static struct _timeout *first(void)
 {
 	sys_dnode_t *t = sys_dlist_peek_head(&timeout_list);
@@ -44,6 +45,13 @@ static struct _timeout *next(struct _timeout *t)
 	return n == NULL ? NULL : CONTAINER_OF(n, struct _timeout, node);
 }
 
+static struct _timeout *prev(struct _timeout *t)
+{
+	sys_dnode_t *p = sys_dlist_peek_prev(&timeout_list, &t->node);
+
+	return p == NULL ? NULL : CONTAINER_OF(p, struct _timeout, node);
+}
+
 static void remove_timeout(struct _timeout *t)
 {
 	if (next(t) != NULL) {
@@ -54,6 +62,352 @@ static void remove_timeout(struct _timeout *t)
 	t->dticks = _INACTIVE;
 }
 
+/* Queues @a to to expire @a ticks after curr_tick */
+static void insert_timeout(struct _timeout *to, s32_t ticks)
+{
+	struct _timeout *t;
+
+	to->dticks = ticks;
+	to->expiry = (u32_t)curr_tick + ticks;
+	for (t = first(); t != NULL; t = next(t)) {
+		__ASSERT(t->dticks >= 0, "");
+
+		if (t->dticks > to->dticks) {
+			t->dticks -= to->dticks;
+			sys_dlist_insert_before(&timeout_list,
+						&t->node, &to->node);
+			break;
+		}
+		to->dticks -= t->dticks;
+	}
+
+	if (t == NULL) {
+		sys_dlist_append(&timeout_list, &to->node);
+	}
+}
+
+/* Moves the active timeout @a to to expire @a ticks after curr_tick.
+ * The deltas of the timeouts between its old and new places are summed
+ * from its old place, so only those are walked.
+ */
+static void move_timeout(struct _timeout *to, s32_t ticks)
+{
+	struct _timeout *p = prev(to), *n = next(to);
+	s32_t d = to->dticks + (s32_t)((u32_t)curr_tick + ticks - to->expiry);
+
+	if (n != NULL) {
+		n->dticks += to->dticks;
+	}
+	sys_dlist_remove(&to->node);
+
+	/* d is now relative to p's expiry, and never below zero once
+	 * relative to curr_tick at the head of the list
+	 */
+	while (d < 0) {
+		d += p->dticks;
+		n = p;
+		p = prev(p);
+	}
+
+	while (n != NULL && n->dticks <= d) {
+		d -= n->dticks;
+		n = next(n);
+	}
+
+	to->dticks = d;
+	to->expiry = (u32_t)curr_tick + ticks;
+	if (n != NULL) {
+		n->dticks -= d;
+		sys_dlist_insert_before(&timeout_list, &n->node, &to->node);
+	} else {
+		sys_dlist_append(&timeout_list, &to->node);
+	}
+}
+
+static s32_t timeout_ticks_left(struct _timeout *to)
+{
+	return (s32_t)(to->expiry - (u32_t)curr_tick);
+}
+
+/* Ticks from curr_tick to the first expiry, or -1 if none */
+static s32_t next_expiry_ticks(void)
+{
+	struct _timeout *to = first();
+
+	return to == NULL ? -1 : to->dticks;
+}
+
+/* Advances curr_tick by at most announce_remaining ticks, up to the
+ * first tick in that span on which timeouts are due, and moves all of
+ * them to @a run.  Leaves @a run empty once nothing else is due.
+ */
+static void pop_expired(sys_dlist_t *run)
+{
+	struct _timeout *t = first();
+
+	if (t == NULL) {
+		return;
+	}
+
+	if (t->dticks > announce_remaining) {
+		/* keep expiry - curr_tick equal to the sum of the deltas */
+		t->dticks -= announce_remaining;
+		curr_tick += announce_remaining;
+		announce_remaining = 0;
+		return;
+	}
+
+	announce_remaining -= t->dticks;
+	curr_tick += t->dticks;
+	t->dticks = 0;
+
+	while (t != NULL && t->dticks == 0) {
+		sys_dlist_remove(&t->node);
+		t->dticks = _EXPIRED;
+		sys_dlist_append(run, &t->node);
+		t = first();
+	}
+}
+#endif /* CONFIG_TIMEOUT_QUEUE_DLIST */
+
+#ifdef CONFIG_TIMEOUT_QUEUE_WHEEL
+/*
+ * Hierarchical timer wheel.  A timeout expiring at absolute tick E
+ * lives at the lowest level L where E and curr_tick agree on all bits
+ * above that level's slot bits, in slot (E >> (L * WHEEL_BITS)) &
+ * WHEEL_MASK.  Its slot is therefore always ahead of curr_tick's slot
+ * at that level.  When curr_tick reaches the start of a slot above
+ * level 0, the slot is "cascaded": its timeouts are re-inserted and
+ * land on a lower level.  Everything in a level 0 slot expires on the
+ * same tick.  Timeouts too far out for the top level wait on an
+ * overflow list that is re-inserted each time the top level wraps.
+ *
+ * The next event (an expiry or a cascade) is the first set bit at or
+ * after curr_tick's slot in each level's bitmap, so it is found
+ * without walking any list.
+ */
+#define WHEEL_BITS	5
+#define WHEEL_SLOTS	(1 << WHEEL_BITS)
+#define WHEEL_MASK	(WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS	4
+#define WHEEL_SPAN_BITS	(WHEEL_BITS * WHEEL_LEVELS)
+
+static sys_dlist_t wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+static u32_t wheel_bitmap[WHEEL_LEVELS];
+static sys_dlist_t wheel_overflow = SYS_DLIST_STATIC_INIT(&wheel_overflow);
+static bool wheel_initialized;
+
+static inline int wheel_index(u64_t tick, int level)
+{
+	return (tick >> (level * WHEEL_BITS)) & WHEEL_MASK;
+}
+
+static int wheel_level(u64_t expiry)
+{
+	int level;
+
+	for (level = 0; level < WHEEL_LEVELS; level++) {
+		int shift = (level + 1) * WHEEL_BITS;
+
+		if ((expiry >> shift) == (curr_tick >> shift)) {
+			break;
+		}
+	}
+
+	return level;
+}
+
+static void wheel_init(void)
+{
+	for (int l = 0; l < WHEEL_LEVELS; l++) {
+		for (int i = 0; i < WHEEL_SLOTS; i++) {
+			sys_dlist_init(&wheel[l][i]);
+		}
+	}
+	wheel_initialized = true;
+}
+
+static void wheel_add(struct _timeout *to)
+{
+	int level = wheel_level(to->expiry);
+
+	if (level == WHEEL_LEVELS) {
+		sys_dlist_append(&wheel_overflow, &to->node);
+	} else {
+		int idx = wheel_index(to->expiry, level);
+
+		sys_dlist_append(&wheel[level][idx], &to->node);
+		wheel_bitmap[level] |= BIT(idx);
+	}
+}
+
+static void remove_timeout(struct _timeout *t)
+{
+	int level = wheel_level(t->expiry);
+
+	sys_dlist_remove(&t->node);
+
+	if (level < WHEEL_LEVELS) {
+		int idx = wheel_index(t->expiry, level);
+
+		if (sys_dlist_is_empty(&wheel[level][idx])) {
+			wheel_bitmap[level] &= ~BIT(idx);
+		}
+	}
+
+	t->dticks = _INACTIVE;
+}
+
+/* Queues @a to to expire @a ticks after curr_tick */
+static void insert_timeout(struct _timeout *to, s32_t ticks)
+{
+	if (!wheel_initialized) {
+		wheel_init();
+	}
+
+	/* dticks only marks the timeout active for the rest of the kernel */
+	to->dticks = 0;
+	to->expiry = curr_tick + ticks;
+	wheel_add(to);
+}
+
+/* Moves the active timeout @a to to expire @a ticks after curr_tick,
+ * leaving it in place if it stays in the same slot.
+ */
+static void move_timeout(struct _timeout *to, s32_t ticks)
+{
+	u64_t expiry = curr_tick + ticks;
+	int level = wheel_level(to->expiry);
+
+	if (level == wheel_level(expiry) && (level == WHEEL_LEVELS ||
+	    wheel_index(to->expiry, level) == wheel_index(expiry, level))) {
+		to->expiry = expiry;
+		return;
+	}
+
+	remove_timeout(to);
+	insert_timeout(to, ticks);
+}
+
+static s32_t timeout_ticks_left(struct _timeout *to)
+{
+	return (s32_t)(to->expiry - curr_tick);
+}
+
+/* Absolute tick of the next expiry or cascade, no earlier than
+ * curr_tick, or 0 if the wheel is empty.  For levels above 0 this is
+ * the start of the slot, a lower bound on the expiry of the timeouts
+ * in it.
+ */
+static u64_t wheel_next_event(void)
+{
+	u64_t ret = 0;
+
+	for (int l = 0; l < WHEEL_LEVELS; l++) {
+		int idx = wheel_index(curr_tick, l);
+		u32_t pending = wheel_bitmap[l] & ~(BIT(idx) - 1);
+		int shift = (l + 1) * WHEEL_BITS;
+		u64_t ev;
+
+		if (pending == 0) {
+			continue;
+		}
+
+		ev = ((curr_tick >> shift) << shift) |
+		     ((u64_t)__builtin_ctz(pending) << (l * WHEEL_BITS));
+		ev = max(ev, curr_tick);
+
+		if (ret == 0 || ev < ret) {
+			ret = ev;
+		}
+	}
+
+	if (!sys_dlist_is_empty(&wheel_overflow)) {
+		u64_t ev = ((curr_tick >> WHEEL_SPAN_BITS) + 1)
+			   << WHEEL_SPAN_BITS;
+
+		if (ret == 0 || ev < ret) {
+			ret = ev;
+		}
+	}
+
+	return ret;
+}
+
+static void wheel_requeue(sys_dlist_t *list)
+{
+	sys_dlist_t tmp;
+	sys_dnode_t *n;
+
+	sys_dlist_init(&tmp);
+	while ((n = sys_dlist_get(list)) != NULL) {
+		sys_dlist_append(&tmp, n);
+	}
+
+	while ((n = sys_dlist_get(&tmp)) != NULL) {
+		wheel_add(CONTAINER_OF(n, struct _timeout, node));
+	}
+}
+
+/* Moves everything in curr_tick's slot of each upper level down */
+static void wheel_cascade(void)
+{
+	if ((curr_tick & BIT_MASK(WHEEL_SPAN_BITS)) == 0) {
+		wheel_requeue(&wheel_overflow);
+	}
+
+	for (int l = WHEEL_LEVELS - 1; l > 0; l--) {
+		int idx = wheel_index(curr_tick, l);
+
+		if (wheel_bitmap[l] & BIT(idx)) {
+			wheel_bitmap[l] &= ~BIT(idx);
+			wheel_requeue(&wheel[l][idx]);
+		}
+	}
+}
+
+static s32_t next_expiry_ticks(void)
+{
+	u64_t ev = wheel_initialized ? wheel_next_event() : 0;
+
+	if (ev == 0) {
+		return -1;
+	}
+
+	return (s32_t)min(ev - curr_tick, (u64_t)INT_MAX);
+}
+
+/* Advances curr_tick by at most announce_remaining ticks, up to the
+ * first tick in that span on which timeouts are due, and moves all of
+ * them to @a run.  Leaves @a run empty once nothing else is due.
+ */
+static void pop_expired(sys_dlist_t *run)
+{
+	u64_t ev;
+
+	while (wheel_initialized && (ev = wheel_next_event()) != 0 &&
+	       ev - curr_tick <= announce_remaining) {
+		int idx;
+		sys_dnode_t *n;
+
+		announce_remaining -= ev - curr_tick;
+		curr_tick = ev;
+		wheel_cascade();
+
+		idx = wheel_index(curr_tick, 0);
+		if (wheel_bitmap[0] & BIT(idx)) {
+			wheel_bitmap[0] &= ~BIT(idx);
+			while ((n = sys_dlist_get(&wheel[0][idx])) != NULL) {
+				CONTAINER_OF(n, struct _timeout, node)->dticks =
+					_EXPIRED;
+				sys_dlist_append(run, n);
+			}
+			return;
+		}
+	}
+}
+#endif /* CONFIG_TIMEOUT_QUEUE_WHEEL */
+
 static s32_t elapsed(void)
 {
 	return announce_remaining == 0 ? z_clock_elapsed() : 0;
@@ -66,24 +420,7 @@ void _add_timeout(struct _timeout *to, _timeout_func_t fn, s32_t ticks)
 	ticks = max(1, ticks);
 
 	LOCKED(&timeout_lock) {
-		struct _timeout *t;
-
-		to->dticks = ticks + elapsed();
-		for (t = first(); t != NULL; t = next(t)) {
-			__ASSERT(t->dticks >= 0, "");
-
-			if (t->dticks > to->dticks) {
-				t->dticks -= to->dticks;
-				sys_dlist_insert_before(&timeout_list,
-							&t->node, &to->node);
-				break;
-			}
-			to->dticks -= t->dticks;
-		}
-
-		if (t == NULL) {
-			sys_dlist_append(&timeout_list, &to->node);
-		}
+		insert_timeout(to, ticks + elapsed());
 	}
 
 	z_clock_set_timeout(_get_next_timeout_expiry(), false);
@@ -94,7 +431,12 @@ int _abort_timeout(struct _timeout *to)
 	int ret = _INACTIVE;
 
 	LOCKED(&timeout_lock) {
-		if (to->dticks != _INACTIVE) {
+		if (to->dticks == _EXPIRED) {
+			/* detached by z_clock_announce(), not fired yet */
+			sys_dlist_remove(&to->node);
+			to->dticks = _INACTIVE;
+			ret = 0;
+		} else if (to->dticks != _INACTIVE) {
 			remove_timeout(to);
 			ret = 0;
 		}
@@ -103,56 +445,93 @@ int _abort_timeout(struct _timeout *to)
 	return ret;
 }
 
+void z_timeout_reschedule(struct _timeout *to, _timeout_func_t fn,
+			  s32_t ticks)
+{
+	to->fn = fn;
+	ticks = max(1, ticks);
+
+	LOCKED(&timeout_lock) {
+		if (to->dticks == _INACTIVE) {
+			insert_timeout(to, ticks + elapsed());
+		} else if (to->dticks == _EXPIRED) {
+			/* detached by z_clock_announce(), not fired yet */
+			sys_dlist_remove(&to->node);
+			insert_timeout(to, ticks + elapsed());
+		} else {
+			move_timeout(to, ticks + elapsed());
+		}
+	}
+
+	z_clock_set_timeout(_get_next_timeout_expiry(), false);
+}
+
 s32_t z_timeout_remaining(struct _timeout *to)
 {
 	s32_t ticks = 0;
 
-	if (to->dticks == _INACTIVE) {
+	if (to->dticks == _INACTIVE || to->dticks == _EXPIRED) {
 		return 0;
 	}
 
 	LOCKED(&timeout_lock) {
-		for (struct _timeout *t = first(); t != NULL; t = next(t)) {
-			ticks += t->dticks;
-			if (to == t) {
-				break;
-			}
-		}
+		ticks = timeout_ticks_left(to);
 	}
 
 	return ticks;
 }
 
+/*
+ * Timeouts are expired one tick at a time: everything due on the next
+ * tick is detached onto a local list in a single step, then the
+ * callbacks are run.  Detached timeouts are marked _EXPIRED until
+ * their callback runs and can still be aborted by an earlier callback
+ * of the same run.  Callbacks see curr_tick at their own expiry, so
+ * timeouts they add are relative to it.
+ */
 void z_clock_announce(s32_t ticks)
 {
-	struct _timeout *t = NULL;
+	sys_dlist_t run;
+	sys_dnode_t *n;
 
 #ifdef CONFIG_TIMESLICING
 	z_time_slice(ticks);
 #endif
 
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	z_sched_usage_update();
+#endif
+
+	sys_dlist_init(&run);
+
 	announce_remaining = ticks;
 	while (true) {
 		LOCKED(&timeout_lock) {
-			t = first();
-			if (t != NULL) {
-				if (t->dticks <= announce_remaining) {
-					announce_remaining -= t->dticks;
-					curr_tick += t->dticks;
-					t->dticks = 0;
-					remove_timeout(t);
-				} else {
-					t->dticks -= announce_remaining;
-					t = NULL;
-				}
-			}
+			pop_expired(&run);
 		}
 
-		if (t == NULL) {
+		if (sys_dlist_is_empty(&run)) {
 			break;
 		}
 
-		t->fn(t);
+		while (true) {
+			struct _timeout *t = NULL;
+
+			LOCKED(&timeout_lock) {
+				n = sys_dlist_get(&run);
+				if (n != NULL) {
+					t = CONTAINER_OF(n, struct _timeout,
+							 node);
+					t->dticks = _INACTIVE;
+				}
+			}
+
+			if (t == NULL) {
+				break;
+			}
+
+			t->fn(t);
+		}
 	}
 
 	LOCKED(&timeout_lock) {
@@ -169,9 +548,9 @@ s32_t _get_next_timeout_expiry(void)
 	int maxw = can_wait_forever ? K_FOREVER : INT_MAX;
 
 	LOCKED(&timeout_lock) {
-		struct _timeout *to = first();
+		s32_t to = next_expiry_ticks();
 
-		ret = to == NULL ? maxw : max(0, to->dticks - elapsed());
+		ret = to < 0 ? maxw : max(0, to - elapsed());
 	}
 
 #ifdef CONFIG_TIMESLICING
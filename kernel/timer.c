@@ -47,46 +47,40 @@ void _timer_expiration_handler(struct _timeout *t)
 {
 	struct k_timer *timer = CONTAINER_OF(t, struct k_timer, timeout);
 	struct k_thread *thread;
-	unsigned int key;
+	k_spinlock_key_t key;
 
 	/*
 	 * if the timer is periodic, start it again; don't add _TICK_ALIGN
 	 * since we're already aligned to a tick boundary
 	 */
 	if (timer->period > 0) {
-		key = irq_lock();
 		_add_timeout(&timer->timeout, _timer_expiration_handler,
 			     timer->period);
-		irq_unlock(key);
 	}
 
 	/* update timer's status */
+	key = k_spin_lock(&timer->lock);
 	timer->status += 1;
+	k_spin_unlock(&timer->lock, key);
 
 	/* invoke timer expiry function */
 	if (timer->expiry_fn) {
 		timer->expiry_fn(timer);
 	}
 
-	thread = _waitq_head(&timer->wait_q);
+	/*
+	 * The status update above is ordered against the check made by
+	 * k_timer_status_sync() under the timer lock, so a thread is
+	 * either already on the wait queue here or will see the new
+	 * status and not pend at all.
+	 */
+	thread = _unpend1_no_timeout(&timer->wait_q);
 
 	if (thread == NULL) {
 		return;
 	}
 
-	/*
-	 * Interrupts _DO NOT_ have to be locked in this specific
-	 * instance of thread unpending because a) this is the only
-	 * place a thread can be taken off this pend queue, and b) the
-	 * only place a thread can be put on the pend queue is at
-	 * thread level, which of course cannot interrupt the current
-	 * context.
-	 */
-	_unpend_thread_no_timeout(thread);
-
-	key = irq_lock();
 	_ready_thread(thread);
-	irq_unlock(key);
 
 	_set_thread_return_value(thread, 0);
 }
@@ -99,6 +93,7 @@ void k_timer_init(struct k_timer *timer,
 	timer->expiry_fn = expiry_fn;
 	timer->stop_fn = stop_fn;
 	timer->status = 0;
+	timer->lock = (struct k_spinlock) {};
 
 	_waitq_init(&timer->wait_q);
 	_init_timeout(&timer->timeout, _timer_expiration_handler);
@@ -120,14 +115,14 @@ void _impl_k_timer_start(struct k_timer *timer, s32_t duration, s32_t period)
 	period_in_ticks = _ms_to_ticks(period);
 	duration_in_ticks = _ms_to_ticks(duration);
 
-	unsigned int key = irq_lock();
+	k_spinlock_key_t key = k_spin_lock(&timer->lock);
 
 	(void)_abort_timeout(&timer->timeout);
 	timer->period = period_in_ticks;
 	timer->status = 0;
 	_add_timeout(&timer->timeout, _timer_expiration_handler,
 		     duration_in_ticks);
-	irq_unlock(key);
+	k_spin_unlock(&timer->lock, key);
 }
 
 #ifdef CONFIG_USERSPACE
@@ -148,11 +143,8 @@ Z_SYSCALL_HANDLER(k_timer_start, timer, duration_p, period_p)
 
 void _impl_k_timer_stop(struct k_timer *timer)
 {
-	unsigned int key = irq_lock();
 	int inactive = (_abort_timeout(&timer->timeout) == _INACTIVE);
 
-	irq_unlock(key);
-
 	if (inactive) {
 		return;
 	}
@@ -161,7 +153,7 @@ void _impl_k_timer_stop(struct k_timer *timer)
 		timer->stop_fn(timer);
 	}
 
-	key = irq_lock();
+	k_spinlock_key_t key = k_spin_lock(&timer->lock);
 	struct k_thread *pending_thread = _unpend1_no_timeout(&timer->wait_q);
 
 	if (pending_thread != NULL) {
@@ -169,9 +161,9 @@ void _impl_k_timer_stop(struct k_timer *timer)
 	}
 
 	if (_is_in_isr()) {
-		irq_unlock(key);
+		k_spin_unlock(&timer->lock, key);
 	} else {
-		_reschedule(key);
+		_reschedule(&timer->lock, key);
 	}
 }
 
@@ -181,11 +173,11 @@ Z_SYSCALL_HANDLER1_SIMPLE_VOID(k_timer_stop, K_OBJ_TIMER, struct k_timer *);
 
 u32_t _impl_k_timer_status_get(struct k_timer *timer)
 {
-	unsigned int key = irq_lock();
+	k_spinlock_key_t key = k_spin_lock(&timer->lock);
 	u32_t result = timer->status;
 
 	timer->status = 0;
-	irq_unlock(key);
+	k_spin_unlock(&timer->lock, key);
 
 	return result;
 }
@@ -198,16 +190,17 @@ u32_t _impl_k_timer_status_sync(struct k_timer *timer)
 {
 	__ASSERT(!_is_in_isr(), "");
 
-	unsigned int key = irq_lock();
+	k_spinlock_key_t key = k_spin_lock(&timer->lock);
 	u32_t result = timer->status;
 
 	if (result == 0) {
 		if (timer->timeout.dticks != _INACTIVE) {
 			/* wait for timer to expire or stop */
-			(void)_pend_current_thread(key, &timer->wait_q, K_FOREVER);
+			(void)_pend_curr(&timer->lock, key, &timer->wait_q,
+					 K_FOREVER);
 
 			/* get updated timer status */
-			key = irq_lock();
+			key = k_spin_lock(&timer->lock);
 			result = timer->status;
 		} else {
 			/* timer is already stopped */
@@ -217,7 +210,7 @@ u32_t _impl_k_timer_status_sync(struct k_timer *timer)
 	}
 
 	timer->status = 0;
-	irq_unlock(key);
+	k_spin_unlock(&timer->lock, key);
 
 	return result;
 }
@@ -36,6 +36,22 @@ extern u8_t _thread_idx_map[CONFIG_MAX_THREAD_BYTES];
 
 static void clear_perms_cb(struct _k_object *ko, void *ctx_ptr);
 
+#if CONFIG_KOBJECT_CACHE_SIZE > 0
+/* Bumped whenever an object is freed, flushing all the threads' object
+ * caches, as its memory may come back as another object.
+ */
+static u32_t kobj_cache_gen;
+
+static inline void kobj_cache_invalidate(void)
+{
+	kobj_cache_gen++;
+}
+#else
+static inline void kobj_cache_invalidate(void)
+{
+}
+#endif
+
 const char *otype_to_str(enum k_objects otype)
 {
 	const char *ret;
@@ -272,6 +288,7 @@ void k_object_free(void *obj)
 	if (dyn_obj != NULL) {
 		rb_remove(&obj_rb_tree, &dyn_obj->node);
 		sys_dlist_remove(&dyn_obj->obj_list);
+		kobj_cache_invalidate();
 
 		if (dyn_obj->kobj.type == K_OBJ_THREAD) {
 			_thread_idx_free(dyn_obj->kobj.data);
@@ -330,6 +347,53 @@ static int thread_index_get(struct k_thread *t)
 	return ko->data;
 }
 
+#if CONFIG_KOBJECT_CACHE_SIZE > 0
+struct _k_object *z_object_find_cached(void *obj)
+{
+	struct _k_object_cache *cache = &_current->kobj_cache;
+	struct _k_object_cache_entry *entry;
+	struct _k_object *ko;
+
+	if (cache->gen != kobj_cache_gen) {
+		(void)memset(cache->entries, 0, sizeof(cache->entries));
+		cache->gen = kobj_cache_gen;
+	}
+
+	entry = &cache->entries[((uintptr_t)obj / sizeof(void *)) %
+				CONFIG_KOBJECT_CACHE_SIZE];
+	if (entry->obj == obj && entry->ko != NULL) {
+		return entry->ko;
+	}
+
+	ko = _k_object_find(obj);
+	if (ko != NULL) {
+		entry->obj = obj;
+		entry->ko = ko;
+	}
+
+	return ko;
+}
+
+void z_object_cache_reset(struct k_thread *thread)
+{
+	(void)memset(&thread->kobj_cache, 0, sizeof(thread->kobj_cache));
+}
+#endif
+
+/* Only valid in system call context, see z_object_find_cached() */
+static int current_index_get(void)
+{
+	struct _k_object *ko;
+
+	ko = z_object_find_cached(_current);
+
+	if (ko == NULL) {
+		return -1;
+	}
+
+	return ko->data;
+}
+
 static void unref_check(struct _k_object *ko)
 {
 	for (int i = 0; i < CONFIG_MAX_THREAD_BYTES; i++) {
@@ -364,6 +428,7 @@ static void unref_check(struct _k_object *ko)
 			CONTAINER_OF(ko, struct dyn_obj, kobj);
 		rb_remove(&obj_rb_tree, &dyn_obj->node);
 		sys_dlist_remove(&dyn_obj->obj_list);
+		kobj_cache_invalidate();
 		k_free(dyn_obj);
 	}
 #endif
@@ -441,7 +506,7 @@ static int thread_perms_test(struct _k_object *ko)
 		return 1;
 	}
 
-	index = thread_index_get(_current);
+	index = current_index_get();
 	if (index != -1) {
 		return sys_bitfield_test_bit((mem_addr_t)&ko->perms, index);
 	}
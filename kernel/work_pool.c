@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ *
+ * Work pools: several worker threads draining a shared queue
+ */
+
+#include <kernel.h>
+#include <kernel_structs.h>
+#include <wait_q.h>
+#include <ksched.h>
+#include <misc/__assert.h>
+
+#define WORK_POOL_THREAD_NAME	"workpool"
+
+/* Called with the pool lock held */
+static void enqueue(struct k_work_pool *pool, struct k_pool_work *work)
+{
+	sys_slist_append(&pool->queues[work->prio], &work->node);
+	pool->ready |= BIT(work->prio);
+
+	pool->stats.queued++;
+	if (pool->stats.queued > pool->stats.max_queued) {
+		pool->stats.max_queued = pool->stats.queued;
+	}
+}
+
+/* Called with the pool lock held */
+static struct k_pool_work *dequeue(struct k_work_pool *pool)
+{
+	struct k_pool_work *work;
+	int prio;
+
+	if (pool->ready == 0) {
+		return NULL;
+	}
+
+	prio = find_lsb_set(pool->ready) - 1;
+	work = CONTAINER_OF(sys_slist_get_not_empty(&pool->queues[prio]),
+			    struct k_pool_work, node);
+	if (sys_slist_is_empty(&pool->queues[prio])) {
+		pool->ready &= ~BIT(prio);
+	}
+
+	pool->stats.queued--;
+
+	return work;
+}
+
+void k_work_pool_submit(struct k_work_pool *pool, struct k_pool_work *work)
+{
+	k_spinlock_key_t key = k_spin_lock(&pool->lock);
+	struct k_work_domain *domain = work->domain;
+	struct k_thread *thread;
+
+	if (work->pending) {
+		k_spin_unlock(&pool->lock, key);
+		return;
+	}
+
+	work->pending = true;
+#ifdef CONFIG_WORK_POOL_STATS
+	work->submit_cycles = k_cycle_get_32();
+#endif
+
+	if (domain != NULL && domain->busy) {
+		/* queued when the domain's previous items have run */
+		sys_slist_append(&domain->backlog, &work->node);
+		pool->stats.queued++;
+		if (pool->stats.queued > pool->stats.max_queued) {
+			pool->stats.max_queued = pool->stats.queued;
+		}
+		k_spin_unlock(&pool->lock, key);
+		return;
+	}
+
+	if (domain != NULL) {
+		domain->busy = true;
+	}
+	enqueue(pool, work);
+
+	thread = _unpend_first_thread(&pool->wait_q);
+	if (thread != NULL) {
+		_set_thread_return_value(thread, 0);
+		_ready_thread(thread);
+		_reschedule(&pool->lock, key);
+	} else {
+		k_spin_unlock(&pool->lock, key);
+	}
+}
+
+static void work_pool_main(void *pool_ptr, void *p2, void *p3)
+{
+	struct k_work_pool *pool = pool_ptr;
+	struct k_pool_work *work;
+	struct k_work_domain *domain;
+	k_spinlock_key_t key;
+#ifdef CONFIG_WORK_POOL_STATS
+	u32_t start, wait, run;
+#endif
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		key = k_spin_lock(&pool->lock);
+
+		work = dequeue(pool);
+		if (work == NULL) {
+			(void)_pend_curr(&pool->lock, key, &pool->wait_q,
+					 K_FOREVER);
+			continue;
+		}
+
+		/* Reset pending state so it can be resubmitted by handler,
+		 * and save what is needed after the handler, which may
+		 * free the item.
+		 */
+		work->pending = false;
+		domain = work->domain;
+
+#ifdef CONFIG_WORK_POOL_STATS
+		start = k_cycle_get_32();
+		wait = start - work->submit_cycles;
+		pool->stats.total_wait_cycles += wait;
+		if (wait > pool->stats.max_wait_cycles) {
+			pool->stats.max_wait_cycles = wait;
+		}
+#endif
+
+		k_spin_unlock(&pool->lock, key);
+
+		work->handler(work);
+
+		key = k_spin_lock(&pool->lock);
+
+#ifdef CONFIG_WORK_POOL_STATS
+		run = k_cycle_get_32() - start;
+		pool->stats.total_run_cycles += run;
+		if (run > pool->stats.max_run_cycles) {
+			pool->stats.max_run_cycles = run;
+		}
+#endif
+		pool->stats.completed++;
+
+		if (domain != NULL) {
+			sys_snode_t *next = sys_slist_get(&domain->backlog);
+
+			if (next != NULL) {
+				/* this thread picks it up, or another
+				 * idle one
+				 */
+				pool->stats.queued--;
+				enqueue(pool, CONTAINER_OF(next,
+							   struct k_pool_work,
+							   node));
+			} else {
+				domain->busy = false;
+			}
+		}
+
+		k_spin_unlock(&pool->lock, key);
+
+		/* Make sure we don't hog up the CPU if the queue never (or
+		 * very rarely) gets empty.
+		 */
+		k_yield();
+	}
+}
+
+void k_work_pool_start(struct k_work_pool *pool, int prio, u32_t options)
+{
+	size_t stride = K_THREAD_STACK_LEN(pool->stack_size);
+	k_thread_stack_t *stack;
+	int i;
+
+	for (i = 0; i < CONFIG_WORK_POOL_PRIORITIES; i++) {
+		sys_slist_init(&pool->queues[i]);
+	}
+	pool->ready = 0;
+	_waitq_init(&pool->wait_q);
+
+	for (i = 0; i < pool->num_threads; i++) {
+		stack = (k_thread_stack_t *)((char *)pool->stacks +
+					     i * stride);
+
+		(void)k_thread_create(&pool->threads[i], stack,
+				      pool->stack_size, work_pool_main, pool,
+				      NULL, NULL, prio, 0, K_FOREVER);
+		k_thread_name_set(&pool->threads[i], WORK_POOL_THREAD_NAME);
+
+#ifdef CONFIG_SCHED_PER_CPU_RUNQ
+		if (options & K_WORK_POOL_PER_CPU) {
+			k_thread_cpu_mask_clear(&pool->threads[i]);
+			k_thread_cpu_mask_enable(&pool->threads[i],
+						 i % CONFIG_MP_NUM_CPUS);
+		}
+#else
+		ARG_UNUSED(options);
+#endif
+
+		k_thread_start(&pool->threads[i]);
+	}
+}
+
+void k_work_pool_stats_get(struct k_work_pool *pool,
+			   struct k_work_pool_stats *stats)
+{
+	k_spinlock_key_t key = k_spin_lock(&pool->lock);
+
+	*stats = pool->stats;
+
+	k_spin_unlock(&pool->lock, key);
+}
+
+void k_work_pool_stats_reset(struct k_work_pool *pool)
+{
+	k_spinlock_key_t key = k_spin_lock(&pool->lock);
+
+	pool->stats = (struct k_work_pool_stats) {
+		.queued = pool->stats.queued,
+		.max_queued = pool->stats.queued,
+	};
+
+	k_spin_unlock(&pool->lock, key);
+}
@@ -92,8 +92,8 @@ int k_delayed_work_submit_to_queue(struct k_work_q *work_q,
 		goto done;
 	}
 
-	/* Cancel if work has been submitted */
-	if (work->work_q == work_q) {
+	/* Cancel if work has already been queued */
+	if (work->work_q == work_q && k_work_pending(&work->work)) {
 		err = k_delayed_work_cancel(work);
 		if (err < 0) {
 			goto done;
@@ -105,11 +105,12 @@ int k_delayed_work_submit_to_queue(struct k_work_q *work_q,
 
 	if (!delay) {
 		/* Submit work if no ticks is 0 */
+		(void)_abort_timeout(&work->timeout);
 		k_work_submit_to_queue(work_q, &work->work);
 	} else {
-		/* Add timeout */
-		_add_timeout(&work->timeout, work_timeout,
-			     _TICK_ALIGN + _ms_to_ticks(delay));
+		/* Add timeout, or move it if the countdown is running */
+		z_timeout_reschedule(&work->timeout, work_timeout,
+				     _TICK_ALIGN + _ms_to_ticks(delay));
 	}
 
 	err = 0;
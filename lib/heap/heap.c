@@ -0,0 +1,520 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <kernel.h>
+#include <string.h>
+#include <misc/__assert.h>
+#include <misc/heap.h>
+
+/*
+ * The buffer is handled in 8 byte chunks, which blocks are made of and
+ * which are addressed by their index from the start of the buffer.  The
+ * first chunks hold struct z_heap, the last one is a permanently used
+ * end marker, and blocks tile the space in between.
+ *
+ * Every block starts with a one chunk header: its size in chunks, with
+ * the "used" flag in the low bit, and the size of the block before it,
+ * so that a freed block can find both of its neighbors.  Free blocks
+ * keep the indices of the next and previous blocks of their free list
+ * in their first two words after the header, so the smallest block is
+ * two chunks.
+ *
+ * Free lists are circular and indexed by size class (see bucket_of()),
+ * with bitmaps of the non-empty ones.  Index 0 is the heap header, so
+ * never a block, and stands for an empty list.
+ */
+
+#define CHUNK_SIZE Z_HEAP_CHUNK_SIZE
+#define SL_LOG2 Z_HEAP_SL_LOG2
+#define SL_COUNT BIT(SL_LOG2)
+#define MIN_CHUNKS 2
+
+typedef u32_t chunkid_t;
+
+struct z_heap_bucket {
+	u32_t sl_bitmap;
+	chunkid_t heads[SL_COUNT];
+};
+
+struct z_heap {
+	/* chunk index of the end marker */
+	chunkid_t end;
+	u32_t fl_bitmap;
+	u32_t allocated;
+	u32_t max_allocated;
+	struct z_heap_bucket buckets[];
+};
+
+BUILD_ASSERT(sizeof(struct z_heap) == Z_HEAP_HDR_BYTES);
+BUILD_ASSERT(sizeof(struct z_heap_bucket) == Z_HEAP_BUCKET_BYTES);
+
+enum chunk_fields { SIZE_AND_USED, LEFT_SIZE, FREE_NEXT, FREE_PREV };
+
+static inline u32_t *chunk_word(struct z_heap *h, chunkid_t c, int f)
+{
+	return &((u32_t *)h)[c * (CHUNK_SIZE / 4) + f];
+}
+
+static inline u32_t chunk_size(struct z_heap *h, chunkid_t c)
+{
+	return *chunk_word(h, c, SIZE_AND_USED) >> 1;
+}
+
+static inline bool chunk_used(struct z_heap *h, chunkid_t c)
+{
+	return (*chunk_word(h, c, SIZE_AND_USED) & 1) != 0;
+}
+
+static inline u32_t left_size(struct z_heap *h, chunkid_t c)
+{
+	return *chunk_word(h, c, LEFT_SIZE);
+}
+
+static inline chunkid_t right_chunk(struct z_heap *h, chunkid_t c)
+{
+	return c + chunk_size(h, c);
+}
+
+static inline chunkid_t left_chunk(struct z_heap *h, chunkid_t c)
+{
+	return c - left_size(h, c);
+}
+
+/* Sets the header of a block, and the left size of the one after it */
+static void set_chunk(struct z_heap *h, chunkid_t c, u32_t size, bool used)
+{
+	*chunk_word(h, c, SIZE_AND_USED) = (size << 1) | (used ? 1 : 0);
+	*chunk_word(h, c + size, LEFT_SIZE) = size;
+}
+
+static inline void *chunk_mem(struct z_heap *h, chunkid_t c)
+{
+	return (u8_t *)h + (c + 1) * CHUNK_SIZE;
+}
+
+static inline chunkid_t mem_chunk(struct z_heap *h, void *mem)
+{
+	return ((u8_t *)mem - (u8_t *)h) / CHUNK_SIZE - 1;
+}
+
+/* Chunks needed for a block of the given number of bytes */
+static inline u32_t bytes_to_chunks(size_t bytes)
+{
+	u32_t n = 1 + (bytes + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+	return max(n, MIN_CHUNKS);
+}
+
+static inline int msb(u32_t n)
+{
+	return 31 - __builtin_clz(n);
+}
+
+/* First level: the power of two below the size, second level: which
+ * quarter of the range up to the next one.  The smallest sizes all go
+ * in the first level 0 lists.
+ */
+static void bucket_of(u32_t size, int *fl, int *sl)
+{
+	if (size < SL_COUNT) {
+		*fl = 0;
+		*sl = size;
+	} else {
+		int m = msb(size);
+
+		*fl = m - SL_LOG2 + 1;
+		*sl = (size >> (m - SL_LOG2)) - SL_COUNT;
+	}
+}
+
+static int bucket_count(u32_t chunks)
+{
+	int fl, sl;
+
+	bucket_of(chunks, &fl, &sl);
+
+	return fl + 1;
+}
+
+/* Chunks taken by struct z_heap, which the first block follows */
+static u32_t hdr_chunks(struct z_heap *h)
+{
+	return ROUND_UP(sizeof(struct z_heap) + bucket_count(h->end) *
+			sizeof(struct z_heap_bucket), CHUNK_SIZE) / CHUNK_SIZE;
+}
+
+static void free_list_add(struct z_heap *h, chunkid_t c)
+{
+	struct z_heap_bucket *b;
+	chunkid_t *head;
+	int fl, sl;
+
+	bucket_of(chunk_size(h, c), &fl, &sl);
+	b = &h->buckets[fl];
+	head = &b->heads[sl];
+
+	if (*head == 0) {
+		*chunk_word(h, c, FREE_NEXT) = c;
+		*chunk_word(h, c, FREE_PREV) = c;
+		b->sl_bitmap |= BIT(sl);
+		h->fl_bitmap |= BIT(fl);
+	} else {
+		chunkid_t next = *head;
+		chunkid_t prev = *chunk_word(h, next, FREE_PREV);
+
+		*chunk_word(h, c, FREE_NEXT) = next;
+		*chunk_word(h, c, FREE_PREV) = prev;
+		*chunk_word(h, prev, FREE_NEXT) = c;
+		*chunk_word(h, next, FREE_PREV) = c;
+	}
+
+	*head = c;
+}
+
+static void free_list_remove(struct z_heap *h, chunkid_t c)
+{
+	struct z_heap_bucket *b;
+	chunkid_t *head;
+	chunkid_t next = *chunk_word(h, c, FREE_NEXT);
+	chunkid_t prev = *chunk_word(h, c, FREE_PREV);
+	int fl, sl;
+
+	bucket_of(chunk_size(h, c), &fl, &sl);
+	b = &h->buckets[fl];
+	head = &b->heads[sl];
+
+	if (next == c) {
+		*head = 0;
+		b->sl_bitmap &= ~BIT(sl);
+		if (b->sl_bitmap == 0) {
+			h->fl_bitmap &= ~BIT(fl);
+		}
+	} else {
+		*chunk_word(h, prev, FREE_NEXT) = next;
+		*chunk_word(h, next, FREE_PREV) = prev;
+		if (*head == c) {
+			*head = next;
+		}
+	}
+}
+
+/* Returns a free block of at least size chunks, or 0 */
+static chunkid_t find_free(struct z_heap *h, u32_t size)
+{
+	int nb = bucket_count(h->end);
+	u32_t rounded = size;
+	u32_t bits;
+	int fl, sl;
+
+	/* Look from the next class up, where any block will do */
+	if (size >= SL_COUNT) {
+		rounded += BIT(msb(size) - SL_LOG2) - 1;
+	}
+	bucket_of(rounded, &fl, &sl);
+
+	if (fl < nb) {
+		bits = h->buckets[fl].sl_bitmap & (~0U << sl);
+		if (bits == 0 && fl + 1 < 32) {
+			u32_t fl_bits = h->fl_bitmap & (~0U << (fl + 1));
+
+			if (fl_bits != 0) {
+				fl = __builtin_ctz(fl_bits);
+				bits = h->buckets[fl].sl_bitmap;
+			}
+		}
+
+		if (bits != 0) {
+			sl = __builtin_ctz(bits);
+			return h->buckets[fl].heads[sl];
+		}
+	}
+
+	/* Last resort: some blocks of the requested class may fit */
+	bucket_of(size, &fl, &sl);
+	if (fl < nb && (h->buckets[fl].sl_bitmap & BIT(sl)) != 0) {
+		chunkid_t first = h->buckets[fl].heads[sl];
+		chunkid_t c = first;
+
+		do {
+			if (chunk_size(h, c) >= size) {
+				return c;
+			}
+			c = *chunk_word(h, c, FREE_NEXT);
+		} while (c != first);
+	}
+
+	return 0;
+}
+
+/* Keeps the first size chunks of block c, if the rest can make a
+ * block, which is freed and merged with the block after it if free.
+ */
+static void split_chunk(struct z_heap *h, chunkid_t c, u32_t size)
+{
+	u32_t rest = chunk_size(h, c) - size;
+	chunkid_t r = c + size;
+	chunkid_t rr;
+
+	if (rest < MIN_CHUNKS) {
+		return;
+	}
+
+	rr = r + rest;
+	if (!chunk_used(h, rr)) {
+		free_list_remove(h, rr);
+		rest += chunk_size(h, rr);
+	}
+
+	set_chunk(h, c, size, chunk_used(h, c));
+	set_chunk(h, r, rest, false);
+	free_list_add(h, r);
+}
+
+static void account(struct z_heap *h, s32_t delta)
+{
+	h->allocated += delta;
+	if (h->allocated > h->max_allocated) {
+		h->max_allocated = h->allocated;
+	}
+}
+
+void sys_heap_init(struct sys_heap *heap, void *mem, size_t bytes)
+{
+	uintptr_t start = ROUND_UP(mem, CHUNK_SIZE);
+	uintptr_t end = ROUND_DOWN((uintptr_t)mem + bytes, CHUNK_SIZE);
+	struct z_heap *h = (struct z_heap *)start;
+	u32_t chunks = (end - start) / CHUNK_SIZE;
+	chunkid_t first;
+
+	__ASSERT(end > start + 2 * sizeof(struct z_heap),
+		 "heap buffer too small");
+
+	h->end = chunks - 1;
+	first = hdr_chunks(h);
+
+	__ASSERT(h->end >= first + MIN_CHUNKS, "heap buffer too small");
+
+	(void)memset(&h->fl_bitmap, 0,
+		     first * CHUNK_SIZE - offsetof(struct z_heap, fl_bitmap));
+
+	/* the end marker, with a left size set by set_chunk() below */
+	*chunk_word(h, h->end, SIZE_AND_USED) = (1 << 1) | 1;
+
+	set_chunk(h, first, h->end - first, false);
+	*chunk_word(h, first, LEFT_SIZE) = 0;
+	free_list_add(h, first);
+
+	heap->heap = h;
+	heap->init_mem = mem;
+	heap->init_bytes = bytes;
+}
+
+void *sys_heap_alloc(struct sys_heap *heap, size_t bytes)
+{
+	struct z_heap *h = heap->heap;
+	u32_t size;
+	chunkid_t c;
+
+	if (bytes == 0 || bytes >= h->end * CHUNK_SIZE) {
+		return NULL;
+	}
+
+	size = bytes_to_chunks(bytes);
+	c = find_free(h, size);
+	if (c == 0) {
+		return NULL;
+	}
+
+	free_list_remove(h, c);
+	set_chunk(h, c, chunk_size(h, c), true);
+	split_chunk(h, c, size);
+	account(h, chunk_size(h, c));
+
+	return chunk_mem(h, c);
+}
+
+void sys_heap_free(struct sys_heap *heap, void *mem)
+{
+	struct z_heap *h = heap->heap;
+	chunkid_t c, r;
+	u32_t size;
+
+	if (mem == NULL) {
+		return;
+	}
+
+	c = mem_chunk(h, mem);
+	__ASSERT(chunk_used(h, c), "%p is not an allocated block", mem);
+
+	size = chunk_size(h, c);
+	account(h, -(s32_t)size);
+
+	r = c + size;
+	if (!chunk_used(h, r)) {
+		free_list_remove(h, r);
+		size += chunk_size(h, r);
+	}
+
+	/* the first block has no left neighbor, which its left size says */
+	if (left_size(h, c) != 0 && !chunk_used(h, left_chunk(h, c))) {
+		c = left_chunk(h, c);
+		free_list_remove(h, c);
+		size += chunk_size(h, c);
+	}
+
+	set_chunk(h, c, size, false);
+	free_list_add(h, c);
+}
+
+void *sys_heap_realloc(struct sys_heap *heap, void *mem, size_t bytes)
+{
+	struct z_heap *h = heap->heap;
+	u32_t size, cur;
+	chunkid_t c, r;
+	void *new_mem;
+
+	if (mem == NULL) {
+		return sys_heap_alloc(heap, bytes);
+	}
+
+	if (bytes == 0) {
+		sys_heap_free(heap, mem);
+		return NULL;
+	}
+
+	if (bytes >= h->end * CHUNK_SIZE) {
+		return NULL;
+	}
+
+	c = mem_chunk(h, mem);
+	size = bytes_to_chunks(bytes);
+	cur = chunk_size(h, c);
+
+	if (size <= cur) {
+		split_chunk(h, c, size);
+		account(h, (s32_t)chunk_size(h, c) - (s32_t)cur);
+		return mem;
+	}
+
+	r = c + cur;
+	if (!chunk_used(h, r) && cur + chunk_size(h, r) >= size) {
+		free_list_remove(h, r);
+		set_chunk(h, c, cur + chunk_size(h, r), true);
+		split_chunk(h, c, size);
+		account(h, (s32_t)chunk_size(h, c) - (s32_t)cur);
+		return mem;
+	}
+
+	new_mem = sys_heap_alloc(heap, bytes);
+	if (new_mem != NULL) {
+		(void)memcpy(new_mem, mem, (cur - 1) * CHUNK_SIZE);
+		sys_heap_free(heap, mem);
+	}
+
+	return new_mem;
+}
+
+size_t sys_heap_usable_size(struct sys_heap *heap, void *mem)
+{
+	struct z_heap *h = heap->heap;
+
+	return (chunk_size(h, mem_chunk(h, mem)) - 1) * CHUNK_SIZE;
+}
+
+void sys_heap_stats_get(struct sys_heap *heap, struct sys_heap_stats *stats)
+{
+	struct z_heap *h = heap->heap;
+	u32_t largest = 0;
+
+	stats->allocated_bytes = h->allocated * CHUNK_SIZE;
+	stats->max_allocated_bytes = h->max_allocated * CHUNK_SIZE;
+	stats->free_bytes = (h->end - hdr_chunks(h) - h->allocated) *
+			    CHUNK_SIZE;
+
+	if (h->fl_bitmap != 0) {
+		int fl = msb(h->fl_bitmap);
+		int sl = msb(h->buckets[fl].sl_bitmap);
+		chunkid_t first = h->buckets[fl].heads[sl];
+		chunkid_t c = first;
+
+		do {
+			largest = max(largest, chunk_size(h, c));
+			c = *chunk_word(h, c, FREE_NEXT);
+		} while (c != first);
+	}
+
+	stats->largest_free_bytes = largest ? (largest - 1) * CHUNK_SIZE : 0;
+}
+
+bool sys_heap_validate(struct sys_heap *heap)
+{
+	struct z_heap *h = heap->heap;
+	int nb = bucket_count(h->end);
+	u32_t free_chunks = 0, used_chunks = 0;
+	u32_t listed_chunks = 0;
+	chunkid_t c, prev = 0;
+	int fl, sl;
+
+	for (c = hdr_chunks(h); c != h->end; prev = c, c = right_chunk(h, c)) {
+		u32_t size = chunk_size(h, c);
+
+		if (size < MIN_CHUNKS || c + size > h->end) {
+			return false;
+		}
+		if (left_size(h, c) != (prev != 0 ? c - prev : 0)) {
+			return false;
+		}
+		if (chunk_used(h, c)) {
+			used_chunks += size;
+		} else {
+			/* free blocks are always merged */
+			if (prev != 0 && !chunk_used(h, prev)) {
+				return false;
+			}
+			free_chunks += size;
+		}
+	}
+
+	if (left_size(h, h->end) != c - prev || !chunk_used(h, h->end) ||
+	    used_chunks != h->allocated) {
+		return false;
+	}
+
+	for (fl = 0; fl < nb; fl++) {
+		struct z_heap_bucket *b = &h->buckets[fl];
+
+		if (((h->fl_bitmap & BIT(fl)) != 0) != (b->sl_bitmap != 0)) {
+			return false;
+		}
+
+		for (sl = 0; sl < SL_COUNT; sl++) {
+			chunkid_t first = b->heads[sl];
+			int cfl, csl;
+
+			if (((b->sl_bitmap & BIT(sl)) != 0) != (first != 0)) {
+				return false;
+			}
+			if (first == 0) {
+				continue;
+			}
+
+			c = first;
+			do {
+				bucket_of(chunk_size(h, c), &cfl, &csl);
+				if (chunk_used(h, c) ||
+				    cfl != fl || csl != sl ||
+				    *chunk_word(h, *chunk_word(h, c, FREE_NEXT),
+						FREE_PREV) != c) {
+					return false;
+				}
+				listed_chunks += chunk_size(h, c);
+				c = *chunk_word(h, c, FREE_NEXT);
+			} while (c != first);
+		}
+	}
+
+	return listed_chunks == free_chunks;
+}
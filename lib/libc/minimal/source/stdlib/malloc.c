@@ -8,7 +8,7 @@
 #include <zephyr.h>
 #include <init.h>
 #include <errno.h>
-#include <misc/mempool.h>
+#include <misc/heap.h>
 #include <string.h>
 
 #define LOG_LEVEL CONFIG_KERNEL_LOG_LEVEL
@@ -17,15 +17,41 @@ LOG_MODULE_DECLARE(os);
 
 #if (CONFIG_MINIMAL_LIBC_MALLOC_ARENA_SIZE > 0)
 K_MUTEX_DEFINE(malloc_mutex);
-SYS_MEM_POOL_DEFINE(z_malloc_mem_pool, &malloc_mutex, 16,
-		    CONFIG_MINIMAL_LIBC_MALLOC_ARENA_SIZE, 1, 4, .data);
+static char __aligned(8) _GENERIC_SECTION(.data)
+	z_malloc_heap_mem[CONFIG_MINIMAL_LIBC_MALLOC_ARENA_SIZE];
+static _GENERIC_SECTION(.data) struct sys_heap z_malloc_heap;
 
 void *malloc(size_t size)
 {
 	void *ret;
 
-	ret = sys_mem_pool_alloc(&z_malloc_mem_pool, size);
-	if (ret == NULL) {
+	k_mutex_lock(&malloc_mutex, K_FOREVER);
+	ret = sys_heap_alloc(&z_malloc_heap, size);
+	k_mutex_unlock(&malloc_mutex);
+
+	if (ret == NULL && size != 0) {
+		errno = ENOMEM;
+	}
+
+	return ret;
+}
+
+void free(void *ptr)
+{
+	k_mutex_lock(&malloc_mutex, K_FOREVER);
+	sys_heap_free(&z_malloc_heap, ptr);
+	k_mutex_unlock(&malloc_mutex);
+}
+
+void *realloc(void *ptr, size_t requested_size)
+{
+	void *ret;
+
+	k_mutex_lock(&malloc_mutex, K_FOREVER);
+	ret = sys_heap_realloc(&z_malloc_heap, ptr, requested_size);
+	k_mutex_unlock(&malloc_mutex);
+
+	if (ret == NULL && requested_size != 0) {
 		errno = ENOMEM;
 	}
 
@@ -39,7 +65,8 @@ static int malloc_prepare(struct device *unused)
 #ifdef CONFIG_USERSPACE
 	k_object_access_all_grant(&malloc_mutex);
 #endif
-	sys_mem_pool_init(&z_malloc_mem_pool);
+	sys_heap_init(&z_malloc_heap, z_malloc_heap_mem,
+		      CONFIG_MINIMAL_LIBC_MALLOC_ARENA_SIZE);
 
 	return 0;
 }
@@ -55,12 +82,19 @@ void *malloc(size_t size)
 
 	return NULL;
 }
-#endif
 
 void free(void *ptr)
 {
-	sys_mem_pool_free(ptr);
+	ARG_UNUSED(ptr);
+}
+
+void *realloc(void *ptr, size_t requested_size)
+{
+	ARG_UNUSED(ptr);
+
+	return malloc(requested_size);
 }
+#endif
 
 static bool size_t_mul_overflow(size_t a, size_t b, size_t *res)
 {
@@ -92,48 +126,6 @@ void *calloc(size_t nmemb, size_t size)
 	return ret;
 }
 
-void *realloc(void *ptr, size_t requested_size)
-{
-	struct sys_mem_pool_block *blk;
-	size_t block_size, total_requested_size;
-	void *new_ptr;
-
-	if (requested_size == 0) {
-		return NULL;
-	}
-
-	/* Stored right before the pointer passed to the user */
-	blk = (struct sys_mem_pool_block *)((char *)ptr - sizeof(*blk));
-
-	/* Determine size of previously allocated block by its level.
-	 * Most likely a bit larger than the original allocation
-	 */
-	block_size = _ALIGN4(blk->pool->base.max_sz);
-	for (int i = 1; i <= blk->level; i++) {
-		block_size = _ALIGN4(block_size / 4);
-	}
-
-	/* We really need this much memory */
-	total_requested_size = requested_size +
-		sizeof(struct sys_mem_pool_block);
-
-	if (block_size >= total_requested_size) {
-		/* Existing block large enough, nothing to do */
-		return ptr;
-	}
-
-	new_ptr = malloc(requested_size);
-	if (new_ptr == NULL) {
-		return NULL;
-	}
-
-	memcpy(new_ptr, ptr, block_size - sizeof(struct sys_mem_pool_block));
-	free(ptr);
-
-	return new_ptr;
-}
-
-
 void *reallocarray(void *ptr, size_t nmemb, size_t size)
 {
 	if (size_t_mul_overflow(nmemb, size, &size)) {
@@ -39,20 +39,25 @@ static int get_bit_ptr(struct sys_mem_pool_base *p, int level, int bn,
 	return bn & 0x1f;
 }
 
-static void set_free_bit(struct sys_mem_pool_base *p, int level, int bn)
+/* Sets the free bits of the blocks in partners, a mask of block bn and
+ * its three partners in its bottom 4 bits, with a single word update
+ */
+static void set_free_bits(struct sys_mem_pool_base *p, int level, int bn,
+			  u32_t partners)
 {
 	u32_t *word;
-	int bit = get_bit_ptr(p, level, bn, &word);
+	int bit = get_bit_ptr(p, level, bn & ~3, &word);
 
-	*word |= (1<<bit);
+	*word |= partners << bit;
 }
 
-static void clear_free_bit(struct sys_mem_pool_base *p, int level, int bn)
+static void clear_free_bits(struct sys_mem_pool_base *p, int level, int bn,
+			    u32_t partners)
 {
 	u32_t *word;
-	int bit = get_bit_ptr(p, level, bn, &word);
+	int bit = get_bit_ptr(p, level, bn & ~3, &word);
 
-	*word &= ~(1<<bit);
+	*word &= ~(partners << bit);
 }
 
 /* Returns all four of the free bits for the specified blocks
@@ -103,7 +108,7 @@ void _sys_mem_pool_base_init(struct sys_mem_pool_base *p)
 		void *block = block_ptr(p, p->max_sz, i);
 
 		sys_dlist_append(&p->levels[0].free_list, block);
-		set_free_bit(p, 0, i);
+		set_free_bits(p, 0, i, BIT(i & 3));
 	}
 }
 
@@ -115,10 +120,16 @@ void _sys_mem_pool_base_init(struct sys_mem_pool_base *p)
  * pointer that is marked used in the store and one where she doesn't (or else
  * they will fail, e.g. if there isn't a free block).  So that is the basic
  * operation that needs synchronization, which we can do piecewise as needed in
- * small one-block chunks to preserve latency.  At most (in free_block) a
- * single locked operation consists of four bit sets and dlist removals. If the
- * overall allocation operation fails, we just free the block we have (putting
- * a block back into the list cannot fail) and return failure.
+ * small one-block chunks to preserve latency.  If the overall allocation
+ * operation fails, we just free the block we have (putting a block back into
+ * the list cannot fail) and return failure.
+ *
+ * Each locked section touches a single level, and block addresses are
+ * computed before taking the lock, so interrupts are never locked for
+ * more than one update of a free bit word and at most three dlist
+ * operations (in block_free() when merging, or block_break()),
+ * whatever the size of the pool or the level of the block.  A large
+ * split or merge is made of several such sections, one per level.
  *
  * For user mode compatible sys_mem_pool pools, a semaphore is used at the API
  * level since using that does not introduce latency issues like locking
@@ -127,8 +138,14 @@ void _sys_mem_pool_base_init(struct sys_mem_pool_base *p)
 
 static inline int pool_irq_lock(struct sys_mem_pool_base *p)
 {
+	int key;
+
 	if (p->flags & SYS_MEM_POOL_KERNEL) {
-		return irq_lock();
+		key = irq_lock();
+#ifdef CONFIG_MEM_POOL_IRQ_LOCK_STATS
+		p->lock_start = k_cycle_get_32();
+#endif
+		return key;
 	} else {
 		return 0;
 	}
@@ -137,6 +154,13 @@ static inline int pool_irq_lock(struct sys_mem_pool_base *p)
 static inline void pool_irq_unlock(struct sys_mem_pool_base *p, int key)
 {
 	if (p->flags & SYS_MEM_POOL_KERNEL) {
+#ifdef CONFIG_MEM_POOL_IRQ_LOCK_STATS
+		u32_t held = k_cycle_get_32() - p->lock_start;
+
+		if (held > p->max_lock_cycles) {
+			p->max_lock_cycles = held;
+		}
+#endif
 		irq_unlock(key);
 	}
 }
@@ -148,7 +172,9 @@ static void *block_alloc(struct sys_mem_pool_base *p, int l, size_t lsz)
 
 	block = sys_dlist_get(&p->levels[l].free_list);
 	if (block != NULL) {
-		clear_free_bit(p, l, block_num(p, block, lsz));
+		int bn = block_num(p, block, lsz);
+
+		clear_free_bits(p, l, bn, BIT(bn & 3));
 	}
 	pool_irq_unlock(p, key);
 
@@ -159,20 +185,23 @@ static void block_free(struct sys_mem_pool_base *p, int level,
 			      size_t *lsizes, int bn)
 {
 	int i, key, lsz = lsizes[level];
-	void *block = block_ptr(p, lsz, bn);
+	void *partners[4];
+	bool fits[4];
+
+	for (i = 0; i < 4; i++) {
+		partners[i] = block_ptr(p, lsz, (bn & ~3) + i);
+		fits[i] = block_fits(p, partners[i], lsz);
+	}
 
 	key = pool_irq_lock(p);
 
-	set_free_bit(p, level, bn);
+	set_free_bits(p, level, bn, BIT(bn & 3));
 
 	if (level && partner_bits(p, level, bn) == 0xf) {
+		clear_free_bits(p, level, bn, 0xf);
 		for (i = 0; i < 4; i++) {
-			int b = (bn & ~3) + i;
-
-			clear_free_bit(p, level, b);
-			if (b != bn &&
-			    block_fits(p, block_ptr(p, lsz, b), lsz)) {
-				sys_dlist_remove(block_ptr(p, lsz, b));
+			if (i != (bn & 3) && fits[i]) {
+				sys_dlist_remove(partners[i]);
 			}
 		}
 
@@ -183,8 +212,9 @@ static void block_free(struct sys_mem_pool_base *p, int level,
 		return;
 	}
 
-	if (block_fits(p, block, lsz)) {
-		sys_dlist_append(&p->levels[level].free_list, block);
+	if (fits[bn & 3]) {
+		sys_dlist_append(&p->levels[level].free_list,
+				 partners[bn & 3]);
 	}
 
 	pool_irq_unlock(p, key);
@@ -198,20 +228,23 @@ static void block_free(struct sys_mem_pool_base *p, int level,
 static void *block_break(struct sys_mem_pool_base *p, void *block, int l,
 				size_t *lsizes)
 {
-	int i, bn, key;
+	int i, key, lsz = lsizes[l + 1];
+	int bn = block_num(p, block, lsizes[l]);
+	void *blocks[4];
+	bool fits[4];
 
-	key = pool_irq_lock(p);
+	for (i = 1; i < 4; i++) {
+		blocks[i] = (lsz * i) + (char *)block;
+		fits[i] = block_fits(p, blocks[i], lsz);
+	}
 
-	bn = block_num(p, block, lsizes[l]);
+	key = pool_irq_lock(p);
 
+	set_free_bits(p, l + 1, 4*bn, 0xe);
 	for (i = 1; i < 4; i++) {
-		int lbn = 4*bn + i;
-		int lsz = lsizes[l + 1];
-		void *block2 = (lsz * i) + (char *)block;
-
-		set_free_bit(p, l + 1, lbn);
-		if (block_fits(p, block2, lsz)) {
-			sys_dlist_append(&p->levels[l + 1].free_list, block2);
+		if (fits[i]) {
+			sys_dlist_append(&p->levels[l + 1].free_list,
+					 blocks[i]);
 		}
 	}
 
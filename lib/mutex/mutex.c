@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <kernel.h>
+#include <misc/mutex.h>
+
+/*
+ * Contended paths of struct sys_mutex, which follow the futex based
+ * mutex of Drepper's "Futexes Are Tricky".  A waiter marks the mutex as
+ * contended before it sleeps, so the holder knows to give the semaphore
+ * when it unlocks, and tries to take the mutex again when woken up.  A
+ * wake-up nobody was waiting for yet stays in the semaphore and at most
+ * costs its taker one more try, so none is ever lost.
+ */
+int z_sys_mutex_lock_contended(struct sys_mutex *mutex, s32_t timeout)
+{
+	u32_t start = 0;
+	s32_t left = timeout;
+
+	if (timeout == K_NO_WAIT) {
+		return -EBUSY;
+	}
+
+	if (timeout != K_FOREVER) {
+		start = k_uptime_get_32();
+	}
+
+	while (atomic_set(&mutex->val, 2) != 0) {
+		if (k_sem_take(mutex->sem, left) != 0) {
+			return -EAGAIN;
+		}
+
+		if (timeout != K_FOREVER) {
+			left = timeout - (s32_t)(k_uptime_get_32() - start);
+			if (left < 0) {
+				left = K_NO_WAIT;
+			}
+		}
+	}
+
+	return 0;
+}
+
+void z_sys_mutex_unlock_contended(struct sys_mutex *mutex)
+{
+	atomic_clear(&mutex->val);
+	k_sem_give(mutex->sem);
+}
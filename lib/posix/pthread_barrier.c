@@ -24,9 +24,9 @@ int pthread_barrier_wait(pthread_barrier_t *b)
 		while (_waitq_head(&b->wait_q)) {
 			_ready_one_thread(&b->wait_q);
 		}
-		_reschedule(key);
+		_reschedule_irqlock(key);
 		return 0;
 	} else {
-		return _pend_current_thread(key, &b->wait_q, K_FOREVER);
+		return _pend_curr_irqlock(key, &b->wait_q, K_FOREVER);
 	}
 }
@@ -18,7 +18,7 @@ static int cond_wait(pthread_cond_t *cv, pthread_mutex_t *mut, int timeout)
 	mut->lock_count = 0;
 	mut->owner = NULL;
 	_ready_one_thread(&mut->wait_q);
-	ret = _pend_current_thread(key, &cv->wait_q, timeout);
+	ret = _pend_curr_irqlock(key, &cv->wait_q, timeout);
 
 	/* FIXME: this extra lock (and the potential context switch it
 	 * can cause) could be optimized out.  At the point of the
@@ -49,7 +49,7 @@ int pthread_cond_signal(pthread_cond_t *cv)
 	int key = irq_lock();
 
 	_ready_one_thread(&cv->wait_q);
-	_reschedule(key);
+	_reschedule_irqlock(key);
 
 	return 0;
 }
@@ -62,7 +62,7 @@ int pthread_cond_broadcast(pthread_cond_t *cv)
 		_ready_one_thread(&cv->wait_q);
 	}
 
-	_reschedule(key);
+	_reschedule_irqlock(key);
 
 	return 0;
 }
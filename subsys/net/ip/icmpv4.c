@@ -108,12 +108,25 @@ static inline enum net_verdict icmpv4_handle_echo_request(struct net_pkt *pkt)
 		log_strdup(net_sprint_ipv4_addr(&NET_IPV4_HDR(pkt)->src)),
 		log_strdup(net_sprint_ipv4_addr(&NET_IPV4_HDR(pkt)->dst)));
 
+	ret = net_icmpv4_get_hdr(pkt, &icmp_hdr);
+	if (ret < 0) {
+		return NET_DROP;
+	}
+
 	net_ipaddr_copy(&addr, &NET_IPV4_HDR(pkt)->src);
 	net_ipaddr_copy(&NET_IPV4_HDR(pkt)->src,
 			net_if_ipv4_select_src_addr(net_pkt_iface(pkt),
 						    &addr));
 	net_ipaddr_copy(&NET_IPV4_HDR(pkt)->dst, &addr);
 
+	/* Only the type and code words of the message change, so its
+	 * checksum is updated instead of computed again over the whole
+	 * payload.
+	 */
+	icmp_hdr.chksum = net_chksum_update16(icmp_hdr.chksum,
+					      htons(icmp_hdr.type << 8 |
+						    icmp_hdr.code),
+					      htons(NET_ICMPV4_ECHO_REPLY << 8));
 	icmp_hdr.type = NET_ICMPV4_ECHO_REPLY;
 	icmp_hdr.code = 0;
 
@@ -122,7 +135,10 @@ static inline enum net_verdict icmpv4_handle_echo_request(struct net_pkt *pkt)
 		return NET_DROP;
 	}
 
-	net_ipv4_finalize(pkt, IPPROTO_ICMP);
+	net_pkt_compact(pkt);
+
+	NET_IPV4_HDR(pkt)->chksum = 0;
+	NET_IPV4_HDR(pkt)->chksum = ~net_calc_chksum_ipv4(pkt);
 
 	NET_DBG("Sending Echo Reply from %s to %s",
 		log_strdup(net_sprint_ipv4_addr(&NET_IPV4_HDR(pkt)->src)),
@@ -173,6 +173,33 @@ static inline u16_t net_calc_chksum_tcp(struct net_pkt *pkt)
 	return net_calc_chksum(pkt, IPPROTO_TCP);
 }
 
+/* Update a checksum, as stored in a header, after a 16-bit word of the
+ * data it covers changed from old_val to new_val (RFC 1624, eqn. 3).
+ * All three values are in network byte order.
+ */
+static inline u16_t net_chksum_update16(u16_t chksum, u16_t old_val,
+					u16_t new_val)
+{
+	u32_t sum = (u16_t)~chksum + (u16_t)~old_val + new_val;
+
+	sum = (sum >> 16) + (sum & 0xffff);
+	sum += sum >> 16;
+
+	return ~sum;
+}
+
+/* Same as net_chksum_update16(), for a 32-bit word such as an IPv4
+ * address.
+ */
+static inline u16_t net_chksum_update32(u16_t chksum, u32_t old_val,
+					u32_t new_val)
+{
+	chksum = net_chksum_update16(chksum, old_val >> 16, new_val >> 16);
+
+	return net_chksum_update16(chksum, old_val & 0xffff,
+				   new_val & 0xffff);
+}
+
 static inline char *net_sprint_ll_addr(const u8_t *ll, u8_t ll_len)
 {
 	static char buf[sizeof("xx:xx:xx:xx:xx:xx:xx:xx")];
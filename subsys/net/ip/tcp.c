@@ -53,6 +53,8 @@ static struct tcp_backlog_entry {
 	struct k_delayed_work ack_timer;
 	struct sockaddr remote;
 	u16_t send_mss;
+	u8_t send_wscale;
+	bool sack_permitted;
 } tcp_backlog[CONFIG_NET_TCP_BACKLOG_SIZE];
 
 #if defined(CONFIG_NET_TCP_ACK_TIMEOUT)
@@ -205,6 +207,148 @@ static void abort_connection(struct net_tcp *tcp)
 	net_context_unref(ctx);
 }
 
+/* Sequence space taken by a segment: its data, plus one for each of
+ * the SYN and FIN flags.
+ */
+static u32_t seq_len(struct net_pkt *pkt, struct net_tcp_hdr *tcp_hdr)
+{
+	u32_t len = net_pkt_appdatalen(pkt);
+
+	if (tcp_hdr->flags & NET_TCP_SYN) {
+		len += 1;
+	}
+	if (tcp_hdr->flags & NET_TCP_FIN) {
+		len += 1;
+	}
+
+	return len;
+}
+
+/* Send a packet of the sent_list, for the first time or again. */
+static int send_queued_pkt(struct net_tcp *tcp, struct net_pkt *pkt)
+{
+	int ret;
+
+	if (net_pkt_sent(pkt)) {
+		do_ref_if_needed(tcp, pkt);
+		net_pkt_set_sent(pkt, false);
+	}
+
+	net_pkt_set_queued(pkt, true);
+
+	ret = net_tcp_send_pkt(pkt);
+	if (ret < 0 && !is_6lo_technology(pkt)) {
+		net_pkt_unref(pkt);
+	}
+
+	return ret;
+}
+
+#if defined(CONFIG_NET_TCP_WINDOW_SCALE)
+static inline u8_t send_wscale(struct net_tcp *tcp)
+{
+	return tcp->send_wscale;
+}
+#else
+#define send_wscale(...) 0
+#endif
+
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+static void cc_init(struct net_tcp *tcp, u32_t wnd)
+{
+	u32_t mss = tcp->send_mss;
+
+	tcp->send_una = tcp->send_seq;
+	tcp->send_max = tcp->send_seq;
+	tcp->send_wnd = wnd;
+	tcp->recover = tcp->send_seq - 1;
+	tcp->dup_acks = 0;
+
+	/* RFC 5681 3.1: initial window, and an arbitrarily high
+	 * threshold so that slow start probes the path first.
+	 */
+	tcp->cwnd = min(4 * mss, max(2 * mss, 4380));
+	tcp->ssthresh = UINT32_MAX;
+}
+
+static inline u32_t flight_size(struct net_tcp *tcp)
+{
+	return tcp->send_max - tcp->send_una;
+}
+
+static bool cc_can_send(struct net_tcp *tcp, u32_t len)
+{
+	u32_t flight = flight_size(tcp);
+
+	/* A segment may always go out when nothing is in flight, so
+	 * that a window smaller than the segment cannot stall us.
+	 */
+	return flight == 0 || flight + len <= min(tcp->cwnd, tcp->send_wnd);
+}
+
+static inline void cc_sent(struct net_tcp *tcp, u32_t end)
+{
+	if (net_tcp_seq_greater(end, tcp->send_max)) {
+		tcp->send_max = end;
+	}
+}
+
+/* A segment is on its way while it waits in the TX queue, and once sent
+ * until a timeout pulls send_max back below its end.
+ */
+static inline bool pkt_in_flight(struct net_tcp *tcp, struct net_pkt *pkt,
+				 u32_t end)
+{
+	return net_pkt_queued(pkt) || !net_tcp_seq_greater(end, tcp->send_max);
+}
+
+static void cc_timeout(struct net_tcp *tcp)
+{
+	struct net_tcp_hdr hdr, *tcp_hdr;
+	struct net_pkt *pkt;
+
+	/* RFC 5681 3.1: halve the window once per loss, not for each
+	 * retransmission of the same segment.
+	 */
+	if (tcp->retry_timeout_shift == 1) {
+		tcp->ssthresh = max(flight_size(tcp) / 2, 2 * tcp->send_mss);
+	}
+
+	tcp->cwnd = tcp->send_mss;
+	tcp->dup_acks = 0;
+	tcp->recover = tcp->send_max - 1;
+	tcp->flags &= ~NET_TCP_FAST_RECOVERY;
+
+	/* Only the oldest segment is sent again by the timer, the ones
+	 * after it go out again as the congestion window opens.
+	 */
+	pkt = SYS_SLIST_PEEK_HEAD_CONTAINER(&tcp->sent_list, pkt, sent_list);
+	if (!pkt) {
+		return;
+	}
+
+	tcp_hdr = net_tcp_get_hdr(pkt, &hdr);
+	if (tcp_hdr) {
+		tcp->send_max = sys_get_be32(tcp_hdr->seq) +
+				seq_len(pkt, tcp_hdr);
+	}
+}
+#else
+/* Without congestion control only the timer sends a segment again */
+static inline bool pkt_in_flight(struct net_tcp *tcp, struct net_pkt *pkt,
+				 u32_t end)
+{
+	ARG_UNUSED(tcp);
+	ARG_UNUSED(end);
+
+	return net_pkt_queued(pkt) || net_pkt_sent(pkt);
+}
+
+#define cc_can_send(...) true
+#define cc_sent(...)
+#define cc_timeout(...)
+#endif /* CONFIG_NET_TCP_CONGESTION_CONTROL */
+
 static void tcp_retry_expired(struct k_work *work)
 {
 	struct net_tcp *tcp = CONTAINER_OF(work, struct net_tcp, retry_timer);
@@ -223,20 +367,14 @@ static void tcp_retry_expired(struct k_work *work)
 
 		k_delayed_work_submit(&tcp->retry_timer, retry_timeout(tcp));
 
+		cc_timeout(tcp);
+
 		pkt = CONTAINER_OF(sys_slist_peek_head(&tcp->sent_list),
 				   struct net_pkt, sent_list);
 
-		if (net_pkt_sent(pkt)) {
-			do_ref_if_needed(tcp, pkt);
-			net_pkt_set_sent(pkt, false);
-		}
-
-		net_pkt_set_queued(pkt, true);
-
-		if (net_tcp_send_pkt(pkt) < 0 && !is_6lo_technology(pkt)) {
+		if (send_queued_pkt(tcp, pkt) < 0 && !is_6lo_technology(pkt)) {
 			NET_DBG("retry %u: [%p] pkt %p send failed",
 				tcp->retry_timeout_shift, tcp, pkt);
-			net_pkt_unref(pkt);
 		} else {
 			NET_DBG("retry %u: [%p] sent pkt %p",
 				tcp->retry_timeout_shift, tcp, pkt);
@@ -326,6 +464,16 @@ int net_tcp_release(struct net_tcp *tcp)
 		net_pkt_unref(pkt);
 	}
 
+#if defined(CONFIG_NET_TCP_OUT_OF_ORDER_QUEUE)
+	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&tcp->ooo_list, pkt, tmp,
+					  sent_list) {
+		sys_slist_remove(&tcp->ooo_list, NULL, &pkt->sent_list);
+		net_pkt_unref(pkt);
+	}
+
+	tcp->ooo_count = 0;
+#endif
+
 	retry_timer_cancel(tcp);
 	k_sem_reset(&tcp->connect_wait);
 
@@ -337,7 +485,8 @@ int net_tcp_release(struct net_tcp *tcp)
 	tcp->context = NULL;
 
 	key = irq_lock();
-	tcp->flags &= ~(NET_TCP_IN_USE | NET_TCP_RECV_MSS_SET);
+	tcp->flags &= ~(NET_TCP_IN_USE | NET_TCP_RECV_MSS_SET |
+			NET_TCP_FAST_RECOVERY | NET_TCP_SACK_PERMITTED);
 	irq_unlock(key);
 
 	NET_DBG("[%p] Disposed of TCP connection state", tcp);
@@ -684,10 +833,109 @@ static void net_tcp_set_syn_opt(struct net_tcp *tcp, u8_t *options,
 	*optionlen += NET_TCP_MSS_SIZE;
 }
 
+/* Add the window scale and SACK permitted options of a SYN, if they are
+ * enabled.  A SYN-ACK carries them only if the SYN did.
+ */
+static void net_tcp_set_syn_ext_opt(u8_t *options, u8_t *optionlen,
+				    bool wscale, bool sack)
+{
+	if (IS_ENABLED(CONFIG_NET_TCP_WINDOW_SCALE) && wscale) {
+		options[(*optionlen)++] = NET_TCP_NOP_OPT;
+		options[(*optionlen)++] = NET_TCP_WINDOW_SCALE_OPT;
+		options[(*optionlen)++] = NET_TCP_WINDOW_SCALE_SIZE;
+		options[(*optionlen)++] = NET_TCP_RECV_WINDOW_SCALE;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_TCP_SACK) && sack) {
+		options[(*optionlen)++] = NET_TCP_NOP_OPT;
+		options[(*optionlen)++] = NET_TCP_NOP_OPT;
+		options[(*optionlen)++] = NET_TCP_SACK_PERM_OPT;
+		options[(*optionlen)++] = NET_TCP_SACK_PERM_SIZE;
+	}
+}
+
+#if defined(CONFIG_NET_TCP_OUT_OF_ORDER_QUEUE)
+static u32_t ooo_pkt_seq(struct net_pkt *pkt)
+{
+	struct net_tcp_hdr hdr, *tcp_hdr;
+
+	tcp_hdr = net_tcp_get_hdr(pkt, &hdr);
+	if (!tcp_hdr) {
+		return 0;
+	}
+
+	return sys_get_be32(tcp_hdr->seq);
+}
+#endif
+
+#if defined(CONFIG_NET_TCP_SACK)
+/* Report the data held in the out-of-order queue, the block holding the
+ * most recently received segment first (RFC 2018 4).
+ */
+static void net_tcp_set_sack_opt(struct net_tcp *tcp, u8_t *options,
+				 u8_t *optionlen)
+{
+	struct net_tcp_sack_block blocks[NET_TCP_MAX_SACK_BLOCKS];
+	struct net_tcp_sack_block tmp;
+	struct net_pkt *pkt;
+	int count = 0, last = 0, i;
+
+	*optionlen = 0;
+
+	if (!(tcp->flags & NET_TCP_SACK_PERMITTED)) {
+		return;
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->ooo_list, pkt, sent_list) {
+		u32_t seq = ooo_pkt_seq(pkt);
+		u32_t end = seq + net_pkt_appdatalen(pkt);
+
+		if (count && !net_tcp_seq_greater(seq, blocks[count - 1].end)) {
+			if (net_tcp_seq_greater(end, blocks[count - 1].end)) {
+				blocks[count - 1].end = end;
+			}
+		} else if (count < NET_TCP_MAX_SACK_BLOCKS) {
+			blocks[count].start = seq;
+			blocks[count].end = end;
+			count++;
+		} else {
+			break;
+		}
+
+		if (seq == tcp->ooo_last_seq) {
+			last = count - 1;
+		}
+	}
+
+	if (!count) {
+		return;
+	}
+
+	tmp = blocks[last];
+	blocks[last] = blocks[0];
+	blocks[0] = tmp;
+
+	options[(*optionlen)++] = NET_TCP_NOP_OPT;
+	options[(*optionlen)++] = NET_TCP_NOP_OPT;
+	options[(*optionlen)++] = NET_TCP_SACK_OPT;
+	options[(*optionlen)++] = 2 + count * NET_TCP_SACK_BLOCK_SIZE;
+
+	for (i = 0; i < count; i++) {
+		UNALIGNED_PUT(htonl(blocks[i].start),
+			      (u32_t *)(options + *optionlen));
+		UNALIGNED_PUT(htonl(blocks[i].end),
+			      (u32_t *)(options + *optionlen + 4));
+		*optionlen += NET_TCP_SACK_BLOCK_SIZE;
+	}
+}
+#else
+#define net_tcp_set_sack_opt(tcp, options, optionlen) (*(optionlen) = 0)
+#endif /* CONFIG_NET_TCP_SACK */
+
 int net_tcp_prepare_ack(struct net_tcp *tcp, const struct sockaddr *remote,
 			struct net_pkt **pkt)
 {
-	u8_t options[NET_TCP_MAX_OPT_SIZE];
+	u8_t options[NET_TCP_MAX_HDR_OPT_SIZE];
 	u8_t optionlen;
 
 	switch (net_tcp_get_state(tcp)) {
@@ -708,8 +956,10 @@ int net_tcp_prepare_ack(struct net_tcp *tcp, const struct sockaddr *remote,
 		return net_tcp_prepare_segment(tcp, NET_TCP_FIN | NET_TCP_ACK,
 					       0, 0, NULL, remote, pkt);
 	default:
-		return net_tcp_prepare_segment(tcp, NET_TCP_ACK, 0, 0, NULL,
-					       remote, pkt);
+		net_tcp_set_sack_opt(tcp, options, &optionlen);
+
+		return net_tcp_prepare_segment(tcp, NET_TCP_ACK, options,
+					       optionlen, NULL, remote, pkt);
 	}
 
 	return -EINVAL;
@@ -976,38 +1226,58 @@ static void restart_timer(struct net_tcp *tcp)
 	}
 }
 
-int net_tcp_send_data(struct net_context *context, net_context_send_cb_t cb,
-		      void *token, void *user_data)
+/* Send the queued packets that have not been sent yet, as far as the
+ * congestion window and the receive window of the peer allow.
+ */
+static void send_queued_data(struct net_tcp *tcp)
 {
+	struct net_tcp_hdr hdr, *tcp_hdr;
 	struct net_pkt *pkt;
+	u32_t len, end;
+	int ret;
 
-	/* For now, just send all queued data synchronously.  Need to
-	 * add window handling and retry/ACK logic.
-	 */
-	SYS_SLIST_FOR_EACH_CONTAINER(&context->tcp->sent_list, pkt, sent_list) {
-		/* Do not resend packets that were sent by expire timer */
-		if (net_pkt_queued(pkt)) {
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->sent_list, pkt, sent_list) {
+		tcp_hdr = net_tcp_get_hdr(pkt, &hdr);
+		if (!tcp_hdr) {
+			break;
+		}
+
+		len = seq_len(pkt, tcp_hdr);
+		end = sys_get_be32(tcp_hdr->seq) + len;
+
+		/* Do not resend packets that were sent already, here or by
+		 * the expire timer.
+		 */
+		if (pkt_in_flight(tcp, pkt, end)) {
 			NET_DBG("[%p] Skipping pkt %p because it was already "
-				"sent.", context->tcp, pkt);
+				"sent.", tcp, pkt);
 			continue;
 		}
 
-		if (!net_pkt_sent(pkt)) {
-			int ret;
-
-			NET_DBG("[%p] Sending pkt %p (%zd bytes)", context->tcp,
-				pkt, net_pkt_get_len(pkt));
+		if (!cc_can_send(tcp, len)) {
+			NET_DBG("[%p] Window full, pkt %p held back", tcp, pkt);
+			break;
+		}
 
-			ret = net_tcp_send_pkt(pkt);
-			if (ret < 0 && !is_6lo_technology(pkt)) {
-				NET_DBG("[%p] pkt %p not sent (%d)",
-					context->tcp, pkt, ret);
-				net_pkt_unref(pkt);
-			}
+		NET_DBG("[%p] Sending pkt %p (%zd bytes)", tcp,
+			pkt, net_pkt_get_len(pkt));
 
-			net_pkt_set_queued(pkt, true);
+		ret = send_queued_pkt(tcp, pkt);
+		if (ret < 0) {
+			NET_DBG("[%p] pkt %p not sent (%d)", tcp, pkt, ret);
 		}
+
+		cc_sent(tcp, end);
 	}
+}
+
+int net_tcp_send_data(struct net_context *context, net_context_send_cb_t cb,
+		      void *token, void *user_data)
+{
+	/* Send the queued data synchronously, what does not fit in the
+	 * windows goes out as ACKs come in.
+	 */
+	send_queued_data(context->tcp);
 
 	/* Just make the callback synchronously even if it didn't
 	 * go over the wire.  In theory it would be nice to track
@@ -1043,7 +1313,6 @@ bool net_tcp_ack_received(struct net_context *ctx, u32_t ack)
 	while (!sys_slist_is_empty(list)) {
 		struct net_tcp_hdr hdr, *tcp_hdr;
 		u32_t last_seq;
-		u32_t seq_len;
 
 		head = sys_slist_peek_head(list);
 		pkt = CONTAINER_OF(head, struct net_pkt, sent_list);
@@ -1059,20 +1328,9 @@ bool net_tcp_ack_received(struct net_context *ctx, u32_t ack)
 			continue;
 		}
 
-		seq_len = net_pkt_appdatalen(pkt);
-
-		/* Each of SYN and FIN flags are counted
-		 * as one sequence number.
-		 */
-		if (tcp_hdr->flags & NET_TCP_SYN) {
-			seq_len += 1;
-		}
-		if (tcp_hdr->flags & NET_TCP_FIN) {
-			seq_len += 1;
-		}
-
 		/* Last sequence number in this packet. */
-		last_seq = sys_get_be32(tcp_hdr->seq) + seq_len - 1;
+		last_seq = sys_get_be32(tcp_hdr->seq) +
+			   seq_len(pkt, tcp_hdr) - 1;
 
 		/* Ack number should be strictly greater to acknowleged numbers
 		 * below it. For example, ack no. 10 acknowledges all numbers up
@@ -1110,6 +1368,246 @@ bool net_tcp_ack_received(struct net_context *ctx, u32_t ack)
 	return true;
 }
 
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+static void fast_retransmit(struct net_tcp *tcp, struct net_pkt *pkt)
+{
+	NET_DBG("[%p] Fast retransmit of pkt %p", tcp, pkt);
+
+	/* Putting it in the TX queue a second time would corrupt it */
+	if (net_pkt_queued(pkt)) {
+		return;
+	}
+
+	if (send_queued_pkt(tcp, pkt) >= 0 &&
+	    IS_ENABLED(CONFIG_NET_STATISTICS_TCP) &&
+	    !is_6lo_technology(pkt)) {
+		net_stats_update_tcp_seg_rexmit(net_pkt_iface(pkt));
+	}
+}
+
+#if defined(CONFIG_NET_TCP_SACK)
+static void sack_update(struct net_tcp *tcp, struct net_pkt *pkt,
+			struct net_tcp_hdr *tcp_hdr)
+{
+	struct net_tcp_options opts = { 0 };
+	int opt_totlen = NET_TCP_HDR_LEN(tcp_hdr) - sizeof(struct net_tcp_hdr);
+
+	if (!(tcp->flags & NET_TCP_SACK_PERMITTED)) {
+		return;
+	}
+
+	if (opt_totlen > 0 && net_tcp_parse_opts(pkt, opt_totlen, &opts) < 0) {
+		return;
+	}
+
+	memcpy(tcp->sack, opts.sack, sizeof(tcp->sack));
+	tcp->sack_count = opts.sack_count;
+}
+
+static bool sack_covers(struct net_tcp *tcp, u32_t seq, u32_t end)
+{
+	int i;
+
+	for (i = 0; i < tcp->sack_count; i++) {
+		if (net_tcp_seq_cmp(seq, tcp->sack[i].start) >= 0 &&
+		    net_tcp_seq_cmp(end, tcp->sack[i].end) <= 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool sack_above(struct net_tcp *tcp, u32_t end)
+{
+	int i;
+
+	for (i = 0; i < tcp->sack_count; i++) {
+		if (net_tcp_seq_greater(tcp->sack[i].end, end)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* During fast recovery, send again the oldest segment not sent again
+ * yet that the peer did not receive although it received later data.
+ */
+static bool sack_retransmit(struct net_tcp *tcp)
+{
+	struct net_tcp_hdr hdr, *tcp_hdr;
+	struct net_pkt *pkt;
+	u32_t seq, end;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->sent_list, pkt, sent_list) {
+		/* Still waiting in the TX queue, so not lost */
+		if (net_pkt_queued(pkt)) {
+			continue;
+		}
+
+		/* Neither this one nor the ones after it were sent yet */
+		if (!net_pkt_sent(pkt)) {
+			break;
+		}
+
+		tcp_hdr = net_tcp_get_hdr(pkt, &hdr);
+		if (!tcp_hdr) {
+			break;
+		}
+
+		seq = sys_get_be32(tcp_hdr->seq);
+		end = seq + seq_len(pkt, tcp_hdr);
+
+		if (!sack_above(tcp, end)) {
+			break;
+		}
+
+		if (!net_tcp_seq_greater(end, tcp->rexmit_high) ||
+		    sack_covers(tcp, seq, end)) {
+			continue;
+		}
+
+		tcp->rexmit_high = end;
+		fast_retransmit(tcp, pkt);
+
+		return true;
+	}
+
+	return false;
+}
+
+static void sack_retransmitted(struct net_tcp *tcp, struct net_pkt *pkt)
+{
+	struct net_tcp_hdr hdr, *tcp_hdr;
+
+	tcp_hdr = net_tcp_get_hdr(pkt, &hdr);
+	if (tcp_hdr) {
+		tcp->rexmit_high = sys_get_be32(tcp_hdr->seq) +
+				   seq_len(pkt, tcp_hdr);
+	}
+}
+#else
+#define sack_update(...)
+#define sack_retransmit(...) false
+#define sack_retransmitted(...)
+#endif /* CONFIG_NET_TCP_SACK */
+
+/* Count a duplicate ACK, and do a fast retransmit on the third one in a
+ * row (RFC 5681 3.2, RFC 6582 3.2).
+ */
+static void cc_dup_ack(struct net_tcp *tcp)
+{
+	struct net_pkt *pkt;
+	u32_t mss = tcp->send_mss;
+
+	if (tcp->flags & NET_TCP_FAST_RECOVERY) {
+		/* A segment has left the network: send a missing one in
+		 * its place if SACK tells which, new data otherwise.
+		 */
+		if (!sack_retransmit(tcp)) {
+			tcp->cwnd += mss;
+		}
+
+		return;
+	}
+
+	if (tcp->dup_acks >= NET_TCP_DUP_ACK_THRESHOLD ||
+	    ++tcp->dup_acks < NET_TCP_DUP_ACK_THRESHOLD) {
+		return;
+	}
+
+	/* Losses of data sent before the last recovery have been dealt
+	 * with already.
+	 */
+	if (!net_tcp_seq_greater(tcp->send_una, tcp->recover)) {
+		return;
+	}
+
+	pkt = SYS_SLIST_PEEK_HEAD_CONTAINER(&tcp->sent_list, pkt, sent_list);
+	if (!pkt) {
+		return;
+	}
+
+	tcp->ssthresh = max(flight_size(tcp) / 2, 2 * mss);
+	tcp->cwnd = tcp->ssthresh + NET_TCP_DUP_ACK_THRESHOLD * mss;
+	tcp->recover = tcp->send_max - 1;
+	tcp->flags |= NET_TCP_FAST_RECOVERY;
+
+	sack_retransmitted(tcp, pkt);
+	fast_retransmit(tcp, pkt);
+}
+
+/* Open the congestion window on an ACK for new data, or deflate it and
+ * repair the next loss when only part of the data sent before a fast
+ * retransmit is acknowledged (RFC 5681 3.1, RFC 6582 3.2).
+ */
+static void cc_new_ack(struct net_tcp *tcp, u32_t acked)
+{
+	struct net_pkt *pkt;
+	u32_t mss = tcp->send_mss;
+
+	tcp->dup_acks = 0;
+
+	if (!(tcp->flags & NET_TCP_FAST_RECOVERY)) {
+		if (tcp->cwnd < tcp->ssthresh) {
+			tcp->cwnd += min(acked, mss);
+		} else {
+			tcp->cwnd += max(mss * mss / tcp->cwnd, 1);
+		}
+
+		return;
+	}
+
+	if (net_tcp_seq_greater(tcp->send_una, tcp->recover)) {
+		tcp->cwnd = min(tcp->ssthresh, max(flight_size(tcp), mss) + mss);
+		tcp->flags &= ~NET_TCP_FAST_RECOVERY;
+		return;
+	}
+
+	pkt = SYS_SLIST_PEEK_HEAD_CONTAINER(&tcp->sent_list, pkt, sent_list);
+	if (pkt && !sack_retransmit(tcp)) {
+		sack_retransmitted(tcp, pkt);
+		fast_retransmit(tcp, pkt);
+	}
+
+	tcp->cwnd = (tcp->cwnd > acked ? tcp->cwnd - acked : 0);
+	tcp->cwnd = max(tcp->cwnd + (acked >= mss ? mss : 0), mss);
+}
+
+static void cc_ack_received(struct net_tcp *tcp, struct net_pkt *pkt,
+			    struct net_tcp_hdr *tcp_hdr)
+{
+	u32_t ack = sys_get_be32(tcp_hdr->ack);
+	u32_t wnd = (u32_t)sys_get_be16(tcp_hdr->wnd) << send_wscale(tcp);
+
+	sack_update(tcp, pkt, tcp_hdr);
+
+	if (net_tcp_seq_greater(ack, tcp->send_una)) {
+		u32_t acked = ack - tcp->send_una;
+
+		tcp->send_una = ack;
+		tcp->send_wnd = wnd;
+		cc_sent(tcp, ack);
+		cc_new_ack(tcp, acked);
+	} else if (ack == tcp->send_una) {
+		net_pkt_set_appdata_values(pkt, IPPROTO_TCP);
+
+		if (net_pkt_appdatalen(pkt) == 0 &&
+		    !(tcp_hdr->flags & (NET_TCP_SYN | NET_TCP_FIN)) &&
+		    wnd == tcp->send_wnd && flight_size(tcp) > 0) {
+			cc_dup_ack(tcp);
+		}
+
+		tcp->send_wnd = wnd;
+	}
+
+	send_queued_data(tcp);
+}
+#else
+#define cc_ack_received(...)
+#endif /* CONFIG_NET_TCP_CONGESTION_CONTROL */
+
 void net_tcp_init(void)
 {
 }
@@ -1392,6 +1890,8 @@ int net_tcp_parse_opts(struct net_pkt *pkt, int opt_totlen,
 		  + net_pkt_ipv6_ext_len(pkt)
 		  + sizeof(struct net_tcp_hdr);
 	u8_t opt, optlen;
+	u32_t start, end;
+	int i;
 
 	/* TODO: this should be done for each TCP pkt, on reception */
 	if (pos + opt_totlen > net_pkt_get_len(pkt)) {
@@ -1443,6 +1943,42 @@ int net_tcp_parse_opts(struct net_pkt *pkt, int opt_totlen,
 			frag = net_frag_read_be16(frag, pos, &pos,
 						  &opts->mss);
 			break;
+		case NET_TCP_WINDOW_SCALE_OPT:
+			if (optlen != 1) {
+				goto error;
+			}
+			frag = net_frag_read_u8(frag, pos, &pos, &opts->wscale);
+			opts->wscale = min(opts->wscale,
+					   NET_TCP_MAX_WINDOW_SCALE);
+			opts->wscale_set = true;
+			break;
+		case NET_TCP_SACK_PERM_OPT:
+			if (optlen != 0) {
+				goto error;
+			}
+			opts->sack_permitted = true;
+			break;
+		case NET_TCP_SACK_OPT:
+			if (optlen == 0 || optlen % NET_TCP_SACK_BLOCK_SIZE) {
+				goto error;
+			}
+			/* Blocks beyond the ones we have room for are
+			 * ignored, they are reported again later.
+			 */
+			opts->sack_count = 0;
+			for (i = 0; i < optlen; i += NET_TCP_SACK_BLOCK_SIZE) {
+				frag = net_frag_read_be32(frag, pos, &pos,
+							  &start);
+				frag = net_frag_read_be32(frag, pos, &pos,
+							  &end);
+				if (opts->sack_count < NET_TCP_MAX_SACK_BLOCKS) {
+					opts->sack[opts->sack_count].start =
+						start;
+					opts->sack[opts->sack_count].end = end;
+					opts->sack_count++;
+				}
+			}
+			break;
 		default:
 			frag = net_frag_skip(frag, pos, &pos, optlen);
 			break;
@@ -1500,6 +2036,12 @@ static void queue_fin(struct net_context *ctx)
 
 	net_tcp_queue_pkt(ctx, pkt);
 
+	/* The FIN must not overtake data held back by the windows */
+	if (IS_ENABLED(CONFIG_NET_TCP_CONGESTION_CONTROL)) {
+		send_queued_data(ctx->tcp);
+		return;
+	}
+
 	ret = net_tcp_send_pkt(pkt);
 	if (ret < 0) {
 		net_pkt_unref(pkt);
@@ -1557,6 +2099,25 @@ int net_tcp_update_recv_wnd(struct net_context *context, s32_t delta)
 	return 0;
 }
 
+/* Apply the options both ends agreed on during the handshake, wnd being
+ * the window the peer advertised, already scaled.
+ */
+static void set_conn_opts(struct net_tcp *tcp, u32_t wnd, u8_t wscale,
+			  bool sack_permitted)
+{
+#if defined(CONFIG_NET_TCP_WINDOW_SCALE)
+	tcp->send_wscale = wscale;
+#endif
+
+	if (IS_ENABLED(CONFIG_NET_TCP_SACK) && sack_permitted) {
+		tcp->flags |= NET_TCP_SACK_PERMITTED;
+	}
+
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+	cc_init(tcp, wnd);
+#endif
+}
+
 static int send_reset(struct net_context *context, struct sockaddr *local,
 		      struct sockaddr *remote);
 
@@ -1641,7 +2202,7 @@ static int tcp_backlog_find(struct net_pkt *pkt, int *empty_slot)
 }
 
 static int tcp_backlog_syn(struct net_pkt *pkt, struct net_context *context,
-			   u16_t send_mss)
+			   const struct net_tcp_options *opts)
 {
 	int empty_slot = -1;
 	int ret;
@@ -1667,7 +2228,11 @@ static int tcp_backlog_syn(struct net_pkt *pkt, struct net_context *context,
 
 	tcp_backlog[empty_slot].send_seq = context->tcp->send_seq;
 	tcp_backlog[empty_slot].send_ack = context->tcp->send_ack;
-	tcp_backlog[empty_slot].send_mss = send_mss;
+	tcp_backlog[empty_slot].send_mss = opts->mss;
+	tcp_backlog[empty_slot].send_wscale =
+		IS_ENABLED(CONFIG_NET_TCP_WINDOW_SCALE) && opts->wscale_set ?
+		opts->wscale : 0;
+	tcp_backlog[empty_slot].sack_permitted = opts->sack_permitted;
 
 	k_delayed_work_init(&tcp_backlog[empty_slot].ack_timer,
 			    backlog_ack_timeout);
@@ -1703,6 +2268,13 @@ static int tcp_backlog_ack(struct net_pkt *pkt, struct net_context *context)
 	context->tcp->send_ack = tcp_backlog[r].send_ack;
 	context->tcp->send_mss = tcp_backlog[r].send_mss;
 
+	/* Unlike that of the SYN, the window of this ACK is scaled */
+	set_conn_opts(context->tcp,
+		      (u32_t)sys_get_be16(tcp_hdr->wnd) <<
+		      tcp_backlog[r].send_wscale,
+		      tcp_backlog[r].send_wscale,
+		      tcp_backlog[r].sack_permitted);
+
 	k_delayed_work_cancel(&tcp_backlog[r].ack_timer);
 	(void)memset(&tcp_backlog[r], 0, sizeof(struct tcp_backlog_entry));
 
@@ -1868,19 +2440,27 @@ static void print_send_info(struct net_pkt *pkt, const char *msg)
 	}
 }
 
-/* Send SYN or SYN/ACK. */
+/* Send SYN or SYN/ACK, the latter answering a SYN with the given
+ * options.
+ */
 static inline int send_syn_segment(struct net_context *context,
 				       const struct sockaddr_ptr *local,
 				       const struct sockaddr *remote,
-				       int flags, const char *msg)
+				       int flags, const char *msg,
+				       const struct net_tcp_options *syn_opts)
 {
 	struct net_pkt *pkt = NULL;
 	int ret;
-	u8_t options[NET_TCP_MAX_OPT_SIZE];
+	u8_t options[NET_TCP_MAX_HDR_OPT_SIZE];
 	u8_t optionlen = 0;
 
 	if (flags == NET_TCP_SYN) {
 		net_tcp_set_syn_opt(context->tcp, options, &optionlen);
+		net_tcp_set_syn_ext_opt(options, &optionlen, true, true);
+	} else if (syn_opts) {
+		net_tcp_set_syn_ext_opt(options, &optionlen,
+					syn_opts->wscale_set,
+					syn_opts->sack_permitted);
 	}
 
 	ret = net_tcp_prepare_segment(context->tcp, flags, options, optionlen,
@@ -1907,16 +2487,18 @@ static inline int send_syn(struct net_context *context,
 {
 	net_tcp_change_state(context->tcp, NET_TCP_SYN_SENT);
 
-	return send_syn_segment(context, NULL, remote, NET_TCP_SYN, "SYN");
+	return send_syn_segment(context, NULL, remote, NET_TCP_SYN, "SYN",
+				NULL);
 }
 
 static inline int send_syn_ack(struct net_context *context,
 			       struct sockaddr_ptr *local,
-			       struct sockaddr *remote)
+			       struct sockaddr *remote,
+			       const struct net_tcp_options *syn_opts)
 {
 	return send_syn_segment(context, local, remote,
 				    NET_TCP_SYN | NET_TCP_ACK,
-				    "SYN_ACK");
+				    "SYN_ACK", syn_opts);
 }
 
 static int send_ack(struct net_context *context,
@@ -1969,6 +2551,103 @@ static int send_reset(struct net_context *context,
 	return ret;
 }
 
+#if defined(CONFIG_NET_TCP_OUT_OF_ORDER_QUEUE)
+/* Hold a data segment that arrived ahead of the next expected one,
+ * until the data before it has been received.
+ */
+static bool ooo_queue(struct net_tcp *tcp, struct net_pkt *pkt,
+		      struct net_tcp_hdr *tcp_hdr)
+{
+	u32_t seq = sys_get_be32(tcp_hdr->seq);
+	struct net_pkt *cur, *prev = NULL;
+	u16_t data_len;
+	s32_t cmp;
+
+	if ((NET_TCP_FLAGS(tcp_hdr) & ~(NET_TCP_ACK | NET_TCP_PSH)) ||
+	    tcp->ooo_count >= CONFIG_NET_TCP_OUT_OF_ORDER_QUEUE_SIZE) {
+		return false;
+	}
+
+	net_pkt_set_appdata_values(pkt, IPPROTO_TCP);
+
+	data_len = net_pkt_appdatalen(pkt);
+	if (data_len == 0 ||
+	    net_tcp_seq_greater(seq + data_len,
+				tcp->send_ack + net_tcp_get_recv_wnd(tcp))) {
+		return false;
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->ooo_list, cur, sent_list) {
+		cmp = net_tcp_seq_cmp(ooo_pkt_seq(cur), seq);
+		if (cmp == 0) {
+			/* Already held */
+			return false;
+		}
+
+		if (cmp > 0) {
+			break;
+		}
+
+		prev = cur;
+	}
+
+	sys_slist_insert(&tcp->ooo_list, prev ? &prev->sent_list : NULL,
+			 &pkt->sent_list);
+	tcp->ooo_count++;
+	tcp->ooo_last_seq = seq;
+
+	NET_DBG("[%p] Queued out-of-order pkt %p seq %u (%u held)",
+		tcp, pkt, seq, tcp->ooo_count);
+
+	return true;
+}
+
+/* Pass on the held segments that the data just received made
+ * contiguous.
+ */
+static void ooo_deliver(struct net_context *context, struct net_conn *conn)
+{
+	struct net_tcp *tcp = context->tcp;
+	struct net_pkt *pkt;
+	u16_t data_len;
+	s32_t cmp;
+
+	while ((pkt = SYS_SLIST_PEEK_HEAD_CONTAINER(&tcp->ooo_list, pkt,
+						     sent_list))) {
+		cmp = net_tcp_seq_cmp(ooo_pkt_seq(pkt), tcp->send_ack);
+		if (cmp > 0) {
+			break;
+		}
+
+		sys_slist_remove(&tcp->ooo_list, NULL, &pkt->sent_list);
+		tcp->ooo_count--;
+
+		data_len = net_pkt_appdatalen(pkt);
+
+		/* A segment overlapping data already received is dropped,
+		 * the peer sends the rest of it again.
+		 */
+		if (cmp < 0 || data_len > net_tcp_get_recv_wnd(tcp)) {
+			net_pkt_unref(pkt);
+			continue;
+		}
+
+		NET_DBG("[%p] Delivering out-of-order pkt %p", tcp, pkt);
+
+		if (net_context_packet_received(conn, pkt,
+						tcp->recv_user_data) ==
+		    NET_DROP) {
+			net_pkt_unref(pkt);
+		}
+
+		tcp->send_ack += data_len;
+	}
+}
+#else
+#define ooo_queue(...) false
+#define ooo_deliver(...)
+#endif /* CONFIG_NET_TCP_OUT_OF_ORDER_QUEUE */
+
 /* This is called when we receive data after the connection has been
  * established. The core TCP logic is located here.
  *
@@ -2017,11 +2696,19 @@ resend_ack:
 
 	if (net_tcp_seq_cmp(sys_get_be32(tcp_hdr->seq),
 			    context->tcp->send_ack) > 0) {
-		/* Don't try to reorder packets.  If it doesn't
-		 * match the next segment exactly, drop and wait for
-		 * retransmit
+		/* Hold the segment until the gap before it is filled if
+		 * there is room for it, drop it and wait for retransmit
+		 * otherwise.  Either way, tell the peer about the gap
+		 * with an immediate duplicate ACK (RFC 5681 4.2).
 		 */
-		return NET_DROP;
+		if (ooo_queue(context->tcp, pkt, tcp_hdr)) {
+			ret = NET_OK;
+		} else {
+			ret = NET_DROP;
+		}
+
+		send_ack(context, &conn->remote_addr, true);
+		return ret;
 	}
 
 	/*
@@ -2056,6 +2743,8 @@ resend_ack:
 			return NET_DROP;
 		}
 
+		cc_ack_received(context->tcp, pkt, tcp_hdr);
+
 		/* TCP state might be changed after maintaining the sent pkt
 		 * list, e.g., an ack of FIN is received.
 		 */
@@ -2133,6 +2822,8 @@ resend_ack:
 	context->tcp->send_ack += data_len;
 	if (tcp_flags & NET_TCP_FIN) {
 		context->tcp->send_ack += 1;
+	} else if (data_len > 0) {
+		ooo_deliver(context, conn);
 	}
 
 	send_ack(context, &conn->remote_addr, false);
@@ -2219,6 +2910,15 @@ NET_CONN_CB(tcp_synack_received)
 		 */
 		struct sockaddr local_addr;
 		struct sockaddr remote_addr;
+		struct net_tcp_options tcp_opts = {
+			.mss = NET_TCP_DEFAULT_MSS,
+		};
+
+		if (net_tcp_parse_opts(pkt, NET_TCP_HDR_LEN(tcp_hdr) -
+				       sizeof(struct net_tcp_hdr),
+				       &tcp_opts) < 0) {
+			return NET_DROP;
+		}
 
 		if (net_pkt_get_src_addr(
 			pkt, &remote_addr, sizeof(remote_addr)) < 0) {
@@ -2248,6 +2948,12 @@ NET_CONN_CB(tcp_synack_received)
 			return NET_DROP;
 		}
 
+		context->tcp->send_mss = tcp_opts.mss;
+		set_conn_opts(context->tcp, sys_get_be16(tcp_hdr->wnd),
+			      IS_ENABLED(CONFIG_NET_TCP_WINDOW_SCALE) &&
+			      tcp_opts.wscale_set ? tcp_opts.wscale : 0,
+			      tcp_opts.sack_permitted);
+
 		net_tcp_change_state(context->tcp, NET_TCP_ESTABLISHED);
 		net_context_set_state(context, NET_CONTEXT_CONNECTED);
 
@@ -2393,7 +3099,7 @@ NET_CONN_CB(tcp_syn_rcvd)
 
 		/* Get MSS from TCP options here*/
 
-		r = tcp_backlog_syn(pkt, context, tcp_opts.mss);
+		r = tcp_backlog_syn(pkt, context, &tcp_opts);
 		if (r < 0) {
 			if (r == -EADDRINUSE) {
 				NET_DBG("TCP connection already exists");
@@ -2406,7 +3112,7 @@ NET_CONN_CB(tcp_syn_rcvd)
 
 		pkt_get_sockaddr(net_context_get_family(context),
 				 pkt, &pkt_src_addr);
-		send_syn_ack(context, &pkt_src_addr, &remote_addr);
+		send_syn_ack(context, &pkt_src_addr, &remote_addr, &tcp_opts);
 
 		return NET_DROP;
 	}
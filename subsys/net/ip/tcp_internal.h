@@ -29,7 +29,11 @@ extern "C" {
 /** Is this TCP context/socket used or not */
 #define NET_TCP_IN_USE BIT(0)
 
-/* BIT(1), BIT(2) are unused and available */
+/** Fast retransmit was done and fast recovery is in progress */
+#define NET_TCP_FAST_RECOVERY BIT(1)
+
+/** Both ends agreed to use selective acknowledgments (SACK) */
+#define NET_TCP_SACK_PERMITTED BIT(2)
 
 /** Is the socket shutdown for read/write */
 #define NET_TCP_IS_SHUTDOWN BIT(3)
@@ -77,33 +81,68 @@ enum net_tcp_state {
  */
 #define NET_TCP_DEFAULT_MSS   536
 
-/* TCP max window size */
-#define NET_TCP_MAX_WIN   (4 * 1024)
+/* TCP max window size, our receive window is never scaled */
+#define NET_TCP_MAX_WIN   UINT16_MAX
 
 /* Maximal value of the sequence number */
 #define NET_TCP_MAX_SEQ   0xffffffff
 
 #define NET_TCP_MAX_OPT_SIZE  8
 
+/* Room for options in the TCP header */
+#define NET_TCP_MAX_HDR_OPT_SIZE 40
+
 /* TCP Option codes */
 #define NET_TCP_END_OPT          0
 #define NET_TCP_NOP_OPT          1
 #define NET_TCP_MSS_OPT          2
 #define NET_TCP_WINDOW_SCALE_OPT 3
+#define NET_TCP_SACK_PERM_OPT    4
+#define NET_TCP_SACK_OPT         5
 
 /* TCP Option sizes */
 #define NET_TCP_END_SIZE          1
 #define NET_TCP_NOP_SIZE          1
 #define NET_TCP_MSS_SIZE          4
 #define NET_TCP_WINDOW_SCALE_SIZE 3
+#define NET_TCP_SACK_PERM_SIZE    2
+#define NET_TCP_SACK_BLOCK_SIZE   8
+
+/* RFC 7323 2.3: shift counts above 14 are treated as 14 */
+#define NET_TCP_MAX_WINDOW_SCALE 14
+
+/* Shift count advertised for our receive window.  The receive window
+ * never exceeds 64 KiB, so it is 0: this only lets the peer scale its
+ * own window.
+ */
+#define NET_TCP_RECV_WINDOW_SCALE 0
+
+/* SACK blocks sent or remembered per segment, which leaves room for
+ * the timestamp option that peers commonly send along.
+ */
+#define NET_TCP_MAX_SACK_BLOCKS 3
+
+/* Duplicate ACKs that trigger a fast retransmit (RFC 5681 3.2) */
+#define NET_TCP_DUP_ACK_THRESHOLD 3
+
+/** Block of data received out of order, as reported in a SACK option */
+struct net_tcp_sack_block {
+	u32_t start;
+	u32_t end;
+};
 
 /** Parsed TCP option values for net_tcp_parse_opts()  */
 struct net_tcp_options {
 	u16_t mss;
+	u8_t wscale;
+	bool wscale_set;
+	bool sack_permitted;
+	u8_t sack_count;
+	struct net_tcp_sack_block sack[NET_TCP_MAX_SACK_BLOCKS];
 };
 
 /* Max received bytes to buffer internally */
-#define NET_TCP_BUF_MAX_LEN 1280
+#define NET_TCP_BUF_MAX_LEN CONFIG_NET_TCP_RECV_WINDOW_SIZE
 
 /* Max segment lifetime, in seconds */
 #define NET_TCP_MAX_SEG_LIFETIME 60
@@ -161,6 +200,56 @@ struct net_tcp {
 	 */
 	u16_t send_mss;
 
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+	/** Oldest unacknowledged sequence number */
+	u32_t send_una;
+
+	/** Sequence number following the highest one sent */
+	u32_t send_max;
+
+	/** Receive window of the peer, scaled */
+	u32_t send_wnd;
+
+	/** Congestion window */
+	u32_t cwnd;
+
+	/** Slow start threshold */
+	u32_t ssthresh;
+
+	/** Highest sequence number sent when fast recovery started */
+	u32_t recover;
+
+	/** Duplicate ACKs received in a row */
+	u8_t dup_acks;
+#endif
+
+#if defined(CONFIG_NET_TCP_WINDOW_SCALE)
+	/** Shift count of the windows advertised by the peer */
+	u8_t send_wscale;
+#endif
+
+#if defined(CONFIG_NET_TCP_OUT_OF_ORDER_QUEUE)
+	/** Segments received ahead of send_ack, sorted by sequence number */
+	sys_slist_t ooo_list;
+
+	/** Sequence number of the segment last added to ooo_list */
+	u32_t ooo_last_seq;
+
+	/** Number of segments in ooo_list */
+	u8_t ooo_count;
+#endif
+
+#if defined(CONFIG_NET_TCP_SACK)
+	/** Data the peer reported as received out of order */
+	struct net_tcp_sack_block sack[NET_TCP_MAX_SACK_BLOCKS];
+
+	/** Number of valid entries in sack */
+	u8_t sack_count;
+
+	/** Sequence number up to which fast recovery retransmitted */
+	u32_t rexmit_high;
+#endif
+
 	/** Current retransmit period */
 	u32_t retry_timeout_shift : 5;
 	/** Flags for the TCP */
@@ -390,31 +390,53 @@ int net_addr_pton(sa_family_t family, const char *src,
 	return 0;
 }
 
+/* Add up the 16-bit big endian words of the data to sum, in one's
+ * complement arithmetic (RFC 1071).  As the one's complement sum does not
+ * depend on byte order, the data is read a 32-bit word at a time in host
+ * byte order into a 64-bit accumulator, which keeps all the carries, and
+ * the result is only folded and put in host byte order at the end.
+ */
 static u16_t calc_chksum(u16_t sum, const u8_t *ptr, u16_t len)
 {
-	u16_t tmp;
-	const u8_t *end;
+	u64_t acc = 0;
+	u32_t tmp;
 
-	end = ptr + len - 1;
+	while (len >= 4 * sizeof(u32_t)) {
+		acc += UNALIGNED_GET((u32_t *)ptr);
+		acc += UNALIGNED_GET((u32_t *)ptr + 1);
+		acc += UNALIGNED_GET((u32_t *)ptr + 2);
+		acc += UNALIGNED_GET((u32_t *)ptr + 3);
+		ptr += 4 * sizeof(u32_t);
+		len -= 4 * sizeof(u32_t);
+	}
 
-	while (ptr < end) {
-		tmp = (ptr[0] << 8) + ptr[1];
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
-		}
-		ptr += 2;
+	while (len >= sizeof(u32_t)) {
+		acc += UNALIGNED_GET((u32_t *)ptr);
+		ptr += sizeof(u32_t);
+		len -= sizeof(u32_t);
 	}
 
-	if (ptr == end) {
-		tmp = ptr[0] << 8;
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
-		}
+	if (len >= sizeof(u16_t)) {
+		acc += UNALIGNED_GET((u16_t *)ptr);
+		ptr += sizeof(u16_t);
+		len -= sizeof(u16_t);
 	}
 
-	return sum;
+	/* An odd last byte is the high byte of a word */
+	if (len) {
+		acc += htons(ptr[0] << 8);
+	}
+
+	acc = (acc >> 32) + (acc & 0xffffffff);
+	acc = (acc >> 32) + (acc & 0xffffffff);
+
+	tmp = (acc >> 16) + (acc & 0xffff);
+	tmp = (tmp >> 16) + (tmp & 0xffff);
+
+	tmp = ntohs(tmp) + sum;
+	tmp = (tmp >> 16) + (tmp & 0xffff);
+
+	return tmp;
 }
 
 static inline u16_t calc_chksum_pkt(u16_t sum, struct net_pkt *pkt,
@@ -63,6 +63,111 @@ static inline struct net_context *sock_to_net_ctx(int sock)
 	return z_get_fd_obj(sock, &sock_fd_op_vtable, ENOTSOCK);
 }
 
+#if CONFIG_NET_SOCKETS_POLL_SETS > 0
+/* Sockets watched by the last poll() of a thread, kept registered in a
+ * poll set.  Event n watches the receive queue of the n-th socket polled
+ * for input, or nothing if its object is NULL, so that a thread passing
+ * the same sockets again finds them already registered.
+ */
+struct poll_cache {
+	struct k_thread *thread;
+	u32_t last_used;
+	bool busy;
+	struct k_poll_set set;
+	struct k_poll_event events[CONFIG_NET_SOCKETS_POLL_MAX];
+};
+
+static struct poll_cache poll_caches[CONFIG_NET_SOCKETS_POLL_SETS];
+static u32_t poll_cache_clock;
+K_MUTEX_DEFINE(poll_cache_lock);
+
+/* must be called with poll_cache_lock held */
+static void poll_cache_drop(struct poll_cache *pc, int from)
+{
+	for (int i = from; i < ARRAY_SIZE(pc->events); i++) {
+		if (pc->events[i].obj != NULL) {
+			(void)k_poll_set_remove(&pc->set, &pc->events[i]);
+			pc->events[i].obj = NULL;
+		}
+	}
+}
+
+/* Gets the calling thread's poll cache, or a new one taken from the
+ * least recently used thread, or NULL if all are in use.
+ */
+static struct poll_cache *poll_cache_get(void)
+{
+	struct k_thread *thread = k_current_get();
+	struct poll_cache *pc = NULL;
+
+	k_mutex_lock(&poll_cache_lock, K_FOREVER);
+
+	for (int i = 0; i < ARRAY_SIZE(poll_caches); i++) {
+		struct poll_cache *c = &poll_caches[i];
+
+		if (c->thread == thread) {
+			pc = c;
+			break;
+		}
+
+		if (!c->busy && (pc == NULL || c->thread == NULL ||
+				 (pc->thread != NULL &&
+				  c->last_used < pc->last_used))) {
+			pc = c;
+		}
+	}
+
+	if (pc != NULL && pc->thread != thread) {
+		if (pc->thread == NULL) {
+			k_poll_set_init(&pc->set);
+			for (int i = 0; i < ARRAY_SIZE(pc->events); i++) {
+				pc->events[i].obj = NULL;
+			}
+		}
+		poll_cache_drop(pc, 0);
+		pc->thread = thread;
+	}
+
+	if (pc != NULL) {
+		pc->busy = true;
+		pc->last_used = ++poll_cache_clock;
+	}
+
+	k_mutex_unlock(&poll_cache_lock);
+
+	return pc;
+}
+
+static void poll_cache_put(struct poll_cache *pc)
+{
+	k_mutex_lock(&poll_cache_lock, K_FOREVER);
+	pc->busy = false;
+	k_mutex_unlock(&poll_cache_lock);
+}
+
+/* Called when a socket is closed, so no poll set keeps watching it */
+static void poll_cache_forget(struct net_context *ctx)
+{
+	k_mutex_lock(&poll_cache_lock, K_FOREVER);
+
+	for (int i = 0; i < ARRAY_SIZE(poll_caches); i++) {
+		struct poll_cache *pc = &poll_caches[i];
+
+		for (int j = 0; j < ARRAY_SIZE(pc->events); j++) {
+			if (pc->events[j].obj == &ctx->recv_q) {
+				(void)k_poll_set_remove(&pc->set,
+							&pc->events[j]);
+				pc->events[j].obj = NULL;
+			}
+		}
+	}
+
+	k_mutex_unlock(&poll_cache_lock);
+}
+#else
+#define poll_cache_forget(ctx) do { } while (false)
+#endif /* CONFIG_NET_SOCKETS_POLL_SETS > 0 */
+
 int _impl_zsock_socket(int family, int type, int proto)
 {
 	int fd = z_reserve_fd();
@@ -125,6 +230,7 @@ int zsock_close_ctx(struct net_context *ctx)
 	}
 
 	zsock_flush_queue(ctx);
+	poll_cache_forget(ctx);
 
 	SET_ERRNO(net_context_put(ctx));
 
@@ -360,16 +466,60 @@ Z_SYSCALL_HANDLER(zsock_accept, sock, addr, addrlen)
 }
 #endif /* CONFIG_USERSPACE */
 
+static inline s32_t zsock_timeout(struct net_context *ctx, int flags)
+{
+	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
+		return K_NO_WAIT;
+	}
+
+	return K_FOREVER;
+}
+
+/* Registers the callback before sending in order to receive the response
+ * from the peer. Returns 0 or the negative error code.
+ */
+static inline int zsock_send_prepare(struct net_context *ctx)
+{
+	return net_context_recv(ctx, zsock_received_cb, K_NO_WAIT,
+				ctx->user_data);
+}
+
+/* Sends send_pkt, which already holds the payload, once
+ * zsock_send_prepare() was called. On error, send_pkt is released and the
+ * negative error code is returned.
+ */
+static int zsock_send_pkt(struct net_context *ctx, struct net_pkt *send_pkt,
+			  s32_t timeout, const struct sockaddr *dest_addr,
+			  socklen_t addrlen)
+{
+	int err;
+
+	if (dest_addr) {
+		err = net_context_sendto(send_pkt, dest_addr, addrlen, NULL,
+					 timeout, NULL, ctx->user_data);
+	} else {
+		err = net_context_send(send_pkt, NULL, timeout, NULL, ctx->user_data);
+	}
+
+	if (err < 0) {
+		net_pkt_unref(send_pkt);
+	}
+
+	return err;
+}
+
 ssize_t zsock_sendto_ctx(struct net_context *ctx, const void *buf, size_t len,
 			 int flags,
 			 const struct sockaddr *dest_addr, socklen_t addrlen)
 {
 	int err;
 	struct net_pkt *send_pkt;
-	s32_t timeout = K_FOREVER;
+	s32_t timeout = zsock_timeout(ctx, flags);
 
-	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
-		timeout = K_NO_WAIT;
+	err = zsock_send_prepare(ctx);
+	if (err < 0) {
+		errno = -err;
+		return -1;
 	}
 
 	send_pkt = net_pkt_get_tx(ctx, timeout);
@@ -385,25 +535,8 @@ ssize_t zsock_sendto_ctx(struct net_context *ctx, const void *buf, size_t len,
 		return -1;
 	}
 
-	/* Register the callback before sending in order to receive the response
-	 * from the peer.
-	 */
-	err = net_context_recv(ctx, zsock_received_cb, K_NO_WAIT, ctx->user_data);
-	if (err < 0) {
-		net_pkt_unref(send_pkt);
-		errno = -err;
-		return -1;
-	}
-
-	if (dest_addr) {
-		err = net_context_sendto(send_pkt, dest_addr, addrlen, NULL,
-					 timeout, NULL, ctx->user_data);
-	} else {
-		err = net_context_send(send_pkt, NULL, timeout, NULL, ctx->user_data);
-	}
-
+	err = zsock_send_pkt(ctx, send_pkt, timeout, dest_addr, addrlen);
 	if (err < 0) {
-		net_pkt_unref(send_pkt);
 		errno = -err;
 		return -1;
 	}
@@ -441,237 +574,1059 @@ Z_SYSCALL_HANDLER(zsock_sendto, sock, buf, len, flags, dest_addr, addrlen)
 }
 #endif /* CONFIG_USERSPACE */
 
-static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
-				       void *buf,
-				       size_t max_len,
-				       int flags,
-				       struct sockaddr *src_addr,
-				       socklen_t *addrlen)
+/* Sends one message once zsock_send_prepare() was called */
+static ssize_t zsock_send_msg(struct net_context *ctx,
+			      const struct zsock_msghdr *msg, s32_t timeout)
 {
-	size_t recv_len = 0;
-	s32_t timeout = K_FOREVER;
-	unsigned int header_len;
-	struct net_pkt *pkt;
+	int err;
+	struct net_pkt *send_pkt;
+	size_t len = 0;
+	size_t i;
 
-	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
-		timeout = K_NO_WAIT;
+	send_pkt = net_pkt_get_tx(ctx, timeout);
+	if (!send_pkt) {
+		errno = EAGAIN;
+		return -1;
 	}
 
-	if (flags & ZSOCK_MSG_PEEK) {
-		int res;
-
-		res = _k_fifo_wait_non_empty(&ctx->recv_q, timeout);
-		/* EAGAIN when timeout expired, EINTR when cancelled */
-		if (res && res != -EAGAIN && res != -EINTR) {
-			errno = -res;
-			return -1;
+	/* Gather all the buffers into the one packet, stopping at the first
+	 * one which does not fit entirely.
+	 */
+	for (i = 0; i < msg->msg_iovlen; i++) {
+		const struct zsock_iovec *iov = &msg->msg_iov[i];
+		size_t appended;
+
+		appended = net_pkt_append(send_pkt,
+					  min(iov->iov_len, UINT16_MAX),
+					  iov->iov_base, timeout);
+		len += appended;
+		if (appended < iov->iov_len) {
+			break;
 		}
-
-		pkt = k_fifo_peek_head(&ctx->recv_q);
-	} else {
-		pkt = k_fifo_get(&ctx->recv_q, timeout);
 	}
 
-	if (!pkt) {
+	if (!len) {
+		net_pkt_unref(send_pkt);
 		errno = EAGAIN;
 		return -1;
 	}
 
-	if (src_addr && addrlen) {
-		int rv;
-
-		rv = net_pkt_get_src_addr(pkt, src_addr, *addrlen);
-		if (rv < 0) {
-			errno = rv;
-			return -1;
-		}
-
-		/* addrlen is a value-result argument, set to actual
-		 * size of source address
-		 */
-		if (src_addr->sa_family == AF_INET) {
-			*addrlen = sizeof(struct sockaddr_in);
-		} else if (src_addr->sa_family == AF_INET6) {
-			*addrlen = sizeof(struct sockaddr_in6);
-		} else {
-			errno = ENOTSUP;
-			return -1;
-		}
+	err = zsock_send_pkt(ctx, send_pkt, timeout, msg->msg_name,
+			     msg->msg_namelen);
+	if (err < 0) {
+		errno = -err;
+		return -1;
 	}
 
-	/* Set starting point behind packet header since we've
-	 * handled src addr and port.
-	 */
-	header_len = net_pkt_appdata(pkt) - pkt->frags->data;
+	return len;
+}
 
-	recv_len = net_pkt_appdatalen(pkt);
-	if (recv_len > max_len) {
-		recv_len = max_len;
+static ssize_t zsock_sendmsg_ctx(struct net_context *ctx,
+				 const struct zsock_msghdr *msg, int flags)
+{
+	int err;
+
+	err = zsock_send_prepare(ctx);
+	if (err < 0) {
+		errno = -err;
+		return -1;
 	}
 
-	net_frag_linearize(buf, recv_len, pkt, header_len, recv_len);
+	return zsock_send_msg(ctx, msg, zsock_timeout(ctx, flags));
+}
 
-	if (!(flags & ZSOCK_MSG_PEEK)) {
-		net_pkt_unref(pkt);
+ssize_t _impl_zsock_sendmsg(int sock, const struct zsock_msghdr *msg,
+			    int flags)
+{
+	struct net_context *ctx = sock_to_net_ctx(sock);
+
+	if (ctx == NULL) {
+		return -1;
 	}
 
-	return recv_len;
+	return zsock_sendmsg_ctx(ctx, msg, flags);
 }
 
-static inline ssize_t zsock_recv_stream(struct net_context *ctx,
-					void *buf,
-					size_t max_len,
-					int flags)
+#ifdef CONFIG_USERSPACE
+/* Replaces the iovec array of a message header copied from user mode by
+ * a copy of its own, once checked that the calling thread may access
+ * the buffers it describes. The copy is released with k_free().
+ *
+ * The message helpers below return -EFAULT rather than oops right away,
+ * so that the caller can release what it copied in before.
+ */
+static int zsock_iov_from_user(struct zsock_msghdr *msg, int write)
 {
-	size_t recv_len = 0;
-	s32_t timeout = K_FOREVER;
-	int res;
+	struct zsock_iovec *iov;
+	size_t i;
 
-	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
-		timeout = K_NO_WAIT;
+	if (msg->msg_iovlen == 0) {
+		msg->msg_iov = NULL;
+		return 0;
 	}
 
-	do {
-		struct net_pkt *pkt;
-		struct net_buf *frag;
-		u32_t frag_len;
-
-		if (sock_is_eof(ctx)) {
-			return 0;
-		}
+	if (Z_SYSCALL_MEMORY_ARRAY_READ(msg->msg_iov, msg->msg_iovlen,
+					sizeof(*iov))) {
+		return -EFAULT;
+	}
 
-		res = _k_fifo_wait_non_empty(&ctx->recv_q, timeout);
-		/* EAGAIN when timeout expired, EINTR when cancelled */
-		if (res && res != -EAGAIN && res != -EINTR) {
-			errno = -res;
-			return -1;
-		}
+	iov = z_user_alloc_from_copy(msg->msg_iov,
+				     msg->msg_iovlen * sizeof(*iov));
+	if (!iov) {
+		return -ENOMEM;
+	}
 
-		pkt = k_fifo_peek_head(&ctx->recv_q);
-		if (!pkt) {
-			/* Either timeout expired, or wait was cancelled
-			 * due to connection closure by peer.
-			 */
-			NET_DBG("NULL return from fifo");
-			if (sock_is_eof(ctx)) {
-				return 0;
-			} else {
-				errno = EAGAIN;
-				return -1;
-			}
+	for (i = 0; i < msg->msg_iovlen; i++) {
+		if (Z_SYSCALL_MEMORY(iov[i].iov_base, iov[i].iov_len, write)) {
+			k_free(iov);
+			return -EFAULT;
 		}
+	}
 
-		frag = pkt->frags;
-		if (!frag) {
-			NET_ERR("net_pkt has empty fragments on start!");
-			errno = EAGAIN;
-			return -1;
-		}
+	msg->msg_iov = iov;
 
-		frag_len = frag->len;
-		recv_len = frag_len;
-		if (recv_len > max_len) {
-			recv_len = max_len;
-		}
+	return 0;
+}
 
-		/* Actually copy data to application buffer */
-		memcpy(buf, frag->data, recv_len);
+/* Copies in a message header to send from user mode, along with its
+ * destination address and iovec array.
+ */
+static int zsock_send_msghdr_from_user(struct zsock_msghdr *msg_copy,
+				       struct zsock_msghdr *msg,
+				       struct sockaddr_storage *addr_copy)
+{
+	if (z_user_from_copy(msg_copy, msg, sizeof(*msg_copy))) {
+		return -EFAULT;
+	}
 
-		if (!(flags & ZSOCK_MSG_PEEK)) {
-			if (recv_len != frag_len) {
-				net_buf_pull(frag, recv_len);
-			} else {
-				frag = net_pkt_frag_del(pkt, NULL, frag);
-				if (!frag) {
-					/* Finished processing head pkt in
-					 * the fifo. Drop it from there.
-					 */
-					k_fifo_get(&ctx->recv_q, K_NO_WAIT);
-					if (net_pkt_eof(pkt)) {
-						sock_set_eof(ctx);
-					}
-
-					net_pkt_unref(pkt);
-				}
-			}
+	if (msg_copy->msg_name) {
+		if (Z_SYSCALL_VERIFY(msg_copy->msg_namelen <=
+				     sizeof(*addr_copy)) ||
+		    z_user_from_copy(addr_copy, msg_copy->msg_name,
+				     msg_copy->msg_namelen)) {
+			return -EFAULT;
 		}
-	} while (recv_len == 0);
 
-	if (!(flags & ZSOCK_MSG_PEEK)) {
-		net_context_update_recv_wnd(ctx, recv_len);
+		msg_copy->msg_name = addr_copy;
 	}
 
-	return recv_len;
+	return zsock_iov_from_user(msg_copy, 0);
 }
 
-ssize_t zsock_recvfrom_ctx(struct net_context *ctx, void *buf, size_t max_len,
-			   int flags,
-			   struct sockaddr *src_addr, socklen_t *addrlen)
-{
-	enum net_sock_type sock_type = net_context_get_type(ctx);
-
-	if (sock_type == SOCK_DGRAM) {
-		return zsock_recv_dgram(ctx, buf, max_len, flags, src_addr, addrlen);
-	} else if (sock_type == SOCK_STREAM) {
-		return zsock_recv_stream(ctx, buf, max_len, flags);
-	} else {
-		__ASSERT(0, "Unknown socket type");
-	}
+/* How many messages the mmsg handlers copy in from user mode at a time */
+#define ZSOCK_MMSG_CHUNK 8
 
-	return 0;
-}
+struct zsock_mmsg_chunk {
+	struct zsock_mmsghdr msgs[ZSOCK_MMSG_CHUNK];
+	struct sockaddr_storage addrs[ZSOCK_MMSG_CHUNK];
+};
 
-ssize_t _impl_zsock_recvfrom(int sock, void *buf, size_t max_len, int flags,
-			     struct sockaddr *src_addr, socklen_t *addrlen)
+/* Releases the iovec copies of the first n messages of a chunk */
+static void zsock_mmsg_chunk_free(struct zsock_mmsg_chunk *chunk,
+				  unsigned int n)
 {
-	struct net_context *ctx = sock_to_net_ctx(sock);
-
-	if (ctx == NULL) {
-		return -1;
+	while (n--) {
+		k_free(chunk->msgs[n].msg_hdr.msg_iov);
 	}
-
-	return zsock_recvfrom_ctx(ctx, buf, max_len, flags, src_addr, addrlen);
 }
 
-#ifdef CONFIG_USERSPACE
-Z_SYSCALL_HANDLER(zsock_recvfrom, sock, buf, max_len, flags, src_addr,
-		  addrlen_param)
+Z_SYSCALL_HANDLER(zsock_sendmsg, sock, msg, flags)
 {
-	socklen_t addrlen_copy;
-	socklen_t *addrlen_ptr = (socklen_t *)addrlen_param;
+	struct zsock_msghdr msg_copy;
+	struct sockaddr_storage dest_addr_copy;
 	ssize_t ret;
+	int err;
 
-	if (Z_SYSCALL_MEMORY_WRITE(buf, max_len)) {
-		errno = EFAULT;
+	err = zsock_send_msghdr_from_user(&msg_copy,
+					  (struct zsock_msghdr *)msg,
+					  &dest_addr_copy);
+	Z_OOPS(err == -EFAULT);
+	if (err < 0) {
+		errno = -err;
 		return -1;
 	}
 
-	if (addrlen_param) {
-		Z_OOPS(z_user_from_copy(&addrlen_copy,
-					(socklen_t *)addrlen_param,
-					sizeof(socklen_t)));
-	}
-	Z_OOPS(src_addr && Z_SYSCALL_MEMORY_WRITE(src_addr, addrlen_copy));
-
-	ret = _impl_zsock_recvfrom(sock, (void *)buf, max_len, flags,
-				   (struct sockaddr *)src_addr,
-				   addrlen_param ? &addrlen_copy : NULL);
+	ret = _impl_zsock_sendmsg(sock, &msg_copy, flags);
 
-	if (addrlen_param) {
-		Z_OOPS(z_user_to_copy(addrlen_ptr, &addrlen_copy,
-				      sizeof(socklen_t)));
-	}
+	k_free(msg_copy.msg_iov);
 
 	return ret;
 }
 #endif /* CONFIG_USERSPACE */
 
-/* As this is limited function, we don't follow POSIX signature, with
- * "..." instead of last arg.
+/* Sends messages once zsock_send_prepare() was called, and returns how
+ * many were sent. errno tells why, if not all of them.
  */
-int _impl_zsock_fcntl(int sock, int cmd, int flags)
+static unsigned int zsock_send_msgs(struct net_context *ctx,
+				    struct zsock_mmsghdr *msgvec,
+				    unsigned int vlen, s32_t timeout)
 {
-	struct net_context *ctx = sock_to_net_ctx(sock);
+	unsigned int i;
+	ssize_t len;
+
+	for (i = 0; i < vlen; i++) {
+		len = zsock_send_msg(ctx, &msgvec[i].msg_hdr, timeout);
+		if (len < 0) {
+			break;
+		}
+
+		msgvec[i].msg_len = len;
+	}
+
+	return i;
+}
+
+static int zsock_sendmmsg_ctx(struct net_context *ctx,
+			      struct zsock_mmsghdr *msgvec, unsigned int vlen,
+			      int flags)
+{
+	unsigned int sent;
+	int err;
+
+	err = zsock_send_prepare(ctx);
+	if (err < 0) {
+		errno = -err;
+		return -1;
+	}
+
+	sent = zsock_send_msgs(ctx, msgvec, vlen, zsock_timeout(ctx, flags));
+
+	/* An error is only reported if no message was sent */
+	return (sent > 0 || vlen == 0) ? sent : -1;
+}
+
+int _impl_zsock_sendmmsg(int sock, struct zsock_mmsghdr *msgvec,
+			 unsigned int vlen, int flags)
+{
+	struct net_context *ctx = sock_to_net_ctx(sock);
+
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	return zsock_sendmmsg_ctx(ctx, msgvec, vlen, flags);
+}
+
+#ifdef CONFIG_USERSPACE
+Z_SYSCALL_HANDLER(zsock_sendmmsg, sock, msgvec, vlen, flags)
+{
+	struct zsock_mmsghdr *msgvec_ptr = (struct zsock_mmsghdr *)msgvec;
+	struct net_context *ctx = sock_to_net_ctx(sock);
+	struct zsock_mmsg_chunk *chunk;
+	unsigned int done = 0;
+	unsigned int i, n, sent;
+	s32_t timeout;
+	int err;
+
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	Z_OOPS(Z_SYSCALL_MEMORY_ARRAY_WRITE(msgvec_ptr, vlen,
+					    sizeof(*msgvec_ptr)));
+
+	err = zsock_send_prepare(ctx);
+	if (err < 0) {
+		errno = -err;
+		return -1;
+	}
+
+	if (vlen == 0) {
+		return 0;
+	}
+
+	chunk = k_malloc(sizeof(*chunk));
+	if (!chunk) {
+		errno = ENOMEM;
+		return -1;
+	}
+
+	timeout = zsock_timeout(ctx, flags);
+
+	/* Messages are copied in and sent a chunk at a time, so as not to
+	 * need memory for the whole batch, with the socket looked up and
+	 * prepared only once.
+	 */
+	while (done < vlen) {
+		n = min(vlen - done, ZSOCK_MMSG_CHUNK);
+
+		for (i = 0; i < n; i++) {
+			err = zsock_send_msghdr_from_user(
+				&chunk->msgs[i].msg_hdr,
+				&msgvec_ptr[done + i].msg_hdr,
+				&chunk->addrs[i]);
+			if (err < 0) {
+				break;
+			}
+		}
+
+		if (err < 0) {
+			zsock_mmsg_chunk_free(chunk, i);
+			break;
+		}
+
+		sent = zsock_send_msgs(ctx, chunk->msgs, n, timeout);
+
+		for (i = 0; i < sent; i++) {
+			msgvec_ptr[done + i].msg_len = chunk->msgs[i].msg_len;
+		}
+
+		zsock_mmsg_chunk_free(chunk, n);
+
+		done += sent;
+		if (sent < n) {
+			break;
+		}
+	}
+
+	k_free(chunk);
+
+	Z_OOPS(err == -EFAULT);
+
+	/* An error is only reported if no message was sent */
+	if (done == 0 && err < 0) {
+		errno = -err;
+	}
+
+	return done > 0 ? done : -1;
+}
+#endif /* CONFIG_USERSPACE */
+
+/* The data of a TLS socket has to go through mbedTLS, which the zero-copy
+ * calls would bypass.
+ */
+static inline bool zsock_is_tls(struct net_context *ctx)
+{
+#if defined(CONFIG_NET_SOCKETS_SOCKOPT_TLS)
+	return ctx->tls != NULL;
+#else
+	return false;
+#endif
+}
+
+ssize_t zsock_send_zc(int sock, struct net_buf *frags, int flags,
+		      const struct sockaddr *dest_addr, socklen_t addrlen)
+{
+	struct net_context *ctx = sock_to_net_ctx(sock);
+	struct net_pkt *send_pkt;
+	s32_t timeout;
+	size_t len;
+	int err;
+
+	if (ctx == NULL) {
+		goto drop;
+	}
+
+	if (zsock_is_tls(ctx)) {
+		errno = EOPNOTSUPP;
+		goto drop;
+	}
+
+	len = net_buf_frags_len(frags);
+	if (!len) {
+		errno = EINVAL;
+		goto drop;
+	}
+
+	err = zsock_send_prepare(ctx);
+	if (err < 0) {
+		errno = -err;
+		goto drop;
+	}
+
+	timeout = zsock_timeout(ctx, flags);
+
+	send_pkt = net_pkt_get_tx(ctx, timeout);
+	if (!send_pkt) {
+		errno = EAGAIN;
+		goto drop;
+	}
+
+	/* The packet takes over the caller's reference. Headers may have
+	 * been linked in front of the fragments by the time sending fails,
+	 * so they go away with the packet.
+	 */
+	net_pkt_frag_add(send_pkt, frags);
+
+	err = zsock_send_pkt(ctx, send_pkt, timeout, dest_addr, addrlen);
+	if (err < 0) {
+		errno = -err;
+		return -1;
+	}
+
+	return len;
+
+drop:
+	if (frags) {
+		net_buf_unref(frags);
+	}
+
+	return -1;
+}
+
+/* Copies up to len bytes of a fragment chain, starting at offset, into
+ * an iovec array, and returns how many were copied.
+ */
+static size_t zsock_copy_to_iov(struct net_buf *frag, size_t offset,
+				size_t len, const struct zsock_iovec *iov,
+				size_t iovlen)
+{
+	size_t copied = 0;
+	size_t iov_off = 0;
+
+	while (frag && offset >= frag->len) {
+		offset -= frag->len;
+		frag = frag->frags;
+	}
+
+	while (frag && iovlen && copied < len) {
+		size_t chunk = min(frag->len - offset, iov->iov_len - iov_off);
+
+		chunk = min(chunk, len - copied);
+		memcpy((u8_t *)iov->iov_base + iov_off, frag->data + offset,
+		       chunk);
+		copied += chunk;
+		offset += chunk;
+		iov_off += chunk;
+
+		if (offset == frag->len) {
+			frag = frag->frags;
+			offset = 0;
+		}
+
+		if (iov_off == iov->iov_len) {
+			iov++;
+			iovlen--;
+			iov_off = 0;
+		}
+	}
+
+	return copied;
+}
+
+/* Gets the next datagram, filling in its source address if requested.
+ * The datagram is left in the queue if flags has ZSOCK_MSG_PEEK.
+ */
+static struct net_pkt *zsock_get_dgram(struct net_context *ctx, int flags,
+				       struct sockaddr *src_addr,
+				       socklen_t *addrlen)
+{
+	s32_t timeout = zsock_timeout(ctx, flags);
+	struct net_pkt *pkt;
+
+	if (flags & ZSOCK_MSG_PEEK) {
+		int res;
+
+		res = _k_fifo_wait_non_empty(&ctx->recv_q, timeout);
+		/* EAGAIN when timeout expired, EINTR when cancelled */
+		if (res && res != -EAGAIN && res != -EINTR) {
+			errno = -res;
+			return NULL;
+		}
+
+		pkt = k_fifo_peek_head(&ctx->recv_q);
+	} else {
+		pkt = k_fifo_get(&ctx->recv_q, timeout);
+	}
+
+	if (!pkt) {
+		errno = EAGAIN;
+		return NULL;
+	}
+
+	if (src_addr && addrlen) {
+		int rv;
+
+		rv = net_pkt_get_src_addr(pkt, src_addr, *addrlen);
+		if (rv < 0) {
+			errno = -rv;
+			goto fail;
+		}
+
+		/* addrlen is a value-result argument, set to actual
+		 * size of source address
+		 */
+		if (src_addr->sa_family == AF_INET) {
+			*addrlen = sizeof(struct sockaddr_in);
+		} else if (src_addr->sa_family == AF_INET6) {
+			*addrlen = sizeof(struct sockaddr_in6);
+		} else {
+			errno = ENOTSUP;
+			goto fail;
+		}
+	}
+
+	return pkt;
+
+fail:
+	if (!(flags & ZSOCK_MSG_PEEK)) {
+		net_pkt_unref(pkt);
+	}
+
+	return NULL;
+}
+
+static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
+				       const struct zsock_iovec *iov,
+				       size_t iovlen,
+				       int flags,
+				       struct sockaddr *src_addr,
+				       socklen_t *addrlen,
+				       int *msg_flags)
+{
+	size_t recv_len;
+	size_t data_len;
+	unsigned int header_len;
+	struct net_pkt *pkt;
+
+	pkt = zsock_get_dgram(ctx, flags, src_addr, addrlen);
+	if (!pkt) {
+		return -1;
+	}
+
+	/* Set starting point behind packet header since we've
+	 * handled src addr and port.
+	 */
+	header_len = net_pkt_appdata(pkt) - pkt->frags->data;
+	data_len = net_pkt_appdatalen(pkt);
+
+	recv_len = zsock_copy_to_iov(pkt->frags, header_len, data_len,
+				     iov, iovlen);
+	if (recv_len < data_len && msg_flags) {
+		*msg_flags |= ZSOCK_MSG_TRUNC;
+	}
+
+	if (!(flags & ZSOCK_MSG_PEEK)) {
+		net_pkt_unref(pkt);
+	}
+
+	return recv_len;
+}
+
+static ssize_t zsock_recv_dgram_zc(struct net_context *ctx,
+				   struct net_buf **frags, int flags,
+				   struct sockaddr *src_addr,
+				   socklen_t *addrlen)
+{
+	unsigned int header_len;
+	struct net_pkt *pkt;
+	struct net_buf *frag;
+
+	pkt = zsock_get_dgram(ctx, flags, src_addr, addrlen);
+	if (!pkt) {
+		return -1;
+	}
+
+	/* Strip the headers, dropping the fragments holding nothing else */
+	header_len = net_pkt_appdata(pkt) - pkt->frags->data;
+	frag = pkt->frags;
+	while (frag && header_len >= frag->len) {
+		header_len -= frag->len;
+		frag = net_pkt_frag_del(pkt, NULL, frag);
+	}
+
+	if (frag) {
+		net_buf_pull(frag, header_len);
+	}
+
+	*frags = pkt->frags;
+	pkt->frags = NULL;
+	net_pkt_unref(pkt);
+
+	return net_buf_frags_len(*frags);
+}
+
+/* Waits for a stream socket to have data queued. Returns 1 with the
+ * packet at the head of the queue in pkt, 0 on EOF, or -1 with errno set.
+ */
+static int zsock_wait_stream(struct net_context *ctx, s32_t timeout,
+			     struct net_pkt **pkt)
+{
+	int res;
+
+	if (sock_is_eof(ctx)) {
+		return 0;
+	}
+
+	res = _k_fifo_wait_non_empty(&ctx->recv_q, timeout);
+	/* EAGAIN when timeout expired, EINTR when cancelled */
+	if (res && res != -EAGAIN && res != -EINTR) {
+		errno = -res;
+		return -1;
+	}
+
+	*pkt = k_fifo_peek_head(&ctx->recv_q);
+	if (!*pkt) {
+		/* Either timeout expired, or wait was cancelled
+		 * due to connection closure by peer.
+		 */
+		NET_DBG("NULL return from fifo");
+		if (sock_is_eof(ctx)) {
+			return 0;
+		}
+
+		errno = EAGAIN;
+		return -1;
+	}
+
+	if (!(*pkt)->frags) {
+		NET_ERR("net_pkt has empty fragments on start!");
+		errno = EAGAIN;
+		return -1;
+	}
+
+	return 1;
+}
+
+/* Drops the packet at the head of a stream socket's queue, once all of
+ * its data was received.
+ */
+static void zsock_stream_pkt_done(struct net_context *ctx,
+				  struct net_pkt *pkt)
+{
+	k_fifo_get(&ctx->recv_q, K_NO_WAIT);
+	if (net_pkt_eof(pkt)) {
+		sock_set_eof(ctx);
+	}
+
+	net_pkt_unref(pkt);
+}
+
+static inline ssize_t zsock_recv_stream(struct net_context *ctx,
+					const struct zsock_iovec *iov,
+					size_t iovlen,
+					int flags)
+{
+	bool peek = flags & ZSOCK_MSG_PEEK;
+	s32_t timeout = zsock_timeout(ctx, flags);
+	size_t recv_len = 0;
+	size_t iov_off = 0;
+	int res;
+
+	do {
+		struct net_pkt *pkt;
+		struct net_buf *frag;
+		size_t frag_off = 0;
+
+		res = zsock_wait_stream(ctx, timeout, &pkt);
+		if (res <= 0) {
+			return res;
+		}
+
+		/* Actually copy data to application buffers, for as long
+		 * as both they and the head packet have some left.
+		 */
+		frag = pkt->frags;
+		while (frag && iovlen) {
+			size_t len = min(frag->len - frag_off,
+					 iov->iov_len - iov_off);
+
+			memcpy((u8_t *)iov->iov_base + iov_off,
+			       frag->data + frag_off, len);
+			recv_len += len;
+			frag_off += len;
+			iov_off += len;
+
+			if (iov_off == iov->iov_len) {
+				iov++;
+				iovlen--;
+				iov_off = 0;
+			}
+
+			if (frag_off == frag->len) {
+				if (peek) {
+					frag = frag->frags;
+				} else {
+					frag = net_pkt_frag_del(pkt, NULL,
+								frag);
+				}
+
+				frag_off = 0;
+			}
+		}
+
+		if (!peek) {
+			if (frag) {
+				net_buf_pull(frag, frag_off);
+			} else {
+				/* Finished processing head pkt in
+				 * the fifo. Drop it from there.
+				 */
+				zsock_stream_pkt_done(ctx, pkt);
+			}
+		}
+	} while (recv_len == 0 && iovlen);
+
+	if (!peek) {
+		net_context_update_recv_wnd(ctx, recv_len);
+	}
+
+	return recv_len;
+}
+
+static ssize_t zsock_recv_stream_zc(struct net_context *ctx,
+				    struct net_buf **frags, int flags)
+{
+	s32_t timeout = zsock_timeout(ctx, flags);
+	size_t recv_len;
+	int res;
+
+	do {
+		struct net_pkt *pkt;
+
+		res = zsock_wait_stream(ctx, timeout, &pkt);
+		if (res <= 0) {
+			return res;
+		}
+
+		/* Hand over what is left of the head pkt as a whole */
+		*frags = pkt->frags;
+		pkt->frags = NULL;
+		zsock_stream_pkt_done(ctx, pkt);
+
+		recv_len = net_buf_frags_len(*frags);
+		if (!recv_len) {
+			net_buf_unref(*frags);
+			*frags = NULL;
+		}
+	} while (recv_len == 0);
+
+	net_context_update_recv_wnd(ctx, recv_len);
+
+	return recv_len;
+}
+
+ssize_t zsock_recvfrom_ctx(struct net_context *ctx, void *buf, size_t max_len,
+			   int flags,
+			   struct sockaddr *src_addr, socklen_t *addrlen)
+{
+	enum net_sock_type sock_type = net_context_get_type(ctx);
+	struct zsock_iovec iov = {
+		.iov_base = buf,
+		.iov_len = max_len,
+	};
+
+	if (sock_type == SOCK_DGRAM) {
+		return zsock_recv_dgram(ctx, &iov, 1, flags, src_addr, addrlen,
+					NULL);
+	} else if (sock_type == SOCK_STREAM) {
+		return zsock_recv_stream(ctx, &iov, 1, flags);
+	} else {
+		__ASSERT(0, "Unknown socket type");
+	}
+
+	return 0;
+}
+
+ssize_t _impl_zsock_recvfrom(int sock, void *buf, size_t max_len, int flags,
+			     struct sockaddr *src_addr, socklen_t *addrlen)
+{
+	struct net_context *ctx = sock_to_net_ctx(sock);
+
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	return zsock_recvfrom_ctx(ctx, buf, max_len, flags, src_addr, addrlen);
+}
+
+#ifdef CONFIG_USERSPACE
+Z_SYSCALL_HANDLER(zsock_recvfrom, sock, buf, max_len, flags, src_addr,
+		  addrlen_param)
+{
+	socklen_t addrlen_copy;
+	socklen_t *addrlen_ptr = (socklen_t *)addrlen_param;
+	ssize_t ret;
+
+	if (Z_SYSCALL_MEMORY_WRITE(buf, max_len)) {
+		errno = EFAULT;
+		return -1;
+	}
+
+	if (addrlen_param) {
+		Z_OOPS(z_user_from_copy(&addrlen_copy,
+					(socklen_t *)addrlen_param,
+					sizeof(socklen_t)));
+	}
+	Z_OOPS(src_addr && Z_SYSCALL_MEMORY_WRITE(src_addr, addrlen_copy));
+
+	ret = _impl_zsock_recvfrom(sock, (void *)buf, max_len, flags,
+				   (struct sockaddr *)src_addr,
+				   addrlen_param ? &addrlen_copy : NULL);
+
+	if (addrlen_param) {
+		Z_OOPS(z_user_to_copy(addrlen_ptr, &addrlen_copy,
+				      sizeof(socklen_t)));
+	}
+
+	return ret;
+}
+#endif /* CONFIG_USERSPACE */
+
+static ssize_t zsock_recvmsg_ctx(struct net_context *ctx,
+				 struct zsock_msghdr *msg, int flags)
+{
+	enum net_sock_type sock_type = net_context_get_type(ctx);
+
+	msg->msg_controllen = 0;
+	msg->msg_flags = 0;
+
+	if (sock_type == SOCK_DGRAM) {
+		return zsock_recv_dgram(ctx, msg->msg_iov, msg->msg_iovlen,
+					flags, msg->msg_name,
+					msg->msg_name ? &msg->msg_namelen : NULL,
+					&msg->msg_flags);
+	} else if (sock_type == SOCK_STREAM) {
+		msg->msg_namelen = 0;
+		return zsock_recv_stream(ctx, msg->msg_iov, msg->msg_iovlen,
+					 flags);
+	} else {
+		__ASSERT(0, "Unknown socket type");
+	}
+
+	return 0;
+}
+
+ssize_t _impl_zsock_recvmsg(int sock, struct zsock_msghdr *msg, int flags)
+{
+	struct net_context *ctx = sock_to_net_ctx(sock);
+
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	return zsock_recvmsg_ctx(ctx, msg, flags);
+}
+
+#ifdef CONFIG_USERSPACE
+/* Copies in a message header to receive into from user mode, along with
+ * its iovec array.
+ */
+static int zsock_recv_msghdr_from_user(struct zsock_msghdr *msg_copy,
+				       struct zsock_msghdr *msg)
+{
+	if (z_user_from_copy(msg_copy, msg, sizeof(*msg_copy)) ||
+	    (msg_copy->msg_name &&
+	     Z_SYSCALL_MEMORY_WRITE(msg_copy->msg_name,
+				    msg_copy->msg_namelen))) {
+		return -EFAULT;
+	}
+
+	return zsock_iov_from_user(msg_copy, 1);
+}
+
+/* Copies back the message header fields set on receive to user mode */
+static void zsock_recv_msghdr_to_user(struct zsock_msghdr *msg,
+				      struct zsock_msghdr *msg_copy,
+				      void *ssf)
+{
+	Z_OOPS(z_user_to_copy(&msg->msg_namelen, &msg_copy->msg_namelen,
+			      sizeof(msg_copy->msg_namelen)));
+	Z_OOPS(z_user_to_copy(&msg->msg_controllen, &msg_copy->msg_controllen,
+			      sizeof(msg_copy->msg_controllen)));
+	Z_OOPS(z_user_to_copy(&msg->msg_flags, &msg_copy->msg_flags,
+			      sizeof(msg_copy->msg_flags)));
+}
+
+Z_SYSCALL_HANDLER(zsock_recvmsg, sock, msg, flags)
+{
+	struct zsock_msghdr *msg_ptr = (struct zsock_msghdr *)msg;
+	struct zsock_msghdr msg_copy;
+	ssize_t ret;
+	int err;
+
+	err = zsock_recv_msghdr_from_user(&msg_copy, msg_ptr);
+	Z_OOPS(err == -EFAULT);
+	if (err < 0) {
+		errno = -err;
+		return -1;
+	}
+
+	ret = _impl_zsock_recvmsg(sock, &msg_copy, flags);
+
+	k_free(msg_copy.msg_iov);
+
+	zsock_recv_msghdr_to_user(msg_ptr, &msg_copy, ssf);
+
+	return ret;
+}
+#endif /* CONFIG_USERSPACE */
+
+/* Receives messages and returns how many were received. errno tells why,
+ * if not all of them.
+ */
+static unsigned int zsock_recv_msgs(struct net_context *ctx,
+				    struct zsock_mmsghdr *msgvec,
+				    unsigned int vlen, int flags)
+{
+	unsigned int i;
+	ssize_t len;
+
+	for (i = 0; i < vlen; i++) {
+		len = zsock_recvmsg_ctx(ctx, &msgvec[i].msg_hdr, flags);
+		if (len < 0) {
+			break;
+		}
+
+		msgvec[i].msg_len = len;
+
+		if (flags & ZSOCK_MSG_WAITFORONE) {
+			flags |= ZSOCK_MSG_DONTWAIT;
+		}
+	}
+
+	return i;
+}
+
+static int zsock_recvmmsg_ctx(struct net_context *ctx,
+			      struct zsock_mmsghdr *msgvec, unsigned int vlen,
+			      int flags)
+{
+	unsigned int received = zsock_recv_msgs(ctx, msgvec, vlen, flags);
+
+	/* An error is only reported if no message was received */
+	return (received > 0 || vlen == 0) ? received : -1;
+}
+
+int _impl_zsock_recvmmsg(int sock, struct zsock_mmsghdr *msgvec,
+			 unsigned int vlen, int flags)
+{
+	struct net_context *ctx = sock_to_net_ctx(sock);
+
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	return zsock_recvmmsg_ctx(ctx, msgvec, vlen, flags);
+}
+
+#ifdef CONFIG_USERSPACE
+Z_SYSCALL_HANDLER(zsock_recvmmsg, sock, msgvec, vlen, flags)
+{
+	struct zsock_mmsghdr *msgvec_ptr = (struct zsock_mmsghdr *)msgvec;
+	struct net_context *ctx = sock_to_net_ctx(sock);
+	struct zsock_mmsg_chunk *chunk;
+	struct zsock_msghdr *msg;
+	unsigned int done = 0;
+	unsigned int i, n, received;
+	int err = 0;
+
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	Z_OOPS(Z_SYSCALL_MEMORY_ARRAY_WRITE(msgvec_ptr, vlen,
+					    sizeof(*msgvec_ptr)));
+
+	if (vlen == 0) {
+		return 0;
+	}
+
+	chunk = k_malloc(sizeof(*chunk));
+	if (!chunk) {
+		errno = ENOMEM;
+		return -1;
+	}
+
+	/* Messages are copied in and received a chunk at a time, so as not
+	 * to need memory for the whole batch, with the socket looked up
+	 * only once.
+	 */
+	while (done < vlen) {
+		n = min(vlen - done, ZSOCK_MMSG_CHUNK);
+
+		for (i = 0; i < n; i++) {
+			err = zsock_recv_msghdr_from_user(
+				&chunk->msgs[i].msg_hdr,
+				&msgvec_ptr[done + i].msg_hdr);
+			if (err < 0) {
+				break;
+			}
+		}
+
+		if (err < 0) {
+			zsock_mmsg_chunk_free(chunk, i);
+			break;
+		}
+
+		received = zsock_recv_msgs(ctx, chunk->msgs, n, flags);
+
+		/* The user array was checked to be writable above */
+		for (i = 0; i < received; i++) {
+			msg = &msgvec_ptr[done + i].msg_hdr;
+			msg->msg_namelen = chunk->msgs[i].msg_hdr.msg_namelen;
+			msg->msg_controllen =
+				chunk->msgs[i].msg_hdr.msg_controllen;
+			msg->msg_flags = chunk->msgs[i].msg_hdr.msg_flags;
+			msgvec_ptr[done + i].msg_len = chunk->msgs[i].msg_len;
+		}
+
+		zsock_mmsg_chunk_free(chunk, n);
+
+		done += received;
+		if (received < n) {
+			break;
+		}
+
+		if (flags & ZSOCK_MSG_WAITFORONE) {
+			flags |= ZSOCK_MSG_DONTWAIT;
+		}
+	}
+
+	k_free(chunk);
+
+	Z_OOPS(err == -EFAULT);
+
+	/* An error is only reported if no message was received */
+	if (done == 0 && err < 0) {
+		errno = -err;
+	}
+
+	return done > 0 ? done : -1;
+}
+#endif /* CONFIG_USERSPACE */
+
+ssize_t zsock_recv_zc(int sock, struct net_buf **frags, int flags,
+		      struct sockaddr *src_addr, socklen_t *addrlen)
+{
+	struct net_context *ctx = sock_to_net_ctx(sock);
+	enum net_sock_type sock_type;
+
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	if (zsock_is_tls(ctx)) {
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+
+	if (flags & ZSOCK_MSG_PEEK) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	*frags = NULL;
+	sock_type = net_context_get_type(ctx);
+
+	if (sock_type == SOCK_DGRAM) {
+		return zsock_recv_dgram_zc(ctx, frags, flags, src_addr,
+					   addrlen);
+	} else if (sock_type == SOCK_STREAM) {
+		return zsock_recv_stream_zc(ctx, frags, flags);
+	} else {
+		__ASSERT(0, "Unknown socket type");
+	}
+
+	return 0;
+}
+
+/* As this is limited function, we don't follow POSIX signature, with
+ * "..." instead of last arg.
+ */
+int _impl_zsock_fcntl(int sock, int cmd, int flags)
+{
+	struct net_context *ctx = sock_to_net_ctx(sock);
 
 	if (ctx == NULL) {
 		return -1;
@@ -703,20 +1658,16 @@ Z_SYSCALL_HANDLER(zsock_fcntl, sock, cmd, flags)
 }
 #endif
 
-int _impl_zsock_poll(struct zsock_pollfd *fds, int nfds, int timeout)
+/* Sets up one event per socket polled for input, in the order of fds */
+static int zsock_poll_prepare(struct zsock_pollfd *fds, int nfds,
+			      struct k_poll_event *poll_events)
 {
 	int i;
-	int ret = 0;
 	struct zsock_pollfd *pfd;
-	struct k_poll_event poll_events[CONFIG_NET_SOCKETS_POLL_MAX];
-	struct k_poll_event *pev;
-	struct k_poll_event *pev_end = poll_events + ARRAY_SIZE(poll_events);
-
-	if (timeout < 0) {
-		timeout = K_FOREVER;
-	}
+	struct k_poll_event *pev = poll_events;
+	struct k_poll_event *pev_end = poll_events +
+				       CONFIG_NET_SOCKETS_POLL_MAX;
 
-	pev = poll_events;
 	for (pfd = fds, i = nfds; i--; pfd++) {
 		struct net_context *ctx;
 
@@ -746,7 +1697,83 @@ int _impl_zsock_poll(struct zsock_pollfd *fds, int nfds, int timeout)
 		}
 	}
 
-	ret = k_poll(poll_events, pev - poll_events, timeout);
+	return pev - poll_events;
+}
+
+#if CONFIG_NET_SOCKETS_POLL_SETS > 0
+/* Same as k_poll() on @a poll_events, but waiting on the thread's poll
+ * set, where only the sockets which changed place since its previous
+ * call need to be registered again.
+ */
+static int zsock_poll_cached(struct poll_cache *pc,
+			     struct k_poll_event *poll_events, int num,
+			     int timeout)
+{
+	struct k_poll_event *ready[CONFIG_NET_SOCKETS_POLL_MAX];
+	int i, ret;
+
+	k_mutex_lock(&poll_cache_lock, K_FOREVER);
+
+	for (i = 0; i < num; i++) {
+		struct k_poll_event *pev = &pc->events[i];
+
+		if (pev->obj == poll_events[i].obj) {
+			continue;
+		}
+
+		if (pev->obj != NULL) {
+			(void)k_poll_set_remove(&pc->set, pev);
+		}
+
+		k_poll_event_init(pev, K_POLL_TYPE_FIFO_DATA_AVAILABLE,
+				  K_POLL_MODE_NOTIFY_ONLY, poll_events[i].obj);
+		(void)k_poll_set_add(&pc->set, pev);
+	}
+
+	poll_cache_drop(pc, num);
+
+	k_mutex_unlock(&poll_cache_lock);
+
+	ret = k_poll_set_wait(&pc->set, ready, num, timeout);
+
+	for (i = 0; i < ret; i++) {
+		poll_events[ready[i] - pc->events].state = ready[i]->state;
+	}
+
+	return ret < 0 ? ret : 0;
+}
+#endif /* CONFIG_NET_SOCKETS_POLL_SETS > 0 */
+
+int _impl_zsock_poll(struct zsock_pollfd *fds, int nfds, int timeout)
+{
+	int i;
+	int ret = 0;
+	struct zsock_pollfd *pfd;
+	struct k_poll_event poll_events[CONFIG_NET_SOCKETS_POLL_MAX];
+	struct k_poll_event *pev;
+	int num_events;
+
+	if (timeout < 0) {
+		timeout = K_FOREVER;
+	}
+
+	num_events = zsock_poll_prepare(fds, nfds, poll_events);
+	if (num_events < 0) {
+		return -1;
+	}
+
+#if CONFIG_NET_SOCKETS_POLL_SETS > 0
+	struct poll_cache *pc = num_events > 0 ? poll_cache_get() : NULL;
+
+	if (pc != NULL) {
+		ret = zsock_poll_cached(pc, poll_events, num_events, timeout);
+		poll_cache_put(pc);
+	} else {
+		ret = k_poll(poll_events, num_events, timeout);
+	}
+#else
+	ret = k_poll(poll_events, num_events, timeout);
+#endif
 	/* EAGAIN when timeout expired, EINTR when cancelled (i.e. EOF) */
 	if (ret != 0 && ret != -EAGAIN && ret != -EINTR) {
 		errno = -ret;
@@ -1661,6 +1661,168 @@ ssize_t ztls_recvfrom(int sock, void *buf, size_t max_len, int flags,
 #endif /* CONFIG_NET_SOCKETS_ENABLE_DTLS */
 }
 
+/* Over DTLS a message is a single record, which mbedTLS reads or writes
+ * with a single buffer.
+ */
+static bool tls_msg_supported(struct net_context *context,
+			      const struct zsock_msghdr *msg)
+{
+	return net_context_get_type(context) == SOCK_STREAM ||
+	       msg->msg_iovlen == 1;
+}
+
+ssize_t ztls_sendmsg(int sock, const struct zsock_msghdr *msg, int flags)
+{
+	struct net_context *context = sock_to_net_ctx(sock);
+	ssize_t len = 0;
+	ssize_t ret;
+	size_t i;
+
+	if (context == NULL) {
+		return -1;
+	}
+
+	if (!context->tls) {
+		return zsock_sendmsg(sock, msg, flags);
+	}
+
+	if (!tls_msg_supported(context, msg)) {
+		errno = ENOTSUP;
+		return -1;
+	}
+
+	for (i = 0; i < msg->msg_iovlen; i++) {
+		const struct zsock_iovec *iov = &msg->msg_iov[i];
+
+		if (iov->iov_len == 0) {
+			continue;
+		}
+
+		ret = ztls_sendto(sock, iov->iov_base, iov->iov_len, flags,
+				  msg->msg_name, msg->msg_namelen);
+		if (ret < 0) {
+			return len > 0 ? len : -1;
+		}
+
+		len += ret;
+
+		if ((size_t)ret < iov->iov_len) {
+			break;
+		}
+	}
+
+	return len;
+}
+
+ssize_t ztls_recvmsg(int sock, struct zsock_msghdr *msg, int flags)
+{
+	struct net_context *context = sock_to_net_ctx(sock);
+	ssize_t len = 0;
+	ssize_t ret;
+	size_t i;
+
+	if (context == NULL) {
+		return -1;
+	}
+
+	if (!context->tls) {
+		return zsock_recvmsg(sock, msg, flags);
+	}
+
+	if (!tls_msg_supported(context, msg)) {
+		errno = ENOTSUP;
+		return -1;
+	}
+
+	msg->msg_flags = 0;
+
+	for (i = 0; i < msg->msg_iovlen; i++) {
+		struct zsock_iovec *iov = &msg->msg_iov[i];
+
+		if (iov->iov_len == 0) {
+			continue;
+		}
+
+		ret = ztls_recvfrom(sock, iov->iov_base, iov->iov_len, flags,
+				    msg->msg_name,
+				    msg->msg_name ? &msg->msg_namelen : NULL);
+		if (ret < 0) {
+			return len > 0 ? len : -1;
+		}
+
+		len += ret;
+
+		if ((size_t)ret < iov->iov_len) {
+			break;
+		}
+
+		/* Only wait for the start of the data */
+		flags |= ZSOCK_MSG_DONTWAIT;
+	}
+
+	return len;
+}
+
+int ztls_sendmmsg(int sock, struct zsock_mmsghdr *msgvec, unsigned int vlen,
+		  int flags)
+{
+	struct net_context *context = sock_to_net_ctx(sock);
+	unsigned int i;
+	ssize_t len;
+
+	if (context == NULL) {
+		return -1;
+	}
+
+	if (!context->tls) {
+		return zsock_sendmmsg(sock, msgvec, vlen, flags);
+	}
+
+	for (i = 0; i < vlen; i++) {
+		len = ztls_sendmsg(sock, &msgvec[i].msg_hdr, flags);
+		if (len < 0) {
+			break;
+		}
+
+		msgvec[i].msg_len = len;
+	}
+
+	/* An error is only reported if no message was sent */
+	return (i > 0 || vlen == 0) ? i : -1;
+}
+
+int ztls_recvmmsg(int sock, struct zsock_mmsghdr *msgvec, unsigned int vlen,
+		  int flags)
+{
+	struct net_context *context = sock_to_net_ctx(sock);
+	unsigned int i;
+	ssize_t len;
+
+	if (context == NULL) {
+		return -1;
+	}
+
+	if (!context->tls) {
+		return zsock_recvmmsg(sock, msgvec, vlen, flags);
+	}
+
+	for (i = 0; i < vlen; i++) {
+		len = ztls_recvmsg(sock, &msgvec[i].msg_hdr, flags);
+		if (len < 0) {
+			break;
+		}
+
+		msgvec[i].msg_len = len;
+
+		if (flags & ZSOCK_MSG_WAITFORONE) {
+			flags |= ZSOCK_MSG_DONTWAIT;
+		}
+	}
+
+	/* An error is only reported if no message was received */
+	return (i > 0 || vlen == 0) ? i : -1;
+}
+
 int ztls_fcntl(int sock, int cmd, int flags)
 {
 	/* No extra action needed here. */
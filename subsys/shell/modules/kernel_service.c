@@ -53,6 +53,17 @@ static int cmd_kernel_cycles(const struct shell *shell,
 
 #if defined(CONFIG_INIT_STACKS) && defined(CONFIG_THREAD_MONITOR) \
 				&& defined(CONFIG_THREAD_STACK_INFO)
+#if defined(CONFIG_THREAD_RUNTIME_STATS)
+/* Percentage of the time since boot that stats cover */
+static unsigned int runtime_pcnt(const struct k_thread_runtime_stats *stats)
+{
+	u64_t uptime = (u64_t)k_uptime_get() * sys_clock_hw_cycles_per_sec() /
+		       MSEC_PER_SEC;
+
+	return uptime ? (stats->execution_cycles * 100) / uptime : 0;
+}
+#endif
+
 static void shell_tdata_dump(const struct k_thread *thread, void *user_data)
 {
 	unsigned int pcnt, unused = 0;
@@ -77,9 +88,19 @@ static void shell_tdata_dump(const struct k_thread *thread, void *user_data)
 		      thread->base.user_options,
 		      thread->base.prio);
 	shell_fprintf((const struct shell *)user_data, SHELL_NORMAL,
-		"\tstack size %u, unused %u, usage %u / %u (%u %%)\r\n\n",
+		"\tstack size %u, unused %u, usage %u / %u (%u %%)\r\n",
 		      size, unused, size - unused, size, pcnt);
+#if defined(CONFIG_THREAD_RUNTIME_STATS)
+	struct k_thread_runtime_stats stats;
 
+	k_thread_runtime_stats_get((k_tid_t)thread, &stats);
+	shell_fprintf((const struct shell *)user_data, SHELL_NORMAL,
+		"\truntime %llu cycles (%u %%), switches %u, preemptions %u, "
+		"yields %u\r\n",
+		      stats.execution_cycles, runtime_pcnt(&stats),
+		      stats.switches, stats.preemptions, stats.yields);
+#endif
+	shell_fprintf((const struct shell *)user_data, SHELL_NORMAL, "\r\n");
 }
 
 static int cmd_kernel_threads(const struct shell *shell,
@@ -88,6 +109,16 @@ static int cmd_kernel_threads(const struct shell *shell,
 	ARG_UNUSED(argc);
 	ARG_UNUSED(argv);
 
+#if defined(CONFIG_THREAD_RUNTIME_STATS)
+	struct k_thread_runtime_stats stats;
+
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		k_cpu_idle_stats_get(i, &stats);
+		shell_fprintf(shell, SHELL_NORMAL,
+			      "CPU %d idle %llu cycles (%u %%)\r\n",
+			      i, stats.execution_cycles, runtime_pcnt(&stats));
+	}
+#endif
 	shell_fprintf(shell, SHELL_NORMAL, "Threads:\r\n");
 	k_thread_foreach(shell_tdata_dump, (void *)shell);
 	return 0;
@@ -10,28 +10,130 @@
 
 #ifdef MUTEX_BENCH
 
+#include <misc/mutex.h>
+
+K_SEM_DEFINE(DEMO_SYS_MUTEX_SEM, 0, 1);
+SYS_MUTEX_DEFINE(DEMO_SYS_MUTEX, &DEMO_SYS_MUTEX_SEM, .data);
+
+#ifdef CONFIG_USERSPACE
+#define USER_STACKSIZE 1024
+
+static K_THREAD_STACK_DEFINE(mutex_user_stack, USER_STACKSIZE);
+static struct k_thread mutex_user_thread;
+#endif
+
 /**
  *
- * @brief Mutex lock/unlock test
+ * @brief Lock and unlock the kernel mutex
  *
  * @return N/A
  */
-void mutex_test(void)
+static void k_mutex_loop(void *p1, void *p2, void *p3)
 {
-	u32_t et; /* elapsed time */
 	int i;
 
-	PRINT_STRING(dashline, output_file);
-	et = BENCH_START();
 	for (i = 0; i < NR_OF_MUTEX_RUNS; i++) {
 		k_mutex_lock(&DEMO_MUTEX, K_FOREVER);
 		k_mutex_unlock(&DEMO_MUTEX);
 	}
+}
+
+/**
+ *
+ * @brief Lock and unlock the system mutex
+ *
+ * @return N/A
+ */
+static void sys_mutex_loop(void *p1, void *p2, void *p3)
+{
+	int i;
+
+	for (i = 0; i < NR_OF_MUTEX_RUNS; i++) {
+		sys_mutex_lock(&DEMO_SYS_MUTEX, K_FOREVER);
+		sys_mutex_unlock(&DEMO_SYS_MUTEX);
+	}
+}
+
+/**
+ *
+ * @brief Time one of the loops, run by the current thread
+ *
+ * @param loop   Loop to run.
+ *
+ * @return elapsed time
+ */
+static u32_t run_loop(k_thread_entry_t loop)
+{
+	u32_t et; /* elapsed time */
+
+	et = BENCH_START();
+	loop(NULL, NULL, NULL);
 	et = TIME_STAMP_DELTA_GET(et);
 	check_result();
 
+	return et;
+}
+
+#ifdef CONFIG_USERSPACE
+/**
+ *
+ * @brief Time one of the loops, run by a user mode thread
+ *
+ * The thread has a higher priority, so it runs to completion as soon as
+ * it is started, and the time stamps are taken in supervisor mode.
+ *
+ * @param loop   Loop to run.
+ *
+ * @return elapsed time
+ */
+static u32_t run_user_loop(k_thread_entry_t loop)
+{
+	u32_t et; /* elapsed time */
+
+	k_thread_create(&mutex_user_thread, mutex_user_stack, USER_STACKSIZE,
+			loop, NULL, NULL, NULL,
+			k_thread_priority_get(k_current_get()) - 1,
+			K_USER, K_FOREVER);
+	k_thread_access_grant(&mutex_user_thread, &DEMO_MUTEX,
+			      &DEMO_SYS_MUTEX_SEM, NULL);
+
+	et = BENCH_START();
+	k_thread_start(&mutex_user_thread);
+	et = TIME_STAMP_DELTA_GET(et);
+	check_result();
+
+	return et;
+}
+#endif
+
+/**
+ *
+ * @brief Mutex lock/unlock test
+ *
+ * @return N/A
+ */
+void mutex_test(void)
+{
+	u32_t et; /* elapsed time */
+
+	PRINT_STRING(dashline, output_file);
+	et = run_loop(k_mutex_loop);
 	PRINT_F(output_file, FORMAT, "average lock and unlock mutex",
 		SYS_CLOCK_HW_CYCLES_TO_NS_AVG(et, (2 * NR_OF_MUTEX_RUNS)));
+
+	et = run_loop(sys_mutex_loop);
+	PRINT_F(output_file, FORMAT, "average lock and unlock sys_mutex",
+		SYS_CLOCK_HW_CYCLES_TO_NS_AVG(et, (2 * NR_OF_MUTEX_RUNS)));
+
+#ifdef CONFIG_USERSPACE
+	et = run_user_loop(k_mutex_loop);
+	PRINT_F(output_file, FORMAT, "average lock and unlock mutex (user)",
+		SYS_CLOCK_HW_CYCLES_TO_NS_AVG(et, (2 * NR_OF_MUTEX_RUNS)));
+
+	et = run_user_loop(sys_mutex_loop);
+	PRINT_F(output_file, FORMAT, "average lock and unlock sys_mutex (user)",
+		SYS_CLOCK_HW_CYCLES_TO_NS_AVG(et, (2 * NR_OF_MUTEX_RUNS)));
+#endif
 }
 
 #endif /* MUTEX_BENCH */
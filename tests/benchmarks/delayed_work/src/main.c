@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure delayed work resubmission with many items outstanding
+ *
+ * Submits NUM_WORK delayed work items to a workqueue at pseudo-random
+ * delays far enough in the future that none fires during the test, then
+ * measures the average cost of resubmitting one of them with the same
+ * delay, as protocol timers pushed back on every event do, and with a
+ * new random delay.  For comparison, it also measures canceling the item
+ * and submitting it again, which is what resubmission used to do, and
+ * reading the time remaining before an item fires.  Build with
+ * CONFIG_TIMEOUT_QUEUE_DLIST (default) or CONFIG_TIMEOUT_QUEUE_WHEEL to
+ * compare the two backends.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+
+#define NUM_WORK	1000
+#define NUM_OPS		10000
+
+/* delays are spread over this many ms, starting after MIN_DELAY */
+#define MIN_DELAY	100000
+#define DELAY_SPREAD	1000000
+
+#define STACK_SIZE	512
+
+static K_THREAD_STACK_DEFINE(work_q_stack, STACK_SIZE);
+static struct k_work_q work_q;
+
+static struct k_delayed_work works[NUM_WORK];
+static s32_t delays[NUM_WORK];
+
+static volatile int fired;
+
+static u32_t rand_state = 1;
+
+static u32_t rand_u32(void)
+{
+	/* Numerical Recipes LCG, good enough to scatter delays */
+	rand_state = rand_state * 1664525 + 1013904223;
+	return rand_state >> 8;
+}
+
+static s32_t rand_delay(void)
+{
+	return MIN_DELAY + rand_u32() % DELAY_SPREAD;
+}
+
+static void work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	fired++;
+}
+
+enum op { RESTART, RANDOM, CANCEL_SUBMIT, REMAINING, NUM_OP_KINDS };
+
+static const char * const op_names[] = {
+	"resubmit, same delay", "resubmit, new delay",
+	"cancel and submit", "remaining time",
+};
+
+static int measure(enum op op)
+{
+	u32_t start, cycles = 0;
+	int i, w, ret = 0;
+
+	for (i = 0; i < NUM_OPS; i++) {
+		w = rand_u32() % NUM_WORK;
+		if (op == RANDOM) {
+			delays[w] = rand_delay();
+		}
+
+		start = k_cycle_get_32();
+		switch (op) {
+		case RESTART:
+		case RANDOM:
+			ret |= k_delayed_work_submit_to_queue(&work_q,
+							      &works[w],
+							      delays[w]);
+			break;
+		case CANCEL_SUBMIT:
+			ret |= k_delayed_work_cancel(&works[w]);
+			ret |= k_delayed_work_submit_to_queue(&work_q,
+							      &works[w],
+							      delays[w]);
+			break;
+		default:
+			ret |= k_delayed_work_remaining_get(&works[w]) <
+			       MIN_DELAY / 2;
+			break;
+		}
+		cycles += k_cycle_get_32() - start;
+	}
+
+	TC_PRINT("%-20s: %6u ns\n", op_names[op],
+		 SYS_CLOCK_HW_CYCLES_TO_NS_AVG(cycles, NUM_OPS));
+
+	if (ret != 0) {
+		TC_ERROR("%s failed\n", op_names[op]);
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	int status = TC_PASS;
+	int i;
+
+	TC_START("Delayed work resubmission");
+
+	k_work_q_start(&work_q, work_q_stack, STACK_SIZE,
+		       K_PRIO_PREEMPT(0));
+
+	TC_PRINT("Timeout queue: %s, %d delayed work items\n",
+		 IS_ENABLED(CONFIG_TIMEOUT_QUEUE_WHEEL) ? "timer wheel" :
+		 "sorted delta list", NUM_WORK);
+
+	for (i = 0; i < NUM_WORK; i++) {
+		k_delayed_work_init(&works[i], work_handler);
+		delays[i] = rand_delay();
+		(void)k_delayed_work_submit_to_queue(&work_q, &works[i],
+						     delays[i]);
+	}
+
+	for (i = 0; i < NUM_OP_KINDS; i++) {
+		if (measure(i) != TC_PASS) {
+			status = TC_FAIL;
+		}
+	}
+
+	for (i = 0; i < NUM_WORK; i++) {
+		(void)k_delayed_work_cancel(&works[i]);
+	}
+
+	if (fired != 0) {
+		TC_ERROR("%d delayed work items fired\n", fired);
+		status = TC_FAIL;
+	}
+
+	TC_END_RESULT(status);
+	TC_END_REPORT(status);
+}
@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Compare sys_heap and sys_mem_pool on allocation traces
+ *
+ * Replays the same pseudo-random allocation traces against a sys_heap
+ * and a sys_mem_pool of the same size, and reports for each the average
+ * and worst time of an operation, the number of failed allocations and
+ * the share of the arena in use when the first one failed.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <string.h>
+#include <misc/heap.h>
+#include <misc/mempool.h>
+
+#define ARENA_SIZE	16384
+#define NUM_SLOTS	64
+#define NUM_OPS		20000
+
+K_MUTEX_DEFINE(trace_mutex);
+
+static char __aligned(8) heap_mem[ARENA_SIZE];
+static struct sys_heap heap;
+
+SYS_MEM_POOL_DEFINE(pool, &trace_mutex, 16, ARENA_SIZE, 1, 4, .data);
+
+struct allocator {
+	const char *name;
+	void *(*alloc)(size_t size);
+	void (*free)(void *mem);
+	void *(*realloc)(void *mem, size_t old_size, size_t size);
+};
+
+static void *heap_alloc(size_t size)
+{
+	void *mem;
+
+	k_mutex_lock(&trace_mutex, K_FOREVER);
+	mem = sys_heap_alloc(&heap, size);
+	k_mutex_unlock(&trace_mutex);
+
+	return mem;
+}
+
+static void heap_free(void *mem)
+{
+	k_mutex_lock(&trace_mutex, K_FOREVER);
+	sys_heap_free(&heap, mem);
+	k_mutex_unlock(&trace_mutex);
+}
+
+static void *heap_realloc(void *mem, size_t old_size, size_t size)
+{
+	ARG_UNUSED(old_size);
+
+	k_mutex_lock(&trace_mutex, K_FOREVER);
+	mem = sys_heap_realloc(&heap, mem, size);
+	k_mutex_unlock(&trace_mutex);
+
+	return mem;
+}
+
+static void *pool_alloc(size_t size)
+{
+	return sys_mem_pool_alloc(&pool, size);
+}
+
+/* what minimal libc's realloc() did on top of sys_mem_pool */
+static void *pool_realloc(void *mem, size_t old_size, size_t size)
+{
+	void *new_mem = sys_mem_pool_alloc(&pool, size);
+
+	if (new_mem != NULL) {
+		(void)memcpy(new_mem, mem, min(old_size, size));
+		sys_mem_pool_free(mem);
+	}
+
+	return new_mem;
+}
+
+static const struct allocator allocators[] = {
+	{ "sys_heap", heap_alloc, heap_free, heap_realloc },
+	{ "buddy", pool_alloc, sys_mem_pool_free, pool_realloc },
+};
+
+enum trace { SMALL, GATEWAY, REALLOC, NUM_TRACES };
+
+static const char * const trace_names[] = { "small", "gateway", "realloc" };
+
+static void *slots[NUM_SLOTS];
+static size_t slot_sizes[NUM_SLOTS];
+
+static u32_t rand_state;
+
+static u32_t rand_u32(void)
+{
+	/* Numerical Recipes LCG, good enough to drive the traces */
+	rand_state = rand_state * 1664525 + 1013904223;
+	return rand_state >> 8;
+}
+
+static size_t rand_size(size_t min, size_t max)
+{
+	return min + rand_u32() % (max - min + 1);
+}
+
+/* Picks the slot and size of the next operation: allocating into an
+ * empty slot, or freeing or growing a busy one.
+ */
+static size_t next_op(enum trace trace, int *slot)
+{
+	u32_t r = rand_u32() % 100;
+
+	switch (trace) {
+	case SMALL:
+		*slot = rand_u32() % NUM_SLOTS;
+		return rand_size(8, 128);
+	case GATEWAY:
+		if (r < 5) {
+			/* long lived: in the first slots, rarely freed */
+			*slot = rand_u32() % 8;
+			if (slots[*slot] != NULL && rand_u32() % 16 != 0) {
+				*slot = 8 + rand_u32() % (NUM_SLOTS - 8);
+			}
+			return rand_size(200, 600);
+		}
+		*slot = 8 + rand_u32() % (NUM_SLOTS - 8);
+		return r < 75 ? rand_size(40, 200) : rand_size(1100, 1500);
+	default:
+		*slot = rand_u32() % (NUM_SLOTS / 4);
+		return slot_sizes[*slot] + rand_size(1, 256);
+	}
+}
+
+static void replay(enum trace trace, const struct allocator *a)
+{
+	u32_t start, cycles, total = 0, worst = 0;
+	size_t live = 0, live_at_failure = 0;
+	int failures = 0;
+	int slot;
+	size_t size;
+	void *mem;
+
+	rand_state = trace + 1;
+	(void)memset(slot_sizes, 0, sizeof(slot_sizes));
+
+	for (int op = 0; op < NUM_OPS; op++) {
+		size = next_op(trace, &slot);
+
+		start = k_cycle_get_32();
+		if (slots[slot] == NULL) {
+			mem = a->alloc(size);
+		} else if (trace == REALLOC && size < ARENA_SIZE / 4) {
+			mem = a->realloc(slots[slot], slot_sizes[slot], size);
+		} else {
+			a->free(slots[slot]);
+			mem = NULL;
+			size = 0;
+		}
+		cycles = k_cycle_get_32() - start;
+
+		total += cycles;
+		worst = max(worst, cycles);
+
+		if (size != 0 && mem == NULL) {
+			if (failures++ == 0) {
+				live_at_failure = live;
+			}
+			continue;
+		}
+
+		live = live - slot_sizes[slot] + size;
+		slots[slot] = mem;
+		slot_sizes[slot] = size;
+	}
+
+	for (slot = 0; slot < NUM_SLOTS; slot++) {
+		if (slots[slot] != NULL) {
+			a->free(slots[slot]);
+			slots[slot] = NULL;
+		}
+	}
+
+	TC_PRINT("%-7s %-9s: avg %5u ns, max %6u ns, %5d failed",
+		 trace_names[trace], a->name,
+		 SYS_CLOCK_HW_CYCLES_TO_NS_AVG(total, NUM_OPS),
+		 SYS_CLOCK_HW_CYCLES_TO_NS(worst), failures);
+	if (failures != 0) {
+		TC_PRINT(", first at %2u%% used\n",
+			 (u32_t)(live_at_failure * 100 / ARENA_SIZE));
+	} else {
+		TC_PRINT("\n");
+	}
+}
+
+void main(void)
+{
+	int status = TC_PASS;
+	struct sys_heap_stats stats;
+
+	TC_START("Heap allocation traces");
+
+	sys_heap_init(&heap, heap_mem, sizeof(heap_mem));
+	sys_mem_pool_init(&pool);
+
+	TC_PRINT("Arena: %d bytes, %d operations per trace\n",
+		 ARENA_SIZE, NUM_OPS);
+
+	for (int trace = 0; trace < NUM_TRACES; trace++) {
+		for (int i = 0; i < ARRAY_SIZE(allocators); i++) {
+			replay(trace, &allocators[i]);
+		}
+	}
+
+	/* everything must have been merged back */
+	sys_heap_stats_get(&heap, &stats);
+	if (stats.allocated_bytes != 0 ||
+	    stats.largest_free_bytes + Z_HEAP_CHUNK_SIZE != stats.free_bytes) {
+		TC_ERROR("heap not empty after the traces\n");
+		status = TC_FAIL;
+	}
+
+	TC_END_RESULT(status);
+	TC_END_REPORT(status);
+}
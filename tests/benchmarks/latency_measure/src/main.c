@@ -25,6 +25,8 @@ extern void int_to_thread_evt(void);
 extern void sema_lock_unlock(void);
 extern void mutex_lock_unlock(void);
 extern int coop_ctx_switch(void);
+extern int smp_wakeup(void);
+extern int sched_scaling(void);
 void test_thread(void *arg1, void *arg2, void *arg3)
 {
 	PRINT_BANNER();
@@ -50,6 +52,12 @@ void test_thread(void *arg1, void *arg2, void *arg3)
 	coop_ctx_switch();
 	print_dash_line();
 
+	smp_wakeup();
+	print_dash_line();
+
+	sched_scaling();
+	print_dash_line();
+
 	TC_END_REPORT(error_count);
 }
 
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ *
+ * @brief Measure ready and wait queue cost with many threads
+ *
+ * With 8, 32, 128, ... threads, up to CONFIG_LATENCY_SCHED_THREADS,
+ * spread over the preemptible priorities, measures:
+ *
+ * - the average time to suspend and resume one of them while they are
+ *   all runnable, i.e. to remove a thread from and add it back to the
+ *   ready queue, at a priority lower than the test thread's so that
+ *   no context switch happens;
+ *
+ * - the average time for a semaphore give to wake the best of them
+ *   while they are all pended on it, including the switch to the woken
+ *   thread, which pends again, and back.
+ *
+ * Comparing the results of the benchmark.latency.sched_* variants
+ * shows how the SCHED_ and WAITQ_ backends scale.
+ */
+
+#include <kernel.h>
+#include "timestamp.h"
+#include "utils.h"
+
+#include <arch/cpu.h>
+
+#define MAX_THREADS	CONFIG_LATENCY_SCHED_THREADS
+#define NUM_LOOPS	1000
+
+#ifndef STACKSIZE
+#define STACKSIZE	512
+#endif
+
+/* priorities the threads are spread over, below the highest one */
+#define NUM_SPREAD	(CONFIG_NUM_PREEMPT_PRIORITIES - 1)
+
+#if MAX_THREADS > 0
+static K_THREAD_STACK_ARRAY_DEFINE(sched_stacks, MAX_THREADS, STACKSIZE);
+static struct k_thread sched_threads[MAX_THREADS];
+
+static K_SEM_DEFINE(sched_sema, 0, 1);
+
+static void ready_entry(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+}
+
+static void waiter_entry(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (1) {
+		k_sem_take(&sched_sema, K_FOREVER);
+	}
+}
+
+static void start_threads(int num, k_thread_entry_t entry, int base_prio)
+{
+	int i;
+
+	for (i = 0; i < num; i++) {
+		k_thread_create(&sched_threads[i], sched_stacks[i], STACKSIZE,
+				entry, NULL, NULL, NULL,
+				base_prio + i % NUM_SPREAD, 0, K_NO_WAIT);
+	}
+}
+
+static void abort_threads(int num)
+{
+	int i;
+
+	for (i = 0; i < num; i++) {
+		k_thread_abort(&sched_threads[i]);
+	}
+}
+
+static void print_result(const char *what, int num, u32_t t)
+{
+	if (bench_test_end() != 0) {
+		error_count++;
+		PRINT_OVERFLOW_ERROR();
+		return;
+	}
+
+	PRINT_FORMAT(" %3d threads: %s %u tcs = %u nsec", num, what,
+		     t / NUM_LOOPS, SYS_CLOCK_HW_CYCLES_TO_NS_AVG(t, NUM_LOOPS));
+}
+
+static void measure(int num)
+{
+	struct k_thread *victim = &sched_threads[num / 2];
+	u32_t t;
+	int i;
+
+	/* all runnable, below the test thread */
+	k_thread_priority_set(k_current_get(), K_PRIO_PREEMPT(0));
+	start_threads(num, ready_entry, K_PRIO_PREEMPT(1));
+
+	bench_test_start();
+	t = TIME_STAMP_DELTA_GET(0);
+	for (i = 0; i < NUM_LOOPS; i++) {
+		k_thread_suspend(victim);
+		k_thread_resume(victim);
+	}
+	t = TIME_STAMP_DELTA_GET(t);
+	print_result("ready queue remove/add", num, t);
+
+	abort_threads(num);
+
+	/* all pended, above the test thread */
+	k_thread_priority_set(k_current_get(),
+			      K_LOWEST_APPLICATION_THREAD_PRIO);
+	start_threads(num, waiter_entry, K_PRIO_PREEMPT(0));
+
+	bench_test_start();
+	t = TIME_STAMP_DELTA_GET(0);
+	for (i = 0; i < NUM_LOOPS; i++) {
+		k_sem_give(&sched_sema);
+	}
+	t = TIME_STAMP_DELTA_GET(t);
+	print_result("wait queue wake/pend", num, t);
+
+	abort_threads(num);
+}
+
+#endif /* MAX_THREADS > 0 */
+
+/**
+ *
+ * @brief The test main function
+ *
+ * @return 0 on success
+ */
+int sched_scaling(void)
+{
+	int prio = k_thread_priority_get(k_current_get());
+	int num;
+
+	PRINT_FORMAT(" 8 - Measure ready and wait queue cost with many threads");
+	PRINT_FORMAT(" ready queue: %s, wait queue: %s",
+		     IS_ENABLED(CONFIG_SCHED_MULTIQ) ? "multiq" :
+		     IS_ENABLED(CONFIG_SCHED_SCALABLE) ? "scalable" : "dumb",
+		     IS_ENABLED(CONFIG_WAITQ_MULTIQ) ? "multiq" :
+		     IS_ENABLED(CONFIG_WAITQ_SCALABLE) ? "scalable" : "dumb");
+
+	if (IS_ENABLED(CONFIG_SMP)) {
+		/* the other CPUs would run the "ready" threads */
+		PRINT_FORMAT(" Skipped on SMP");
+		return 0;
+	}
+
+#if MAX_THREADS > 0
+	for (num = 8; num <= MAX_THREADS; num *= 4) {
+		measure(num);
+	}
+
+	k_thread_priority_set(k_current_get(), prio);
+#else
+	ARG_UNUSED(prio);
+	ARG_UNUSED(num);
+	PRINT_FORMAT(" Skipped, CONFIG_LATENCY_SCHED_THREADS is 0");
+#endif
+
+	return 0;
+}
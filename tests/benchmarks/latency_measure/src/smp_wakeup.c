@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ *
+ * @brief Measure cross-CPU wakeup latency
+ *
+ * A waiter thread pends on a semaphore.  The test thread records a
+ * timestamp and gives the semaphore; the waiter computes the time it
+ * took to start running and acknowledges through a second semaphore.
+ * With CONFIG_SCHED_PER_CPU_RUNQ the waiter is kept off the test
+ * thread's CPU with the CPU mask API, so every wakeup crosses CPUs;
+ * otherwise the scheduler is free to place it, and the number of
+ * wakeups that did cross CPUs is reported alongside the average.
+ */
+
+#include <kernel_structs.h>
+#include "timestamp.h"
+#include "utils.h"
+
+#include <arch/cpu.h>
+
+/* number of wakeups */
+#define NWAKEUPS     1000
+#ifndef STACKSIZE
+#define STACKSIZE    512
+#endif
+
+static K_THREAD_STACK_DEFINE(waiter_stack, STACKSIZE);
+static struct k_thread waiter_data;
+
+static K_SEM_DEFINE(wake_sema, 0, 1);
+static K_SEM_DEFINE(ack_sema, 0, 1);
+
+static volatile u32_t give_stamp;
+static volatile int giver_cpu;
+
+static u32_t total_latency;
+static u32_t cross_cpu_count;
+
+/**
+ *
+ * @brief Waiter thread: time each wakeup relative to the give
+ *
+ * @return N/A
+ */
+static void waiter(void *p1, void *p2, void *p3)
+{
+	int i;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	for (i = 0; i < NWAKEUPS; i++) {
+		k_sem_take(&wake_sema, K_FOREVER);
+		total_latency += TIME_STAMP_DELTA_GET(give_stamp);
+		if (_current_cpu->id != giver_cpu) {
+			cross_cpu_count++;
+		}
+		k_sem_give(&ack_sema);
+	}
+}
+
+/**
+ *
+ * @brief The test main function
+ *
+ * @return 0 on success
+ */
+int smp_wakeup(void)
+{
+	int i;
+
+	PRINT_FORMAT(" 7 - Measure average wakeup latency to another CPU");
+	total_latency = 0;
+	cross_cpu_count = 0;
+
+	k_thread_create(&waiter_data, waiter_stack, STACKSIZE, waiter,
+			NULL, NULL, NULL, 5, 0, K_FOREVER);
+#ifdef CONFIG_SCHED_PER_CPU_RUNQ
+	k_thread_cpu_mask_disable(&waiter_data, _current_cpu->id);
+#endif
+	k_thread_start(&waiter_data);
+
+	bench_test_start();
+	for (i = 0; i < NWAKEUPS; i++) {
+		giver_cpu = _current_cpu->id;
+		give_stamp = TIME_STAMP_DELTA_GET(0);
+		k_sem_give(&wake_sema);
+		k_sem_take(&ack_sema, K_FOREVER);
+	}
+
+	if (bench_test_end() != 0) {
+		error_count++;
+		PRINT_OVERFLOW_ERROR();
+	} else {
+		PRINT_FORMAT(" Average wakeup latency %u tcs = %u nsec",
+			     total_latency / NWAKEUPS,
+			     SYS_CLOCK_HW_CYCLES_TO_NS_AVG(total_latency,
+							   NWAKEUPS));
+		PRINT_FORMAT(" %u of %u wakeups ran on another CPU",
+			     cross_cpu_count, NWAKEUPS);
+	}
+
+	return 0;
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure memory slab throughput with one allocator per CPU
+ *
+ * Starts one thread per CPU, all allocating and freeing bursts of
+ * blocks from the same memory slab as fast as they can, the way network
+ * drivers and stacks allocate buffers.  Each burst is allocated and
+ * freed one block at a time, then with k_mem_slab_alloc_n() and
+ * k_mem_slab_free_n().  Reports the average time of an allocation and
+ * free pair seen by each thread and the aggregate throughput.  Build
+ * with and without CONFIG_MEM_SLAB_MAGAZINES to compare.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+
+#define NUM_THREADS	CONFIG_MP_NUM_CPUS
+#define BURST		8
+#define NUM_BURSTS	2000
+#define BLOCK_SIZE	64
+#define STACK_SIZE	1024
+
+#ifdef CONFIG_MEM_SLAB_MAGAZINES
+#define NUM_CACHED	(NUM_THREADS * CONFIG_MEM_SLAB_MAGAZINE_SIZE)
+#else
+#define NUM_CACHED	0
+#endif
+
+/* enough for all bursts at once, wherever the free blocks are cached */
+#define NUM_BLOCKS	(NUM_THREADS * BURST + NUM_CACHED)
+
+K_MEM_SLAB_DEFINE(storm_slab, BLOCK_SIZE, NUM_BLOCKS, 8);
+
+static K_THREAD_STACK_ARRAY_DEFINE(stacks, NUM_THREADS, STACK_SIZE);
+static struct k_thread threads[NUM_THREADS];
+
+static K_SEM_DEFINE(done_sem, 0, NUM_THREADS);
+
+static u32_t thread_cycles[NUM_THREADS];
+static int thread_errors[NUM_THREADS];
+
+static void storm_single(int id)
+{
+	void *block[BURST];
+	int i, j;
+
+	for (i = 0; i < NUM_BURSTS; i++) {
+		for (j = 0; j < BURST; j++) {
+			if (k_mem_slab_alloc(&storm_slab, &block[j],
+					     K_NO_WAIT) != 0) {
+				thread_errors[id]++;
+				break;
+			}
+		}
+		while (j-- > 0) {
+			k_mem_slab_free(&storm_slab, &block[j]);
+		}
+	}
+}
+
+static void storm_bulk(int id)
+{
+	void *block[BURST];
+	int i;
+
+	for (i = 0; i < NUM_BURSTS; i++) {
+		if (k_mem_slab_alloc_n(&storm_slab, block, BURST) != 0) {
+			thread_errors[id]++;
+			continue;
+		}
+		k_mem_slab_free_n(&storm_slab, block, BURST);
+	}
+}
+
+static void storm_entry(void *p1, void *p2, void *p3)
+{
+	int id = POINTER_TO_INT(p1);
+	void (*storm)(int id) = p2;
+	u32_t start;
+
+	ARG_UNUSED(p3);
+
+	start = k_cycle_get_32();
+	storm(id);
+	thread_cycles[id] = k_cycle_get_32() - start;
+
+	k_sem_give(&done_sem);
+}
+
+static int run(const char *name, void (*storm)(int id))
+{
+	u32_t start, total, worst = 0;
+	int errors = 0;
+	int i;
+
+	start = k_cycle_get_32();
+	for (i = 0; i < NUM_THREADS; i++) {
+		k_thread_create(&threads[i], stacks[i], STACK_SIZE,
+				storm_entry, INT_TO_POINTER(i), storm, NULL,
+				K_PRIO_PREEMPT(1), 0, K_FOREVER);
+#ifdef CONFIG_SCHED_PER_CPU_RUNQ
+		k_thread_cpu_mask_clear(&threads[i]);
+		k_thread_cpu_mask_enable(&threads[i], i);
+#endif
+		k_thread_start(&threads[i]);
+	}
+	for (i = 0; i < NUM_THREADS; i++) {
+		k_sem_take(&done_sem, K_FOREVER);
+	}
+	total = k_cycle_get_32() - start;
+
+	for (i = 0; i < NUM_THREADS; i++) {
+		worst = max(worst, thread_cycles[i]);
+		errors += thread_errors[i];
+		thread_errors[i] = 0;
+	}
+
+	TC_PRINT("%-6s: %5u ns per alloc+free (slowest thread), "
+		 "%6u pairs/ms overall\n", name,
+		 SYS_CLOCK_HW_CYCLES_TO_NS_AVG(worst, NUM_BURSTS * BURST),
+		 (u32_t)((u64_t)NUM_THREADS * NUM_BURSTS * BURST * 1000000 /
+			 max(SYS_CLOCK_HW_CYCLES_TO_NS(total), 1U)));
+
+	if (errors != 0) {
+		TC_ERROR("%d allocations failed\n", errors);
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	int status;
+
+	TC_START("Memory slab storm");
+
+	TC_PRINT("%d threads, bursts of %d %d byte blocks, magazines %s\n",
+		 NUM_THREADS, BURST, BLOCK_SIZE,
+		 IS_ENABLED(CONFIG_MEM_SLAB_MAGAZINES) ? "on" : "off");
+
+	status = run("single", storm_single);
+	if (status == TC_PASS) {
+		status = run("bulk", storm_bulk);
+	}
+
+	if (k_mem_slab_num_used_get(&storm_slab) != 0) {
+		TC_ERROR("blocks leaked\n");
+		status = TC_FAIL;
+	}
+
+	TC_END_RESULT(status);
+	TC_END_REPORT(status);
+}
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure the cost of network checksums
+ *
+ * Computes the checksum of UDP/IPv4 packets with payloads of 64 to 1024
+ * bytes, split over chains of 1 to 8 fragments of uneven lengths, and
+ * reports the average cost per packet in cycles.  Each result is checked
+ * against a plain reference computation over the packet as a whole.  Then
+ * compares computing the checksum again after a source address rewrite
+ * with updating it incrementally (RFC 1624).
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <string.h>
+#include <net/net_pkt.h>
+#include <net/net_ip.h>
+
+#include "net_private.h"
+
+#define HDR_LEN		(sizeof(struct net_ipv4_hdr) + \
+			 sizeof(struct net_udp_hdr))
+#define MAX_PAYLOAD	1024
+#define ROUNDS		256
+
+static const u16_t payload_sizes[] = { 64, 256, 1024 };
+static const int chain_lengths[] = { 1, 2, 4, 8 };
+
+static const struct in_addr addrs[] = {
+	{ { { 192, 0, 2, 1 } } },
+	{ { { 198, 51, 100, 7 } } },
+};
+
+static u8_t flat[HDR_LEN + MAX_PAYLOAD];
+
+static void set_headers(u16_t payload)
+{
+	struct net_ipv4_hdr *hdr = (struct net_ipv4_hdr *)flat;
+	struct net_udp_hdr *udp_hdr = (struct net_udp_hdr *)(hdr + 1);
+
+	(void)memset(flat, 0, HDR_LEN);
+
+	hdr->vhl = 0x45;
+	hdr->len = htons(HDR_LEN + payload);
+	hdr->ttl = 64;
+	hdr->proto = IPPROTO_UDP;
+	net_ipaddr_copy(&hdr->src, &addrs[0]);
+	net_ipaddr_copy(&hdr->dst, &addrs[1]);
+
+	udp_hdr->src_port = htons(4242);
+	udp_hdr->dst_port = htons(4242);
+	udp_hdr->len = htons(sizeof(*udp_hdr) + payload);
+}
+
+/* Same result as net_calc_chksum(), one big endian word at a time */
+static u16_t ref_chksum(u16_t payload)
+{
+	u32_t sum = IPPROTO_UDP + sizeof(struct net_udp_hdr) + payload;
+	const u8_t *data = flat + offsetof(struct net_ipv4_hdr, src);
+	u16_t len = HDR_LEN + payload - offsetof(struct net_ipv4_hdr, src);
+	int i;
+
+	for (i = 0; i < len; i += 2) {
+		sum += data[i] << 8;
+		if (i + 1 < len) {
+			sum += data[i + 1];
+		}
+	}
+
+	while (sum >> 16) {
+		sum = (sum >> 16) + (sum & 0xffff);
+	}
+
+	return (sum == 0) ? 0xffff : htons(sum);
+}
+
+/* Split the packet over the fragments, one byte more than an even share
+ * in every other fragment and one byte less in the others, so that words
+ * straddle fragments.
+ */
+static struct net_pkt *build_pkt(u16_t payload, int frags)
+{
+	struct net_pkt *pkt;
+	struct net_buf *frag;
+	u16_t len = HDR_LEN + payload;
+	u16_t share = payload / frags;
+	u16_t pos = 0, size;
+	int i;
+
+	pkt = net_pkt_get_reserve_tx(0, K_FOREVER);
+
+	net_pkt_set_family(pkt, AF_INET);
+	net_pkt_set_ip_hdr_len(pkt, sizeof(struct net_ipv4_hdr));
+	net_pkt_set_ipv6_ext_len(pkt, 0);
+
+	for (i = 0; i < frags; i++) {
+		if (i == frags - 1) {
+			size = len - pos;
+		} else {
+			size = (i == 0 ? HDR_LEN : 0) + share +
+			       (i % 2 ? -1 : 1);
+		}
+
+		frag = net_pkt_get_frag(pkt, K_FOREVER);
+		net_buf_add_mem(frag, flat + pos, size);
+		net_pkt_frag_add(pkt, frag);
+		pos += size;
+	}
+
+	return pkt;
+}
+
+static u32_t measure_chksum(u16_t payload, int frags, int *errors)
+{
+	struct net_pkt *pkt;
+	u16_t expected;
+	u32_t start, cycles;
+	int i;
+
+	set_headers(payload);
+	expected = ref_chksum(payload);
+	pkt = build_pkt(payload, frags);
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < ROUNDS; i++) {
+		if (net_calc_chksum(pkt, IPPROTO_UDP) != expected) {
+			(*errors)++;
+		}
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	net_pkt_unref(pkt);
+
+	return cycles / ROUNDS;
+}
+
+/* Alternate the source address between the two test addresses, updating
+ * the checksum each time either from scratch or incrementally.
+ */
+static u32_t measure_rewrite(struct net_pkt *pkt, bool incremental,
+			     u16_t *chksum)
+{
+	struct net_ipv4_hdr *hdr = NET_IPV4_HDR(pkt);
+	u32_t start, cycles;
+	int i;
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < ROUNDS; i++) {
+		const struct in_addr *from = &addrs[i % 2];
+		const struct in_addr *to = &addrs[(i + 1) % 2];
+
+		net_ipaddr_copy(&hdr->src, to);
+
+		if (incremental) {
+			*chksum = net_chksum_update32(*chksum, from->s_addr,
+						      to->s_addr);
+		} else {
+			*chksum = ~net_calc_chksum(pkt, IPPROTO_UDP);
+		}
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	return cycles / ROUNDS;
+}
+
+void main(void)
+{
+	int status = TC_PASS;
+	int errors = 0;
+	struct net_pkt *pkt;
+	u32_t full_cost, incremental_cost;
+	u16_t full_chksum, incremental_chksum;
+	int i, j;
+
+	TC_START("Network checksum");
+
+	for (i = HDR_LEN; i < sizeof(flat); i++) {
+		flat[i] = i * 7 + 3;
+	}
+
+	TC_PRINT("Cycles per packet, by payload size and fragments per "
+		 "packet\n");
+
+	for (i = 0; i < ARRAY_SIZE(payload_sizes); i++) {
+		TC_PRINT("%4u bytes:", payload_sizes[i]);
+
+		for (j = 0; j < ARRAY_SIZE(chain_lengths); j++) {
+			TC_PRINT("%s %d frag%s %4u", j ? "," : "",
+				 chain_lengths[j],
+				 chain_lengths[j] > 1 ? "s" : "",
+				 measure_chksum(payload_sizes[i],
+						chain_lengths[j], &errors));
+		}
+
+		TC_PRINT("\n");
+	}
+
+	set_headers(MAX_PAYLOAD);
+	pkt = build_pkt(MAX_PAYLOAD, 1);
+
+	incremental_chksum = ~net_calc_chksum(pkt, IPPROTO_UDP);
+	incremental_cost = measure_rewrite(pkt, true, &incremental_chksum);
+	full_cost = measure_rewrite(pkt, false, &full_chksum);
+
+	TC_PRINT("Address rewrite: full %4u cycles, incremental %4u cycles\n",
+		 full_cost, incremental_cost);
+
+	if (incremental_chksum != full_chksum) {
+		TC_ERROR("Incremental update gave 0x%04x instead of 0x%04x\n",
+			 ntohs(incremental_chksum), ntohs(full_chksum));
+		errors++;
+	}
+
+	net_pkt_unref(pkt);
+
+	if (errors != 0) {
+		TC_ERROR("%d checksums were wrong\n", errors);
+		status = TC_FAIL;
+	}
+
+	TC_END_RESULT(status);
+	TC_END_REPORT(status);
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Compare k_poll() and poll sets as the number of objects grows
+ *
+ * Watches 1 to MAX_OBJECTS semaphores, and measures the average time
+ * to find out that one of them is available, with k_poll() on an array
+ * of events and with k_poll_set_wait() on a poll set holding the same
+ * events.  The available semaphore is always the last one watched, so
+ * k_poll() registers with, then unregisters from, all the others first,
+ * as it does when it has to wait.  The semaphore is taken back after
+ * each wait.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+
+#define MAX_OBJECTS	64
+#define NUM_WAITS	1000
+
+static struct k_sem sems[MAX_OBJECTS];
+static struct k_poll_event events[MAX_OBJECTS];
+static struct k_poll_set set;
+
+static u32_t measure_poll(int num)
+{
+	u32_t start, cycles = 0;
+
+	for (int i = 0; i < NUM_WAITS; i++) {
+		k_sem_give(&sems[num - 1]);
+
+		start = k_cycle_get_32();
+		(void)k_poll(events, num, K_FOREVER);
+		cycles += k_cycle_get_32() - start;
+
+		events[num - 1].state = K_POLL_STATE_NOT_READY;
+		(void)k_sem_take(&sems[num - 1], K_NO_WAIT);
+	}
+
+	return cycles;
+}
+
+static u32_t measure_set(int num, int *errors)
+{
+	struct k_poll_event *ready[1];
+	u32_t start, cycles = 0;
+
+	for (int i = 0; i < num; i++) {
+		(void)k_poll_set_add(&set, &events[i]);
+	}
+
+	for (int i = 0; i < NUM_WAITS; i++) {
+		k_sem_give(&sems[num - 1]);
+
+		start = k_cycle_get_32();
+		if (k_poll_set_wait(&set, ready, 1, K_FOREVER) != 1 ||
+		    ready[0] != &events[num - 1]) {
+			(*errors)++;
+		}
+		cycles += k_cycle_get_32() - start;
+
+		(void)k_sem_take(&sems[num - 1], K_NO_WAIT);
+	}
+
+	for (int i = 0; i < num; i++) {
+		(void)k_poll_set_remove(&set, &events[i]);
+	}
+
+	return cycles;
+}
+
+void main(void)
+{
+	int status = TC_PASS;
+	int errors = 0;
+	u32_t poll_cycles, set_cycles;
+
+	TC_START("Poll set scaling");
+
+	k_poll_set_init(&set);
+	for (int i = 0; i < MAX_OBJECTS; i++) {
+		k_sem_init(&sems[i], 0, 1);
+		k_poll_event_init(&events[i], K_POLL_TYPE_SEM_AVAILABLE,
+				  K_POLL_MODE_NOTIFY_ONLY, &sems[i]);
+	}
+
+	for (int num = 1; num <= MAX_OBJECTS; num *= 4) {
+		poll_cycles = measure_poll(num);
+		set_cycles = measure_set(num, &errors);
+
+		TC_PRINT("%2d objects: k_poll %6u ns, poll set %6u ns\n",
+			 num, SYS_CLOCK_HW_CYCLES_TO_NS_AVG(poll_cycles,
+							    NUM_WAITS),
+			 SYS_CLOCK_HW_CYCLES_TO_NS_AVG(set_cycles,
+						       NUM_WAITS));
+	}
+
+	if (errors != 0) {
+		TC_ERROR("%d poll set waits returned the wrong event\n",
+			 errors);
+		status = TC_FAIL;
+	}
+
+	TC_END_RESULT(status);
+	TC_END_REPORT(status);
+}
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Compare copying and zero-copy socket calls
+ *
+ * Sends datagrams over a UDP socket connected to another one through the
+ * loopback interface, and receives each back before sending the next, first
+ * with send() and recv(), then with sendmsg() and recvmsg() and a separate
+ * header buffer, and last with zsock_send_zc() and zsock_recv_zc(), which
+ * fill and check the payload in the network buffers themselves.  Reports
+ * the average cost of a datagram in cycles for each.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <net/socket.h>
+#include <net/net_pkt.h>
+
+#define DGRAM_LEN	480
+#define HDR_LEN		16
+#define DGRAMS		1024
+#define SERVER_PORT	4242
+
+static int client;
+static int server;
+
+static u8_t tx_hdr[HDR_LEN];
+static u8_t rx_hdr[HDR_LEN];
+static u8_t tx_buf[DGRAM_LEN];
+static u8_t rx_buf[DGRAM_LEN];
+
+/* Byte i of datagram seq is (seq + i) & 0xff, so that a datagram received
+ * out of turn or corrupted is noticed.
+ */
+static void fill(u8_t *buf, size_t len, u32_t seq, size_t off)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		buf[i] = seq + off + i;
+	}
+}
+
+static bool check(const u8_t *buf, size_t len, u32_t seq, size_t off)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		if (buf[i] != (u8_t)(seq + off + i)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static u32_t measure_copy(int *errors)
+{
+	u32_t start, cycles;
+	u32_t seq;
+
+	start = k_cycle_get_32();
+
+	for (seq = 0; seq < DGRAMS; seq++) {
+		fill(tx_buf, DGRAM_LEN, seq, 0);
+
+		if (send(client, tx_buf, DGRAM_LEN, 0) != DGRAM_LEN ||
+		    recv(server, rx_buf, sizeof(rx_buf), 0) != DGRAM_LEN ||
+		    !check(rx_buf, DGRAM_LEN, seq, 0)) {
+			(*errors)++;
+		}
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	return cycles / DGRAMS;
+}
+
+static u32_t measure_iovec(int *errors)
+{
+	struct iovec tx_iov[] = {
+		{ .iov_base = tx_hdr, .iov_len = HDR_LEN },
+		{ .iov_base = tx_buf, .iov_len = DGRAM_LEN - HDR_LEN },
+	};
+	struct iovec rx_iov[] = {
+		{ .iov_base = rx_hdr, .iov_len = HDR_LEN },
+		{ .iov_base = rx_buf, .iov_len = DGRAM_LEN - HDR_LEN },
+	};
+	struct msghdr tx_msg = {
+		.msg_iov = tx_iov,
+		.msg_iovlen = ARRAY_SIZE(tx_iov),
+	};
+	struct msghdr rx_msg = {
+		.msg_iov = rx_iov,
+		.msg_iovlen = ARRAY_SIZE(rx_iov),
+	};
+	u32_t start, cycles;
+	u32_t seq;
+
+	start = k_cycle_get_32();
+
+	for (seq = 0; seq < DGRAMS; seq++) {
+		fill(tx_hdr, HDR_LEN, seq, 0);
+		fill(tx_buf, DGRAM_LEN - HDR_LEN, seq, HDR_LEN);
+
+		if (sendmsg(client, &tx_msg, 0) != DGRAM_LEN ||
+		    recvmsg(server, &rx_msg, 0) != DGRAM_LEN ||
+		    !check(rx_hdr, HDR_LEN, seq, 0) ||
+		    !check(rx_buf, DGRAM_LEN - HDR_LEN, seq, HDR_LEN)) {
+			(*errors)++;
+		}
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	return cycles / DGRAMS;
+}
+
+/* Builds the payload of datagram seq right in a chain of data buffers */
+static struct net_buf *alloc_dgram(u32_t seq)
+{
+	struct net_buf *head = NULL;
+	struct net_buf *last = NULL;
+	size_t len = 0;
+
+	while (len < DGRAM_LEN) {
+		struct net_buf *frag;
+		size_t n;
+
+		frag = net_pkt_get_reserve_tx_data(0, K_FOREVER);
+		n = min(net_buf_tailroom(frag), DGRAM_LEN - len);
+		fill(net_buf_add(frag, n), n, seq, len);
+		len += n;
+
+		if (last) {
+			net_buf_frag_insert(last, frag);
+		} else {
+			head = frag;
+		}
+
+		last = frag;
+	}
+
+	return head;
+}
+
+static u32_t measure_zero_copy(int *errors)
+{
+	struct net_buf *frags;
+	struct net_buf *frag;
+	u32_t start, cycles;
+	u32_t seq;
+	size_t off;
+
+	start = k_cycle_get_32();
+
+	for (seq = 0; seq < DGRAMS; seq++) {
+		frags = alloc_dgram(seq);
+
+		/* The stack takes the fragments, whether or not it sends them */
+		if (zsock_send_zc(client, frags, 0, NULL, 0) != DGRAM_LEN) {
+			(*errors)++;
+			continue;
+		}
+
+		if (zsock_recv_zc(server, &frags, 0, NULL, NULL) != DGRAM_LEN) {
+			(*errors)++;
+		}
+
+		off = 0;
+		for (frag = frags; frag; frag = frag->frags) {
+			if (!check(frag->data, frag->len, seq, off)) {
+				(*errors)++;
+				break;
+			}
+
+			off += frag->len;
+		}
+
+		if (frags) {
+			net_buf_unref(frags);
+		}
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	return cycles / DGRAMS;
+}
+
+void main(void)
+{
+	int status = TC_PASS;
+	int errors = 0;
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(SERVER_PORT),
+	};
+
+	TC_START("Socket zero-copy");
+
+	inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR, &addr.sin_addr);
+
+	client = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	server = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (client < 0 || server < 0 ||
+	    bind(server, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+	    connect(client, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		TC_ERROR("Cannot set up the sockets: %d\n", errno);
+		TC_END_RESULT(TC_FAIL);
+		TC_END_REPORT(TC_FAIL);
+		return;
+	}
+
+	TC_PRINT("%d datagrams of %d bytes\n", DGRAMS, DGRAM_LEN);
+	TC_PRINT("sendto/recvfrom:   %4u cycles/datagram\n",
+		 measure_copy(&errors));
+	TC_PRINT("sendmsg/recvmsg:   %4u cycles/datagram\n",
+		 measure_iovec(&errors));
+	TC_PRINT("zero-copy:         %4u cycles/datagram\n",
+		 measure_zero_copy(&errors));
+
+	if (errors != 0) {
+		TC_ERROR("%d datagrams were lost or corrupted\n", errors);
+		status = TC_FAIL;
+	}
+
+	close(client);
+	close(server);
+
+	TC_END_RESULT(status);
+	TC_END_REPORT(status);
+}
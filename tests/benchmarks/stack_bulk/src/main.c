@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Compare single and bulk stack operations
+ *
+ * Pushes then pops batches of 1, 8 and 64 values, as a driver recycling
+ * DMA descriptors would, and reports the average cost per value in cycles,
+ * first with a k_stack_push() and k_stack_pop() call per value, then with
+ * a single k_stack_push_n() and k_stack_pop_n() call per batch.  Each
+ * batch size moves the same total number of values.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+
+#define MAX_BATCH	64
+#define TOTAL_ENTRIES	(64 * 1024)
+
+K_STACK_DEFINE(stack, MAX_BATCH);
+
+static u32_t tx_buf[MAX_BATCH];
+static u32_t rx_buf[MAX_BATCH];
+
+static const u32_t batches[] = { 1, 8, 64 };
+
+static u32_t measure_single(u32_t batch, int *errors)
+{
+	u32_t start, cycles;
+	u32_t i, j;
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < TOTAL_ENTRIES / batch; i++) {
+		for (j = 0; j < batch; j++) {
+			k_stack_push(&stack, tx_buf[j]);
+		}
+		for (j = 0; j < batch; j++) {
+			if (k_stack_pop(&stack, &rx_buf[j], K_NO_WAIT) != 0) {
+				(*errors)++;
+			}
+		}
+		if (rx_buf[batch - 1] != tx_buf[0]) {
+			(*errors)++;
+		}
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	return cycles / TOTAL_ENTRIES;
+}
+
+static u32_t measure_bulk(u32_t batch, int *errors)
+{
+	u32_t start, cycles;
+	u32_t i;
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < TOTAL_ENTRIES / batch; i++) {
+		k_stack_push_n(&stack, tx_buf, batch);
+		if (k_stack_pop_n(&stack, rx_buf, batch,
+				  K_NO_WAIT) != (int)batch ||
+		    rx_buf[batch - 1] != tx_buf[0]) {
+			(*errors)++;
+		}
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	return cycles / TOTAL_ENTRIES;
+}
+
+void main(void)
+{
+	int status = TC_PASS;
+	int errors = 0;
+	u32_t single_cost, bulk_cost;
+	int i;
+
+	TC_START("Stack bulk operations");
+
+	for (i = 0; i < MAX_BATCH; i++) {
+		tx_buf[i] = 0x1000 + i;
+	}
+
+	TC_PRINT("%d values moved per batch size\n", TOTAL_ENTRIES);
+
+	for (i = 0; i < ARRAY_SIZE(batches); i++) {
+		single_cost = measure_single(batches[i], &errors);
+		bulk_cost = measure_bulk(batches[i], &errors);
+
+		TC_PRINT("%2u values per batch: single %4u cycles/value, "
+			 "bulk %4u cycles/value\n",
+			 batches[i], single_cost, bulk_cost);
+	}
+
+	if (errors != 0) {
+		TC_ERROR("%d batches were lost or corrupted\n", errors);
+		status = TC_FAIL;
+	}
+
+	TC_END_RESULT(status);
+	TC_END_REPORT(status);
+}
@@ -0,0 +1,142 @@
+/* fifo_burst.c */
+
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "syskernel.h"
+
+#include <irq_offload.h>
+
+/*
+ * A producer puts a whole burst of elements into a FIFO before the
+ * consumer, a lower priority thread, gets to run and drains it, which is
+ * how e.g. network RX queues are mostly used.  The producer is either a
+ * thread or an ISR.  Build with CONFIG_QUEUE_LOCKLESS_APPEND=y to measure
+ * the lock-free append path.
+ */
+struct burst_element {
+	void *reserved;
+	int value;
+};
+
+static struct burst_element burst_elements[NUMBER_OF_LOOPS];
+
+static struct k_fifo burst_fifo;
+static struct k_sem burst_done;
+static int burst_count;
+
+/**
+ *
+ * @brief Consumer thread: get the burst, checking the order
+ *
+ * @param par1   Ignored parameter.
+ * @param par2   Number of elements.
+ * @param par3   Ignored parameter.
+ *
+ * @return N/A
+ */
+static void burst_consumer(void *par1, void *par2, void *par3)
+{
+	int i;
+	int num_loops = (int)par2;
+	struct burst_element *pelement;
+
+	ARG_UNUSED(par1);
+	ARG_UNUSED(par3);
+
+	for (i = 0; i < num_loops; i++) {
+		pelement = k_fifo_get(&burst_fifo, K_FOREVER);
+		if (pelement->value != i) {
+			break;
+		}
+		burst_count++;
+	}
+
+	k_sem_give(&burst_done);
+}
+
+/**
+ *
+ * @brief Put the whole burst into the FIFO
+ *
+ * @param arg   Number of elements.
+ *
+ * @return N/A
+ */
+static void burst_producer(void *arg)
+{
+	int i;
+	int num_loops = (int)arg;
+
+	for (i = 0; i < num_loops; i++) {
+		burst_elements[i].value = i;
+		k_fifo_put(&burst_fifo, &burst_elements[i]);
+	}
+}
+
+/**
+ *
+ * @brief Run one burst, produced from thread or ISR context
+ *
+ * @param from_isr   Put the elements from an ISR.
+ *
+ * @return 1 if success and 0 on failure
+ */
+static int burst_run(bool from_isr)
+{
+	u32_t t;
+
+	k_fifo_init(&burst_fifo);
+	k_sem_init(&burst_done, 0, 1);
+	burst_count = 0;
+
+	/* lower priority than main, so it only runs once main blocks */
+	k_thread_create(&thread_data1, thread_stack1, STACK_SIZE,
+			burst_consumer, NULL, (void *)number_of_loops, NULL,
+			K_PRIO_PREEMPT(10), 0, K_NO_WAIT);
+
+	t = BENCH_START();
+
+	if (from_isr) {
+		irq_offload(burst_producer, (void *)number_of_loops);
+	} else {
+		burst_producer((void *)number_of_loops);
+	}
+	k_sem_take(&burst_done, K_FOREVER);
+
+	t = TIME_STAMP_DELTA_GET(t);
+
+	return check_result(burst_count, t);
+}
+
+/**
+ *
+ * @brief The main test entry
+ *
+ * @return number of successful test cases
+ */
+int fifo_burst_test(void)
+{
+	int return_value = 0;
+
+	fprintf(output_file, sz_test_case_fmt, "FIFO burst #1");
+	fprintf(output_file, sz_description,
+			"\n\tk_fifo_put (thread, burst)"
+			"\n\tk_fifo_get(K_FOREVER)");
+	printf(sz_test_start_fmt);
+
+	return_value += burst_run(false);
+
+	fprintf(output_file, sz_test_case_fmt, "FIFO burst #2");
+	fprintf(output_file, sz_description,
+			"\n\tk_fifo_put (ISR, burst)"
+			"\n\tk_fifo_get(K_FOREVER)");
+	printf(sz_test_start_fmt);
+
+	return_value += burst_run(true);
+
+	return return_value;
+}
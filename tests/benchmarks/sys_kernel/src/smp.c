@@ -0,0 +1,157 @@
+/* smp.c */
+
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "syskernel.h"
+
+/*
+ * Each pair of threads ping-pongs on its own pair of semaphores, so no
+ * two pairs ever touch the same kernel object.  With per-object locking
+ * the time for one iteration should stay flat as pairs are added, up to
+ * the number of CPUs.
+ */
+#define MAX_PAIRS CONFIG_MP_NUM_CPUS
+
+static K_THREAD_STACK_ARRAY_DEFINE(smp_stacks, 2 * MAX_PAIRS, STACK_SIZE);
+static struct k_thread smp_threads[2 * MAX_PAIRS];
+
+static struct k_sem smp_sem[2 * MAX_PAIRS];
+static struct k_sem smp_done;
+static int smp_counter[MAX_PAIRS];
+
+/**
+ *
+ * @brief SMP test thread (receiving side of a pair)
+ *
+ * @param par1   Index of the pair.
+ * @param par2   Number of test loops.
+ * @param par3   Unused
+ *
+ * @return N/A
+ */
+static void smp_thread1(void *par1, void *par2, void *par3)
+{
+	int i;
+	int pair = (int)par1;
+	int num_loops = (int)par2;
+
+	ARG_UNUSED(par3);
+
+	for (i = 0; i < num_loops; i++) {
+		k_sem_take(&smp_sem[2 * pair], K_FOREVER);
+		k_sem_give(&smp_sem[2 * pair + 1]);
+	}
+}
+
+/**
+ *
+ * @brief SMP test thread (sending side of a pair)
+ *
+ * @param par1   Index of the pair.
+ * @param par2   Number of test loops.
+ * @param par3   Unused
+ *
+ * @return N/A
+ */
+static void smp_thread2(void *par1, void *par2, void *par3)
+{
+	int i;
+	int pair = (int)par1;
+	int num_loops = (int)par2;
+
+	ARG_UNUSED(par3);
+
+	for (i = 0; i < num_loops; i++) {
+		k_sem_give(&smp_sem[2 * pair]);
+		k_sem_take(&smp_sem[2 * pair + 1], K_FOREVER);
+		smp_counter[pair]++;
+	}
+
+	k_sem_give(&smp_done);
+}
+
+/**
+ *
+ * @brief Run the ping-pong benchmark with a given number of thread pairs
+ *
+ * @param pairs   Number of independent thread pairs.
+ *
+ * @return 1 if success and 0 on failure
+ */
+static int smp_test_pairs(int pairs)
+{
+	u32_t t;
+	int i;
+	int min_count;
+
+	for (i = 0; i < 2 * pairs; i++) {
+		k_sem_init(&smp_sem[i], 0, 1);
+	}
+	k_sem_init(&smp_done, 0, MAX_PAIRS);
+
+	for (i = 0; i < pairs; i++) {
+		smp_counter[i] = 0;
+		k_thread_create(&smp_threads[2 * i], smp_stacks[2 * i],
+				STACK_SIZE, smp_thread1,
+				(void *)i, (void *)number_of_loops, NULL,
+				K_PRIO_COOP(3), 0, K_FOREVER);
+		k_thread_create(&smp_threads[2 * i + 1], smp_stacks[2 * i + 1],
+				STACK_SIZE, smp_thread2,
+				(void *)i, (void *)number_of_loops, NULL,
+				K_PRIO_COOP(3), 0, K_FOREVER);
+	}
+
+	t = BENCH_START();
+
+	for (i = 0; i < 2 * pairs; i++) {
+		k_thread_start(&smp_threads[i]);
+	}
+
+	/* on SMP the pairs may still be running on other CPUs */
+	for (i = 0; i < pairs; i++) {
+		k_sem_take(&smp_done, K_FOREVER);
+	}
+
+	t = TIME_STAMP_DELTA_GET(t);
+
+	min_count = smp_counter[0];
+	for (i = 1; i < pairs; i++) {
+		if (smp_counter[i] < min_count) {
+			min_count = smp_counter[i];
+		}
+	}
+
+	return check_result(min_count, t);
+}
+
+/**
+ *
+ * @brief The main test entry
+ *
+ * @return number of successful test cases
+ */
+int smp_test(void)
+{
+	int pairs;
+	int return_value = 0;
+	char title[32];
+
+	for (pairs = 1; pairs <= MAX_PAIRS; pairs++) {
+		snprintf(title, sizeof(title), "SMP scaling, %d pair%s",
+			 pairs, pairs > 1 ? "s" : "");
+		fprintf(output_file, sz_test_case_fmt, title);
+		fprintf(output_file, sz_description,
+				"\n\tk_sem_take(K_FOREVER)"
+				"\n\tk_sem_give"
+				"\n\t(one semaphore pair per thread pair)");
+		printf(sz_test_start_fmt);
+
+		return_value += smp_test_pairs(pairs);
+	}
+
+	return return_value;
+}
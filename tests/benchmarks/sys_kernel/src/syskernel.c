@@ -177,11 +177,16 @@ void main(void)
 		test_result += sema_test();
 		test_result += lifo_test();
 		test_result += fifo_test();
+		test_result += fifo_burst_test();
 		test_result += stack_test();
+		test_result += smp_test();
 
 		if (test_result) {
-			/* sema/lifo/fifo/stack account for 12 tests in total */
-			if (test_result == 12) {
+			/*
+			 * sema/lifo/fifo/stack account for 14 tests in total,
+			 * plus one SMP scaling test per CPU
+			 */
+			if (test_result == 14 + CONFIG_MP_NUM_CPUS) {
 				fprintf(output_file, sz_module_result_fmt,
 					sz_success);
 			} else {
@@ -50,7 +50,9 @@ int check_result(int i, u32_t ticks);
 int sema_test(void);
 int lifo_test(void);
 int fifo_test(void);
+int fifo_burst_test(void);
 int stack_test(void);
+int smp_test(void);
 void begin_test(void);
 
 static inline u32_t BENCH_START(void)
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Loopback interface losing and reordering data segments
+ *
+ * Works like the loopback driver, but drops CONFIG_GOODPUT_LOSS_PERCENT
+ * percent of the segments carrying data, and holds back another
+ * CONFIG_GOODPUT_REORDER_PERCENT percent until the next segment has been
+ * delivered.  Segments without data, such as SYNs and pure ACKs, are left
+ * alone so that connection setup never depends on luck.
+ */
+
+#include <zephyr.h>
+#include <random/rand32.h>
+#include <net/net_pkt.h>
+#include <net/buf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+
+#include "lossy_if.h"
+
+/* How long a held back segment waits when no other one follows */
+#define REORDER_FLUSH_DELAY K_MSEC(10)
+
+static struct net_if *lossy_iface;
+static struct net_pkt *held;
+static struct k_delayed_work flush_work;
+static u32_t dropped;
+static u32_t reordered;
+
+void lossy_if_stats(u32_t *dropped_count, u32_t *reordered_count)
+{
+	*dropped_count = dropped;
+	*reordered_count = reordered;
+}
+
+/* Copy the sent packet to the RX pools, as a real driver would */
+static struct net_pkt *copy_to_rx(struct net_pkt *pkt)
+{
+	struct net_pkt *rx;
+	struct net_buf *frag, *copy;
+
+	rx = net_pkt_get_reserve_rx(0, K_MSEC(100));
+	if (!rx) {
+		return NULL;
+	}
+
+	for (frag = pkt->frags; frag; frag = frag->frags) {
+		copy = net_pkt_get_reserve_rx_data(0, K_MSEC(100));
+		if (!copy) {
+			net_pkt_unref(rx);
+			return NULL;
+		}
+
+		net_buf_add_mem(copy, frag->data, frag->len);
+		net_pkt_frag_add(rx, copy);
+	}
+
+	return rx;
+}
+
+static void deliver(struct net_pkt *pkt)
+{
+	if (net_recv_data(lossy_iface, pkt) < 0) {
+		net_pkt_unref(pkt);
+	}
+}
+
+static struct net_pkt *take_held(void)
+{
+	struct net_pkt *pkt;
+	unsigned int key;
+
+	key = irq_lock();
+	pkt = held;
+	held = NULL;
+	irq_unlock(key);
+
+	return pkt;
+}
+
+static void flush_held(struct k_work *work)
+{
+	struct net_pkt *pkt = take_held();
+
+	ARG_UNUSED(work);
+
+	if (pkt) {
+		deliver(pkt);
+	}
+}
+
+static int lossy_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static void lossy_init(struct net_if *iface)
+{
+	lossy_iface = iface;
+	k_delayed_work_init(&flush_work, flush_held);
+
+	/* RFC 7042, s.2.1.1. address to use in documentation */
+	net_if_set_link_addr(iface, "\x00\x00\x5e\x00\x53\xfe", 6,
+			     NET_LINK_DUMMY);
+}
+
+static int lossy_send(struct net_if *iface, struct net_pkt *pkt)
+{
+	struct net_pkt *rx, *late;
+	struct in_addr addr;
+	u32_t dice = 100;
+	unsigned int key;
+
+	if (!pkt->frags) {
+		return -ENODATA;
+	}
+
+	net_ipaddr_copy(&addr, &NET_IPV4_HDR(pkt)->src);
+	net_ipaddr_copy(&NET_IPV4_HDR(pkt)->src, &NET_IPV4_HDR(pkt)->dst);
+	net_ipaddr_copy(&NET_IPV4_HDR(pkt)->dst, &addr);
+
+	if (net_pkt_appdatalen(pkt) > 0) {
+		dice = sys_rand32_get() % 100;
+	}
+
+	if (dice < CONFIG_GOODPUT_LOSS_PERCENT) {
+		dropped++;
+		net_pkt_unref(pkt);
+		return 0;
+	}
+
+	rx = copy_to_rx(pkt);
+	if (!rx) {
+		return -ENOMEM;
+	}
+
+	net_pkt_unref(pkt);
+
+	if (dice < CONFIG_GOODPUT_LOSS_PERCENT +
+		   CONFIG_GOODPUT_REORDER_PERCENT) {
+		key = irq_lock();
+		if (!held) {
+			held = rx;
+			rx = NULL;
+		}
+		irq_unlock(key);
+
+		if (!rx) {
+			reordered++;
+			k_delayed_work_submit(&flush_work,
+					      REORDER_FLUSH_DELAY);
+			goto out;
+		}
+	}
+
+	late = take_held();
+
+	deliver(rx);
+	if (late) {
+		deliver(late);
+	}
+
+out:
+	/* Let the receiving thread run now */
+	k_yield();
+
+	return 0;
+}
+
+static struct net_if_api lossy_if_api = {
+	.init = lossy_init,
+	.send = lossy_send,
+};
+
+NET_DEVICE_INIT(lossy_loopback, "lossy_lo",
+		lossy_dev_init, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&lossy_if_api, DUMMY_L2,
+		NET_L2_GET_CTX_TYPE(DUMMY_L2), 576);
@@ -0,0 +1,14 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __LOSSY_IF_H__
+#define __LOSSY_IF_H__
+
+#include <zephyr/types.h>
+
+void lossy_if_stats(u32_t *dropped, u32_t *reordered);
+
+#endif /* __LOSSY_IF_H__ */
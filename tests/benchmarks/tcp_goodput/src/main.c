@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure TCP goodput over a lossy link
+ *
+ * Streams CONFIG_GOODPUT_BYTES bytes from a client to a server over the
+ * lossy loopback interface, and reports the goodput: the rate at which the
+ * server application receives the data.  The stream carries a counting
+ * pattern, so that data delivered out of order is caught.  Build with and
+ * without TCP congestion control, the out-of-order queue and SACK to
+ * compare them.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <net/net_pkt.h>
+#include <net/net_ip.h>
+#include <net/net_context.h>
+
+#include "lossy_if.h"
+
+#define PORT		4242
+#define CHUNK		1024
+#define STREAM_TIMEOUT	K_SECONDS(600)
+
+/* The client sends from pools of its own, so that data waiting in its
+ * queue does not use up the buffers the server needs for its ACKs.
+ */
+NET_PKT_TX_SLAB_DEFINE(client_tx_slab, 64);
+NET_PKT_DATA_POOL_DEFINE(client_data_pool, 512);
+
+static K_SEM_DEFINE(stream_done, 0, 1);
+
+/* The stream byte at offset n is n & 0xff */
+static u8_t pattern[CHUNK + 256];
+static u32_t received;
+static int errors;
+
+static struct k_mem_slab *client_tx_slab_get(void)
+{
+	return &client_tx_slab;
+}
+
+static struct net_buf_pool *client_data_pool_get(void)
+{
+	return &client_data_pool;
+}
+
+static void server_recv(struct net_context *context, struct net_pkt *pkt,
+			int status, void *user_data)
+{
+	if (!pkt) {
+		return;
+	}
+
+	if (*net_pkt_appdata(pkt) != (u8_t)received) {
+		errors++;
+	}
+
+	received += net_pkt_appdatalen(pkt);
+	net_pkt_unref(pkt);
+
+	if (received >= CONFIG_GOODPUT_BYTES) {
+		k_sem_give(&stream_done);
+	}
+}
+
+static void server_accept(struct net_context *context,
+			  struct sockaddr *addr, socklen_t addrlen,
+			  int status, void *user_data)
+{
+	if (status == 0) {
+		net_context_recv(context, server_recv, K_NO_WAIT, NULL);
+	}
+}
+
+static int setup_server(struct sockaddr_in *addr)
+{
+	struct net_context *server;
+
+	if (net_context_get(AF_INET, SOCK_STREAM, IPPROTO_TCP, &server) < 0) {
+		return -ENOMEM;
+	}
+
+	if (net_context_bind(server, (struct sockaddr *)addr,
+			     sizeof(*addr)) < 0 ||
+	    net_context_listen(server, 0) < 0 ||
+	    net_context_accept(server, server_accept, K_NO_WAIT, NULL) < 0) {
+		net_context_put(server);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static int stream(struct net_context *client)
+{
+	struct net_pkt *pkt;
+	u32_t sent = 0;
+	u16_t len;
+
+	while (sent < CONFIG_GOODPUT_BYTES) {
+		pkt = net_pkt_get_tx(client, K_FOREVER);
+
+		len = min(CHUNK, CONFIG_GOODPUT_BYTES - sent);
+		len = net_pkt_append(pkt, len, &pattern[sent & 0xff],
+				     K_FOREVER);
+
+		if (!len || net_context_send(pkt, NULL, K_NO_WAIT,
+					     NULL, NULL) < 0) {
+			net_pkt_unref(pkt);
+			return -EIO;
+		}
+
+		sent += len;
+	}
+
+	return 0;
+}
+
+void main(void)
+{
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(PORT),
+	};
+	struct net_context *client = NULL;
+	int status = TC_FAIL;
+	u32_t start, elapsed;
+	u32_t dropped, reordered;
+	int i;
+
+	TC_START("TCP goodput");
+
+	for (i = 0; i < sizeof(pattern); i++) {
+		pattern[i] = i;
+	}
+
+	net_addr_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+		      &addr.sin_addr);
+
+	if (setup_server(&addr) < 0) {
+		TC_ERROR("Cannot set up the server\n");
+		goto out;
+	}
+
+	if (net_context_get(AF_INET, SOCK_STREAM, IPPROTO_TCP, &client) < 0) {
+		TC_ERROR("Cannot get the client context\n");
+		goto out;
+	}
+
+	net_context_setup_pools(client, client_tx_slab_get,
+				client_data_pool_get);
+
+	if (net_context_connect(client, (struct sockaddr *)&addr,
+				sizeof(addr), NULL, K_SECONDS(1), NULL) < 0) {
+		TC_ERROR("Cannot connect\n");
+		goto out;
+	}
+
+	TC_PRINT("%d bytes, %d%% of data segments lost, %d%% reordered\n",
+		 CONFIG_GOODPUT_BYTES, CONFIG_GOODPUT_LOSS_PERCENT,
+		 CONFIG_GOODPUT_REORDER_PERCENT);
+	TC_PRINT("congestion control %s, out-of-order queue %s, SACK %s\n",
+		 IS_ENABLED(CONFIG_NET_TCP_CONGESTION_CONTROL) ? "on" : "off",
+		 IS_ENABLED(CONFIG_NET_TCP_OUT_OF_ORDER_QUEUE) ? "on" : "off",
+		 IS_ENABLED(CONFIG_NET_TCP_SACK) ? "on" : "off");
+
+	start = k_uptime_get_32();
+
+	if (stream(client) < 0) {
+		TC_ERROR("Cannot send, %u bytes received\n", received);
+		goto out;
+	}
+
+	if (k_sem_take(&stream_done, STREAM_TIMEOUT) != 0) {
+		TC_ERROR("Stream stalled, %u bytes received\n", received);
+		goto out;
+	}
+
+	elapsed = max(k_uptime_get_32() - start, 1);
+	lossy_if_stats(&dropped, &reordered);
+
+	TC_PRINT("%u ms, goodput %u KB/s (%u segments dropped, "
+		 "%u reordered)\n", elapsed,
+		 (u32_t)((u64_t)received * 1000 / 1024 / elapsed),
+		 dropped, reordered);
+
+	if (errors != 0) {
+		TC_ERROR("%d segments were delivered out of order\n", errors);
+	} else {
+		status = TC_PASS;
+	}
+
+out:
+	if (client) {
+		net_context_put(client);
+	}
+
+	TC_END_RESULT(status);
+	TC_END_REPORT(status);
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure kernel timeout queue scaling
+ *
+ * Fills the kernel timeout queue with 10 to 10000 pending timeouts at
+ * pseudo-random expiries far enough in the future that none fires
+ * during the test, then measures the average cost of adding and
+ * aborting one more timeout and of looking up the next expiry.  Build
+ * with CONFIG_TIMEOUT_QUEUE_DLIST (default) or
+ * CONFIG_TIMEOUT_QUEUE_WHEEL to compare the two backends.
+ *
+ * It then arms NUM_BURST timeouts expiring on the same tick and
+ * measures the time spent in the timer interrupt expiring them, from
+ * the first callback to the last.  The first callback aborts the last
+ * timeout of the burst, which must then not fire.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <timeout_q.h>
+
+#define MAX_PENDING	10000
+#define NUM_PROBES	100
+
+/* expiries are spread over this many ticks, starting after MIN_DELAY */
+#define MIN_DELAY	100000
+#define DELAY_SPREAD	1000000
+
+static struct _timeout pending[MAX_PENDING];
+static struct _timeout probes[NUM_PROBES];
+
+#define NUM_BURST	1000
+#define BURST_DELAY	10
+
+static struct _timeout burst_arm;
+static volatile int burst_fired;
+static volatile u32_t burst_start, burst_end;
+
+static u32_t rand_state = 1;
+
+static s32_t rand_delay(void)
+{
+	/* Numerical Recipes LCG, good enough to scatter expiries */
+	rand_state = rand_state * 1664525 + 1013904223;
+	return MIN_DELAY + (rand_state >> 8) % DELAY_SPREAD;
+}
+
+static void timeout_fn(struct _timeout *t)
+{
+	ARG_UNUSED(t);
+
+	TC_ERROR("timeout fired during the benchmark\n");
+}
+
+static void measure(int num_pending)
+{
+	u32_t add_cycles, abort_cycles, next_cycles;
+	u32_t start;
+	int i;
+
+	for (i = 0; i < num_pending; i++) {
+		_add_timeout(&pending[i], timeout_fn, rand_delay());
+	}
+
+	start = k_cycle_get_32();
+	for (i = 0; i < NUM_PROBES; i++) {
+		_add_timeout(&probes[i], timeout_fn, rand_delay());
+	}
+	add_cycles = k_cycle_get_32() - start;
+
+	start = k_cycle_get_32();
+	for (i = 0; i < NUM_PROBES; i++) {
+		(void)_get_next_timeout_expiry();
+	}
+	next_cycles = k_cycle_get_32() - start;
+
+	start = k_cycle_get_32();
+	for (i = 0; i < NUM_PROBES; i++) {
+		_abort_timeout(&probes[i]);
+	}
+	abort_cycles = k_cycle_get_32() - start;
+
+	for (i = 0; i < num_pending; i++) {
+		_abort_timeout(&pending[i]);
+	}
+
+	TC_PRINT("%6d pending: add %6u ns, abort %6u ns, next expiry %6u ns\n",
+		 num_pending,
+		 SYS_CLOCK_HW_CYCLES_TO_NS_AVG(add_cycles, NUM_PROBES),
+		 SYS_CLOCK_HW_CYCLES_TO_NS_AVG(abort_cycles, NUM_PROBES),
+		 SYS_CLOCK_HW_CYCLES_TO_NS_AVG(next_cycles, NUM_PROBES));
+}
+
+static void burst_fn(struct _timeout *t)
+{
+	u32_t now = k_cycle_get_32();
+
+	if (burst_fired == 0) {
+		burst_start = now;
+		_abort_timeout(&pending[NUM_BURST - 1]);
+	}
+
+	burst_fired++;
+	burst_end = now;
+}
+
+/* Runs from the timer interrupt, so all the burst timeouts are added
+ * relative to the same tick.
+ */
+static void burst_arm_fn(struct _timeout *t)
+{
+	for (int i = 0; i < NUM_BURST; i++) {
+		_add_timeout(&pending[i], burst_fn, BURST_DELAY);
+	}
+}
+
+static int measure_burst(void)
+{
+	burst_fired = 0;
+
+	_add_timeout(&burst_arm, burst_arm_fn, 1);
+	k_sleep(__ticks_to_ms(BURST_DELAY + 10));
+
+	TC_PRINT("%d timeouts on one tick: %u ns per expiry (%u ns total)\n",
+		 burst_fired,
+		 SYS_CLOCK_HW_CYCLES_TO_NS_AVG(burst_end - burst_start,
+					       burst_fired),
+		 SYS_CLOCK_HW_CYCLES_TO_NS(burst_end - burst_start));
+
+	if (burst_fired != NUM_BURST - 1) {
+		TC_ERROR("expected %d expiries, got %d\n",
+			 NUM_BURST - 1, burst_fired);
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	int i;
+	int status;
+
+	TC_START("Timeout queue scaling");
+
+	for (i = 0; i < MAX_PENDING; i++) {
+		_init_timeout(&pending[i], timeout_fn);
+	}
+	for (i = 0; i < NUM_PROBES; i++) {
+		_init_timeout(&probes[i], timeout_fn);
+	}
+	_init_timeout(&burst_arm, burst_arm_fn);
+
+	TC_PRINT("Timeout queue: %s\n",
+		 IS_ENABLED(CONFIG_TIMEOUT_QUEUE_WHEEL) ? "timer wheel" :
+		 "sorted delta list");
+
+	for (i = 10; i <= MAX_PENDING; i *= 10) {
+		measure(i);
+	}
+
+	status = measure_burst();
+
+	TC_END_RESULT(status);
+	TC_END_REPORT(status);
+}
@@ -223,5 +223,6 @@ extern u64_t __end_tick_time;
 __syscall int k_dummy_syscall(void);
 __syscall u32_t userspace_read_timer_value(void);
 __syscall int validation_overhead_syscall(void);
+__syscall int object_lookup_syscall(struct k_sem *sem);
 #include <syscalls/timing_info.h>
 #endif	/* CONFIG_USERSPACE */
@@ -47,6 +47,8 @@ void drop_to_user_mode(void);
 void user_thread_creation(void);
 void syscall_overhead(void);
 void validation_overhead(void);
+void object_lookup_overhead(void);
+void domain_switch_overhead(void);
 
 void userspace_bench(void)
 {
@@ -58,6 +60,10 @@ void userspace_bench(void)
 
 	validation_overhead();
 
+	object_lookup_overhead();
+
+	domain_switch_overhead();
+
 }
 /******************************************************************************/
 
@@ -273,3 +279,174 @@ void validation_overhead(void)
 
 
 }
+
+/******************************************************************************/
+#define NUM_LOOKUP_SYSCALLS 1000
+
+K_SEM_DEFINE(lookup_sema, 0, 1);
+u32_t object_lookup_start_time;
+u32_t object_lookup_first_end_time;
+u32_t object_lookup_end_time;
+
+int _impl_object_lookup_syscall(struct k_sem *sem)
+{
+	ARG_UNUSED(sem);
+	return 0;
+}
+
+Z_SYSCALL_HANDLER(object_lookup_syscall, sem)
+{
+	Z_OOPS(Z_SYSCALL_OBJ(sem, K_OBJ_SEM));
+	return _impl_object_lookup_syscall((struct k_sem *)sem);
+}
+
+void object_lookup_user_thread(void *p1, void *p2, void *p3)
+{
+	/* The first call looks up the semaphore, and the thread itself for
+	 * the permission check; later ones hit the thread's object cache
+	 * unless CONFIG_KOBJECT_CACHE_SIZE is 0.
+	 */
+	object_lookup_start_time = userspace_read_timer_value();
+	(void)object_lookup_syscall(&lookup_sema);
+	object_lookup_first_end_time = userspace_read_timer_value();
+
+	for (int i = 0; i < NUM_LOOKUP_SYSCALLS; i++) {
+		(void)object_lookup_syscall(&lookup_sema);
+	}
+	object_lookup_end_time = userspace_read_timer_value();
+}
+
+void object_lookup_overhead(void)
+{
+	k_thread_access_grant(k_current_get(), &lookup_sema, NULL);
+
+	k_thread_create(&my_thread_user, my_stack_area, STACK_SIZE,
+			object_lookup_user_thread,
+			NULL, NULL, NULL,
+			-1 /*priority*/, K_INHERIT_PERMS | K_USER, 0);
+
+	u32_t total_cycles_first = (u32_t)
+		((SUBTRACT_CLOCK_CYCLES(object_lookup_first_end_time) -
+		  SUBTRACT_CLOCK_CYCLES(object_lookup_start_time)) &
+		 0xFFFFFFFFULL);
+
+	u32_t total_cycles_repeat = (u32_t)
+		(((SUBTRACT_CLOCK_CYCLES(object_lookup_end_time) -
+		   SUBTRACT_CLOCK_CYCLES(object_lookup_first_end_time)) &
+		  0xFFFFFFFFULL) / NUM_LOOKUP_SYSCALLS);
+
+	PRINT_STATS("Syscall with object, first call",
+		    total_cycles_first,
+		    (u32_t) (CYCLES_TO_NS(total_cycles_first) &
+			     0xFFFFFFFFULL));
+
+	PRINT_STATS("Syscall with object, repeated",
+		    total_cycles_repeat,
+		    (u32_t) (CYCLES_TO_NS(total_cycles_repeat) &
+			     0xFFFFFFFFULL));
+}
+
+/******************************************************************************/
+#define NUM_DOMAIN_YIELDS 500
+
+#if defined(CONFIG_X86)
+#define DOMAIN_BUF_SIZE 4096
+#elif defined(CONFIG_ARC)
+#define DOMAIN_BUF_SIZE STACK_ALIGN
+#else
+#define DOMAIN_BUF_SIZE 32
+#endif
+
+/* the first two words of domain_a_buf hold the start and end times */
+__kernel u32_t __aligned(DOMAIN_BUF_SIZE)
+	domain_a_buf[DOMAIN_BUF_SIZE / sizeof(u32_t)];
+__kernel u32_t __aligned(DOMAIN_BUF_SIZE)
+	domain_b_buf[DOMAIN_BUF_SIZE / sizeof(u32_t)];
+
+K_MEM_PARTITION_DEFINE(domain_a_part, domain_a_buf, sizeof(domain_a_buf),
+		       K_MEM_PARTITION_P_RW_U_RW);
+K_MEM_PARTITION_DEFINE(domain_b_part, domain_b_buf, sizeof(domain_b_buf),
+		       K_MEM_PARTITION_P_RW_U_RW);
+
+__kernel struct k_mem_domain domain_a;
+__kernel struct k_mem_domain domain_b;
+__kernel struct k_thread domain_thread_a;
+__kernel struct k_thread domain_thread_b;
+
+void domain_switch_thread_a(void *p1, void *p2, void *p3)
+{
+	domain_a_buf[0] = userspace_read_timer_value();
+	for (int i = 0; i < NUM_DOMAIN_YIELDS; i++) {
+		k_yield();
+	}
+	domain_a_buf[1] = userspace_read_timer_value();
+}
+
+void domain_switch_thread_b(void *p1, void *p2, void *p3)
+{
+	for (int i = 0; i < NUM_DOMAIN_YIELDS; i++) {
+		domain_b_buf[0] = i;
+		k_yield();
+	}
+}
+
+/* Average cycles per switch between a thread of domain_a and one of
+ * domain_b_ptr, which yield to each other
+ */
+u32_t domain_switch_cycles(struct k_mem_domain *domain_b_ptr)
+{
+	k_thread_create(&domain_thread_a, my_stack_area, STACK_SIZE,
+			domain_switch_thread_a,
+			NULL, NULL, NULL,
+			-1 /*priority*/, K_USER, K_FOREVER);
+	k_thread_create(&domain_thread_b, my_stack_area_0, STACK_SIZE,
+			domain_switch_thread_b,
+			NULL, NULL, NULL,
+			-1 /*priority*/, K_USER, K_FOREVER);
+
+	k_mem_domain_add_thread(&domain_a, &domain_thread_a);
+	k_mem_domain_add_thread(domain_b_ptr, &domain_thread_b);
+
+	/* both threads must be ready before either one first yields */
+	k_sched_lock();
+	k_thread_start(&domain_thread_a);
+	k_thread_start(&domain_thread_b);
+	k_sched_unlock();
+
+	k_mem_domain_remove_thread(&domain_thread_a);
+	k_mem_domain_remove_thread(&domain_thread_b);
+
+	/* each yield of either thread switches to the other one */
+	return (u32_t)(((SUBTRACT_CLOCK_CYCLES(domain_a_buf[1]) -
+			 SUBTRACT_CLOCK_CYCLES(domain_a_buf[0])) &
+			0xFFFFFFFFULL) / (2 * NUM_DOMAIN_YIELDS));
+}
+
+void domain_switch_overhead(void)
+{
+	struct k_mem_partition *parts_a[] = { &domain_a_part };
+	struct k_mem_partition *parts_b[] = { &domain_b_part };
+	u32_t total_cycles_same, total_cycles_other;
+
+	k_mem_domain_init(&domain_a, ARRAY_SIZE(parts_a), parts_a);
+	k_mem_domain_init(&domain_b, ARRAY_SIZE(parts_b), parts_b);
+
+	/* thread b writes domain_b_buf from either domain */
+	k_mem_domain_add_partition(&domain_a, &domain_b_part);
+
+	total_cycles_same = domain_switch_cycles(&domain_a);
+	total_cycles_other = domain_switch_cycles(&domain_b);
+
+	k_mem_domain_destroy(&domain_a);
+	k_mem_domain_destroy(&domain_b);
+
+	PRINT_STATS("User thread switch, same domain",
+		    total_cycles_same,
+		    (u32_t) (CYCLES_TO_NS(total_cycles_same) &
+			     0xFFFFFFFFULL));
+
+	PRINT_STATS("User thread switch, different domains",
+		    total_cycles_other,
+		    (u32_t) (CYCLES_TO_NS(total_cycles_other) &
+			     0xFFFFFFFFULL));
+}
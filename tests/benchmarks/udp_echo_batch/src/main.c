@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure the UDP echo rate for batches of datagrams
+ *
+ * A client sends batches of 1 to 64 datagrams with sendmmsg() to an echo
+ * server thread through the loopback interface, and waits with recvmmsg()
+ * for all of a batch to come back before sending the next.  The server
+ * echoes whatever it has received, up to 64 datagrams, with a single
+ * sendmmsg().  Reports the number of datagrams echoed per second of host
+ * time for each batch size, and as a baseline, the same when the client
+ * sends and receives each datagram of a batch with its own send() and
+ * recv() call.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <string.h>
+#include <net/socket.h>
+
+#define DGRAM_LEN	64
+#define MAX_BATCH	64
+#define DGRAMS		4096
+#define SERVER_PORT	4242
+
+#define SERVER_STACK_SIZE	2048
+#define SERVER_PRIORITY		K_PRIO_PREEMPT(1)
+
+/* Provided by the native_posix timer model. Kernel time only advances
+ * while all threads are idle on native_posix, so it cannot measure how
+ * fast the stack runs.
+ */
+extern u64_t get_host_us_time(void);
+
+static const unsigned int batches[] = { 1, 4, 16, 64 };
+
+static int client;
+static int server;
+
+K_THREAD_STACK_DEFINE(server_stack, SERVER_STACK_SIZE);
+static struct k_thread server_thread;
+
+static u8_t srv_bufs[MAX_BATCH][DGRAM_LEN];
+static struct iovec srv_iov[MAX_BATCH];
+static struct sockaddr_in srv_addrs[MAX_BATCH];
+static struct mmsghdr srv_msgs[MAX_BATCH];
+
+static u8_t tx_bufs[MAX_BATCH][DGRAM_LEN];
+static u8_t rx_bufs[MAX_BATCH][DGRAM_LEN];
+static struct iovec tx_iov[MAX_BATCH];
+static struct iovec rx_iov[MAX_BATCH];
+static struct mmsghdr tx_msgs[MAX_BATCH];
+static struct mmsghdr rx_msgs[MAX_BATCH];
+
+static void server_run(void *p1, void *p2, void *p3)
+{
+	int i, n, sent;
+
+	for (i = 0; i < MAX_BATCH; i++) {
+		srv_iov[i].iov_base = srv_bufs[i];
+		srv_msgs[i].msg_hdr.msg_name = &srv_addrs[i];
+		srv_msgs[i].msg_hdr.msg_iov = &srv_iov[i];
+		srv_msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	while (true) {
+		for (i = 0; i < MAX_BATCH; i++) {
+			srv_iov[i].iov_len = DGRAM_LEN;
+			srv_msgs[i].msg_hdr.msg_namelen = sizeof(srv_addrs[i]);
+		}
+
+		n = recvmmsg(server, srv_msgs, MAX_BATCH, MSG_WAITFORONE);
+		if (n <= 0) {
+			continue;
+		}
+
+		/* Echo each datagram back to its sender, as received */
+		for (i = 0; i < n; i++) {
+			srv_iov[i].iov_len = srv_msgs[i].msg_len;
+		}
+
+		for (i = 0; i < n; i += sent) {
+			sent = sendmmsg(server, &srv_msgs[i], n - i, 0);
+			if (sent <= 0) {
+				break;
+			}
+		}
+	}
+}
+
+/* Sends a batch, then waits for all of it to be echoed back */
+static bool echo_batch(unsigned int batch)
+{
+	unsigned int i;
+	int n;
+
+	for (i = 0; i < batch; i += n) {
+		n = sendmmsg(client, &tx_msgs[i], batch - i, 0);
+		if (n <= 0) {
+			return false;
+		}
+	}
+
+	for (i = 0; i < batch; i += n) {
+		n = recvmmsg(client, &rx_msgs[i], batch - i, MSG_WAITFORONE);
+		if (n <= 0) {
+			return false;
+		}
+	}
+
+	for (i = 0; i < batch; i++) {
+		if (rx_msgs[i].msg_len != DGRAM_LEN ||
+		    memcmp(rx_bufs[i], tx_bufs[i], DGRAM_LEN) != 0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* Same as echo_batch(), with a call per datagram */
+static bool echo_batch_per_call(unsigned int batch)
+{
+	unsigned int i;
+
+	for (i = 0; i < batch; i++) {
+		if (send(client, tx_bufs[i], DGRAM_LEN, 0) != DGRAM_LEN) {
+			return false;
+		}
+	}
+
+	for (i = 0; i < batch; i++) {
+		if (recv(client, rx_bufs[i], DGRAM_LEN, 0) != DGRAM_LEN ||
+		    memcmp(rx_bufs[i], tx_bufs[i], DGRAM_LEN) != 0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static u32_t measure(bool (*echo)(unsigned int batch), unsigned int batch,
+		     int *errors)
+{
+	u64_t start, elapsed;
+	u32_t seq = 0;
+	unsigned int i;
+
+	start = get_host_us_time();
+
+	while (seq < DGRAMS) {
+		/* Number the datagrams, so that one echoed out of turn is
+		 * noticed.
+		 */
+		for (i = 0; i < batch; i++) {
+			memset(tx_bufs[i], seq + i, DGRAM_LEN);
+			memcpy(tx_bufs[i], &seq, sizeof(seq));
+			seq++;
+		}
+
+		if (!echo(batch)) {
+			(*errors)++;
+		}
+	}
+
+	elapsed = max(get_host_us_time() - start, 1);
+
+	return (u64_t)DGRAMS * USEC_PER_SEC / elapsed;
+}
+
+void main(void)
+{
+	int status = TC_PASS;
+	int errors = 0;
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(SERVER_PORT),
+	};
+	int i;
+
+	TC_START("UDP echo batching");
+
+	inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR, &addr.sin_addr);
+
+	client = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	server = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (client < 0 || server < 0 ||
+	    bind(server, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+	    connect(client, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		TC_ERROR("Cannot set up the sockets: %d\n", errno);
+		TC_END_RESULT(TC_FAIL);
+		TC_END_REPORT(TC_FAIL);
+		return;
+	}
+
+	for (i = 0; i < MAX_BATCH; i++) {
+		tx_iov[i].iov_base = tx_bufs[i];
+		tx_iov[i].iov_len = DGRAM_LEN;
+		tx_msgs[i].msg_hdr.msg_iov = &tx_iov[i];
+		tx_msgs[i].msg_hdr.msg_iovlen = 1;
+
+		rx_iov[i].iov_base = rx_bufs[i];
+		rx_iov[i].iov_len = DGRAM_LEN;
+		rx_msgs[i].msg_hdr.msg_iov = &rx_iov[i];
+		rx_msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	k_thread_create(&server_thread, server_stack,
+			K_THREAD_STACK_SIZEOF(server_stack), server_run,
+			NULL, NULL, NULL, SERVER_PRIORITY, 0, K_NO_WAIT);
+
+	TC_PRINT("%d datagrams of %d bytes per batch size\n",
+		 DGRAMS, DGRAM_LEN);
+
+	TC_PRINT("batch   sendmmsg/recvmmsg   send/recv\n");
+
+	for (i = 0; i < ARRAY_SIZE(batches); i++) {
+		TC_PRINT("%5u   %15u/s   %7u/s\n", batches[i],
+			 measure(echo_batch, batches[i], &errors),
+			 measure(echo_batch_per_call, batches[i], &errors));
+	}
+
+	if (errors != 0) {
+		TC_ERROR("%d batches were not echoed back intact\n", errors);
+		status = TC_FAIL;
+	}
+
+	k_thread_abort(&server_thread);
+	close(client);
+	close(server);
+
+	TC_END_RESULT(status);
+	TC_END_REPORT(status);
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure work queue and work pool throughput
+ *
+ * Runs NUM_ITEMS short work items, NUM_IN_FLIGHT at a time, each
+ * handler resubmitting its item until all have run, on a workqueue and
+ * on work pools of one worker thread and of one worker per CPU.
+ * Reports the average time per item and, for the work pools, the
+ * deepest the queue got and the average time items waited for a
+ * worker.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+
+#define NUM_ITEMS	100000
+#define NUM_IN_FLIGHT	64
+#define STACK_SIZE	1024
+#define WORKER_PRIO	K_PRIO_PREEMPT(1)
+
+static K_THREAD_STACK_DEFINE(work_q_stack, STACK_SIZE);
+static struct k_work_q work_q;
+static struct k_work works[NUM_IN_FLIGHT];
+
+K_WORK_POOL_DEFINE(single_pool, 1, STACK_SIZE);
+K_WORK_POOL_DEFINE(cpu_pool, CONFIG_MP_NUM_CPUS, STACK_SIZE);
+static struct k_work_pool *current_pool;
+static struct k_pool_work pool_works[NUM_IN_FLIGHT];
+
+static K_SEM_DEFINE(done_sem, 0, 1);
+static atomic_t count;
+
+/* Returns true if the item must run again */
+static bool item_done(void)
+{
+	atomic_val_t n = atomic_inc(&count) + 1;
+
+	if (n == NUM_ITEMS) {
+		k_sem_give(&done_sem);
+	}
+
+	return n <= NUM_ITEMS - NUM_IN_FLIGHT;
+}
+
+static void work_handler(struct k_work *work)
+{
+	if (item_done()) {
+		k_work_submit_to_queue(&work_q, work);
+	}
+}
+
+static void pool_work_handler(struct k_pool_work *work)
+{
+	if (item_done()) {
+		k_work_pool_submit(current_pool, work);
+	}
+}
+
+static void report(const char *name, u32_t cycles)
+{
+	TC_PRINT("%-16s: %5u ns per item, %6u items/s\n", name,
+		 SYS_CLOCK_HW_CYCLES_TO_NS_AVG(cycles, NUM_ITEMS),
+		 (u32_t)((u64_t)NUM_ITEMS * 1000000000 /
+			 max(SYS_CLOCK_HW_CYCLES_TO_NS64(cycles), 1ULL)));
+}
+
+static void run_work_q(void)
+{
+	u32_t start;
+	int i;
+
+	atomic_clear(&count);
+	start = k_cycle_get_32();
+	for (i = 0; i < NUM_IN_FLIGHT; i++) {
+		k_work_submit_to_queue(&work_q, &works[i]);
+	}
+	k_sem_take(&done_sem, K_FOREVER);
+
+	report("workqueue", k_cycle_get_32() - start);
+}
+
+static void run_pool(const char *name, struct k_work_pool *pool)
+{
+	struct k_work_pool_stats stats;
+	u32_t start;
+	int i;
+
+	current_pool = pool;
+	atomic_clear(&count);
+	k_work_pool_stats_reset(pool);
+
+	start = k_cycle_get_32();
+	for (i = 0; i < NUM_IN_FLIGHT; i++) {
+		k_work_pool_submit(pool, &pool_works[i]);
+	}
+	k_sem_take(&done_sem, K_FOREVER);
+
+	report(name, k_cycle_get_32() - start);
+
+	k_work_pool_stats_get(pool, &stats);
+	TC_PRINT("%16s  max queued %u, avg wait %u ns, avg run %u ns\n", "",
+		 stats.max_queued,
+		 (u32_t)SYS_CLOCK_HW_CYCLES_TO_NS64(stats.total_wait_cycles /
+						   max(stats.completed, 1U)),
+		 (u32_t)SYS_CLOCK_HW_CYCLES_TO_NS64(stats.total_run_cycles /
+						   max(stats.completed, 1U)));
+}
+
+void main(void)
+{
+	int i;
+
+	TC_START("Work pool throughput");
+
+	TC_PRINT("%d items, %d in flight, %d CPUs\n",
+		 NUM_ITEMS, NUM_IN_FLIGHT, CONFIG_MP_NUM_CPUS);
+
+	/* the test thread only waits for the end of each run */
+	k_thread_priority_set(k_current_get(), K_PRIO_PREEMPT(0));
+
+	k_work_q_start(&work_q, work_q_stack,
+		       K_THREAD_STACK_SIZEOF(work_q_stack), WORKER_PRIO);
+	k_work_pool_start(&single_pool, WORKER_PRIO, 0);
+	k_work_pool_start(&cpu_pool, WORKER_PRIO, K_WORK_POOL_PER_CPU);
+
+	for (i = 0; i < NUM_IN_FLIGHT; i++) {
+		k_work_init(&works[i], work_handler);
+		k_pool_work_init(&pool_works[i], pool_work_handler, 0, NULL);
+	}
+
+	run_work_q();
+	run_pool("pool, 1 thread", &single_pool);
+	run_pool("pool, per CPU", &cpu_pool);
+
+	TC_END_RESULT(TC_PASS);
+	TC_END_REPORT(TC_PASS);
+}
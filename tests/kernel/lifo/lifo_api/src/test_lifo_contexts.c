@@ -13,6 +13,8 @@ K_LIFO_DEFINE(klifo);
 
 struct k_lifo lifo;
 static ldata_t data[LIST_LEN];
+static ldata_t data_l[LIST_LEN];
+static void *waiter_data;
 
 static K_THREAD_STACK_DEFINE(tstack, STACK_SIZE);
 static struct k_thread tdata;
@@ -55,6 +57,23 @@ static void tThread_entry(void *p1, void *p2, void *p3)
 	k_sem_give(&end_sema);
 }
 
+static void tThread_entry_get_one(void *p1, void *p2, void *p3)
+{
+	waiter_data = k_lifo_get((struct k_lifo *)p1, K_FOREVER);
+	k_sem_give(&end_sema);
+}
+
+static void tlifo_put_list(struct k_lifo *plifo)
+{
+	for (int i = 0; i < LIST_LEN; i++) {
+		data_l[i].snode.next = (i < LIST_LEN - 1) ?
+				       &data_l[i + 1].snode : NULL;
+	}
+
+	/**TESTPOINT: lifo put list*/
+	k_lifo_put_list(plifo, &data_l[0], &data_l[LIST_LEN - 1]);
+}
+
 static void tlifo_thread_thread(struct k_lifo *plifo)
 {
 	k_sem_init(&end_sema, 0, 1);
@@ -130,6 +149,46 @@ void test_lifo_isr2thread(void)
 	tlifo_isr_thread(&klifo);
 }
 
+/**
+ * @brief test adding a list of items to a lifo
+ * @see k_lifo_put_list(), k_lifo_get()
+ */
+void test_lifo_put_list(void)
+{
+	void *rx_data;
+
+	k_lifo_init(&lifo);
+	k_lifo_put(&lifo, &data[0]);
+	tlifo_put_list(&lifo);
+
+	/* the items come out as if put one at a time */
+	for (int i = LIST_LEN - 1; i >= 0; i--) {
+		rx_data = k_lifo_get(&lifo, K_NO_WAIT);
+		zassert_equal(rx_data, (void *)&data_l[i], NULL);
+	}
+	zassert_equal(k_lifo_get(&lifo, K_NO_WAIT), (void *)&data[0], NULL);
+	zassert_is_null(k_lifo_get(&lifo, K_NO_WAIT), NULL);
+
+	/* a waiting thread gets the first item of the list */
+	k_sem_init(&end_sema, 0, 1);
+	k_tid_t tid = k_thread_create(&tdata, tstack, STACK_SIZE,
+		tThread_entry_get_one, &lifo, NULL, NULL,
+		K_PRIO_PREEMPT(0), 0, 0);
+
+	k_sleep(100);
+	tlifo_put_list(&lifo);
+	k_sem_take(&end_sema, K_FOREVER);
+	zassert_equal(waiter_data, (void *)&data_l[0], NULL);
+
+	for (int i = LIST_LEN - 1; i > 0; i--) {
+		rx_data = k_lifo_get(&lifo, K_NO_WAIT);
+		zassert_equal(rx_data, (void *)&data_l[i], NULL);
+	}
+	zassert_is_null(k_lifo_get(&lifo, K_NO_WAIT), NULL);
+
+	k_thread_abort(tid);
+}
+
 /**
  * @}
  */
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+
+#define NUM_OPS 5000
+#define NUM_BLOCKS 64
+
+#ifdef CONFIG_MEM_POOL_IRQ_LOCK_STATS
+/* 3 levels */
+K_MEM_POOL_DEFINE(small_pool, 16, 256, 4, 4);
+/* 5 levels, the largest blocks split down to 16 bytes */
+K_MEM_POOL_DEFINE(large_pool, 16, 4096, 4, 4);
+
+static struct k_mem_block blocks[NUM_BLOCKS];
+
+static u32_t rand_state = 1;
+
+static u32_t rand_u32(void)
+{
+	rand_state = rand_state * 1664525 + 1013904223;
+	return rand_state >> 8;
+}
+
+static u32_t random_ops(struct k_mem_pool *pool, size_t max_size)
+{
+	int i, n = 0;
+
+	pool->base.max_lock_cycles = 0;
+
+	for (i = 0; i < NUM_OPS; i++) {
+		if (n < NUM_BLOCKS && rand_u32() % 2 == 0) {
+			if (k_mem_pool_alloc(pool, &blocks[n],
+					     1 + rand_u32() % max_size,
+					     K_NO_WAIT) == 0) {
+				n++;
+			}
+		} else if (n > 0) {
+			int j = rand_u32() % n;
+
+			k_mem_pool_free(&blocks[j]);
+			blocks[j] = blocks[--n];
+		}
+	}
+
+	while (n > 0) {
+		k_mem_pool_free(&blocks[--n]);
+	}
+
+	return pool->base.max_lock_cycles;
+}
+
+/**
+ * @brief Measure how long memory pools lock interrupts
+ *
+ * @details Performs random allocations and frees on a small and a large
+ * memory pool and reports the longest time each kept interrupts locked.
+ * Allocating a small block from a large pool splits a block on each
+ * level, and freeing it merges them back, but the pool only locks
+ * interrupts for one level at a time, so the two figures should be
+ * close.  They are only reported: emulators and coverage builds make
+ * them too noisy to check.
+ *
+ * @ingroup kernel_memory_pool_tests
+ */
+void test_mpool_irq_lock_duration(void)
+{
+	u32_t small_max, large_max;
+
+	small_max = random_ops(&small_pool, 256);
+	large_max = random_ops(&large_pool, 4096);
+
+	TC_PRINT("longest interrupt lock: %u ns (3 levels), "
+		 "%u ns (5 levels)\n",
+		 SYS_CLOCK_HW_CYCLES_TO_NS(small_max),
+		 SYS_CLOCK_HW_CYCLES_TO_NS(large_max));
+
+	/* all blocks merged back */
+	for (int i = 0; i < 4; i++) {
+		zassert_equal(k_mem_pool_alloc(&large_pool, &blocks[i], 4096,
+					       K_NO_WAIT), 0, NULL);
+	}
+	for (int i = 0; i < 4; i++) {
+		k_mem_pool_free(&blocks[i]);
+	}
+}
+#else
+void test_mpool_irq_lock_duration(void)
+{
+	/* the heap backend does not keep these statistics */
+	ztest_test_skip();
+}
+#endif
+
+void test_main(void)
+{
+	ztest_test_suite(mpool_irq_lock,
+			 ztest_unit_test(test_mpool_irq_lock_duration));
+	ztest_run_test_suite(mpool_irq_lock);
+}
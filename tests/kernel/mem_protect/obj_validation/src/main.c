@@ -111,10 +111,44 @@ void test_generic_object(void)
 	}
 }
 
+/**
+ * @brief Test the per-thread cache of kernel object lookups
+ *
+ * @ingroup kernel_memprotect_tests
+ *
+ * @see z_object_find_cached()
+ */
+void test_object_cache(void)
+{
+	struct k_sem *sem = k_object_alloc(K_OBJ_SEM);
+	struct _k_object *ko;
+
+	zassert_not_null(sem, "couldn't allocate semaphore");
+	k_sem_init(sem, 0, 1);
+	k_object_access_grant(sem, _main_thread);
+
+	ko = z_object_find_cached(sem);
+	zassert_equal(ko, _k_object_find(sem), NULL);
+	zassert_equal(z_object_find_cached(sem), ko, NULL);
+
+	/* Permissions are checked on every call, cached or not */
+	zassert_equal(_k_object_validate(z_object_find_cached(sem),
+					 K_OBJ_SEM, _OBJ_INIT_TRUE), 0, NULL);
+	k_object_access_revoke(sem, k_current_get());
+	zassert_equal(_k_object_validate(z_object_find_cached(sem),
+					 K_OBJ_SEM, _OBJ_INIT_TRUE), -EPERM,
+		      NULL);
+
+	/* A freed object must not be found in the cache */
+	k_object_free(sem);
+	zassert_is_null(z_object_find_cached(sem), NULL);
+}
+
 void test_main(void)
 {
 	k_thread_system_pool_assign(k_current_get());
 	ztest_test_suite(object_validation,
-			 ztest_unit_test(test_generic_object));
+			 ztest_unit_test(test_generic_object),
+			 ztest_unit_test(test_object_cache));
 	ztest_run_test_suite(object_validation);
 }
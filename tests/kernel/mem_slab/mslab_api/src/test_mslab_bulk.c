@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include "test_mslab.h"
+
+#define BULK_NUM 8
+
+K_MEM_SLAB_DEFINE(bulk_slab, BLK_SIZE, BULK_NUM, BLK_ALIGN);
+
+static K_THREAD_STACK_DEFINE(waiter_stack, 512);
+static struct k_thread waiter_thread;
+static void *waiter_block;
+static int waiter_ret = 1;
+
+static void waiter_entry(void *p1, void *p2, void *p3)
+{
+	waiter_ret = k_mem_slab_alloc(&bulk_slab, &waiter_block, TIMEOUT);
+}
+
+/**
+ * @brief Verify allocating and freeing several blocks at once
+ *
+ * @details Allocates all the blocks of a slab with
+ * @see k_mem_slab_alloc_n(), checks that they are distinct, that a
+ * request for more blocks than are free fails without allocating any,
+ * and that @see k_mem_slab_free_n() gives one block to a thread
+ * waiting on the slab and puts the others back.
+ *
+ * @ingroup kernel_memory_slab_tests
+ */
+void test_mslab_alloc_free_n(void)
+{
+	void *block[BULK_NUM];
+	void *extra;
+
+	/* leave some blocks in the current CPU's magazine, if any */
+	zassert_equal(k_mem_slab_alloc(&bulk_slab, &extra, K_NO_WAIT), 0,
+		      NULL);
+	k_mem_slab_free(&bulk_slab, &extra);
+
+	/**TESTPOINT: all or nothing*/
+	zassert_equal(k_mem_slab_alloc_n(&bulk_slab, block, BULK_NUM + 1),
+		      -ENOMEM, NULL);
+	zassert_equal(k_mem_slab_num_used_get(&bulk_slab), 0, NULL);
+
+	zassert_equal(k_mem_slab_alloc_n(&bulk_slab, block, BULK_NUM), 0,
+		      NULL);
+	zassert_equal(k_mem_slab_num_used_get(&bulk_slab), BULK_NUM, NULL);
+	zassert_equal(k_mem_slab_num_free_get(&bulk_slab), 0, NULL);
+	for (int i = 0; i < BULK_NUM; i++) {
+		zassert_true((u32_t)block[i] % BLK_ALIGN == 0, NULL);
+		for (int j = 0; j < i; j++) {
+			zassert_not_equal(block[i], block[j], NULL);
+		}
+	}
+	zassert_equal(k_mem_slab_alloc_n(&bulk_slab, &extra, 1), -ENOMEM,
+		      NULL);
+
+	/**TESTPOINT: waiters get the first blocks freed*/
+	k_thread_create(&waiter_thread, waiter_stack,
+			K_THREAD_STACK_SIZEOF(waiter_stack), waiter_entry,
+			NULL, NULL, NULL, K_PRIO_PREEMPT(0), 0, K_NO_WAIT);
+	k_sleep(100);
+
+	k_mem_slab_free_n(&bulk_slab, block, BULK_NUM);
+	k_sleep(100);
+
+	zassert_equal(waiter_ret, 0, NULL);
+	zassert_equal(waiter_block, block[0], NULL);
+	zassert_equal(k_mem_slab_num_used_get(&bulk_slab), 1, NULL);
+
+	k_mem_slab_free(&bulk_slab, &waiter_block);
+	zassert_equal(k_mem_slab_num_used_get(&bulk_slab), 0, NULL);
+	zassert_equal(k_mem_slab_num_free_get(&bulk_slab), BULK_NUM, NULL);
+}
+
+/**
+ * @brief Verify the maximum number of used blocks is tracked
+ *
+ * @ingroup kernel_memory_slab_tests
+ */
+void test_mslab_max_used(void)
+{
+	void *block[BULK_NUM];
+
+	zassert_equal(k_mem_slab_alloc_n(&bulk_slab, block, BULK_NUM - 2), 0,
+		      NULL);
+	k_mem_slab_free_n(&bulk_slab, block, BULK_NUM - 2);
+
+	for (int i = 0; i < 2; i++) {
+		zassert_equal(k_mem_slab_alloc(&bulk_slab, &block[i],
+					       K_NO_WAIT), 0, NULL);
+	}
+	for (int i = 0; i < 2; i++) {
+		k_mem_slab_free(&bulk_slab, &block[i]);
+	}
+
+	/* the first test allocated all the blocks */
+	zassert_equal(k_mem_slab_max_used_get(&bulk_slab), BULK_NUM, NULL);
+}
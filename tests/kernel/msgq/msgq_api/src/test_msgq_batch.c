@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "test_msgq.h"
+
+#define BATCH_LEN 8
+
+K_THREAD_STACK_EXTERN(tstack);
+extern struct k_thread tdata;
+extern struct k_msgq msgq;
+static char __aligned(4) bbuffer[MSG_SIZE * BATCH_LEN];
+static u32_t tx[2 * BATCH_LEN];
+static u32_t rx[2 * BATCH_LEN];
+static u32_t thread_msg;
+static int thread_ret;
+
+static void fill_tx(u32_t first)
+{
+	for (int i = 0; i < ARRAY_SIZE(tx); i++) {
+		tx[i] = first + i;
+	}
+}
+
+static void check_rx(int count, u32_t first)
+{
+	for (int i = 0; i < count; i++) {
+		zassert_equal(rx[i], first + i, "message %d out of order", i);
+	}
+}
+
+static void writer_entry(void *p1, void *p2, void *p3)
+{
+	thread_ret = k_msgq_put_n((struct k_msgq *)p1, &thread_msg, 1,
+				  K_FOREVER);
+}
+
+static void reader_entry(void *p1, void *p2, void *p3)
+{
+	thread_ret = k_msgq_get_n((struct k_msgq *)p1, rx, BATCH_LEN,
+				  K_FOREVER);
+}
+
+/**
+ * @addtogroup kernel_message_queue_tests
+ * @{
+ */
+
+/**
+ * @brief Test sending and receiving several messages at once
+ * @see k_msgq_put_n(), k_msgq_get_n()
+ */
+void test_msgq_put_get_n(void)
+{
+	int ret;
+
+	k_msgq_init(&msgq, bbuffer, MSG_SIZE, BATCH_LEN);
+	fill_tx(0);
+
+	ret = k_msgq_put_n(&msgq, tx, 5, K_NO_WAIT);
+	zassert_equal(ret, 5, NULL);
+	ret = k_msgq_get_n(&msgq, rx, 3, K_NO_WAIT);
+	zassert_equal(ret, 3, NULL);
+	check_rx(3, 0);
+
+	/**TESTPOINT: only the messages that fit are sent, wrapping around*/
+	ret = k_msgq_put_n(&msgq, &tx[5], 10, K_NO_WAIT);
+	zassert_equal(ret, 6, NULL);
+	zassert_equal(k_msgq_num_free_get(&msgq), 0, NULL);
+	ret = k_msgq_put_n(&msgq, &tx[11], 1, K_NO_WAIT);
+	zassert_equal(ret, -ENOMSG, NULL);
+	ret = k_msgq_put_n(&msgq, &tx[11], 1, TIMEOUT);
+	zassert_equal(ret, -EAGAIN, NULL);
+
+	/**TESTPOINT: receive across the end of the ring buffer*/
+	ret = k_msgq_get_n(&msgq, rx, 2 * BATCH_LEN, K_NO_WAIT);
+	zassert_equal(ret, BATCH_LEN, NULL);
+	check_rx(BATCH_LEN, 3);
+
+	ret = k_msgq_get_n(&msgq, rx, 1, K_NO_WAIT);
+	zassert_equal(ret, -ENOMSG, NULL);
+	ret = k_msgq_get_n(&msgq, rx, 1, TIMEOUT);
+	zassert_equal(ret, -EAGAIN, NULL);
+}
+
+/**
+ * @brief Test that batch operations wake up waiting threads
+ * @see k_msgq_put_n(), k_msgq_get_n()
+ */
+void test_msgq_put_get_n_pend(void)
+{
+	int ret;
+
+	k_msgq_init(&msgq, bbuffer, MSG_SIZE, BATCH_LEN);
+	fill_tx(0);
+
+	/**TESTPOINT: a waiting reader gets one message, the rest is queued*/
+	k_thread_create(&tdata, tstack, STACK_SIZE, reader_entry, &msgq,
+			NULL, NULL, K_PRIO_PREEMPT(0), 0, 0);
+	k_sleep(TIMEOUT >> 1);
+	ret = k_msgq_put_n(&msgq, tx, 3, K_NO_WAIT);
+	zassert_equal(ret, 3, NULL);
+	k_sleep(TIMEOUT >> 1);
+	zassert_equal(thread_ret, 1, NULL);
+	zassert_equal(rx[0], 0, NULL);
+	zassert_equal(k_msgq_num_used_get(&msgq), 2, NULL);
+	k_thread_abort(&tdata);
+
+	/**TESTPOINT: a waiting writer is queued behind the received batch*/
+	ret = k_msgq_put_n(&msgq, &tx[3], BATCH_LEN, K_NO_WAIT);
+	zassert_equal(ret, BATCH_LEN - 2, NULL);
+	thread_msg = BATCH_LEN + 1;
+	k_thread_create(&tdata, tstack, STACK_SIZE, writer_entry, &msgq,
+			NULL, NULL, K_PRIO_PREEMPT(0), 0, 0);
+	k_sleep(TIMEOUT >> 1);
+	ret = k_msgq_get_n(&msgq, rx, 4, K_NO_WAIT);
+	zassert_equal(ret, 4, NULL);
+	check_rx(4, 1);
+	k_sleep(TIMEOUT >> 1);
+	zassert_equal(thread_ret, 1, NULL);
+	k_thread_abort(&tdata);
+
+	ret = k_msgq_get_n(&msgq, rx, BATCH_LEN, K_NO_WAIT);
+	zassert_equal(ret, 5, NULL);
+	check_rx(5, 5);
+}
+
+/**
+ * @brief Test receiving messages in place
+ * @see k_msgq_get_claim(), k_msgq_get_finish()
+ */
+void test_msgq_get_claim(void)
+{
+	u32_t *msgs;
+	u32_t count;
+	int ret;
+
+	k_msgq_init(&msgq, bbuffer, MSG_SIZE, BATCH_LEN);
+	fill_tx(0);
+
+	count = k_msgq_get_claim(&msgq, (void **)&msgs, BATCH_LEN);
+	zassert_equal(count, 0, NULL);
+
+	ret = k_msgq_put_n(&msgq, tx, BATCH_LEN, K_NO_WAIT);
+	zassert_equal(ret, BATCH_LEN, NULL);
+	ret = k_msgq_get_n(&msgq, rx, 5, K_NO_WAIT);
+	zassert_equal(ret, 5, NULL);
+	ret = k_msgq_put_n(&msgq, &tx[BATCH_LEN], 5, K_NO_WAIT);
+	zassert_equal(ret, 5, NULL);
+
+	/**TESTPOINT: a claim stops at the end of the ring buffer*/
+	count = k_msgq_get_claim(&msgq, (void **)&msgs, BATCH_LEN);
+	zassert_equal(count, 3, NULL);
+	for (int i = 0; i < count; i++) {
+		zassert_equal(msgs[i], 5 + i, NULL);
+	}
+	zassert_equal(k_msgq_get_finish(&msgq, count), 0, NULL);
+
+	count = k_msgq_get_claim(&msgq, (void **)&msgs, BATCH_LEN);
+	zassert_equal(count, 5, NULL);
+	for (int i = 0; i < count; i++) {
+		zassert_equal(msgs[i], BATCH_LEN + i, NULL);
+	}
+	zassert_equal(k_msgq_get_finish(&msgq, count), 0, NULL);
+
+	/**TESTPOINT: more messages than queued can't be released*/
+	zassert_equal(k_msgq_get_finish(&msgq, 1), -EINVAL, NULL);
+	zassert_equal(k_msgq_num_used_get(&msgq), 0, NULL);
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <ztest.h>
+
+#define STACK_SIZE 512
+#define TIMEOUT 500
+#define SETTLE 50
+
+#define PRIO_LOW K_PRIO_PREEMPT(10)
+#define PRIO_MID K_PRIO_PREEMPT(8)
+#define PRIO_HIGH K_PRIO_PREEMPT(5)
+
+static K_THREAD_STACK_ARRAY_DEFINE(chain_stacks, 3, STACK_SIZE);
+static struct k_thread chain_threads[3];
+
+static struct k_mutex mutex1, mutex2;
+static K_SEM_DEFINE(release_sem, 0, 1);
+
+/* holds mutex1 until released, pended on a semaphore */
+static void low_entry(void *p1, void *p2, void *p3)
+{
+	k_mutex_lock(&mutex1, K_FOREVER);
+	k_sem_take(&release_sem, K_FOREVER);
+	k_mutex_unlock(&mutex1);
+}
+
+/* holds mutex2 while waiting for mutex1 */
+static void mid_entry(void *p1, void *p2, void *p3)
+{
+	k_mutex_lock(&mutex2, K_FOREVER);
+	k_mutex_lock(&mutex1, K_FOREVER);
+	k_mutex_unlock(&mutex1);
+	k_mutex_unlock(&mutex2);
+}
+
+/* gives up waiting for mutex2 */
+static void high_entry(void *p1, void *p2, void *p3)
+{
+	zassert_equal(k_mutex_lock(&mutex2, TIMEOUT), -EAGAIN, NULL);
+}
+
+static void start(int i, k_thread_entry_t entry, int prio)
+{
+	k_thread_create(&chain_threads[i], chain_stacks[i], STACK_SIZE,
+			entry, NULL, NULL, NULL, prio, 0, K_NO_WAIT);
+	k_sleep(SETTLE);
+}
+
+/**
+ * @brief Test priority inheritance through a chain of mutexes
+ *
+ * A low priority thread holds mutex1, a medium one holds mutex2 and waits
+ * for mutex1, and a high priority one waits for mutex2: the low priority
+ * thread must run at the high priority until the high priority thread
+ * gives up, then at the medium one until it unlocks mutex1.
+ *
+ * @see k_mutex_lock(), k_mutex_unlock()
+ */
+void test_mutex_priority_inheritance_chain(void)
+{
+	struct k_thread *low = &chain_threads[0];
+	struct k_thread *mid = &chain_threads[1];
+	int prio = k_thread_priority_get(k_current_get());
+
+	k_thread_priority_set(k_current_get(), K_PRIO_PREEMPT(1));
+	k_mutex_init(&mutex1);
+	k_mutex_init(&mutex2);
+
+	start(0, low_entry, PRIO_LOW);
+	zassert_equal(k_thread_priority_get(low), PRIO_LOW, NULL);
+
+	/**TESTPOINT: the owner inherits the priority of its waiter*/
+	start(1, mid_entry, PRIO_MID);
+	zassert_equal(k_thread_priority_get(low), PRIO_MID, NULL);
+
+	/**TESTPOINT: inheritance goes down the chain*/
+	start(2, high_entry, PRIO_HIGH);
+	zassert_equal(k_thread_priority_get(mid), PRIO_HIGH, NULL);
+	zassert_equal(k_thread_priority_get(low), PRIO_HIGH, NULL);
+
+	/**TESTPOINT: and is undone down the chain on timeout*/
+	k_sleep(TIMEOUT);
+	zassert_equal(k_thread_priority_get(mid), PRIO_MID, NULL);
+	zassert_equal(k_thread_priority_get(low), PRIO_MID, NULL);
+
+	/**TESTPOINT: unlocking restores the original priority*/
+	k_sem_give(&release_sem);
+	k_sleep(SETTLE);
+	zassert_equal(mutex1.lock_count, 0, NULL);
+	zassert_equal(mutex2.lock_count, 0, NULL);
+
+	for (int i = 0; i < 3; i++) {
+		k_thread_abort(&chain_threads[i]);
+	}
+	k_thread_priority_set(k_current_get(), prio);
+}
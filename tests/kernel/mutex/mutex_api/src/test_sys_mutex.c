@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <ztest.h>
+#include <misc/mutex.h>
+
+#define STACK_SIZE 512
+#define TIMEOUT 500
+
+static K_THREAD_STACK_DEFINE(sys_mutex_stack, STACK_SIZE);
+static struct k_thread sys_mutex_thread;
+
+K_SEM_DEFINE(sys_mutex_sem, 0, 1);
+SYS_MUTEX_DEFINE(sys_mutex, &sys_mutex_sem, .data);
+
+static int thread_ret;
+
+static void lock_entry(void *p1, void *p2, void *p3)
+{
+	thread_ret = sys_mutex_lock(&sys_mutex, (s32_t)p1);
+	if (thread_ret == 0) {
+		sys_mutex_unlock(&sys_mutex);
+	}
+}
+
+static void start_locker(s32_t timeout)
+{
+	thread_ret = 1;
+	k_thread_create(&sys_mutex_thread, sys_mutex_stack, STACK_SIZE,
+			lock_entry, (void *)timeout, NULL, NULL,
+			K_PRIO_PREEMPT(0), 0, K_NO_WAIT);
+}
+
+/**
+ * @brief Test locking and unlocking a system mutex
+ * @see sys_mutex_lock(), sys_mutex_unlock()
+ */
+void test_sys_mutex_lock_unlock(void)
+{
+	/**TESTPOINT: uncontended lock and unlock*/
+	zassert_equal(sys_mutex_lock(&sys_mutex, K_NO_WAIT), 0, NULL);
+	zassert_equal(sys_mutex_lock(&sys_mutex, K_NO_WAIT), -EBUSY, NULL);
+	sys_mutex_unlock(&sys_mutex);
+	zassert_equal(sys_mutex_lock(&sys_mutex, K_FOREVER), 0, NULL);
+	sys_mutex_unlock(&sys_mutex);
+
+	/**TESTPOINT: a waiter times out*/
+	zassert_equal(sys_mutex_lock(&sys_mutex, K_FOREVER), 0, NULL);
+	start_locker(TIMEOUT / 2);
+	k_sleep(TIMEOUT);
+	zassert_equal(thread_ret, -EAGAIN, NULL);
+
+	/**TESTPOINT: a waiter gets the mutex when it is unlocked*/
+	start_locker(K_FOREVER);
+	k_sleep(TIMEOUT / 2);
+	zassert_equal(thread_ret, 1, NULL);
+	sys_mutex_unlock(&sys_mutex);
+	k_sleep(TIMEOUT / 2);
+	zassert_equal(thread_ret, 0, NULL);
+
+	/**TESTPOINT: and unlocks it*/
+	zassert_equal(sys_mutex_lock(&sys_mutex, K_NO_WAIT), 0, NULL);
+	sys_mutex_unlock(&sys_mutex);
+	k_thread_abort(&sys_mutex_thread);
+}
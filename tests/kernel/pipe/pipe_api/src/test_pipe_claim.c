@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+
+#define STACK_SIZE	1024
+#define PIPE_LEN	16
+
+K_PIPE_DEFINE(claim_pipe, PIPE_LEN, 4);
+
+extern struct k_thread tdata;
+K_THREAD_STACK_EXTERN(tstack);
+extern struct k_sem end_sema;
+
+static const unsigned char stream[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+
+static void put_claimed(struct k_pipe *ppipe, size_t offset, size_t bytes,
+			size_t expected)
+{
+	size_t claimed;
+	void *space;
+
+	zassert_equal(k_pipe_put_claim(ppipe, &space, bytes, &claimed,
+				       K_NO_WAIT), 0, NULL);
+	zassert_equal(claimed, expected, NULL);
+	memcpy(space, &stream[offset], claimed);
+	k_pipe_put_commit(ppipe, claimed);
+}
+
+static void get_claimed(struct k_pipe *ppipe, size_t offset, size_t bytes,
+			size_t expected)
+{
+	size_t claimed;
+	void *data;
+
+	zassert_equal(k_pipe_get_claim(ppipe, &data, bytes, &claimed,
+				       K_NO_WAIT), 0, NULL);
+	zassert_equal(claimed, expected, NULL);
+	zassert_false(memcmp(data, &stream[offset], claimed), NULL);
+	k_pipe_get_commit(ppipe, claimed);
+}
+
+static void tThread_get_claim(void *p1, void *p2, void *p3)
+{
+	struct k_pipe *ppipe = p1;
+	size_t claimed;
+	void *data;
+
+	zassert_equal(k_pipe_get_claim(ppipe, &data, PIPE_LEN, &claimed,
+				       K_FOREVER), 0, NULL);
+	zassert_equal(claimed, 4, NULL);
+	zassert_false(memcmp(data, stream, claimed), NULL);
+	k_pipe_get_commit(ppipe, claimed);
+
+	k_sem_give(&end_sema);
+}
+
+static void tThread_get(void *p1, void *p2, void *p3)
+{
+	unsigned char rx_data[8];
+	size_t rd_byte;
+
+	zassert_false(k_pipe_get(p1, rx_data, sizeof(rx_data), &rd_byte,
+				 sizeof(rx_data), K_FOREVER), NULL);
+	zassert_equal(rd_byte, sizeof(rx_data), NULL);
+	zassert_false(memcmp(rx_data, stream, sizeof(rx_data)), NULL);
+
+	k_sem_give(&end_sema);
+}
+
+static void tThread_put_claim(void *p1, void *p2, void *p3)
+{
+	size_t claimed;
+	void *space;
+
+	put_claimed(p1, 0, 1, 1);
+
+	/* the pipe is full now: wait for a reader to free space */
+	zassert_equal(k_pipe_put_claim(p1, &space, PIPE_LEN, &claimed,
+				       K_FOREVER), 0, NULL);
+	zassert_equal(claimed, 2, NULL);
+	k_pipe_put_commit(p1, 0);
+
+	k_sem_give(&end_sema);
+}
+
+/**
+ * @addtogroup kernel_pipe_tests
+ * @{
+ */
+
+/**
+ * @brief Test writing and reading a pipe's ring buffer in place
+ * @see k_pipe_put_claim(), k_pipe_put_commit(), k_pipe_get_claim(),
+ * k_pipe_get_commit()
+ */
+void test_pipe_claim_commit(void)
+{
+	unsigned char rx_data[PIPE_LEN];
+	size_t claimed, rd_byte;
+	void *area;
+
+	zassert_equal(k_pipe_put_claim(&claim_pipe, &area, 0, &claimed,
+				       K_NO_WAIT), -EINVAL, NULL);
+	zassert_equal(k_pipe_get_claim(&claim_pipe, &area, PIPE_LEN, &claimed,
+				       K_NO_WAIT), -EIO, NULL);
+
+	/**TESTPOINT: only one write claim at a time*/
+	zassert_equal(k_pipe_put_claim(&claim_pipe, &area, 10, &claimed,
+				       K_NO_WAIT), 0, NULL);
+	zassert_equal(k_pipe_put_claim(&claim_pipe, &area, 10, &claimed,
+				       K_NO_WAIT), -EBUSY, NULL);
+	zassert_equal(k_pipe_put(&claim_pipe, (void *)stream, 1, &rd_byte,
+				 1, K_NO_WAIT), -EBUSY, NULL);
+	zassert_equal(rd_byte, 0, NULL);
+	k_pipe_put_commit(&claim_pipe, 0);
+
+	put_claimed(&claim_pipe, 0, 10, 10);
+
+	/**TESTPOINT: partial commit leaves the rest in the pipe*/
+	zassert_equal(k_pipe_get_claim(&claim_pipe, &area, PIPE_LEN, &claimed,
+				       K_NO_WAIT), 0, NULL);
+	zassert_equal(claimed, 10, NULL);
+	zassert_equal(k_pipe_get_claim(&claim_pipe, &area, PIPE_LEN, &claimed,
+				       K_NO_WAIT), -EBUSY, NULL);
+	zassert_equal(k_pipe_get(&claim_pipe, rx_data, 1, &rd_byte,
+				 1, K_NO_WAIT), -EBUSY, NULL);
+	zassert_equal(rd_byte, 0, NULL);
+	k_pipe_get_commit(&claim_pipe, 6);
+
+	/**TESTPOINT: claims stop at the end of the ring buffer*/
+	put_claimed(&claim_pipe, 10, PIPE_LEN, 6);
+	put_claimed(&claim_pipe, 16, PIPE_LEN, 6);
+	zassert_equal(k_pipe_put_claim(&claim_pipe, &area, PIPE_LEN, &claimed,
+				       K_NO_WAIT), -EIO, NULL);
+
+	get_claimed(&claim_pipe, 6, PIPE_LEN, 10);
+
+	/* claimed data is read by the copy path as well */
+	zassert_false(k_pipe_get(&claim_pipe, rx_data, PIPE_LEN, &rd_byte,
+				 6, K_NO_WAIT), NULL);
+	zassert_equal(rd_byte, 6, NULL);
+	zassert_false(memcmp(rx_data, &stream[16], rd_byte), NULL);
+}
+
+/**
+ * @brief Test waking up claims and copies on the other end of a pipe
+ * @see k_pipe_put_claim(), k_pipe_get_claim(), k_pipe_put(), k_pipe_get()
+ */
+void test_pipe_claim_wait(void)
+{
+	unsigned char rx_data[PIPE_LEN];
+	size_t claimed, wt_byte, rd_byte;
+	void *area;
+
+	/**TESTPOINT: a write wakes up a read claim*/
+	k_thread_create(&tdata, tstack, STACK_SIZE, tThread_get_claim,
+			&claim_pipe, NULL, NULL, K_PRIO_PREEMPT(0), 0, 0);
+	k_sleep(K_MSEC(10));
+
+	/* an empty commit must leave the read claim waiting */
+	zassert_equal(k_pipe_put_claim(&claim_pipe, &area, PIPE_LEN, &claimed,
+				       K_NO_WAIT), 0, NULL);
+	k_pipe_put_commit(&claim_pipe, 0);
+	zassert_equal(k_sem_take(&end_sema, K_MSEC(10)), -EAGAIN, NULL);
+
+	zassert_false(k_pipe_put(&claim_pipe, (void *)stream, 4, &wt_byte, 4,
+				 K_NO_WAIT), NULL);
+	zassert_equal(k_sem_take(&end_sema, K_MSEC(100)), 0, NULL);
+
+	/**TESTPOINT: a write commit completes a waiting read*/
+	k_thread_create(&tdata, tstack, STACK_SIZE, tThread_get,
+			&claim_pipe, NULL, NULL, K_PRIO_PREEMPT(0), 0, 0);
+	k_sleep(K_MSEC(10));
+	put_claimed(&claim_pipe, 0, 6, 6);
+	zassert_equal(k_sem_take(&end_sema, K_MSEC(10)), -EAGAIN, NULL);
+	put_claimed(&claim_pipe, 6, 2, 2);
+	zassert_equal(k_sem_take(&end_sema, K_MSEC(100)), 0, NULL);
+
+	/**TESTPOINT: a read wakes up a write claim*/
+	zassert_false(k_pipe_put(&claim_pipe, (void *)stream, PIPE_LEN - 1,
+				 &wt_byte, PIPE_LEN - 1, K_NO_WAIT), NULL);
+	k_thread_create(&tdata, tstack, STACK_SIZE, tThread_put_claim,
+			&claim_pipe, NULL, NULL, K_PRIO_PREEMPT(0), 0, 0);
+	k_sleep(K_MSEC(10));
+	zassert_false(k_pipe_get(&claim_pipe, rx_data, 2, &rd_byte, 2,
+				 K_NO_WAIT), NULL);
+	zassert_equal(k_sem_take(&end_sema, K_MSEC(100)), 0, NULL);
+
+	zassert_false(k_pipe_get(&claim_pipe, rx_data, PIPE_LEN, &rd_byte,
+				 PIPE_LEN - 2, K_NO_WAIT), NULL);
+	zassert_equal(rd_byte, PIPE_LEN - 2, NULL);
+}
+
+/**
+ * @brief Test scatter-gather writes and reads
+ * @see k_pipe_put_sg(), k_pipe_get_sg()
+ */
+void test_pipe_sg(void)
+{
+	unsigned char rx_a[5], rx_b[9], rx_c[PIPE_LEN];
+	struct k_pipe_vec tx_vec[] = {
+		{ (void *)&stream[0], 3 },
+		{ (void *)&stream[3], 0 },
+		{ (void *)&stream[3], 7 },
+		{ (void *)&stream[10], 4 },
+	};
+	struct k_pipe_vec rx_vec[] = {
+		{ rx_a, sizeof(rx_a) },
+		{ rx_b, sizeof(rx_b) },
+	};
+	size_t wt_byte, rd_byte;
+
+	/* start off the middle of the ring buffer so the data wraps */
+	put_claimed(&claim_pipe, 0, 9, 9);
+	get_claimed(&claim_pipe, 0, 9, 9);
+
+	zassert_false(k_pipe_put_sg(&claim_pipe, tx_vec, ARRAY_SIZE(tx_vec),
+				    &wt_byte, 14, K_NO_WAIT), NULL);
+	zassert_equal(wt_byte, 14, NULL);
+
+	/**TESTPOINT: not enough space for min_xfer*/
+	zassert_equal(k_pipe_put_sg(&claim_pipe, tx_vec, ARRAY_SIZE(tx_vec),
+				    &wt_byte, 3, K_NO_WAIT), -EIO, NULL);
+	zassert_equal(wt_byte, 0, NULL);
+
+	/**TESTPOINT: a short write still writes what fits*/
+	zassert_false(k_pipe_put_sg(&claim_pipe, tx_vec, ARRAY_SIZE(tx_vec),
+				    &wt_byte, 0, K_NO_WAIT), NULL);
+	zassert_equal(wt_byte, 2, NULL);
+
+	zassert_false(k_pipe_get_sg(&claim_pipe, rx_vec, ARRAY_SIZE(rx_vec),
+				    &rd_byte, 14, K_NO_WAIT), NULL);
+	zassert_equal(rd_byte, 14, NULL);
+	zassert_false(memcmp(rx_a, &stream[0], sizeof(rx_a)), NULL);
+	zassert_false(memcmp(rx_b, &stream[5], sizeof(rx_b)), NULL);
+
+	/**TESTPOINT: timeout with fewer than min_xfer bytes*/
+	rx_vec[0].data = rx_c;
+	rx_vec[0].len = sizeof(rx_c);
+	zassert_equal(k_pipe_get_sg(&claim_pipe, rx_vec, 1, &rd_byte, 3,
+				    K_MSEC(10)), -EAGAIN, NULL);
+	zassert_equal(rd_byte, 2, NULL);
+	zassert_false(memcmp(rx_c, &stream[0], rd_byte), NULL);
+}
+
+/**
+ * @}
+ */
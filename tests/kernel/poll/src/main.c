@@ -12,6 +12,9 @@ extern void test_poll_cancel_main_high_prio(void);
 extern void test_poll_multi(void);
 extern void test_poll_threadstate(void);
 extern void test_poll_grant_access(void);
+extern void test_poll_set_level(void);
+extern void test_poll_set_wait(void);
+extern void test_poll_set_two_threads(void);
 
 K_MEM_POOL_DEFINE(test_pool, 128, 128, 4, 4);
 
@@ -28,6 +31,9 @@ void test_main(void)
 			 ztest_unit_test(test_poll_cancel_main_low_prio),
 			 ztest_unit_test(test_poll_cancel_main_high_prio),
 			 ztest_unit_test(test_poll_multi),
-			 ztest_unit_test(test_poll_threadstate));
+			 ztest_unit_test(test_poll_threadstate),
+			 ztest_unit_test(test_poll_set_level),
+			 ztest_unit_test(test_poll_set_wait),
+			 ztest_unit_test(test_poll_set_two_threads));
 	ztest_run_test_suite(poll_api);
 }
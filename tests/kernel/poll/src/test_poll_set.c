@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <kernel.h>
+
+#define STACK_SIZE (512 + CONFIG_TEST_EXTRA_STACKSIZE)
+#define SET_TIMEOUT 100
+
+struct fifo_msg {
+	void *private;
+	u32_t msg;
+};
+
+static struct k_poll_set set;
+static struct k_sem set_sem;
+static struct k_fifo set_fifo;
+static struct k_poll_signal set_signal;
+static struct k_poll_event set_events[3];
+
+static K_THREAD_STACK_DEFINE(set_thread_stack, STACK_SIZE);
+static struct k_thread set_thread;
+
+static void set_init(void)
+{
+	k_poll_set_init(&set);
+	k_sem_init(&set_sem, 0, 1);
+	k_fifo_init(&set_fifo);
+	k_poll_signal_init(&set_signal);
+
+	k_poll_event_init(&set_events[0], K_POLL_TYPE_SEM_AVAILABLE,
+			  K_POLL_MODE_NOTIFY_ONLY, &set_sem);
+	k_poll_event_init(&set_events[1], K_POLL_TYPE_FIFO_DATA_AVAILABLE,
+			  K_POLL_MODE_NOTIFY_ONLY, &set_fifo);
+	k_poll_event_init(&set_events[2], K_POLL_TYPE_SIGNAL,
+			  K_POLL_MODE_NOTIFY_ONLY, &set_signal);
+
+	for (int i = 0; i < ARRAY_SIZE(set_events); i++) {
+		zassert_equal(k_poll_set_add(&set, &set_events[i]), 0, NULL);
+	}
+}
+
+static void set_fini(void)
+{
+	for (int i = 0; i < ARRAY_SIZE(set_events); i++) {
+		zassert_equal(k_poll_set_remove(&set, &set_events[i]), 0,
+			      NULL);
+	}
+}
+
+/**
+ * @brief Test level triggered readiness of poll set events
+ *
+ * @ingroup kernel_poll_tests
+ *
+ * @see k_poll_set_init(), k_poll_set_add(), k_poll_set_remove(),
+ * k_poll_set_wait()
+ */
+void test_poll_set_level(void)
+{
+	struct fifo_msg msg = { NULL, 0 };
+	struct k_poll_event *ready[3];
+
+	set_init();
+
+	/**TESTPOINT: nothing ready*/
+	zassert_equal(k_poll_set_wait(&set, ready, 3, K_NO_WAIT), -EAGAIN,
+		      NULL);
+
+	/**TESTPOINT: an event is returned until its condition is cleared*/
+	k_sem_give(&set_sem);
+	for (int i = 0; i < 2; i++) {
+		zassert_equal(k_poll_set_wait(&set, ready, 3, K_NO_WAIT), 1,
+			      NULL);
+		zassert_equal_ptr(ready[0], &set_events[0], NULL);
+		zassert_equal(ready[0]->state, K_POLL_STATE_SEM_AVAILABLE,
+			      NULL);
+	}
+	zassert_equal(k_sem_take(&set_sem, K_NO_WAIT), 0, NULL);
+	zassert_equal(k_poll_set_wait(&set, ready, 3, K_NO_WAIT), -EAGAIN,
+		      NULL);
+
+	/**TESTPOINT: ready events are returned oldest first*/
+	k_poll_signal_raise(&set_signal, 0);
+	k_fifo_put(&set_fifo, &msg);
+	zassert_equal(k_poll_set_wait(&set, ready, 3, K_NO_WAIT), 2, NULL);
+	zassert_equal_ptr(ready[0], &set_events[2], NULL);
+	zassert_equal_ptr(ready[1], &set_events[1], NULL);
+	zassert_equal(ready[1]->state, K_POLL_STATE_FIFO_DATA_AVAILABLE,
+		      NULL);
+
+	/**TESTPOINT: no more than max_events are returned*/
+	k_sem_give(&set_sem);
+	zassert_equal(k_poll_set_wait(&set, ready, 1, K_NO_WAIT), 1, NULL);
+	zassert_equal(k_poll_set_wait(&set, ready, 3, K_NO_WAIT), 3, NULL);
+
+	k_poll_signal_reset(&set_signal);
+	zassert_equal_ptr(k_fifo_get(&set_fifo, K_NO_WAIT), &msg, NULL);
+	zassert_equal(k_sem_take(&set_sem, K_NO_WAIT), 0, NULL);
+	zassert_equal(k_poll_set_wait(&set, ready, 3, K_NO_WAIT), -EAGAIN,
+		      NULL);
+
+	/**TESTPOINT: an event is only in one set at a time*/
+	zassert_equal(k_poll_set_add(&set, &set_events[0]), -EBUSY, NULL);
+
+	set_fini();
+
+	/**TESTPOINT: removed events are not watched any more*/
+	zassert_equal(k_poll_set_remove(&set, &set_events[0]), -EINVAL, NULL);
+	k_sem_give(&set_sem);
+	zassert_equal(k_poll_set_wait(&set, ready, 3, K_NO_WAIT), -EAGAIN,
+		      NULL);
+}
+
+static void set_giver(void *p1, void *p2, void *p3)
+{
+	k_sleep(SET_TIMEOUT / 2);
+	k_sem_give(&set_sem);
+}
+
+/**
+ * @brief Test waiting on a poll set
+ *
+ * @ingroup kernel_poll_tests
+ *
+ * @see k_poll_set_wait()
+ */
+void test_poll_set_wait(void)
+{
+	struct k_poll_event *ready[3];
+
+	set_init();
+
+	/**TESTPOINT: timeout*/
+	zassert_equal(k_poll_set_wait(&set, ready, 3, SET_TIMEOUT), -EAGAIN,
+		      NULL);
+
+	/**TESTPOINT: woken by an event of the set*/
+	k_thread_create(&set_thread, set_thread_stack, STACK_SIZE,
+			set_giver, NULL, NULL, NULL,
+			K_PRIO_PREEMPT(0), 0, 0);
+	zassert_equal(k_poll_set_wait(&set, ready, 3, K_FOREVER), 1, NULL);
+	zassert_equal_ptr(ready[0], &set_events[0], NULL);
+	zassert_equal(k_sem_take(&set_sem, K_NO_WAIT), 0, NULL);
+
+	set_fini();
+}
+
+static struct k_poll_set other_set;
+static struct k_poll_event other_event;
+static struct k_sem other_done;
+
+static K_THREAD_STACK_DEFINE(other_thread_stack, STACK_SIZE);
+static struct k_thread other_thread;
+
+static void set_other_waiter(void *p1, void *p2, void *p3)
+{
+	struct k_poll_event *ready[1];
+
+	zassert_equal(k_poll_set_wait(&other_set, ready, 1, K_FOREVER), 1,
+		      NULL);
+	zassert_equal_ptr(ready[0], &other_event, NULL);
+	zassert_equal(k_sem_take(&set_sem, K_NO_WAIT), 0, NULL);
+	k_sem_give(&other_done);
+}
+
+/**
+ * @brief Test two threads polling the same object in turn
+ *
+ * @ingroup kernel_poll_tests
+ *
+ * @see k_poll_set_wait()
+ */
+void test_poll_set_two_threads(void)
+{
+	struct fifo_msg msg = { NULL, 0 };
+	struct k_poll_event *ready[3];
+
+	set_init();
+	k_poll_set_init(&other_set);
+	k_sem_init(&other_done, 0, 1);
+	k_poll_event_init(&other_event, K_POLL_TYPE_SEM_AVAILABLE,
+			  K_POLL_MODE_NOTIFY_ONLY, &set_sem);
+
+	/* leaves the semaphore event of the set registered */
+	k_fifo_put(&set_fifo, &msg);
+	zassert_equal(k_poll_set_wait(&set, ready, 3, K_NO_WAIT), 1, NULL);
+	zassert_equal_ptr(ready[0], &set_events[1], NULL);
+	zassert_equal_ptr(k_fifo_get(&set_fifo, K_NO_WAIT), &msg, NULL);
+
+	/**TESTPOINT: an idle set does not keep the signal from another*/
+	zassert_equal(k_poll_set_add(&other_set, &other_event), 0, NULL);
+	k_thread_create(&other_thread, other_thread_stack, STACK_SIZE,
+			set_other_waiter, NULL, NULL, NULL,
+			K_PRIO_PREEMPT(0), 0, 0);
+	k_sleep(SET_TIMEOUT / 2);
+	k_sem_give(&set_sem);
+	zassert_equal(k_sem_take(&other_done, SET_TIMEOUT), 0, NULL);
+
+	/**TESTPOINT: a condition cleared by another thread is not returned*/
+	zassert_equal(k_poll_set_wait(&set, ready, 3, K_NO_WAIT), -EAGAIN,
+		      NULL);
+
+	/**TESTPOINT: the first thread gets its turn again*/
+	k_thread_create(&set_thread, set_thread_stack, STACK_SIZE,
+			set_giver, NULL, NULL, NULL,
+			K_PRIO_PREEMPT(0), 0, 0);
+	zassert_equal(k_poll_set_wait(&set, ready, 3, K_FOREVER), 1, NULL);
+	zassert_equal_ptr(ready[0], &set_events[0], NULL);
+	zassert_equal(k_sem_take(&set_sem, K_NO_WAIT), 0, NULL);
+
+	zassert_equal(k_poll_set_remove(&other_set, &other_event), 0, NULL);
+	set_fini();
+}
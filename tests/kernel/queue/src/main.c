@@ -29,6 +29,7 @@ void test_main(void)
 			 ztest_unit_test(test_queue_thread2isr),
 			 ztest_unit_test(test_queue_isr2thread),
 			 ztest_unit_test(test_queue_get_2threads),
+			 ztest_unit_test(test_queue_isr_append_remove),
 			 ztest_unit_test(test_queue_get_fail),
 			 ztest_unit_test(test_queue_loop),
 			 ztest_unit_test(test_queue_alloc));
@@ -225,6 +225,46 @@ void test_queue_get_2threads(void)
 	tqueue_get_2threads(&queue);
 }
 
+static void tIsr_entry_append_only(void *p)
+{
+	for (int i = 0; i < LIST_LEN; i++) {
+		k_queue_append((struct k_queue *)p, (void *)&data[i]);
+	}
+}
+
+/**
+ * @brief Verify removing items appended by an ISR
+ * @details With CONFIG_QUEUE_LOCKLESS_APPEND, the items are still in the
+ * queue's lock-free inbox when the thread looks for them.
+ * @ingroup kernel_queue_tests
+ * @see k_queue_append(), k_queue_remove(), k_queue_unique_append(),
+ * k_queue_get()
+ */
+void test_queue_isr_append_remove(void)
+{
+	k_queue_init(&queue);
+
+	irq_offload(tIsr_entry_append_only, &queue);
+	/**TESTPOINT: remove an item appended by an ISR*/
+	zassert_true(k_queue_remove(&queue, (void *)&data[1]), NULL);
+	zassert_false(k_queue_remove(&queue, (void *)&data[1]), NULL);
+
+	/**TESTPOINT: unique append finds an item appended by an ISR*/
+	zassert_false(k_queue_unique_append(&queue, (void *)&data[0]), NULL);
+
+	zassert_equal(k_queue_get(&queue, K_NO_WAIT), (void *)&data[0],
+		      NULL);
+	zassert_true(k_queue_is_empty(&queue), NULL);
+
+	/**TESTPOINT: get items appended by an ISR, in order*/
+	irq_offload(tIsr_entry_append_only, &queue);
+	for (int i = 0; i < LIST_LEN; i++) {
+		zassert_equal(k_queue_get(&queue, K_NO_WAIT),
+			      (void *)&data[i], NULL);
+	}
+	zassert_true(k_queue_is_empty(&queue), NULL);
+}
+
 static void tqueue_alloc(struct k_queue *pqueue)
 {
 	/* Alloc append without resource pool */
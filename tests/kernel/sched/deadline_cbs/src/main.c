@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <zephyr.h>
+#include <ztest.h>
+
+#define NUM_PERIODIC 3
+#define NUM_THREADS (NUM_PERIODIC + 1)
+#define STACK_SIZE (512 + CONFIG_TEST_EXTRA_STACKSIZE)
+#define WORKER_PRIO K_PRIO_PREEMPT(1)
+
+/* how long each overload scenario runs, in ms */
+#define RUN_TIME 2000
+
+struct k_thread worker_threads[NUM_THREADS];
+
+K_THREAD_STACK_ARRAY_DEFINE(worker_stacks, NUM_THREADS, STACK_SIZE);
+
+/* Periodic tasks, in ms: 30% of the CPU in total, each reserving
+ * 1.5 times its execution time.  The hog reserves 20% but tries to
+ * use all of it.
+ */
+struct periodic_task {
+	u32_t period;
+	u32_t work;
+	u32_t budget;
+	int jobs;
+	int misses;
+};
+
+static struct periodic_task tasks[NUM_PERIODIC] = {
+	{ .period = 20, .work = 2, .budget = 3 },
+	{ .period = 40, .work = 4, .budget = 6 },
+	{ .period = 50, .work = 5, .budget = 8 },
+};
+
+#define HOG_PERIOD 50
+#define HOG_BUDGET 10
+
+static volatile bool stop;
+static bool use_cbs;
+
+static u32_t ms_to_cycles(u32_t ms)
+{
+	return (u64_t)ms * sys_clock_hw_cycles_per_sec() / MSEC_PER_SEC;
+}
+
+/* Spins for about ms milliseconds, in small steps so that time spent
+ * preempted is mostly not counted as work.
+ */
+static void work(u32_t ms)
+{
+	for (int i = 0; i < ms * 10; i++) {
+		k_busy_wait(100);
+	}
+}
+
+static void periodic(void *p1, void *p2, void *p3)
+{
+	struct periodic_task *t = p1;
+	u32_t release = k_uptime_get_32();
+	u32_t now;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (!stop) {
+		work(t->work);
+		t->jobs++;
+
+		release += t->period;
+		now = k_uptime_get_32();
+		if ((s32_t)(now - release) > 0) {
+			t->misses++;
+			release = now;
+		}
+
+		if (!use_cbs) {
+			/* plain EDF: the next job is due at the end of
+			 * the next period
+			 */
+			k_thread_deadline_set(k_current_get(),
+					      ms_to_cycles(release - now +
+							   t->period));
+		}
+
+		k_sleep(release - now);
+	}
+}
+
+static void hog(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (!stop) {
+		if (!use_cbs) {
+			/* misbehave by claiming an immediate deadline */
+			k_thread_deadline_set(k_current_get(), 1);
+		}
+		k_busy_wait(1000);
+	}
+}
+
+static void create_worker(int i, k_thread_entry_t entry, void *arg)
+{
+	k_thread_create(&worker_threads[i], worker_stacks[i], STACK_SIZE,
+			entry, arg, NULL, NULL, WORKER_PRIO, 0, K_FOREVER);
+}
+
+static int run_overload(bool cbs)
+{
+	int i, ret, misses = 0;
+
+	use_cbs = cbs;
+	stop = false;
+
+	for (i = 0; i < NUM_PERIODIC; i++) {
+		tasks[i].jobs = 0;
+		tasks[i].misses = 0;
+		create_worker(i, periodic, &tasks[i]);
+		if (cbs) {
+			ret = k_thread_cbs_set(&worker_threads[i],
+					       ms_to_cycles(tasks[i].budget),
+					       ms_to_cycles(tasks[i].period));
+			zassert_equal(ret, 0, "task %d not admitted", i);
+		}
+	}
+
+	create_worker(NUM_PERIODIC, hog, NULL);
+	if (cbs) {
+		ret = k_thread_cbs_set(&worker_threads[NUM_PERIODIC],
+				       ms_to_cycles(HOG_BUDGET),
+				       ms_to_cycles(HOG_PERIOD));
+		zassert_equal(ret, 0, "hog not admitted");
+	}
+
+	for (i = 0; i < NUM_THREADS; i++) {
+		k_thread_start(&worker_threads[i]);
+	}
+
+	k_sleep(RUN_TIME);
+	stop = true;
+
+	/* let the workers see the flag and exit */
+	k_sleep(RUN_TIME / 4);
+
+	for (i = 0; i < NUM_PERIODIC; i++) {
+		TC_PRINT("%s: task %d (%u/%u ms): %d jobs, %d missed\n",
+			 cbs ? "CBS" : "EDF", i, tasks[i].work,
+			 tasks[i].period, tasks[i].jobs, tasks[i].misses);
+		misses += tasks[i].misses;
+	}
+
+	return misses;
+}
+
+/**
+ * @brief Test admission control of bandwidth reservations
+ */
+void test_cbs_admission(void)
+{
+	u32_t ms = ms_to_cycles(1);
+	int i;
+
+	for (i = 0; i < 3; i++) {
+		create_worker(i, hog, NULL);
+	}
+
+	zassert_equal(k_thread_cbs_set(&worker_threads[0], 0, 0), -EINVAL, "");
+	zassert_equal(k_thread_cbs_set(&worker_threads[0], 20 * ms, 10 * ms),
+		      -EINVAL, "");
+
+	/* 40% + 40% fit in 90%, another 20% doesn't */
+	zassert_equal(k_thread_cbs_set(&worker_threads[0], 40 * ms, 100 * ms),
+		      0, "");
+	zassert_equal(k_thread_cbs_set(&worker_threads[1], 40 * ms, 100 * ms),
+		      0, "");
+	zassert_equal(k_thread_cbs_set(&worker_threads[2], 20 * ms, 100 * ms),
+		      -EBUSY, "");
+	zassert_equal(k_thread_cbs_set(&worker_threads[2], 5 * ms, 100 * ms),
+		      0, "");
+
+	/* a deadline must leave room for the budget */
+	zassert_equal(k_thread_deadline_set(&worker_threads[2], 0),
+		      -EINVAL, "");
+	zassert_equal(k_thread_deadline_set(&worker_threads[2], 2 * ms),
+		      -EINVAL, "");
+
+	/* a shorter relative deadline needs more bandwidth */
+	zassert_equal(k_thread_deadline_set(&worker_threads[2], 10 * ms),
+		      -EBUSY, "");
+	zassert_equal(k_thread_deadline_set(&worker_threads[2], 60 * ms),
+		      0, "");
+
+	/* releasing a reservation makes room */
+	zassert_equal(k_thread_cbs_set(&worker_threads[0], 0, 100 * ms),
+		      0, "");
+	zassert_equal(k_thread_cbs_set(&worker_threads[2], 20 * ms, 100 * ms),
+		      0, "");
+
+	/* as does aborting the threads */
+	for (i = 0; i < 3; i++) {
+		k_thread_abort(&worker_threads[i]);
+	}
+
+	create_worker(0, hog, NULL);
+	zassert_equal(k_thread_cbs_set(&worker_threads[0], 85 * ms, 100 * ms),
+		      0, "");
+	k_thread_abort(&worker_threads[0]);
+}
+
+/**
+ * @brief Report deadline misses of periodic threads under overload
+ *
+ * A hog thread at the same priority as three periodic threads runs
+ * forever.  With plain deadlines, claiming an early deadline is enough
+ * for it to starve the others, which is reported but not checked.  With
+ * bandwidth reservations, it is confined to its own budget and the
+ * periodic threads must not miss any deadline.
+ */
+void test_cbs_overload(void)
+{
+	int misses;
+
+	misses = run_overload(false);
+	TC_PRINT("EDF without reservations: %d deadlines missed\n", misses);
+
+	misses = run_overload(true);
+	TC_PRINT("EDF with bandwidth servers: %d deadlines missed\n", misses);
+	zassert_equal(misses, 0, "periodic threads missed deadlines");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(deadline_cbs,
+			 ztest_unit_test(test_cbs_admission),
+			 ztest_unit_test(test_cbs_overload));
+	ztest_run_test_suite(deadline_cbs);
+}
@@ -9,6 +9,8 @@ extern void test_stack_thread2thread(void);
 extern void test_stack_thread2isr(void);
 extern void test_stack_pop_fail(void);
 extern void test_stack_alloc_thread2thread(void);
+extern void test_stack_push_pop_n(void);
+extern void test_stack_push_pop_n_isr(void);
 #ifdef CONFIG_USERSPACE
 extern void test_stack_user_thread2thread(void);
 extern void test_stack_user_pop_fail(void);
@@ -51,6 +53,8 @@ void test_main(void)
 			 ztest_unit_test(test_stack_thread2isr),
 			 ztest_unit_test(test_stack_pop_fail),
 			 ztest_user_unit_test(test_stack_user_pop_fail),
-			 ztest_unit_test(test_stack_alloc_thread2thread));
+			 ztest_unit_test(test_stack_alloc_thread2thread),
+			 ztest_unit_test(test_stack_push_pop_n),
+			 ztest_unit_test(test_stack_push_pop_n_isr));
 	ztest_run_test_suite(stack_api);
 }
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <irq_offload.h>
+#define STACK_SIZE 512
+#define BULK_LEN 8
+
+K_STACK_DEFINE(bulk_stack, BULK_LEN);
+
+extern struct k_thread thread_data;
+extern struct k_sem end_sema;
+K_THREAD_STACK_EXTERN(threadstack);
+
+static const u32_t bulk_data[BULK_LEN + 1] = {
+	0x1111, 0x2222, 0x3333, 0x4444, 0x5555, 0x6666, 0x7777, 0x8888,
+	0x9999
+};
+
+static void tstack_push_n(struct k_stack *pstack)
+{
+	/**TESTPOINT: bulk push, with the last value on top*/
+	zassert_equal(k_stack_push_n(pstack, bulk_data, 5), 0, NULL);
+}
+
+static void tstack_pop_n(struct k_stack *pstack)
+{
+	u32_t rx_data[BULK_LEN];
+
+	/**TESTPOINT: bulk pop of fewer values than stacked*/
+	zassert_equal(k_stack_pop_n(pstack, rx_data, 3, K_NO_WAIT), 3, NULL);
+	zassert_equal(rx_data[0], bulk_data[4], NULL);
+	zassert_equal(rx_data[1], bulk_data[3], NULL);
+	zassert_equal(rx_data[2], bulk_data[2], NULL);
+
+	/**TESTPOINT: bulk pop of more values than stacked*/
+	zassert_equal(k_stack_pop_n(pstack, rx_data, BULK_LEN, K_NO_WAIT), 2,
+		      NULL);
+	zassert_equal(rx_data[0], bulk_data[1], NULL);
+	zassert_equal(rx_data[1], bulk_data[0], NULL);
+
+	zassert_equal(k_stack_pop_n(pstack, rx_data, BULK_LEN, K_NO_WAIT),
+		      -EBUSY, NULL);
+}
+
+static void tIsr_entry_push_n(void *p)
+{
+	tstack_push_n((struct k_stack *)p);
+}
+
+static void tIsr_entry_pop_n(void *p)
+{
+	tstack_pop_n((struct k_stack *)p);
+}
+
+static void tThread_entry_pop_n(void *p1, void *p2, void *p3)
+{
+	u32_t rx_data[BULK_LEN];
+
+	/* a waiting pop gets a single value */
+	zassert_equal(k_stack_pop_n(p1, rx_data, BULK_LEN, K_FOREVER), 1,
+		      NULL);
+	zassert_equal(rx_data[0], bulk_data[0], NULL);
+	k_sem_give(&end_sema);
+}
+
+/**
+ * @addtogroup kernel_stack_tests
+ * @{
+ */
+
+/**
+ * @brief Test pushing and popping several values at once
+ * @see k_stack_push_n(), k_stack_pop_n()
+ */
+void test_stack_push_pop_n(void)
+{
+	u32_t rx_data[BULK_LEN];
+
+	tstack_push_n(&bulk_stack);
+	tstack_pop_n(&bulk_stack);
+
+	/**TESTPOINT: bulk push that does not fit pushes nothing*/
+	tstack_push_n(&bulk_stack);
+	zassert_equal(k_stack_push_n(&bulk_stack, bulk_data, 4), -ENOMEM,
+		      NULL);
+	tstack_pop_n(&bulk_stack);
+
+	/**TESTPOINT: bulk push hands values to waiting threads first*/
+	k_sem_init(&end_sema, 0, 1);
+	k_tid_t tid = k_thread_create(&thread_data, threadstack, STACK_SIZE,
+				      tThread_entry_pop_n, &bulk_stack,
+				      NULL, NULL, K_PRIO_PREEMPT(0), 0, 0);
+	k_sleep(K_MSEC(10));
+	zassert_equal(k_stack_push_n(&bulk_stack, bulk_data, 3), 0, NULL);
+	zassert_equal(k_sem_take(&end_sema, K_MSEC(100)), 0, NULL);
+
+	zassert_equal(k_stack_pop_n(&bulk_stack, rx_data, BULK_LEN,
+				    K_NO_WAIT), 2, NULL);
+	zassert_equal(rx_data[0], bulk_data[2], NULL);
+	zassert_equal(rx_data[1], bulk_data[1], NULL);
+
+	/**TESTPOINT: waiting bulk pop times out*/
+	zassert_equal(k_stack_pop_n(&bulk_stack, rx_data, BULK_LEN,
+				    K_MSEC(10)), -EAGAIN, NULL);
+
+	k_thread_abort(tid);
+
+	/**TESTPOINT: values for waiting threads need no room on the stack*/
+	tid = k_thread_create(&thread_data, threadstack, STACK_SIZE,
+			      tThread_entry_pop_n, &bulk_stack,
+			      NULL, NULL, K_PRIO_PREEMPT(0), 0, 0);
+	k_sleep(K_MSEC(10));
+	zassert_equal(k_stack_push_n(&bulk_stack, bulk_data, BULK_LEN + 1), 0,
+		      NULL);
+	zassert_equal(k_sem_take(&end_sema, K_MSEC(100)), 0, NULL);
+
+	zassert_equal(k_stack_pop_n(&bulk_stack, rx_data, BULK_LEN,
+				    K_NO_WAIT), BULK_LEN, NULL);
+	for (int i = 0; i < BULK_LEN; i++) {
+		zassert_equal(rx_data[i], bulk_data[BULK_LEN - i], NULL);
+	}
+
+	k_thread_abort(tid);
+}
+
+/**
+ * @brief Test pushing and popping several values at once from an ISR
+ * @see k_stack_push_n(), k_stack_pop_n()
+ */
+void test_stack_push_pop_n_isr(void)
+{
+	irq_offload(tIsr_entry_push_n, &bulk_stack);
+	tstack_pop_n(&bulk_stack);
+
+	tstack_push_n(&bulk_stack);
+	irq_offload(tIsr_entry_pop_n, &bulk_stack);
+}
+
+/**
+ * @}
+ */
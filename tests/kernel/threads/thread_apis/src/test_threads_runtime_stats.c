@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+
+#define STACK_SIZE (384 + CONFIG_TEST_EXTRA_STACKSIZE)
+K_THREAD_STACK_EXTERN(tstack);
+extern struct k_thread tdata;
+
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+static K_THREAD_STACK_DEFINE(tstack_stats, STACK_SIZE);
+__kernel static struct k_thread tdata_stats;
+
+static u64_t ms_to_cycles(u32_t ms)
+{
+	return (u64_t)ms * sys_clock_hw_cycles_per_sec() / MSEC_PER_SEC;
+}
+
+static void busy_entry(void *p1, void *p2, void *p3)
+{
+	k_busy_wait((u32_t)p1 * USEC_PER_MSEC);
+}
+
+static void sleepy_entry(void *p1, void *p2, void *p3)
+{
+	k_sleep((u32_t)p1);
+}
+
+/**
+ * @ingroup kernel_thread_tests
+ * @brief Test thread runtime statistics
+ *
+ * @see k_thread_runtime_stats_get(), k_cpu_idle_stats_get()
+ */
+void test_threads_runtime_stats(void)
+{
+	struct k_thread_runtime_stats before, after, idle_before, idle_after;
+	int prio = k_thread_priority_get(k_current_get());
+
+	/**TESTPOINT: the running thread's own time is up to date */
+	k_thread_runtime_stats_get(k_current_get(), &before);
+	k_busy_wait(10 * USEC_PER_MSEC);
+	k_thread_runtime_stats_get(k_current_get(), &after);
+	zassert_true(after.execution_cycles - before.execution_cycles >=
+		     ms_to_cycles(10), NULL);
+
+	/**TESTPOINT: a lower priority thread runs while we sleep, the CPU
+	 * is idle once it is done
+	 */
+	k_thread_create(&tdata, tstack, STACK_SIZE, busy_entry,
+			(void *)10, NULL, NULL, prio + 1, 0, K_NO_WAIT);
+	k_cpu_idle_stats_get(0, &idle_before);
+	k_sleep(50);
+	k_cpu_idle_stats_get(0, &idle_after);
+	k_thread_runtime_stats_get(&tdata, &after);
+	zassert_true(after.execution_cycles >= ms_to_cycles(10), NULL);
+	zassert_true(after.switches >= 1, NULL);
+	zassert_true(idle_after.execution_cycles - idle_before.execution_cycles
+		     >= ms_to_cycles(20), NULL);
+	zassert_true(idle_after.switches > idle_before.switches, NULL);
+
+	/**TESTPOINT: a thread woken up preempts a busy lower priority one */
+	k_thread_create(&tdata, tstack, STACK_SIZE, busy_entry,
+			(void *)20, NULL, NULL, prio + 2, 0, K_NO_WAIT);
+	k_thread_create(&tdata_stats, tstack_stats, STACK_SIZE, sleepy_entry,
+			(void *)5, NULL, NULL, prio + 1, 0, K_NO_WAIT);
+	k_sleep(50);
+	k_thread_runtime_stats_get(&tdata, &after);
+	zassert_true(after.preemptions >= 1, NULL);
+	k_thread_runtime_stats_get(&tdata_stats, &after);
+	zassert_equal(after.preemptions, 0, NULL);
+	zassert_true(after.switches >= 2, NULL);
+
+	/**TESTPOINT: yielding to a thread of the same priority is not a
+	 * preemption
+	 */
+	k_thread_create(&tdata, tstack, STACK_SIZE, busy_entry,
+			(void *)1, NULL, NULL, prio, 0, K_NO_WAIT);
+	k_thread_runtime_stats_get(k_current_get(), &before);
+	k_yield();
+	k_thread_runtime_stats_get(k_current_get(), &after);
+	zassert_equal(after.yields, before.yields + 1, NULL);
+	zassert_equal(after.preemptions, before.preemptions, NULL);
+
+	zassert_equal(k_cpu_idle_stats_get(CONFIG_MP_NUM_CPUS, &after),
+		      -EINVAL, NULL);
+}
+#else
+void test_threads_runtime_stats(void)
+{
+	ztest_test_skip();
+}
+#endif
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <irq_offload.h>
+
+#define STACK_SIZE (512 + CONFIG_TEST_EXTRA_STACKSIZE)
+#define TIMEOUT 500
+#define NUM_ITEMS 8
+
+K_WORK_POOL_DEFINE(pool, 2, STACK_SIZE);
+K_WORK_POOL_DEFINE(single_pool, 1, STACK_SIZE);
+
+static struct k_pool_work blocker, items[NUM_ITEMS];
+static struct k_work_domain domain;
+
+static K_SEM_DEFINE(block_sem, 0, 1);
+static K_SEM_DEFINE(done_sem, 0, NUM_ITEMS + 1);
+
+static int order[NUM_ITEMS];
+static atomic_t num_done;
+static atomic_t running;
+static bool overlapped;
+
+static void blocker_handler(struct k_pool_work *work)
+{
+	k_sem_take(&block_sem, K_FOREVER);
+	k_sem_give(&done_sem);
+}
+
+static void item_handler(struct k_pool_work *work)
+{
+	order[atomic_inc(&num_done)] = work - items;
+	k_sem_give(&done_sem);
+}
+
+static void domain_handler(struct k_pool_work *work)
+{
+	if (atomic_inc(&running) != 0) {
+		overlapped = true;
+	}
+	k_sleep(10);
+	atomic_dec(&running);
+
+	item_handler(work);
+}
+
+static void reset(void)
+{
+	(void)memset(order, 0, sizeof(order));
+	atomic_clear(&num_done);
+	k_sem_reset(&done_sem);
+}
+
+static void wait_done(int n)
+{
+	for (int i = 0; i < n; i++) {
+		zassert_equal(k_sem_take(&done_sem, TIMEOUT), 0, NULL);
+	}
+}
+
+/**
+ * @brief A blocking handler only holds up its own worker thread
+ *
+ * @ingroup kernel_workqueue_tests
+ */
+void test_work_pool_blocking(void)
+{
+	reset();
+	k_pool_work_init(&blocker, blocker_handler, 0, NULL);
+	k_pool_work_init(&items[0], item_handler, 0, NULL);
+
+	k_work_pool_submit(&pool, &blocker);
+	k_work_pool_submit(&pool, &items[0]);
+
+	/**TESTPOINT: the other worker runs the second item*/
+	zassert_equal(k_sem_take(&done_sem, TIMEOUT), 0, NULL);
+	zassert_equal(atomic_get(&num_done), 1, NULL);
+	zassert_false(k_pool_work_pending(&items[0]), NULL);
+
+	k_sem_give(&block_sem);
+	wait_done(1);
+}
+
+/**
+ * @brief Items are picked up by priority, then in submission order
+ *
+ * @ingroup kernel_workqueue_tests
+ */
+void test_work_pool_priority(void)
+{
+	static const int prios[NUM_ITEMS] = { 3, 3, 0, 2, 0, 3, 1, 2 };
+	static const int expected[NUM_ITEMS] = { 2, 4, 6, 3, 7, 0, 1, 5 };
+
+	reset();
+	k_pool_work_init(&blocker, blocker_handler, 0, NULL);
+	k_work_pool_submit(&single_pool, &blocker);
+	k_sleep(10);
+
+	for (int i = 0; i < NUM_ITEMS; i++) {
+		k_pool_work_init(&items[i], item_handler, prios[i], NULL);
+		k_work_pool_submit(&single_pool, &items[i]);
+		zassert_true(k_pool_work_pending(&items[i]), NULL);
+	}
+	/**TESTPOINT: submitting a pending item has no effect*/
+	k_work_pool_submit(&single_pool, &items[0]);
+
+	k_sem_give(&block_sem);
+	wait_done(NUM_ITEMS + 1);
+
+	for (int i = 0; i < NUM_ITEMS; i++) {
+		zassert_equal(order[i], expected[i], "item %d ran at %d",
+			      order[i], i);
+	}
+}
+
+/**
+ * @brief Items of a domain run one at a time, in submission order
+ *
+ * @ingroup kernel_workqueue_tests
+ */
+void test_work_pool_domain(void)
+{
+	reset();
+	overlapped = false;
+	k_work_domain_init(&domain);
+
+	/* priorities don't reorder items of a domain */
+	for (int i = 0; i < NUM_ITEMS; i++) {
+		int prio = NUM_ITEMS - 1 - i;
+
+		k_pool_work_init(&items[i], domain_handler,
+				 prio < CONFIG_WORK_POOL_PRIORITIES ? prio : 0,
+				 &domain);
+		k_work_pool_submit(&pool, &items[i]);
+	}
+
+	wait_done(NUM_ITEMS);
+	k_sleep(10);
+
+	zassert_false(overlapped, "items of a domain ran concurrently");
+	for (int i = 0; i < NUM_ITEMS; i++) {
+		zassert_equal(order[i], i, NULL);
+	}
+	zassert_false(domain.busy, NULL);
+}
+
+static void submit_isr(void *arg)
+{
+	k_work_pool_submit(&pool, arg);
+}
+
+/**
+ * @brief Items can be submitted from an ISR
+ *
+ * @ingroup kernel_workqueue_tests
+ */
+void test_work_pool_isr(void)
+{
+	reset();
+	k_pool_work_init(&items[0], item_handler, 1, NULL);
+
+	irq_offload(submit_isr, &items[0]);
+
+	wait_done(1);
+}
+
+/**
+ * @brief Queue depth and latency statistics
+ *
+ * @ingroup kernel_workqueue_tests
+ */
+void test_work_pool_stats(void)
+{
+	struct k_work_pool_stats stats;
+
+	reset();
+	k_work_pool_stats_reset(&single_pool);
+
+	k_pool_work_init(&blocker, blocker_handler, 0, NULL);
+	k_work_pool_submit(&single_pool, &blocker);
+	k_sleep(10);
+	for (int i = 0; i < 4; i++) {
+		k_pool_work_init(&items[i], item_handler, 0, NULL);
+		k_work_pool_submit(&single_pool, &items[i]);
+	}
+
+	k_work_pool_stats_get(&single_pool, &stats);
+	zassert_equal(stats.queued, 4, NULL);
+	zassert_equal(stats.max_queued, 4, NULL);
+	zassert_equal(stats.completed, 0, NULL);
+
+	k_sem_give(&block_sem);
+	wait_done(5);
+	k_sleep(10);
+
+	k_work_pool_stats_get(&single_pool, &stats);
+	zassert_equal(stats.queued, 0, NULL);
+	zassert_equal(stats.max_queued, 4, NULL);
+	zassert_equal(stats.completed, 5, NULL);
+	zassert_true(stats.max_wait_cycles <= stats.total_wait_cycles, NULL);
+	zassert_true(stats.max_run_cycles <= stats.total_run_cycles, NULL);
+}
+
+void test_main(void)
+{
+	k_work_pool_start(&pool, K_PRIO_PREEMPT(1), 0);
+	k_work_pool_start(&single_pool, K_PRIO_PREEMPT(1), 0);
+
+	ztest_test_suite(work_pool,
+			 ztest_unit_test(test_work_pool_blocking),
+			 ztest_unit_test(test_work_pool_priority),
+			 ztest_unit_test(test_work_pool_domain),
+			 ztest_unit_test(test_work_pool_isr),
+			 ztest_unit_test(test_work_pool_stats));
+	ztest_run_test_suite(work_pool);
+}
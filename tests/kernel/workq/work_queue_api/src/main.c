@@ -25,6 +25,9 @@ static struct k_work work[NUM_OF_WORK];
 static struct k_delayed_work new_work;
 static struct k_delayed_work delayed_work[NUM_OF_WORK], delayed_work_sleepy;
 static struct k_sem sync_sema;
+static struct k_delayed_work order_work[3];
+static int order[ARRAY_SIZE(order_work)], order_count;
+K_SEM_DEFINE(order_sema, 0, ARRAY_SIZE(order_work));
 
 static void work_sleepy(struct k_work *w)
 {
@@ -42,6 +45,13 @@ static void new_work_handler(struct k_work *w)
 	k_sem_give(&sync_sema);
 }
 
+static void order_handler(struct k_work *w)
+{
+	order[order_count++] = CONTAINER_OF(w, struct k_delayed_work, work) -
+			       order_work;
+	k_sem_give(&order_sema);
+}
+
 static void twork_submit(void *data)
 {
 	struct k_work_q *work_q = (struct k_work_q *)data;
@@ -441,6 +451,46 @@ void test_delayed_work_cancel_isr(void)
 	}
 }
 
+/**
+ * @brief Test delayed work resubmission while counting down
+ *
+ * @ingroup kernel_workqueue_tests
+ *
+ * @see k_delayed_work_submit_to_queue(), k_delayed_work_remaining_get()
+ */
+void test_delayed_work_reschedule(void)
+{
+	int i;
+
+	order_count = 0;
+	for (i = 0; i < ARRAY_SIZE(order_work); i++) {
+		k_delayed_work_init(&order_work[i], order_handler);
+		zassert_equal(k_delayed_work_submit_to_queue(&workq,
+							     &order_work[i],
+							     TIMEOUT * (i + 1)),
+			      0, NULL);
+	}
+
+	/**TESTPOINT: push the first item past the last one*/
+	zassert_equal(k_delayed_work_submit_to_queue(&workq, &order_work[0],
+						     TIMEOUT * 4), 0, NULL);
+	zassert_true(k_delayed_work_remaining_get(&order_work[0]) >=
+		     TIMEOUT * 4, NULL);
+
+	/**TESTPOINT: pull the last item before the second one*/
+	zassert_equal(k_delayed_work_submit_to_queue(&workq, &order_work[2],
+						     TIMEOUT / 2), 0, NULL);
+	zassert_true(k_delayed_work_remaining_get(&order_work[2]) < TIMEOUT,
+		     NULL);
+
+	for (i = 0; i < ARRAY_SIZE(order_work); i++) {
+		k_sem_take(&order_sema, K_FOREVER);
+	}
+
+	zassert_equal(order[0], 2, NULL);
+	zassert_equal(order[1], 1, NULL);
+	zassert_equal(order[2], 0, NULL);
+}
 
 void test_main(void)
 {
@@ -459,6 +509,7 @@ void test_main(void)
 			 ztest_unit_test(test_delayed_work_cancel_from_queue_thread),
 			 ztest_unit_test(test_delayed_work_cancel_from_queue_isr),
 			 ztest_unit_test(test_delayed_work_cancel_thread),
-			 ztest_unit_test(test_delayed_work_cancel_isr));
+			 ztest_unit_test(test_delayed_work_cancel_isr),
+			 ztest_unit_test(test_delayed_work_reschedule));
 	ztest_run_test_suite(workqueue_api);
 }
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2018 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <zephyr.h>
+#include <ztest.h>
+#include <misc/heap.h>
+#include <string.h>
+
+#define HEAP_SIZE 4096
+#define NUM_BLOCKS 64
+#define NUM_OPS 4000
+
+#define POOL_BLOCKS 5
+#define POOL_BLOCK_SIZE 100
+
+static char __aligned(8) heap_mem[HEAP_SIZE];
+static struct sys_heap heap;
+
+static char __aligned(8) fit_mem[SYS_HEAP_BUF_SIZE(POOL_BLOCKS,
+						   POOL_BLOCK_SIZE)];
+
+static void *blocks[NUM_BLOCKS];
+static size_t sizes[NUM_BLOCKS];
+
+K_MEM_POOL_DEFINE(test_pool, 16, POOL_BLOCK_SIZE, POOL_BLOCKS, 4);
+
+static u32_t rand_state = 1;
+
+static u32_t rand_u32(void)
+{
+	/* Numerical Recipes LCG, good enough for picking operations */
+	rand_state = rand_state * 1664525 + 1013904223;
+	return rand_state >> 8;
+}
+
+static void fill(int i)
+{
+	(void)memset(blocks[i], i, sizes[i]);
+}
+
+static bool check(int i, size_t len)
+{
+	for (size_t k = 0; k < len; k++) {
+		if (((u8_t *)blocks[i])[k] != (u8_t)i) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Test a heap under random allocations, frees and reallocations
+ *
+ * Checks that blocks never overlap, by filling each with its own
+ * pattern, and that the heap stays consistent.
+ *
+ * @see sys_heap_alloc(), sys_heap_free(), sys_heap_realloc()
+ */
+void test_heap_random(void)
+{
+	struct sys_heap_stats stats;
+	void *p;
+	int i;
+
+	sys_heap_init(&heap, heap_mem, sizeof(heap_mem));
+	sys_heap_stats_get(&heap, &stats);
+	zassert_equal(stats.allocated_bytes, 0, NULL);
+
+	for (int op = 0; op < NUM_OPS; op++) {
+		size_t size = rand_u32() % (op & 1 ? 32 : 512);
+
+		i = rand_u32() % NUM_BLOCKS;
+
+		if (blocks[i] == NULL) {
+			blocks[i] = sys_heap_alloc(&heap, size);
+			sizes[i] = size;
+			if (blocks[i] != NULL) {
+				zassert_true(((uintptr_t)blocks[i] & 7) == 0,
+					     NULL);
+				zassert_true(sys_heap_usable_size(&heap,
+								  blocks[i])
+					     >= size, NULL);
+				fill(i);
+			}
+		} else if (rand_u32() & 1) {
+			zassert_true(check(i, sizes[i]), "block %d trashed", i);
+			sys_heap_free(&heap, blocks[i]);
+			blocks[i] = NULL;
+		} else if (size > 0) {
+			p = sys_heap_realloc(&heap, blocks[i], size);
+			if (p != NULL) {
+				blocks[i] = p;
+				zassert_true(check(i, min(size, sizes[i])),
+					     "block %d not kept", i);
+				sizes[i] = size;
+				fill(i);
+			}
+		}
+
+		zassert_true(sys_heap_validate(&heap), "heap corrupted");
+	}
+
+	for (i = 0; i < NUM_BLOCKS; i++) {
+		sys_heap_free(&heap, blocks[i]);
+		blocks[i] = NULL;
+	}
+
+	/**TESTPOINT: everything is merged back*/
+	sys_heap_stats_get(&heap, &stats);
+	zassert_equal(stats.allocated_bytes, 0, NULL);
+	zassert_true(stats.max_allocated_bytes > 0, NULL);
+	zassert_equal(stats.largest_free_bytes + 8, stats.free_bytes, NULL);
+	zassert_true(sys_heap_validate(&heap), "heap corrupted");
+}
+
+/**
+ * @brief Test that blocks are resized in place when possible
+ * @see sys_heap_realloc()
+ */
+void test_heap_realloc_in_place(void)
+{
+	void *a, *b, *p;
+
+	sys_heap_init(&heap, heap_mem, sizeof(heap_mem));
+
+	a = sys_heap_alloc(&heap, 64);
+	b = sys_heap_alloc(&heap, 64);
+	zassert_not_null(a, NULL);
+	zassert_not_null(b, NULL);
+
+	/**TESTPOINT: shrinking never moves*/
+	zassert_equal(sys_heap_realloc(&heap, a, 16), a, NULL);
+
+	/**TESTPOINT: growing into the space just freed doesn't either*/
+	zassert_equal(sys_heap_realloc(&heap, a, 64), a, NULL);
+
+	/**TESTPOINT: the last block grows into the free space after it*/
+	zassert_equal(sys_heap_realloc(&heap, b, 1024), b, NULL);
+
+	/**TESTPOINT: a block with no room after it moves*/
+	p = sys_heap_realloc(&heap, a, 128);
+	zassert_not_null(p, NULL);
+	zassert_not_equal(p, a, NULL);
+
+	/**TESTPOINT: failing leaves the block alone*/
+	zassert_is_null(sys_heap_realloc(&heap, p, HEAP_SIZE), NULL);
+
+	sys_heap_free(&heap, p);
+	sys_heap_free(&heap, b);
+	zassert_true(sys_heap_validate(&heap), "heap corrupted");
+}
+
+/**
+ * @brief Test the buffer size needed for a number of blocks
+ * @see SYS_HEAP_BUF_SIZE()
+ */
+void test_heap_buf_size(void)
+{
+	int i;
+
+	sys_heap_init(&heap, fit_mem, sizeof(fit_mem));
+
+	for (i = 0; i < POOL_BLOCKS; i++) {
+		blocks[i] = sys_heap_alloc(&heap, POOL_BLOCK_SIZE);
+		zassert_not_null(blocks[i], "block %d didn't fit", i);
+	}
+
+	for (i = 0; i < POOL_BLOCKS; i++) {
+		sys_heap_free(&heap, blocks[i]);
+		blocks[i] = NULL;
+	}
+}
+
+/**
+ * @brief Test memory pools, built on a heap or not
+ * @see k_mem_pool_alloc(), k_mem_pool_free()
+ */
+void test_heap_mem_pool(void)
+{
+	struct k_mem_block block[POOL_BLOCKS + 1];
+	int i, ret;
+
+	for (i = 0; i < POOL_BLOCKS; i++) {
+		zassert_equal(k_mem_pool_alloc(&test_pool, &block[i],
+					       POOL_BLOCK_SIZE, K_NO_WAIT),
+			      0, "block %d didn't fit", i);
+	}
+	zassert_equal(k_mem_pool_alloc(&test_pool, &block[i],
+				       POOL_BLOCK_SIZE, K_NO_WAIT),
+		      -ENOMEM, NULL);
+
+	for (i = 0; i < POOL_BLOCKS; i++) {
+		k_mem_pool_free(&block[i]);
+	}
+
+	/**TESTPOINT: freeing by id gives the block back*/
+	zassert_equal(k_mem_pool_alloc(&test_pool, &block[0],
+				       POOL_BLOCKS * POOL_BLOCK_SIZE / 2,
+				       K_NO_WAIT),
+		      IS_ENABLED(CONFIG_MEM_POOL_HEAP_BACKEND) ? 0 : -ENOMEM,
+		      NULL);
+	if (IS_ENABLED(CONFIG_MEM_POOL_HEAP_BACKEND)) {
+		k_mem_pool_free_id(&block[0].id);
+		ret = k_mem_pool_alloc(&test_pool, &block[0],
+				       POOL_BLOCKS * POOL_BLOCK_SIZE / 2,
+				       K_NO_WAIT);
+		zassert_equal(ret, 0, NULL);
+		k_mem_pool_free(&block[0]);
+	}
+}
+
+void test_main(void)
+{
+	ztest_test_suite(heap,
+			 ztest_unit_test(test_heap_random),
+			 ztest_unit_test(test_heap_realloc_in_place),
+			 ztest_unit_test(test_heap_buf_size),
+			 ztest_unit_test(test_heap_mem_pool));
+	ztest_run_test_suite(heap);
+}
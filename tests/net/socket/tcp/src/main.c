@@ -393,6 +393,72 @@ void test_v6_sendto_recvfrom_null_dest(void)
 	k_sleep(TCP_TEARDOWN_TIMEOUT);
 }
 
+void test_v4_sendmsg_recvmsg(void)
+{
+	/* Test if sendmsg() and recvmsg() gather and scatter the data
+	 * of a ipv4 stream socket.
+	 */
+	int c_sock;
+	int s_sock;
+	int new_sock;
+	struct sockaddr_in c_saddr;
+	struct sockaddr_in s_saddr;
+	struct sockaddr addr;
+	socklen_t addrlen = sizeof(addr);
+	char rx_head[1];
+	char rx_tail[29];
+	struct iovec tx_iov[] = {
+		{ .iov_base = TEST_STR_SMALL, .iov_len = 2 },
+		{ .iov_base = TEST_STR_SMALL + 2,
+		  .iov_len = strlen(TEST_STR_SMALL) - 2 },
+	};
+	struct iovec rx_iov[] = {
+		{ .iov_base = rx_head, .iov_len = sizeof(rx_head) },
+		{ .iov_base = rx_tail, .iov_len = sizeof(rx_tail) },
+	};
+	struct msghdr msg = {
+		.msg_iov = tx_iov,
+		.msg_iovlen = ARRAY_SIZE(tx_iov),
+	};
+
+	prepare_sock_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+			ANY_PORT,
+			&c_sock,
+			&c_saddr);
+
+	prepare_sock_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+			SERVER_PORT,
+			&s_sock,
+			&s_saddr);
+
+	test_bind(s_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_listen(s_sock);
+
+	test_connect(c_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	zassert_equal(sendmsg(c_sock, &msg, 0), strlen(TEST_STR_SMALL),
+		      "sendmsg failed");
+
+	test_accept(s_sock, &new_sock, &addr, &addrlen);
+	zassert_equal(addrlen, sizeof(struct sockaddr_in), "wrong addrlen");
+
+	msg.msg_iov = rx_iov;
+	msg.msg_iovlen = ARRAY_SIZE(rx_iov);
+	zassert_equal(recvmsg(new_sock, &msg, 0), strlen(TEST_STR_SMALL),
+		      "unexpected received bytes");
+	zassert_equal(rx_head[0], TEST_STR_SMALL[0], "unexpected data");
+	zassert_equal(strncmp(rx_tail, TEST_STR_SMALL + 1,
+			      strlen(TEST_STR_SMALL) - 1),
+		      0,
+		      "unexpected data");
+	zassert_equal(msg.msg_flags, 0, "unexpected flags");
+
+	test_close(new_sock);
+	test_close(c_sock);
+	test_close(s_sock);
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
 void test_main(void)
 {
 	ztest_test_suite(socket_tcp,
@@ -401,7 +467,8 @@ void test_main(void)
 			 ztest_user_unit_test(test_v4_sendto_recvfrom),
 			 ztest_user_unit_test(test_v6_sendto_recvfrom),
 			 ztest_user_unit_test(test_v4_sendto_recvfrom_null_dest),
-			 ztest_user_unit_test(test_v6_sendto_recvfrom_null_dest));
+			 ztest_user_unit_test(test_v6_sendto_recvfrom_null_dest),
+			 ztest_user_unit_test(test_v4_sendmsg_recvmsg));
 
 	ztest_run_test_suite(socket_tcp);
 }
@@ -11,6 +11,7 @@
 #include <ztest_assert.h>
 
 #include <net/socket.h>
+#include <net/net_pkt.h>
 
 #define BUF_AND_SIZE(buf) buf, sizeof(buf) - 1
 #define STRLEN(buf) (sizeof(buf) - 1)
@@ -325,6 +326,220 @@ void test_send_recv_2_sock(void)
 	zassert_equal(rv, 0, "close failed");
 }
 
+void test_v4_sendmsg_recvmsg(void)
+{
+	int rv;
+	int client_sock;
+	int server_sock;
+	struct sockaddr_in client_addr;
+	struct sockaddr_in server_addr;
+	struct sockaddr_in addr;
+	char rx_head[1];
+	char rx_tail[2];
+	struct iovec tx_iov[] = {
+		{ .iov_base = TEST_STR_SMALL, .iov_len = 1 },
+		{ .iov_base = TEST_STR_SMALL + 1,
+		  .iov_len = STRLEN(TEST_STR_SMALL) - 1 },
+	};
+	struct iovec rx_iov[] = {
+		{ .iov_base = rx_head, .iov_len = sizeof(rx_head) },
+		{ .iov_base = rx_tail, .iov_len = sizeof(rx_tail) },
+	};
+	struct msghdr msg = {
+		.msg_name = &server_addr,
+		.msg_namelen = sizeof(server_addr),
+		.msg_iov = tx_iov,
+		.msg_iovlen = ARRAY_SIZE(tx_iov),
+	};
+
+	prepare_sock_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+			CLIENT_PORT,
+			&client_sock,
+			&client_addr);
+
+	prepare_sock_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+			SERVER_PORT,
+			&server_sock,
+			&server_addr);
+
+	rv = bind(client_sock,
+		  (struct sockaddr *)&client_addr,
+		  sizeof(client_addr));
+	zassert_equal(rv, 0, "bind failed");
+
+	rv = bind(server_sock,
+		  (struct sockaddr *)&server_addr,
+		  sizeof(server_addr));
+	zassert_equal(rv, 0, "bind failed");
+
+	rv = sendmsg(client_sock, &msg, 0);
+	zassert_equal(rv, STRLEN(TEST_STR_SMALL), "sendmsg failed");
+
+	/* The datagram does not fit, the rest of it is discarded */
+	msg.msg_name = &addr;
+	msg.msg_namelen = sizeof(addr);
+	msg.msg_iov = rx_iov;
+	msg.msg_iovlen = ARRAY_SIZE(rx_iov);
+	rv = recvmsg(server_sock, &msg, 0);
+	zassert_equal(rv, sizeof(rx_head) + sizeof(rx_tail),
+		      "unexpected received bytes");
+	zassert_equal(rx_head[0], TEST_STR_SMALL[0], "unexpected data");
+	zassert_equal(memcmp(rx_tail, TEST_STR_SMALL + 1, sizeof(rx_tail)), 0,
+		      "unexpected data");
+	zassert_equal(msg.msg_flags, MSG_TRUNC, "datagram not truncated");
+	zassert_equal(msg.msg_namelen, sizeof(addr), "unexpected addrlen");
+	zassert_equal(addr.sin_port, client_addr.sin_port,
+		      "unexpected client port");
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+}
+
+void test_v4_send_recv_zc(void)
+{
+	int rv;
+	int client_sock;
+	int server_sock;
+	struct sockaddr_in client_addr;
+	struct sockaddr_in server_addr;
+	struct net_buf *frags;
+	char buf[10];
+	ssize_t len;
+
+	prepare_sock_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+			ANY_PORT,
+			&client_sock,
+			&client_addr);
+
+	prepare_sock_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+			SERVER_PORT,
+			&server_sock,
+			&server_addr);
+
+	rv = bind(server_sock,
+		  (struct sockaddr *)&server_addr,
+		  sizeof(server_addr));
+	zassert_equal(rv, 0, "bind failed");
+
+	frags = net_pkt_get_reserve_tx_data(0, K_FOREVER);
+	zassert_not_null(frags, "cannot get data buffer");
+	net_buf_add_mem(frags, TEST_STR_SMALL, STRLEN(TEST_STR_SMALL));
+
+	len = zsock_send_zc(client_sock, frags, 0,
+			    (struct sockaddr *)&server_addr,
+			    sizeof(server_addr));
+	zassert_equal(len, STRLEN(TEST_STR_SMALL), "zero-copy send failed");
+
+	len = zsock_recv_zc(server_sock, &frags, MSG_PEEK, NULL, NULL);
+	zassert_equal(len, -1, "zero-copy peek should fail");
+
+	len = zsock_recv_zc(server_sock, &frags, 0, NULL, NULL);
+	zassert_equal(len, STRLEN(TEST_STR_SMALL), "zero-copy recv failed");
+	zassert_equal(net_buf_frags_len(frags), len, "unexpected chain length");
+	zassert_equal(net_buf_linearize(buf, sizeof(buf), frags, 0, len), len,
+		      "linearize failed");
+	zassert_equal(memcmp(buf, TEST_STR_SMALL, len), 0, "unexpected data");
+	net_buf_unref(frags);
+
+	/* The stack takes the chain over even when sending fails */
+	frags = net_pkt_get_reserve_tx_data(0, K_FOREVER);
+	zassert_not_null(frags, "cannot get data buffer");
+	net_buf_add_mem(frags, TEST_STR_SMALL, STRLEN(TEST_STR_SMALL));
+	net_buf_ref(frags);
+
+	len = zsock_send_zc(-1, frags, 0, NULL, 0);
+	zassert_equal(len, -1, "zero-copy send on a bad socket should fail");
+	zassert_equal(frags->ref, 1, "chain not released on failure");
+	net_buf_unref(frags);
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+}
+
+void test_v4_sendmmsg_recvmmsg(void)
+{
+	int rv;
+	int i;
+	int client_sock;
+	int server_sock;
+	struct sockaddr_in client_addr;
+	struct sockaddr_in server_addr;
+	char rx_buf[3][10];
+	struct iovec tx_iov[3];
+	struct iovec rx_iov[3];
+	struct mmsghdr tx_msgs[3];
+	struct mmsghdr rx_msgs[3];
+
+	prepare_sock_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+			ANY_PORT,
+			&client_sock,
+			&client_addr);
+
+	prepare_sock_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+			SERVER_PORT,
+			&server_sock,
+			&server_addr);
+
+	rv = bind(server_sock,
+		  (struct sockaddr *)&server_addr,
+		  sizeof(server_addr));
+	zassert_equal(rv, 0, "bind failed");
+
+	(void)memset(tx_msgs, 0, sizeof(tx_msgs));
+	(void)memset(rx_msgs, 0, sizeof(rx_msgs));
+
+	/* Datagram i holds the first i + 2 characters of the test string */
+	for (i = 0; i < ARRAY_SIZE(tx_msgs); i++) {
+		tx_iov[i].iov_base = TEST_STR_SMALL;
+		tx_iov[i].iov_len = i + 2;
+		tx_msgs[i].msg_hdr.msg_name = &server_addr;
+		tx_msgs[i].msg_hdr.msg_namelen = sizeof(server_addr);
+		tx_msgs[i].msg_hdr.msg_iov = &tx_iov[i];
+		tx_msgs[i].msg_hdr.msg_iovlen = 1;
+
+		rx_iov[i].iov_base = rx_buf[i];
+		rx_iov[i].iov_len = sizeof(rx_buf[i]);
+		rx_msgs[i].msg_hdr.msg_iov = &rx_iov[i];
+		rx_msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	rv = recvmmsg(server_sock, rx_msgs, ARRAY_SIZE(rx_msgs), MSG_DONTWAIT);
+	zassert_equal(rv, -1, "recvmmsg should fail on empty socket");
+	zassert_equal(errno, EAGAIN, "unexpected errno");
+
+	rv = sendmmsg(client_sock, tx_msgs, ARRAY_SIZE(tx_msgs), 0);
+	zassert_equal(rv, ARRAY_SIZE(tx_msgs), "sendmmsg failed");
+
+	for (i = 0; i < ARRAY_SIZE(tx_msgs); i++) {
+		zassert_equal(tx_msgs[i].msg_len, i + 2, "unexpected sent len");
+	}
+
+	for (i = 0; i < ARRAY_SIZE(rx_msgs); i += rv) {
+		rv = recvmmsg(server_sock, &rx_msgs[i], ARRAY_SIZE(rx_msgs) - i,
+			      MSG_WAITFORONE);
+		zassert_true(rv > 0, "recvmmsg failed");
+	}
+
+	for (i = 0; i < ARRAY_SIZE(rx_msgs); i++) {
+		zassert_equal(rx_msgs[i].msg_len, i + 2,
+			      "unexpected received bytes");
+		zassert_equal(memcmp(rx_buf[i], TEST_STR_SMALL, i + 2), 0,
+			      "unexpected data");
+	}
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+}
+
 void test_main(void)
 {
 	ztest_test_suite(socket_udp,
@@ -332,7 +547,10 @@ void test_main(void)
 			 ztest_unit_test(test_v4_sendto_recvfrom),
 			 ztest_unit_test(test_v6_sendto_recvfrom),
 			 ztest_unit_test(test_v4_bind_sendto),
-			 ztest_unit_test(test_v6_bind_sendto));
+			 ztest_unit_test(test_v6_bind_sendto),
+			 ztest_unit_test(test_v4_sendmsg_recvmsg),
+			 ztest_unit_test(test_v4_send_recv_zc),
+			 ztest_unit_test(test_v4_sendmmsg_recvmmsg));
 
 	ztest_run_test_suite(socket_udp);
 }
@@ -82,6 +82,37 @@ static int accept_cb_called;
 #endif
 static bool syn_v6_sent;
 
+/* A remote host connecting to reply_v4_ctx, simulated by the test */
+#define CLIENT_TCP_PORT 4321
+#define CLIENT_ISN 1000
+#define CLIENT_WND 0xffff
+
+static struct in_addr client_v4_inaddr = { { { 192, 0, 2, 1 } } };
+static struct net_context *accepted_v4_ctx;
+static struct k_sem wait_accept;
+
+/* Next sequence number of the client, and next one it expects */
+static u32_t client_seq;
+static u32_t server_seq;
+
+static u8_t rx_data[64];
+static size_t rx_len;
+
+/* Segments sent to the client, as seen on the wire */
+#define MAX_SEGS 16
+
+struct seg {
+	u32_t seq;
+	u32_t ack;
+	u16_t len;
+	u8_t flags;
+};
+
+static struct seg segs[MAX_SEGS];
+static unsigned int seg_in;
+static unsigned int seg_out;
+static struct k_sem seg_sem;
+
 struct net_tcp_context {
 };
 
@@ -157,6 +188,37 @@ static int tester_send(struct net_if *iface, struct net_pkt *pkt)
 	return 0;
 }
 
+static void client_segment_sent(struct net_pkt *pkt)
+{
+	struct net_tcp_hdr hdr, *tcp_hdr;
+	struct seg *seg;
+
+	tcp_hdr = net_tcp_get_hdr(pkt, &hdr);
+	if (!tcp_hdr || seg_in - seg_out >= MAX_SEGS) {
+		test_failed = true;
+		return;
+	}
+
+	seg = &segs[seg_in % MAX_SEGS];
+	seg->seq = sys_get_be32(tcp_hdr->seq);
+	seg->ack = sys_get_be32(tcp_hdr->ack);
+	seg->len = net_pkt_get_len(pkt) - net_pkt_ip_hdr_len(pkt) -
+		   NET_TCP_HDR_LEN(tcp_hdr);
+	seg->flags = NET_TCP_FLAGS(tcp_hdr);
+	seg_in++;
+
+	k_sem_give(&seg_sem);
+}
+
+static struct seg *wait_segment(s32_t timeout)
+{
+	if (k_sem_take(&seg_sem, timeout)) {
+		return NULL;
+	}
+
+	return &segs[seg_out++ % MAX_SEGS];
+}
+
 static int tester_send_peer(struct net_if *iface, struct net_pkt *pkt)
 {
 	if (!pkt->frags) {
@@ -164,6 +226,11 @@ static int tester_send_peer(struct net_if *iface, struct net_pkt *pkt)
 		return -ENODATA;
 	}
 
+	if (net_pkt_family(pkt) == AF_INET &&
+	    net_ipv4_addr_cmp(&NET_IPV4_HDR(pkt)->dst, &client_v4_inaddr)) {
+		client_segment_sent(pkt);
+	}
+
 	DBG("Peer data was sent successfully\n");
 
 	net_pkt_unref(pkt);
@@ -1204,6 +1271,87 @@ static bool test_create_v4_fin_packet(void)
 	return true;
 }
 
+static bool test_parse_options(void)
+{
+	static u8_t options[] = {
+		NET_TCP_MSS_OPT, NET_TCP_MSS_SIZE, 0x05, 0x78,
+		NET_TCP_NOP_OPT, NET_TCP_WINDOW_SCALE_OPT,
+		NET_TCP_WINDOW_SCALE_SIZE, 20,
+		NET_TCP_NOP_OPT, NET_TCP_NOP_OPT,
+		NET_TCP_SACK_PERM_OPT, NET_TCP_SACK_PERM_SIZE,
+		NET_TCP_NOP_OPT, NET_TCP_NOP_OPT,
+		NET_TCP_SACK_OPT, 2 + 2 * NET_TCP_SACK_BLOCK_SIZE,
+		0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x14, 0x00,
+		0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x28, 0x00,
+	};
+	struct net_tcp_options opts = { 0 };
+	struct net_pkt *pkt = NULL;
+	int ret;
+
+	ret = net_tcp_prepare_segment(v4_ctx->tcp, NET_TCP_PSH, options,
+				      sizeof(options), NULL,
+				      (struct sockaddr *)&peer_v4_addr, &pkt);
+	if (ret) {
+		DBG("Prepare segment failed (%d)\n", ret);
+		return false;
+	}
+
+	ret = net_tcp_parse_opts(pkt, sizeof(options), &opts);
+
+	net_pkt_unref(pkt);
+
+	if (ret) {
+		DBG("Parsing options failed (%d)\n", ret);
+		return false;
+	}
+
+	if (opts.mss != 1400) {
+		DBG("Invalid MSS %u\n", opts.mss);
+		return false;
+	}
+
+	/* Shift counts above 14 are used as 14 */
+	if (!opts.wscale_set || opts.wscale != NET_TCP_MAX_WINDOW_SCALE) {
+		DBG("Invalid window scale %u\n", opts.wscale);
+		return false;
+	}
+
+	if (!opts.sack_permitted) {
+		DBG("SACK permitted option not found\n");
+		return false;
+	}
+
+	if (opts.sack_count != 2 ||
+	    opts.sack[0].start != 0x1000 || opts.sack[0].end != 0x1400 ||
+	    opts.sack[1].start != 0x2000 || opts.sack[1].end != 0x2800) {
+		DBG("Invalid SACK blocks\n");
+		return false;
+	}
+
+	/* A SACK option must hold whole blocks */
+	options[15] = 2 + NET_TCP_SACK_BLOCK_SIZE - 2;
+	pkt = NULL;
+
+	ret = net_tcp_prepare_segment(v4_ctx->tcp, NET_TCP_PSH, options,
+				      sizeof(options), NULL,
+				      (struct sockaddr *)&peer_v4_addr, &pkt);
+	if (ret) {
+		DBG("Prepare segment failed (%d)\n", ret);
+		return false;
+	}
+
+	ret = net_tcp_parse_opts(pkt, sizeof(options), &opts);
+
+	net_pkt_unref(pkt);
+
+	if (ret != -EINVAL) {
+		DBG("Truncated SACK block accepted\n");
+		return false;
+	}
+
+	return true;
+}
+
 static bool test_v6_seq_check(void)
 {
 	struct net_tcp *tcp = v6_ctx->tcp;
@@ -1549,6 +1697,11 @@ static void accept_v4_cb(struct net_context *new_context,
 			 void *user_data)
 {
 	DBG("error %d\n", error);
+
+	if (!error) {
+		accepted_v4_ctx = new_context;
+		k_sem_give(&wait_accept);
+	}
 }
 
 static bool test_init_tcp_accept(void)
@@ -1586,6 +1739,433 @@ static bool test_init_tcp_accept(void)
 	return true;
 }
 
+/* Make the client send a segment to reply_v4_ctx with the given options,
+ * acknowledging server_seq if flags has ACK.
+ */
+static bool client_send_opts(u8_t flags, u32_t seq, const u8_t *opts,
+			     u16_t optlen, const u8_t *data, u16_t len)
+{
+	struct net_ipv4_hdr ipv4 = { 0 };
+	struct net_tcp_hdr tcp_hdr = { 0 };
+	struct net_pkt *pkt;
+	struct net_buf *frag;
+	int ret;
+
+	ipv4.vhl = 0x45;
+	ipv4.ttl = 64;
+	ipv4.len = htons(sizeof(ipv4) + sizeof(tcp_hdr) + optlen + len);
+	ipv4.proto = IPPROTO_TCP;
+
+	net_ipaddr_copy(&ipv4.src, &client_v4_inaddr);
+	net_ipaddr_copy(&ipv4.dst, &peer_v4_inaddr);
+
+	tcp_hdr.src_port = htons(CLIENT_TCP_PORT);
+	tcp_hdr.dst_port = htons(PEER_TCP_PORT);
+	tcp_hdr.offset = ((sizeof(tcp_hdr) + optlen) / 4) << 4;
+	tcp_hdr.flags = flags;
+
+	sys_put_be32(seq, tcp_hdr.seq);
+	if (flags & NET_TCP_ACK) {
+		sys_put_be32(server_seq, tcp_hdr.ack);
+	}
+
+	sys_put_be16(CLIENT_WND, tcp_hdr.wnd);
+
+	pkt = net_pkt_get_reserve_tx(0, K_FOREVER);
+
+	net_pkt_set_ll_reserve(pkt, 0);
+
+	frag = net_pkt_get_frag(pkt, K_FOREVER);
+
+	net_pkt_frag_add(pkt, frag);
+
+	net_pkt_append_all(pkt, sizeof(ipv4), (u8_t *)&ipv4, K_FOREVER);
+	net_pkt_append_all(pkt, sizeof(tcp_hdr), (u8_t *)&tcp_hdr, K_FOREVER);
+
+	if (optlen) {
+		net_pkt_append_all(pkt, optlen, opts, K_FOREVER);
+	}
+
+	if (len) {
+		net_pkt_append_all(pkt, len, data, K_FOREVER);
+	}
+
+	ret = net_recv_data(peer_iface, pkt);
+	if (ret < 0) {
+		DBG("Cannot recv pkt %p, ret %d\n", pkt, ret);
+		net_pkt_unref(pkt);
+		return false;
+	}
+
+	return true;
+}
+
+/* Same as client_send_opts(), a SYN permitting SACK */
+static bool client_send(u8_t flags, u32_t seq, const u8_t *data, u16_t len)
+{
+	static const u8_t syn_options[] = {
+		NET_TCP_SACK_PERM_OPT, NET_TCP_SACK_PERM_SIZE,
+		NET_TCP_NOP_OPT, NET_TCP_NOP_OPT,
+	};
+
+	if (flags & NET_TCP_SYN) {
+		return client_send_opts(flags, seq, syn_options,
+					sizeof(syn_options), data, len);
+	}
+
+	return client_send_opts(flags, seq, NULL, 0, data, len);
+}
+
+static void recv_v4_cb(struct net_context *context,
+		       struct net_pkt *pkt,
+		       int status,
+		       void *user_data)
+{
+	u16_t len;
+
+	if (!pkt) {
+		return;
+	}
+
+	len = net_pkt_appdatalen(pkt);
+
+	if (len > sizeof(rx_data) - rx_len ||
+	    net_frag_linearize(rx_data + rx_len, sizeof(rx_data) - rx_len,
+			       pkt, net_pkt_get_len(pkt) - len, len) != len) {
+		DBG("Cannot store %u bytes received\n", len);
+		test_failed = true;
+	} else {
+		rx_len += len;
+	}
+
+	net_pkt_unref(pkt);
+}
+
+static bool test_v4_accept_peer(void)
+{
+	struct seg *seg;
+	int ret;
+
+	client_seq = CLIENT_ISN;
+
+	if (!client_send(NET_TCP_SYN, client_seq, NULL, 0)) {
+		return false;
+	}
+
+	client_seq++;
+
+	seg = wait_segment(WAIT_TIME);
+	if (!seg || seg->flags != (NET_TCP_SYN | NET_TCP_ACK) ||
+	    seg->ack != client_seq) {
+		TC_ERROR("No SYN-ACK from the listening context\n");
+		return false;
+	}
+
+	server_seq = seg->seq + 1;
+
+	if (!client_send(NET_TCP_ACK, client_seq, NULL, 0)) {
+		return false;
+	}
+
+	if (k_sem_take(&wait_accept, WAIT_TIME)) {
+		TC_ERROR("Connection from the client not accepted\n");
+		return false;
+	}
+
+	ret = net_context_recv(accepted_v4_ctx, recv_v4_cb, K_NO_WAIT, NULL);
+	if (ret) {
+		TC_ERROR("Context recv v4 test failed (%d)\n", ret);
+		return false;
+	}
+
+	return true;
+}
+
+static bool test_v4_out_of_order(void)
+{
+	static const u8_t data[] = { 'h', 'e', 'l', 'l', 'o',
+				     'w', 'o', 'r', 'l', 'd' };
+	u32_t seq = client_seq;
+	struct seg *seg;
+
+	rx_len = 0;
+
+	/* The second half first: it is held or dropped, and the gap is
+	 * reported right away with a duplicate ACK.
+	 */
+	if (!client_send(NET_TCP_PSH | NET_TCP_ACK, seq + 5, data + 5, 5)) {
+		return false;
+	}
+
+	seg = wait_segment(WAIT_TIME);
+	if (!seg || seg->ack != seq || rx_len != 0) {
+		TC_ERROR("Gap before out-of-order data not reported\n");
+		return false;
+	}
+
+	if (!client_send(NET_TCP_PSH | NET_TCP_ACK, seq, data, 5)) {
+		return false;
+	}
+
+	seg = wait_segment(WAIT_TIME);
+	if (seg && seg->ack == seq + 5 &&
+	    !IS_ENABLED(CONFIG_NET_TCP_OUT_OF_ORDER_QUEUE)) {
+		/* Dropped, so the client sends it again */
+		if (!client_send(NET_TCP_PSH | NET_TCP_ACK, seq + 5,
+				 data + 5, 5)) {
+			return false;
+		}
+
+		seg = wait_segment(WAIT_TIME);
+	}
+
+	if (!seg || seg->ack != seq + sizeof(data)) {
+		TC_ERROR("Data not acknowledged after the gap was filled\n");
+		return false;
+	}
+
+	if (rx_len != sizeof(data) || memcmp(rx_data, data, rx_len)) {
+		TC_ERROR("Data not received in order (%zu bytes)\n", rx_len);
+		return false;
+	}
+
+#if defined(CONFIG_NET_TCP_OUT_OF_ORDER_QUEUE)
+	if (accepted_v4_ctx->tcp->ooo_count != 0) {
+		TC_ERROR("Out-of-order segments still held\n");
+		return false;
+	}
+#endif
+
+	client_seq = seq + sizeof(data);
+
+	return true;
+}
+
+#define LOSS_SEG_LEN 100
+#define LOSS_SEGS 4
+
+static bool server_send(void)
+{
+	static u8_t data[LOSS_SEG_LEN];
+	struct net_pkt *pkt;
+	int ret;
+
+	pkt = net_pkt_get_tx(accepted_v4_ctx, K_FOREVER);
+
+	if (!net_pkt_append_all(pkt, sizeof(data), data, K_FOREVER)) {
+		net_pkt_unref(pkt);
+		return false;
+	}
+
+	ret = net_context_send(pkt, NULL, K_NO_WAIT, NULL, NULL);
+	if (ret < 0) {
+		TC_ERROR("Context send v4 test failed (%d)\n", ret);
+		net_pkt_unref(pkt);
+		return false;
+	}
+
+	return true;
+}
+
+static bool test_v4_loss_recovery(void)
+{
+	struct net_tcp *tcp = accepted_v4_ctx->tcp;
+	u32_t seq = server_seq;
+	struct seg *seg;
+	int i;
+
+	/* Each send puts its own segment on the wire, and none of those
+	 * sent before it again.
+	 */
+	for (i = 0; i < LOSS_SEGS; i++) {
+		if (!server_send()) {
+			return false;
+		}
+
+		seg = wait_segment(WAIT_TIME);
+		if (!seg || seg->seq != seq + i * LOSS_SEG_LEN ||
+		    seg->len != LOSS_SEG_LEN) {
+			TC_ERROR("Segment %d not sent, or not once\n", i);
+			return false;
+		}
+	}
+
+	/* The first segment is lost, each of the others draws a
+	 * duplicate ACK.
+	 */
+	for (i = 1; i < LOSS_SEGS; i++) {
+		if (!client_send(NET_TCP_ACK, client_seq, NULL, 0)) {
+			return false;
+		}
+	}
+
+	/* Fast retransmit sends it again on the third duplicate ACK,
+	 * the retransmission timer does without congestion control.
+	 */
+	seg = wait_segment(WAIT_TIME_LONG);
+	if (!seg || seg->seq != seq || seg->len != LOSS_SEG_LEN) {
+		TC_ERROR("Lost segment not sent again\n");
+		return false;
+	}
+
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+	if (!(tcp->flags & NET_TCP_FAST_RECOVERY)) {
+		TC_ERROR("Fast recovery not entered\n");
+		return false;
+	}
+#endif
+
+	server_seq = seq + LOSS_SEGS * LOSS_SEG_LEN;
+
+	if (!client_send(NET_TCP_ACK, client_seq, NULL, 0)) {
+		return false;
+	}
+
+	/* Only the lost segment may have gone out again meanwhile */
+	while ((seg = wait_segment(WAIT_TIME))) {
+		if (seg->seq != seq) {
+			TC_ERROR("Segment at offset %u sent again\n",
+				 seg->seq - seq);
+			return false;
+		}
+	}
+
+	if (!sys_slist_is_empty(&tcp->sent_list)) {
+		TC_ERROR("Acknowledged segments still held\n");
+		return false;
+	}
+
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+	if (tcp->send_una != server_seq ||
+	    (tcp->flags & NET_TCP_FAST_RECOVERY)) {
+		TC_ERROR("Fast recovery not left\n");
+		return false;
+	}
+#endif
+
+	return true;
+}
+
+#if defined(CONFIG_NET_TCP_SACK)
+#define SACK_SEGS 5
+
+/* Blocks of segments the client reports as received, as segment
+ * indexes, end excluded.
+ */
+struct sack_blocks {
+	int count;
+	u8_t seg[NET_TCP_MAX_SACK_BLOCKS][2];
+};
+
+/* Make the client acknowledge server_seq again, with SACK blocks of
+ * the segments of LOSS_SEG_LEN bytes sent from seq.
+ */
+static bool client_send_sack(u32_t seq, const struct sack_blocks *blocks)
+{
+	u8_t opts[4 + NET_TCP_MAX_SACK_BLOCKS * NET_TCP_SACK_BLOCK_SIZE];
+	u8_t *block = &opts[4];
+	int i;
+
+	opts[0] = NET_TCP_NOP_OPT;
+	opts[1] = NET_TCP_NOP_OPT;
+	opts[2] = NET_TCP_SACK_OPT;
+	opts[3] = 2 + blocks->count * NET_TCP_SACK_BLOCK_SIZE;
+
+	for (i = 0; i < blocks->count; i++) {
+		sys_put_be32(seq + blocks->seg[i][0] * LOSS_SEG_LEN, block);
+		sys_put_be32(seq + blocks->seg[i][1] * LOSS_SEG_LEN,
+			     block + 4);
+		block += NET_TCP_SACK_BLOCK_SIZE;
+	}
+
+	return client_send_opts(NET_TCP_ACK, client_seq, opts,
+				block - opts, NULL, 0);
+}
+
+static bool test_v4_sack_recovery(void)
+{
+	/* Segments 0 and 2 are lost, each of the others draws a
+	 * duplicate ACK reporting what was received so far, and one
+	 * more comes once segment 0 was sent again.
+	 */
+	static const struct sack_blocks dup_acks[] = {
+		{ 1, { { 1, 2 } } },
+		{ 2, { { 3, 4 }, { 1, 2 } } },
+		{ 2, { { 3, 5 }, { 1, 2 } } },
+		{ 2, { { 3, 5 }, { 1, 2 } } },
+	};
+	struct net_tcp *tcp = accepted_v4_ctx->tcp;
+	u32_t seq = server_seq;
+	struct seg *seg;
+	int i;
+
+	if (!(tcp->flags & NET_TCP_SACK_PERMITTED)) {
+		TC_ERROR("SACK not agreed on with the client\n");
+		return false;
+	}
+
+	for (i = 0; i < SACK_SEGS; i++) {
+		if (!server_send()) {
+			return false;
+		}
+
+		seg = wait_segment(WAIT_TIME);
+		if (!seg || seg->seq != seq + i * LOSS_SEG_LEN) {
+			TC_ERROR("Segment %d not sent\n", i);
+			return false;
+		}
+	}
+
+	for (i = 0; i < NET_TCP_DUP_ACK_THRESHOLD; i++) {
+		if (!client_send_sack(seq, &dup_acks[i])) {
+			return false;
+		}
+	}
+
+	/* The third duplicate ACK sends the first segment again */
+	seg = wait_segment(WAIT_TIME);
+	if (!seg || seg->seq != seq) {
+		TC_ERROR("First lost segment not sent again\n");
+		return false;
+	}
+
+	/* The next one the hole SACK reports after it, not the segment
+	 * after the first one nor new data.
+	 */
+	if (!client_send_sack(seq, &dup_acks[i])) {
+		return false;
+	}
+
+	seg = wait_segment(WAIT_TIME);
+	if (!seg || seg->seq != seq + 2 * LOSS_SEG_LEN ||
+	    seg->len != LOSS_SEG_LEN) {
+		TC_ERROR("Second lost segment not sent again\n");
+		return false;
+	}
+
+	server_seq = seq + SACK_SEGS * LOSS_SEG_LEN;
+
+	if (!client_send(NET_TCP_ACK, client_seq, NULL, 0)) {
+		return false;
+	}
+
+	seg = wait_segment(WAIT_TIME);
+	if (seg) {
+		TC_ERROR("Segment at offset %u sent after recovery\n",
+			 seg->seq - seq);
+		return false;
+	}
+
+	if (!sys_slist_is_empty(&tcp->sent_list) ||
+	    (tcp->flags & NET_TCP_FAST_RECOVERY)) {
+		TC_ERROR("Fast recovery not left\n");
+		return false;
+	}
+
+	return true;
+}
+#endif /* CONFIG_NET_TCP_SACK */
+
 #if 0
 static bool test_init_tcp_connect(void)
 {
@@ -1701,6 +2281,8 @@ static bool test_init(void)
 	any_addr4.sin_family = AF_INET;
 
 	k_sem_init(&wait_connect, 0, UINT_MAX);
+	k_sem_init(&wait_accept, 0, UINT_MAX);
+	k_sem_init(&seg_sem, 0, UINT_MAX);
 
 	return true;
 }
@@ -1733,6 +2315,14 @@ static bool test_cleanup(void)
 		return false;
 	}
 
+	if (accepted_v4_ctx) {
+		ret = net_context_put(accepted_v4_ctx);
+		if (ret != 0) {
+			TC_ERROR("Context free accepted v4 failed.\n");
+			return false;
+		}
+	}
+
 	return true;
 }
 
@@ -1751,11 +2341,18 @@ static const struct {
 	{ "test IPv4 TCP synack packet create", test_create_v4_synack_packet },
 	{ "test IPv6 TCP fin packet creation", test_create_v6_fin_packet },
 	{ "test IPv4 TCP fin packet creation", test_create_v4_fin_packet },
+	{ "test TCP option parsing", test_parse_options },
 	{ "test IPv6 TCP seq check", test_v6_seq_check },
 	{ "test IPv4 TCP seq check", test_v4_seq_check },
 	{ "test TCP seq validity", test_tcp_seq_validity },
 	{ "test TCP reply context init", test_init_tcp_reply_context },
 	{ "test TCP accept init", test_init_tcp_accept },
+	{ "test IPv4 TCP accept from peer", test_v4_accept_peer },
+	{ "test IPv4 TCP out-of-order reassembly", test_v4_out_of_order },
+	{ "test IPv4 TCP loss recovery", test_v4_loss_recovery },
+#if defined(CONFIG_NET_TCP_SACK)
+	{ "test IPv4 TCP SACK recovery", test_v4_sack_recovery },
+#endif
 #if 0
 	/* TBD: more tests are needed */
 	{ "test TCP connect init", test_init_tcp_connect },
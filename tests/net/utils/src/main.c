@@ -539,6 +539,74 @@ void test_utils(void)
 #endif /* CONFIG_NET_IPV4 */
 }
 
+void test_chksum_update(void)
+{
+#if defined(CONFIG_NET_IPV4)
+	struct net_ipv4_hdr *hdr;
+	struct net_icmp_hdr *icmp_hdr;
+	struct net_pkt *pkt;
+	struct net_buf *frag;
+	struct in_addr addr = { { { 192, 0, 2, 1 } } };
+	u16_t old_word, new_word, chksum;
+	u32_t old_addr;
+
+	pkt = net_pkt_get_reserve_rx(0, K_SECONDS(1));
+	zassert_not_null(pkt, "Out of mem");
+
+	frag = net_pkt_get_reserve_rx_data(sizeof(struct net_eth_hdr),
+					   K_SECONDS(1));
+	zassert_not_null(frag, "Out of mem");
+
+	net_pkt_frag_add(pkt, frag);
+
+	net_pkt_set_ll_reserve(pkt, sizeof(struct net_eth_hdr));
+	memcpy(net_pkt_ll(pkt), pkt5, sizeof(pkt5));
+	net_buf_add(frag, sizeof(pkt5) - sizeof(struct net_eth_hdr));
+
+	net_pkt_set_ip_hdr_len(pkt, sizeof(struct net_ipv4_hdr));
+	net_pkt_set_family(pkt, AF_INET);
+	net_pkt_set_ipv6_ext_len(pkt, 0);
+
+	hdr = NET_IPV4_HDR(pkt);
+	icmp_hdr = (struct net_icmp_hdr *)(frag->data +
+					   net_pkt_ip_hdr_len(pkt));
+
+	hdr->chksum = 0;
+	hdr->chksum = ~net_calc_chksum_ipv4(pkt);
+	icmp_hdr->chksum = 0;
+	icmp_hdr->chksum = ~net_calc_chksum(pkt, IPPROTO_ICMP);
+
+	/* Decrement the TTL, which shares a word with the protocol */
+	old_word = htons(hdr->ttl << 8 | hdr->proto);
+	hdr->ttl--;
+	new_word = htons(hdr->ttl << 8 | hdr->proto);
+	hdr->chksum = net_chksum_update16(hdr->chksum, old_word, new_word);
+
+	/* Rewrite the source address */
+	memcpy(&old_addr, &hdr->src, sizeof(old_addr));
+	net_ipaddr_copy(&hdr->src, &addr);
+	hdr->chksum = net_chksum_update32(hdr->chksum, old_addr,
+					  addr.s_addr);
+
+	chksum = hdr->chksum;
+	hdr->chksum = 0;
+	zassert_equal(chksum, (u16_t)~net_calc_chksum_ipv4(pkt),
+		      "Invalid IPv4 header chksum update");
+
+	/* Turn the echo request into a reply */
+	old_word = htons(icmp_hdr->type << 8 | icmp_hdr->code);
+	icmp_hdr->type = 0;
+	icmp_hdr->chksum = net_chksum_update16(icmp_hdr->chksum, old_word, 0);
+
+	chksum = icmp_hdr->chksum;
+	icmp_hdr->chksum = 0;
+	zassert_equal(chksum, (u16_t)~net_calc_chksum(pkt, IPPROTO_ICMP),
+		      "Invalid ICMPv4 chksum update");
+
+	net_pkt_unref(pkt);
+#endif /* CONFIG_NET_IPV4 */
+}
+
 struct net_addr_test_data {
 	sa_family_t family;
 	bool pton;
@@ -1604,6 +1672,7 @@ void test_main(void)
 {
 	ztest_test_suite(test_utils_fn,
 			 ztest_unit_test(test_utils),
+			 ztest_unit_test(test_chksum_update),
 			 ztest_unit_test(test_net_addr),
 			 ztest_unit_test(test_addr_parse),
 			 ztest_unit_test(test_net_pkt_addr_parse));